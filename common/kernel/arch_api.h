@@ -84,6 +84,8 @@ template <typename R> struct ArchAPI : BaseCtx
     virtual NetInfo *getConflictingWireNet(WireId wire) const = 0;
     virtual DelayQuad getWireDelay(WireId wire) const = 0;
     virtual IdString getWireConstantValue(WireId wire) const = 0;
+    virtual int getWireIndex(WireId wire) const = 0;
+    virtual int getWireCount() const = 0;
     // Pip methods
     virtual typename R::AllPipsRangeT getPips() const = 0;
     virtual PipId getPipByName(IdStringList name) const = 0;
@@ -113,6 +115,7 @@ template <typename R> struct ArchAPI : BaseCtx
     virtual typename R::GroupGroupsRangeT getGroupGroups(GroupId group) const = 0;
     // Delay Methods
     virtual delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const = 0;
+    virtual bool isPredictDelayRelative() const = 0;
     virtual delay_t getDelayEpsilon() const = 0;
     virtual delay_t getRipupDelayPenalty() const = 0;
     virtual float getDelayNS(delay_t v) const = 0;
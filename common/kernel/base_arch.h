@@ -202,7 +202,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void bindWire(WireId wire, NetInfo *net, PlaceStrength strength) override
     {
         NPNR_ASSERT(wire != WireId());
-        auto &w2n_entry = base_wire2net[wire];
+        auto &w2n_entry = base_wire2net_entry(wire);
         NPNR_ASSERT(w2n_entry == nullptr);
         net->wires[wire].pip = PipId();
         net->wires[wire].strength = strength;
@@ -212,7 +212,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void unbindWire(WireId wire) override
     {
         NPNR_ASSERT(wire != WireId());
-        auto &w2n_entry = base_wire2net[wire];
+        auto &w2n_entry = base_wire2net_entry(wire);
         NPNR_ASSERT(w2n_entry != nullptr);
 
         auto &net_wires = w2n_entry->wires;
@@ -225,20 +225,28 @@ template <typename R> struct BaseArch : ArchAPI<R>
         }
 
         net_wires.erase(it);
-        base_wire2net[wire] = nullptr;
-
         w2n_entry = nullptr;
         this->refreshUiWire(wire);
     }
     virtual bool checkWireAvail(WireId wire) const override { return getBoundWireNet(wire) == nullptr; }
     virtual NetInfo *getBoundWireNet(WireId wire) const override
     {
-        auto fnd = base_wire2net.find(wire);
-        return fnd == base_wire2net.end() ? nullptr : fnd->second;
+        int idx = this->getWireIndex(wire);
+        return idx < int(base_wire2net.size()) ? base_wire2net[idx] : nullptr;
     }
     virtual WireId getConflictingWireWire(WireId wire) const override { return wire; };
     virtual NetInfo *getConflictingWireNet(WireId wire) const override { return getBoundWireNet(wire); }
     virtual IdString getWireConstantValue(WireId /*wire*/) const override { return {}; }
+    virtual int getWireIndex(WireId wire) const override
+    {
+        init_base_wire_index();
+        return base_wire_index.at(wire);
+    }
+    virtual int getWireCount() const override
+    {
+        init_base_wire_index();
+        return int(base_wire_index.size());
+    }
 
     // Pip methods
     virtual IdString getPipType(PipId /*pip*/) const override { return IdString(); }
@@ -255,7 +263,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
         p2n_entry = net;
 
         WireId dst = this->getPipDstWire(pip);
-        auto &w2n_entry = base_wire2net[dst];
+        auto &w2n_entry = base_wire2net_entry(dst);
         NPNR_ASSERT(w2n_entry == nullptr);
         w2n_entry = net;
         net->wires[dst].pip = pip;
@@ -268,7 +276,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
         NPNR_ASSERT(p2n_entry != nullptr);
         WireId dst = this->getPipDstWire(pip);
 
-        auto &w2n_entry = base_wire2net[dst];
+        auto &w2n_entry = base_wire2net_entry(dst);
         NPNR_ASSERT(w2n_entry != nullptr);
         w2n_entry = nullptr;
 
@@ -316,6 +324,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     };
 
     // Delay methods
+    virtual bool isPredictDelayRelative() const override { return false; }
     virtual bool getArcDelayOverride(const NetInfo * /*net_info*/, const PortRef & /*sink*/,
                                      DelayQuad & /*delay*/) const override
     {
@@ -465,9 +474,31 @@ template <typename R> struct BaseArch : ArchAPI<R>
     // replace them with their own, for example to use faster access structures than dict. Arches might also
     // want to add extra checks around these functions
     dict<BelId, CellInfo *> base_bel2cell;
-    dict<WireId, NetInfo *> base_wire2net;
+    // indexed by getWireIndex()
+    std::vector<NetInfo *> base_wire2net;
     dict<PipId, NetInfo *> base_pip2net;
 
+    NetInfo *&base_wire2net_entry(WireId wire)
+    {
+        int idx = this->getWireIndex(wire);
+        if (idx >= int(base_wire2net.size()))
+            base_wire2net.resize(this->getWireCount(), nullptr);
+        return base_wire2net.at(idx);
+    }
+
+    // For the default dense wire index, for arches that don't have a natural flat numbering of wires. This is built on
+    // first use, which must not happen from a multithreaded context
+    mutable dict<WireId, int> base_wire_index;
+    mutable bool base_wire_index_initialised = false;
+    void init_base_wire_index() const
+    {
+        if (base_wire_index_initialised)
+            return;
+        for (auto wire : this->getWires())
+            base_wire_index.emplace(wire, int(base_wire_index.size()));
+        base_wire_index_initialised = true;
+    }
+
     // For the default cell/bel bucket implementations
     std::vector<IdString> cell_types;
     std::vector<BelBucketId> bel_buckets;
@@ -30,6 +30,7 @@
 
 #include "hashlib.h"
 #include "idstring.h"
+#include "idstring_db.h"
 #include "nextpnr_namespaces.h"
 #include "nextpnr_types.h"
 #include "property.h"
@@ -52,9 +53,8 @@ struct BaseCtx
     std::mutex ui_mutex;
 #endif
 
-    // ID String database.
-    mutable std::unordered_map<std::string, int> *idstring_str_to_idx;
-    mutable std::vector<const std::string *> *idstring_idx_to_str;
+    // ID String database, safe to add to from several threads at once.
+    mutable IdStringDB *idstring_db;
 
     // Temporary string backing store for logging
     mutable StrRingBuffer log_strs;
@@ -94,19 +94,14 @@ struct BaseCtx
 
     BaseCtx()
     {
-        idstring_str_to_idx = new std::unordered_map<std::string, int>;
-        idstring_idx_to_str = new std::vector<const std::string *>;
+        idstring_db = new IdStringDB;
         IdString::initialize_add(this, "", 0);
         IdString::initialize_arch(this);
 
         design_loaded = false;
     }
 
-    virtual ~BaseCtx()
-    {
-        delete idstring_str_to_idx;
-        delete idstring_idx_to_str;
-    }
+    virtual ~BaseCtx() { delete idstring_db; }
 
     // Must be called before performing any mutating changes on the Ctx/Arch.
     void lock(void)
@@ -0,0 +1,661 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include "base_clusterinfo.h"
+#include "log.h"
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+/*
+ * Binary design checkpoints
+ *
+ * Everything is little endian. The file is
+ *
+ *   header:  magic "NPNRCKPT", u32 version, u32 stage, str arch, str chip
+ *   body:    settings, attrs, hierarchy, cells, nets, net aliases, bel bindings, routing
+ *   ids:     u32 count, then count strs; the IdStrings used by the body, which refers to them by their index here
+ *   trailer: u64 offset of ids, magic "NPNRCKPT"
+ *
+ * where str is a u32 length followed by that many bytes, id is a u32 index into ids (0 being the empty IdString), and
+ * every list is a u32 count followed by its entries. Keeping the ids at the end lets the writer stream the body out
+ * as it goes; the reader maps the file and so can jump straight to them.
+ *
+ * Bels, wires and pips are stored by name, as their ids aren't stable between builds of an arch. Arch specific cell
+ * and net data isn't stored, other than what assignArchInfo can rebuild, which is also true of JSON checkpoints.
+ */
+
+namespace {
+
+const char checkpoint_magic[8] = {'N', 'P', 'N', 'R', 'C', 'K', 'P', 'T'};
+const uint32_t checkpoint_version = 1;
+
+// dicts iterate newest first, so entries are written oldest first in order that the reader, inserting them as it
+// goes, ends up with the same iteration order as the writer (which placers and routers depend on for determinism)
+template <typename Tdict, typename TFunc> void foreach_in_order(const Tdict &values, TFunc Func)
+{
+    std::vector<const typename Tdict::value_type *> entries;
+    entries.reserve(values.size());
+    for (auto &value : values)
+        entries.push_back(&value);
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+        Func(**it);
+}
+
+struct CheckpointWriter
+{
+    CheckpointWriter(const Context *ctx, std::ostream &out) : ctx(ctx), out(out)
+    {
+        // Index 0 is always the empty IdString
+        ids.push_back(IdString());
+        id_index[IdString()] = 0;
+    }
+    const Context *ctx;
+    std::ostream &out;
+    std::string buf;
+    uint64_t written = 0;
+    std::vector<IdString> ids;
+    dict<IdString, uint32_t> id_index;
+
+    void flush()
+    {
+        out.write(buf.data(), buf.size());
+        written += buf.size();
+        buf.clear();
+    }
+
+    void raw(const void *data, size_t len)
+    {
+        buf.append(reinterpret_cast<const char *>(data), len);
+        if (buf.size() >= (1 << 20))
+            flush();
+    }
+
+    template <typename T> void uint(T value)
+    {
+        uint8_t bytes[sizeof(T)];
+        for (size_t i = 0; i < sizeof(T); i++)
+            bytes[i] = uint8_t(uint64_t(value) >> (8 * i));
+        raw(bytes, sizeof(T));
+    }
+
+    void u8(uint8_t value) { uint(value); }
+    void u32(uint32_t value) { uint(value); }
+    void i32(int32_t value) { uint(uint32_t(value)); }
+    void u64(uint64_t value) { uint(value); }
+
+    void f64(double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        u64(bits);
+    }
+
+    void str(const std::string &value)
+    {
+        u32(uint32_t(value.size()));
+        raw(value.data(), value.size());
+    }
+
+    void id(IdString value)
+    {
+        auto fnd = id_index.find(value);
+        if (fnd != id_index.end()) {
+            u32(fnd->second);
+            return;
+        }
+        uint32_t idx = uint32_t(ids.size());
+        ids.push_back(value);
+        id_index.emplace(value, idx);
+        u32(idx);
+    }
+
+    void id_list(const IdStringList &value)
+    {
+        u32(uint32_t(value.size()));
+        for (auto entry : value)
+            id(entry);
+    }
+
+    void delay_pair(const DelayPair &value)
+    {
+        f64(value.min_delay);
+        f64(value.max_delay);
+    }
+
+    void props(const dict<IdString, Property> &values)
+    {
+        u32(uint32_t(values.size()));
+        foreach_in_order(values, [&](const std::pair<IdString, Property> &value) {
+            id(value.first);
+            u8(value.second.is_string);
+            str(value.second.str);
+        });
+    }
+
+    void id_map(const dict<IdString, IdString> &values)
+    {
+        u32(uint32_t(values.size()));
+        foreach_in_order(values, [&](const std::pair<IdString, IdString> &value) {
+            id(value.first);
+            id(value.second);
+        });
+    }
+
+    void cell(const CellInfo *ci)
+    {
+        id(ci->name);
+        id(ci->type);
+        id(ci->hierpath);
+        props(ci->attrs);
+        props(ci->params);
+        u32(uint32_t(ci->ports.size()));
+        foreach_in_order(ci->ports, [&](const std::pair<IdString, PortInfo> &port) {
+            id(port.first);
+            u8(uint8_t(port.second.type));
+        });
+        id(ci->cluster);
+        if constexpr (std::is_base_of<BaseClusterInfo, ArchCellInfo>::value) {
+            u32(uint32_t(ci->constr_children.size()));
+            for (auto child : ci->constr_children)
+                id(child->name);
+            i32(ci->constr_x);
+            i32(ci->constr_y);
+            i32(ci->constr_z);
+            u8(ci->constr_abs_z);
+        }
+    }
+
+    void net(const NetInfo *ni)
+    {
+        id(ni->name);
+        id(ni->hierpath);
+        props(ni->attrs);
+        id(ni->constant_value);
+        id(ni->driver.cell ? ni->driver.cell->name : IdString());
+        id(ni->driver.port);
+        u32(uint32_t(ni->users.entries()));
+        for (auto &usr : ni->users) {
+            id(usr.cell->name);
+            id(usr.port);
+        }
+        u8(bool(ni->clkconstr));
+        if (ni->clkconstr) {
+            delay_pair(ni->clkconstr->high);
+            delay_pair(ni->clkconstr->low);
+            delay_pair(ni->clkconstr->period);
+        }
+    }
+
+    void hier_cell(const HierarchicalCell &hc)
+    {
+        id(hc.name);
+        id(hc.type);
+        id(hc.parent);
+        id(hc.fullpath);
+        id_map(hc.leaf_cells);
+        id_map(hc.nets);
+        u32(uint32_t(hc.ports.size()));
+        foreach_in_order(hc.ports, [&](const std::pair<IdString, HierarchicalPort> &port) {
+            id(port.first);
+            id(port.second.name);
+            u8(uint8_t(port.second.dir));
+            u32(uint32_t(port.second.nets.size()));
+            for (auto net : port.second.nets)
+                id(net);
+            i32(port.second.offset);
+            u8(port.second.upto);
+        });
+        id_map(hc.hier_cells);
+        props(hc.attrs);
+    }
+
+    void operator()(CheckpointStage stage)
+    {
+        raw(checkpoint_magic, sizeof(checkpoint_magic));
+        u32(checkpoint_version);
+        u32(uint32_t(stage));
+        str(ctx->archId().str(ctx));
+        str(ctx->getChipName());
+
+        props(ctx->settings);
+        props(ctx->attrs);
+        id(ctx->top_module);
+        u32(uint32_t(ctx->hierarchy.size()));
+        foreach_in_order(ctx->hierarchy,
+                         [&](const std::pair<IdString, HierarchicalCell> &hc) { hier_cell(hc.second); });
+        // All cells and nets are written before any connectivity, so that the reader can create them up front
+        u32(uint32_t(ctx->cells.size()));
+        foreach_in_order(ctx->cells,
+                         [&](const std::pair<IdString, std::unique_ptr<CellInfo>> &ci) { cell(ci.second.get()); });
+        u32(uint32_t(ctx->nets.size()));
+        foreach_in_order(ctx->nets,
+                         [&](const std::pair<IdString, std::unique_ptr<NetInfo>> &ni) { net(ni.second.get()); });
+        id_map(ctx->net_aliases);
+
+        uint32_t placed = 0;
+        for (auto &cell : ctx->cells)
+            if (cell.second->bel != BelId())
+                ++placed;
+        u32(placed);
+        foreach_in_order(ctx->cells, [&](const std::pair<IdString, std::unique_ptr<CellInfo>> &cell) {
+            const CellInfo *ci = cell.second.get();
+            if (ci->bel == BelId())
+                return;
+            id(ci->name);
+            id_list(ctx->getBelName(ci->bel));
+            u8(uint8_t(ci->belStrength));
+        });
+
+        uint32_t routed = 0;
+        for (auto &net : ctx->nets)
+            if (!net.second->wires.empty())
+                ++routed;
+        u32(routed);
+        foreach_in_order(ctx->nets, [&](const std::pair<IdString, std::unique_ptr<NetInfo>> &net) {
+            const NetInfo *ni = net.second.get();
+            if (ni->wires.empty())
+                return;
+            id(ni->name);
+            u32(uint32_t(ni->wires.size()));
+            foreach_in_order(ni->wires, [&](const std::pair<WireId, PipMap> &wire) {
+                id_list(ctx->getWireName(wire.first));
+                if (wire.second.pip != PipId())
+                    id_list(ctx->getPipName(wire.second.pip));
+                else
+                    u32(0);
+                u8(uint8_t(wire.second.strength));
+            });
+        });
+
+        uint64_t ids_offset = written + buf.size();
+        u32(uint32_t(ids.size()));
+        for (auto entry : ids)
+            str(entry.str(ctx));
+        u64(ids_offset);
+        raw(checkpoint_magic, sizeof(checkpoint_magic));
+        flush();
+    }
+};
+
+struct CheckpointReader
+{
+    CheckpointReader(Context *ctx, const std::string &filename, const char *data, size_t len)
+            : ctx(ctx), filename(filename), data(data), len(len)
+    {
+    }
+    Context *ctx;
+    const std::string &filename;
+    const char *data;
+    size_t len;
+    size_t pos = 0;
+    std::vector<IdString> ids;
+
+    [[noreturn]] void fail(const char *what)
+    {
+        log_error("Failed to read checkpoint '%s': %s.\n", filename.c_str(), what);
+    }
+
+    const char *raw(size_t count)
+    {
+        if (count > len - pos)
+            fail("unexpected end of file");
+        const char *result = data + pos;
+        pos += count;
+        return result;
+    }
+
+    template <typename T> T uint()
+    {
+        const char *bytes = raw(sizeof(T));
+        uint64_t value = 0;
+        for (size_t i = 0; i < sizeof(T); i++)
+            value |= uint64_t(uint8_t(bytes[i])) << (8 * i);
+        return T(value);
+    }
+
+    uint8_t u8() { return uint<uint8_t>(); }
+    uint32_t u32() { return uint<uint32_t>(); }
+    int32_t i32() { return int32_t(uint<uint32_t>()); }
+    uint64_t u64() { return uint<uint64_t>(); }
+
+    double f64()
+    {
+        uint64_t bits = u64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string str()
+    {
+        uint32_t size = u32();
+        return std::string(raw(size), size);
+    }
+
+    IdString id()
+    {
+        uint32_t idx = u32();
+        if (idx >= ids.size())
+            fail("bad IdString index");
+        return ids.at(idx);
+    }
+
+    IdStringList id_list()
+    {
+        std::vector<IdString> list(u32());
+        for (auto &entry : list)
+            entry = id();
+        return IdStringList(list);
+    }
+
+    DelayPair delay_pair()
+    {
+        delay_t min_delay = delay_t(f64());
+        delay_t max_delay = delay_t(f64());
+        return DelayPair(min_delay, max_delay);
+    }
+
+    void props(dict<IdString, Property> &values)
+    {
+        uint32_t count = u32();
+        for (uint32_t i = 0; i < count; i++) {
+            IdString key = id();
+            bool is_string = u8();
+            std::string value = str();
+            if (is_string) {
+                values[key] = Property(value);
+                continue;
+            }
+            // Bits are stored as they are held in memory, LSB first
+            if (value.find_first_not_of("01xz") != std::string::npos)
+                fail("bad constant value");
+            Property &prop = values[key];
+            prop.is_string = false;
+            prop.str = std::move(value);
+            prop.update_intval();
+        }
+    }
+
+    void id_map(dict<IdString, IdString> &values)
+    {
+        uint32_t count = u32();
+        for (uint32_t i = 0; i < count; i++) {
+            IdString key = id();
+            values[key] = id();
+        }
+    }
+
+    CellInfo *get_cell(IdString name)
+    {
+        auto fnd = ctx->cells.find(name);
+        if (fnd == ctx->cells.end())
+            fail("reference to unknown cell");
+        return fnd->second.get();
+    }
+
+    NetInfo *get_net(IdString name)
+    {
+        auto fnd = ctx->nets.find(name);
+        if (fnd == ctx->nets.end())
+            fail("reference to unknown net");
+        return fnd->second.get();
+    }
+
+    PortInfo &get_port(CellInfo *ci, IdString port)
+    {
+        auto fnd = ci->ports.find(port);
+        if (fnd == ci->ports.end())
+            fail("reference to unknown port");
+        return fnd->second;
+    }
+
+    void read_ids()
+    {
+        if (len < sizeof(checkpoint_magic) + 8 ||
+            std::memcmp(data + len - sizeof(checkpoint_magic), checkpoint_magic, sizeof(checkpoint_magic)) != 0)
+            fail("bad trailer");
+        size_t body_pos = pos;
+        pos = len - sizeof(checkpoint_magic) - 8;
+        pos = size_t(u64());
+        if (pos > len)
+            fail("bad IdString table offset");
+        ids.resize(u32());
+        if (ids.empty())
+            fail("empty IdString table");
+        ids.at(0) = IdString();
+        for (size_t i = 0; i < ids.size(); i++) {
+            std::string value = str();
+            if (i > 0)
+                ids.at(i) = ctx->id(value);
+        }
+        pos = body_pos;
+    }
+
+    void hier_cell()
+    {
+        IdString name = id();
+        HierarchicalCell &hc = ctx->hierarchy[name];
+        hc.name = name;
+        hc.type = id();
+        hc.parent = id();
+        hc.fullpath = id();
+        id_map(hc.leaf_cells);
+        for (auto &leaf : hc.leaf_cells)
+            hc.leaf_cells_by_gname[leaf.second] = leaf.first;
+        id_map(hc.nets);
+        for (auto &net : hc.nets)
+            hc.nets_by_gname[net.second] = net.first;
+        uint32_t port_count = u32();
+        for (uint32_t i = 0; i < port_count; i++) {
+            HierarchicalPort &port = hc.ports[id()];
+            port.name = id();
+            port.dir = PortType(u8());
+            port.nets.resize(u32());
+            for (auto &net : port.nets)
+                net = id();
+            port.offset = i32();
+            port.upto = u8();
+        }
+        id_map(hc.hier_cells);
+        props(hc.attrs);
+    }
+
+    void cell(std::vector<std::pair<CellInfo *, IdString>> &children)
+    {
+        IdString name = id();
+        IdString type = id();
+        if (ctx->cells.count(name))
+            fail("duplicate cell");
+        CellInfo *ci = ctx->createCell(name, type);
+        ci->hierpath = id();
+        props(ci->attrs);
+        props(ci->params);
+        uint32_t port_count = u32();
+        for (uint32_t i = 0; i < port_count; i++) {
+            IdString port = id();
+            ci->ports[port].name = port;
+            ci->ports[port].type = PortType(u8());
+        }
+        ci->cluster = id();
+        if constexpr (std::is_base_of<BaseClusterInfo, ArchCellInfo>::value) {
+            // Children might not exist yet, so are resolved once all the cells have been read
+            uint32_t child_count = u32();
+            for (uint32_t i = 0; i < child_count; i++)
+                children.emplace_back(ci, id());
+            ci->constr_x = i32();
+            ci->constr_y = i32();
+            ci->constr_z = i32();
+            ci->constr_abs_z = u8();
+        }
+    }
+
+    void net()
+    {
+        IdString name = id();
+        if (ctx->nets.count(name))
+            fail("duplicate net");
+        NetInfo *ni = ctx->createNet(name);
+        ni->hierpath = id();
+        props(ni->attrs);
+        ni->constant_value = id();
+        IdString driver_cell = id(), driver_port = id();
+        if (driver_cell != IdString()) {
+            CellInfo *ci = get_cell(driver_cell);
+            PortInfo &port = get_port(ci, driver_port);
+            port.net = ni;
+            ni->driver.cell = ci;
+            ni->driver.port = driver_port;
+        }
+        // Users are added directly, rather than by connectPort, to keep their order
+        uint32_t user_count = u32();
+        for (uint32_t i = 0; i < user_count; i++) {
+            PortRef user;
+            user.cell = get_cell(id());
+            user.port = id();
+            PortInfo &port = get_port(user.cell, user.port);
+            port.net = ni;
+            port.user_idx = ni->users.add(user);
+        }
+        if (u8()) {
+            ni->clkconstr = std::make_unique<ClockConstraint>();
+            ni->clkconstr->high = delay_pair();
+            ni->clkconstr->low = delay_pair();
+            ni->clkconstr->period = delay_pair();
+        }
+    }
+
+    CheckpointStage operator()()
+    {
+        if (len < sizeof(checkpoint_magic) || std::memcmp(raw(sizeof(checkpoint_magic)), checkpoint_magic,
+                                                          sizeof(checkpoint_magic)) != 0)
+            fail("not a nextpnr checkpoint");
+        uint32_t version = u32();
+        if (version != checkpoint_version)
+            log_error("Checkpoint '%s' is version %u, but this nextpnr reads version %u.\n", filename.c_str(),
+                      version, checkpoint_version);
+        uint32_t stage_value = u32();
+        if (stage_value > uint32_t(CheckpointStage::ROUTED))
+            fail("bad stage");
+        CheckpointStage stage = CheckpointStage(stage_value);
+        std::string arch = str(), chip = str();
+        if (arch != ctx->archId().str(ctx) || chip != ctx->getChipName())
+            log_error("Checkpoint '%s' is for %s %s, not %s %s.\n", filename.c_str(), arch.c_str(), chip.c_str(),
+                      ctx->archId().c_str(ctx), ctx->getChipName().c_str());
+        if (!ctx->cells.empty() || !ctx->nets.empty())
+            log_error("Can't load checkpoint '%s' into a context that already has a design.\n", filename.c_str());
+        read_ids();
+
+        props(ctx->settings);
+        props(ctx->attrs);
+        ctx->top_module = id();
+        uint32_t hier_count = u32();
+        for (uint32_t i = 0; i < hier_count; i++)
+            hier_cell();
+        uint32_t cell_count = u32();
+        std::vector<std::pair<CellInfo *, IdString>> children;
+        for (uint32_t i = 0; i < cell_count; i++)
+            cell(children);
+        if constexpr (std::is_base_of<BaseClusterInfo, ArchCellInfo>::value) {
+            for (auto &child : children)
+                child.first->constr_children.push_back(get_cell(child.second));
+        }
+        uint32_t net_count = u32();
+        for (uint32_t i = 0; i < net_count; i++)
+            net();
+        uint32_t alias_count = u32();
+        for (uint32_t i = 0; i < alias_count; i++) {
+            IdString alias = id();
+            NetInfo *ni = get_net(id());
+            ctx->net_aliases[alias] = ni->name;
+            if (alias != ni->name)
+                ni->aliases.push_back(alias);
+        }
+
+        uint32_t placed = u32();
+        for (uint32_t i = 0; i < placed; i++) {
+            CellInfo *ci = get_cell(id());
+            IdStringList bel_name = id_list();
+            PlaceStrength strength = PlaceStrength(u8());
+            BelId bel = ctx->getBelByName(bel_name);
+            if (bel == BelId())
+                log_error("Checkpoint '%s' places cell '%s' at unknown bel '%s'.\n", filename.c_str(),
+                          ctx->nameOf(ci), bel_name.str(ctx).c_str());
+            ctx->bindBel(bel, ci, strength);
+        }
+
+        uint32_t routed = u32();
+        for (uint32_t i = 0; i < routed; i++) {
+            NetInfo *ni = get_net(id());
+            uint32_t wire_count = u32();
+            for (uint32_t j = 0; j < wire_count; j++) {
+                IdStringList wire_name = id_list();
+                IdStringList pip_name = id_list();
+                PlaceStrength strength = PlaceStrength(u8());
+                if (pip_name.size() == 0) {
+                    WireId wire = ctx->getWireByName(wire_name);
+                    if (wire == WireId())
+                        log_error("Checkpoint '%s' routes net '%s' through unknown wire '%s'.\n", filename.c_str(),
+                                  ctx->nameOf(ni), wire_name.str(ctx).c_str());
+                    ctx->bindWire(wire, ni, strength);
+                } else {
+                    PipId pip = ctx->getPipByName(pip_name);
+                    if (pip == PipId())
+                        log_error("Checkpoint '%s' routes net '%s' through unknown pip '%s'.\n", filename.c_str(),
+                                  ctx->nameOf(ni), pip_name.str(ctx).c_str());
+                    ctx->bindPip(pip, ni, strength);
+                }
+            }
+        }
+
+        ctx->assignArchInfo();
+        ctx->design_loaded = true;
+        return stage;
+    }
+};
+
+} // namespace
+
+void Context::writeCheckpoint(std::ostream &out, CheckpointStage stage) const
+{
+    CheckpointWriter(this, out)(stage);
+}
+
+CheckpointStage Context::readCheckpoint(const std::string &filename)
+{
+#ifndef NPNR_DISABLE_THREADS
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+    boost::iostreams::mapped_file_source file;
+    try {
+        file.open(filename);
+    } catch (std::exception &) {
+        // Not something that can be mapped, like a pipe
+        std::ifstream in(filename, std::ios::binary);
+        if (!in)
+            log_error("Failed to open checkpoint '%s'.\n", filename.c_str());
+        std::string buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return CheckpointReader(this, filename, buf.data(), buf.size())();
+    }
+    return CheckpointReader(this, filename, file.data(), file.size())();
+}
+
+NEXTPNR_NAMESPACE_END
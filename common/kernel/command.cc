@@ -330,6 +330,11 @@ po::options_description CommandHandler::getGeneralOptions()
 #endif
     general.add_options()("json", po::value<std::string>(), "JSON design file to ingest");
     general.add_options()("write", po::value<std::string>(), "JSON design file to write");
+    general.add_options()("checkpoint", po::value<std::string>(),
+                          "binary design checkpoint to load instead of a JSON file; flow stages it was written after "
+                          "are skipped");
+    general.add_options()("write-checkpoint", po::value<std::string>(),
+                          "binary design checkpoint to write after the last flow stage run");
     general.add_options()("top", po::value<std::string>(), "name of top module");
     general.add_options()("seed", po::value<uint64_t>(), "seed value for random number generator");
     general.add_options()("randomize-seed,r", "randomize seed value for random number generator");
@@ -348,6 +353,7 @@ po::options_description CommandHandler::getGeneralOptions()
 
     general.add_options()("cstrweight", po::value<float>(), "placer weighting for relative constraint satisfaction");
     general.add_options()("starttemp", po::value<float>(), "placer SA start temperature");
+    general.add_options()("placer1-parallel", "evaluate batches of SA placer moves in parallel");
 
     general.add_options()("pack-only", "pack design only without placement or routing");
     general.add_options()("no-route", "process design without routing");
@@ -382,12 +388,19 @@ po::options_description CommandHandler::getGeneralOptions()
 
     general.add_options()("static-dump-density", "write density csv files during placer-static flow");
 
+    general.add_options()("placer-multilevel",
+                          "start the heap and static placers from a multilevel (clustered) global placement");
+
+    general.add_options()("predict-delay-cache", "cache estimated delays by bel type, pin and offset during placement");
+
 #if !defined(NPNR_DISABLE_THREADS)
     general.add_options()("parallel-refine", "use new experimental parallelised engine for placement refinement");
 #endif
 
     general.add_options()("router2-heatmap", po::value<std::string>(),
                           "prefix for router2 resource congestion heatmaps");
+    general.add_options()("router2-perf-json", po::value<std::string>(),
+                          "write router2 per-iteration performance statistics to a JSON file");
 
     general.add_options()("tmg-ripup", "enable experimental timing-driven ripup in router");
     general.add_options()("router2-tmg-ripup",
@@ -488,6 +501,8 @@ void CommandHandler::setupContext(Context *ctx)
     if (vm.count("starttemp")) {
         ctx->settings[ctx->id("placer1/startTemp")] = std::to_string(vm["starttemp"].as<float>());
     }
+    if (vm.count("placer1-parallel"))
+        ctx->settings[ctx->id("placer1/parallelMoves")] = true;
 
     if (vm.count("freq")) {
         auto freq = vm["freq"].as<double>();
@@ -520,8 +535,18 @@ void CommandHandler::setupContext(Context *ctx)
     if (vm.count("parallel-refine"))
         ctx->settings[ctx->id("placerHeap/parallelRefine")] = true;
 
+    if (vm.count("predict-delay-cache")) {
+        if (ctx->isPredictDelayRelative())
+            ctx->delay_cache.enabled = true;
+        else
+            log_warning("Delay estimates for this architecture depend on more than the offset between bels, not "
+                        "using a cache.\n");
+    }
+
     if (vm.count("router2-heatmap"))
         ctx->settings[ctx->id("router2/heatmap")] = vm["router2-heatmap"].as<std::string>();
+    if (vm.count("router2-perf-json"))
+        ctx->settings[ctx->id("router2/perfJson")] = vm["router2-perf-json"].as<std::string>();
     if (vm.count("tmg-ripup") || vm.count("router2-tmg-ripup"))
         ctx->settings[ctx->id("router/tmg_ripup")] = true;
 
@@ -531,30 +556,35 @@ void CommandHandler::setupContext(Context *ctx)
     if (vm.count("static-dump-density"))
         ctx->settings[ctx->id("static/dump_density")] = true;
 
-    // Setting default values
-    if (ctx->settings.find(ctx->id("target_freq")) == ctx->settings.end())
-        ctx->settings[ctx->id("target_freq")] = std::to_string(12e6);
-    if (ctx->settings.find(ctx->id("timing_driven")) == ctx->settings.end())
-        ctx->settings[ctx->id("timing_driven")] = true;
-    if (ctx->settings.find(ctx->id("auto_freq")) == ctx->settings.end())
-        ctx->settings[ctx->id("auto_freq")] = false;
-    if (ctx->settings.find(ctx->id("placer")) == ctx->settings.end())
-        ctx->settings[ctx->id("placer")] = Arch::defaultPlacer;
-    if (ctx->settings.find(ctx->id("router")) == ctx->settings.end())
-        ctx->settings[ctx->id("router")] = Arch::defaultRouter;
+    if (vm.count("placer-multilevel")) {
+        ctx->settings[ctx->id("placerHeap/multilevel")] = true;
+        ctx->settings[ctx->id("static/multilevel")] = true;
+    }
+
+    // Setting default values. These are recorded, so that settings restored from a checkpoint can take their place
+    auto set_default = [&](const char *name, Property value) {
+        IdString key = ctx->id(name);
+        if (ctx->settings.find(key) != ctx->settings.end())
+            return;
+        ctx->settings[key] = value;
+        default_settings.insert(key);
+    };
+    set_default("target_freq", std::to_string(12e6));
+    set_default("timing_driven", true);
+    set_default("auto_freq", false);
+    set_default("placer", Arch::defaultPlacer);
+    set_default("router", Arch::defaultRouter);
 
     ctx->settings[ctx->id("arch.name")] = std::string(ctx->archId().c_str(ctx));
     ctx->settings[ctx->id("arch.type")] = std::string(ctx->archArgsToId(ctx->archArgs()).c_str(ctx));
+    default_settings.insert(ctx->id("arch.name"));
+    default_settings.insert(ctx->id("arch.type"));
     ctx->settings[ctx->id("seed")] = Property(ctx->rngstate, 64);
 
-    if (ctx->settings.find(ctx->id("placerHeap/alpha")) == ctx->settings.end())
-        ctx->settings[ctx->id("placerHeap/alpha")] = std::to_string(0.1);
-    if (ctx->settings.find(ctx->id("placerHeap/beta")) == ctx->settings.end())
-        ctx->settings[ctx->id("placerHeap/beta")] = std::to_string(0.9);
-    if (ctx->settings.find(ctx->id("placerHeap/criticalityExponent")) == ctx->settings.end())
-        ctx->settings[ctx->id("placerHeap/criticalityExponent")] = std::to_string(2);
-    if (ctx->settings.find(ctx->id("placerHeap/timingWeight")) == ctx->settings.end())
-        ctx->settings[ctx->id("placerHeap/timingWeight")] = std::to_string(10);
+    set_default("placerHeap/alpha", std::to_string(0.1));
+    set_default("placerHeap/beta", std::to_string(0.9));
+    set_default("placerHeap/criticalityExponent", std::to_string(2));
+    set_default("placerHeap/timingWeight", std::to_string(10));
 
     if (vm.count("detailed-timing-report")) {
         ctx->detailed_timing_report = true;
@@ -583,8 +613,7 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
         try {
             if (vm.count("json")) {
                 std::string filename = vm["json"].as<std::string>();
-                auto f = open_ifstream_and_log_error(filename, "JSON file");
-                if (!parse_json(f, filename, w.getContext()))
+                if (!parse_json_file(filename, w.getContext()))
                     log_error("Loading design failed.\n");
 
                 if (vm.count("sdc")) {
@@ -607,12 +636,24 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
         return a.exec();
     }
 #endif
-    if (vm.count("json")) {
-        std::string filename = vm["json"].as<std::string>();
-        auto f = open_ifstream_and_log_error(filename, "'--json' file");
-
-        if (!parse_json(f, filename, ctx.get()))
-            log_error("Loading design failed.\n");
+    conflicting_options(vm, "json", "checkpoint");
+    CheckpointStage stage = CheckpointStage::NETLIST;
+    if (vm.count("json") || vm.count("checkpoint")) {
+        if (vm.count("json")) {
+            std::string filename = vm["json"].as<std::string>();
+            if (!parse_json_file(filename, ctx.get()))
+                log_error("Loading design failed.\n");
+        } else {
+            // The checkpoint brings back the settings it was written with, but anything given on this command line
+            // takes precedence over them
+            std::vector<std::pair<IdString, Property>> command_line;
+            for (auto &setting : ctx->settings)
+                if (!default_settings.count(setting.first))
+                    command_line.push_back(setting);
+            stage = ctx->readCheckpoint(vm["checkpoint"].as<std::string>());
+            for (auto &setting : command_line)
+                ctx->settings[setting.first] = setting.second;
+        }
 
         if (vm.count("sdc")) {
             std::string sdc_filename = vm["sdc"].as<std::string>();
@@ -638,11 +679,23 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
         bool do_pack = vm.count("pack-only") != 0 || vm.count("no-pack") == 0;
         bool do_place = vm.count("pack-only") == 0 && vm.count("no-place") == 0;
         bool do_route = vm.count("pack-only") == 0 && vm.count("no-route") == 0;
+        if (stage >= CheckpointStage::PACKED)
+            do_pack = false;
+        if (stage >= CheckpointStage::PLACED)
+            do_place = false;
+        if (stage >= CheckpointStage::ROUTED)
+            do_route = false;
+        if (stage != CheckpointStage::NETLIST)
+            log_info("Loaded a checkpoint written after %s; skipping the stages before that.\n",
+                     (stage == CheckpointStage::PACKED) ? "packing"
+                     : (stage == CheckpointStage::PLACED) ? "placement"
+                                                           : "routing");
 
         if (do_pack) {
             run_script_hook("pre-pack");
             if (!ctx->pack() && !ctx->force)
                 log_error("Packing design failed.\n");
+            stage = CheckpointStage::PACKED;
         }
         ctx->check();
         print_utilisation(ctx.get());
@@ -654,7 +707,13 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
                 ctx->debug = true;
             if (!ctx->place() && !ctx->force)
                 log_error("Placing design failed.\n");
+            stage = CheckpointStage::PLACED;
             ctx->debug = saved_debug;
+            if (ctx->delay_cache.enabled) {
+                int64_t hits = ctx->delay_cache.hits(), lookups = hits + ctx->delay_cache.misses();
+                log_info("Delay prediction cache: %lld lookups, %.1f%% hits, %lld entries\n", (long long)lookups,
+                         lookups ? (100.0 * hits) / lookups : 0.0, (long long)ctx->delay_cache.entries());
+            }
             ctx->check();
             if (vm.count("placed-svg"))
                 ctx->writeSVG(vm["placed-svg"].as<std::string>(), "scale=50 hide_routing");
@@ -667,6 +726,7 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
                 ctx->debug = true;
             if (!ctx->route() && !ctx->force)
                 log_error("Routing design failed.\n");
+            stage = CheckpointStage::ROUTED;
             ctx->debug = saved_debug;
             run_script_hook("post-route");
             if (vm.count("routed-svg"))
@@ -683,6 +743,12 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
             log_error("Saving design failed.\n");
     }
 
+    if (vm.count("write-checkpoint")) {
+        std::string filename = vm["write-checkpoint"].as<std::string>();
+        auto f = open_ofstream_and_log_error(filename, "checkpoint file", /*binary=*/true);
+        ctx->writeCheckpoint(f, stage);
+    }
+
     if (vm.count("sdf")) {
         std::string filename = vm["sdf"].as<std::string>();
         auto f = open_ofstream_and_log_error(filename, "SDF file");
@@ -759,11 +825,8 @@ void CommandHandler::load_json(Context *ctx, std::string filename)
 {
     setupContext(ctx);
     setupArchContext(ctx);
-    {
-        auto f = open_ifstream_and_log_error(filename, "JSON file");
-        if (!parse_json(f, filename, ctx))
-            log_error("Loading design failed.\n");
-    }
+    if (!parse_json_file(filename, ctx))
+        log_error("Loading design failed.\n");
 }
 
 void CommandHandler::clear() { vm.clear(); }
@@ -60,6 +60,8 @@ class CommandHandler
 
   protected:
     po::variables_map vm;
+    // Settings that setupContext filled in because nothing set them
+    pool<IdString> default_settings;
 
   private:
     po::options_description options;
@@ -0,0 +1,137 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef CONCURRENT_HASH_TABLE_H
+#define CONCURRENT_HASH_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// An open addressing hash table from 64-bit hashes to 64-bit values, which any number of threads can look up in while
+// one thread at a time adds to it. Used by IdStringDB and PredictDelayCache.
+//
+// Writers must be serialised by the caller, usually with a mutex, but lookups never take a lock. A value is stored
+// before the hash that makes it visible. When the table fills up it is replaced by a larger copy, rather than grown in
+// place, and the old tables are kept until clear() or destruction as readers may still be probing them.
+//
+// Several entries may share a hash, so a lookup calls a predicate on each candidate value; when the hash is a
+// bijection of the key, such as mix() of a 64-bit key, the predicate can just accept the first one.
+struct ConcurrentHashTable
+{
+    explicit ConcurrentHashTable(uint64_t initial_capacity = 64) : initial_capacity(initial_capacity) { clear(); }
+
+    ConcurrentHashTable(const ConcurrentHashTable &) = delete;
+    ConcurrentHashTable &operator=(const ConcurrentHashTable &) = delete;
+
+    // The splitmix64 finaliser. It is a bijection with mix(0) == 0, so distinct non-zero keys get distinct non-zero
+    // hashes.
+    static uint64_t mix(uint64_t h)
+    {
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
+
+    // Looks for an entry with hash h whose value satisfies accept(value), storing it in value. Safe to call at any
+    // time other than during clear().
+    template <typename Tf> bool find(uint64_t h, uint64_t &value, Tf accept) const
+    {
+        const Table *t = table.load(std::memory_order_acquire);
+        for (uint64_t pos = h & t->mask;; pos = (pos + 1) & t->mask) {
+            const Slot &slot = t->slots[pos];
+            uint64_t slot_hash = slot.hash.load(std::memory_order_acquire);
+            if (slot_hash == 0)
+                return false;
+            if (slot_hash == h) {
+                value = slot.value.load(std::memory_order_relaxed);
+                if (accept(value))
+                    return true;
+            }
+        }
+    }
+
+    // Adds an entry; h must not be zero. Only one thread may be adding at a time, and it is up to the caller to check
+    // that the entry isn't already there.
+    void insert(uint64_t h, uint64_t value)
+    {
+        Table *t = tables.back().get();
+        // Keep the load factor at or below one half. The new table is filled in before it is published.
+        if (2 * (count() + 1) > int64_t(t->mask + 1)) {
+            Table *grown = tables.emplace_back(std::make_unique<Table>(2 * (t->mask + 1))).get();
+            for (uint64_t i = 0; i <= t->mask; i++) {
+                uint64_t old_hash = t->slots[i].hash.load(std::memory_order_relaxed);
+                if (old_hash != 0)
+                    store(grown, old_hash, t->slots[i].value.load(std::memory_order_relaxed));
+            }
+            table.store(grown, std::memory_order_release);
+            t = grown;
+        }
+        store(t, h, value);
+        entry_count.store(count() + 1, std::memory_order_relaxed);
+    }
+
+    // Drops all the entries. Nothing else may be using the table.
+    void clear()
+    {
+        tables.clear();
+        table.store(tables.emplace_back(std::make_unique<Table>(initial_capacity)).get(), std::memory_order_release);
+        entry_count.store(0, std::memory_order_relaxed);
+    }
+
+    int64_t count() const { return entry_count.load(std::memory_order_relaxed); }
+
+  private:
+    struct Slot
+    {
+        std::atomic<uint64_t> hash{0};
+        std::atomic<uint64_t> value{0};
+    };
+    struct Table
+    {
+        explicit Table(uint64_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {}
+        uint64_t mask;
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    static void store(Table *t, uint64_t h, uint64_t value)
+    {
+        uint64_t pos = h & t->mask;
+        while (t->slots[pos].hash.load(std::memory_order_relaxed) != 0)
+            pos = (pos + 1) & t->mask;
+        t->slots[pos].value.store(value, std::memory_order_relaxed);
+        t->slots[pos].hash.store(h, std::memory_order_release);
+    }
+
+    uint64_t initial_capacity;
+    std::atomic<const Table *> table{nullptr};
+    std::atomic<int64_t> entry_count{0};
+    // Only touched by writers
+    std::vector<std::unique_ptr<Table>> tables;
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif /* CONCURRENT_HASH_TABLE_H */
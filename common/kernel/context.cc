@@ -25,6 +25,20 @@
 
 NEXTPNR_NAMESPACE_BEGIN
 
+ThreadPool &Context::get_thread_pool()
+{
+    // Passes hold on to references to the pool, so it must never be replaced once created
+    if (!thread_pool) {
+        // Looked up without adding the string, as the JSON writer numbers its dummy bits from the IdString count and
+        // creating the pool part way through must not change it
+        int threads = 8, threads_idx = idstring_db->find("threads");
+        if (threads_idx != -1)
+            threads = int_or_default(settings, IdString(threads_idx), threads);
+        thread_pool = std::make_unique<ThreadPool>(std::max(1, threads));
+    }
+    return *thread_pool;
+}
+
 WireId Context::getNetinfoSourceWire(const NetInfo *net_info) const
 {
     if (net_info->driver.cell == nullptr)
@@ -111,7 +125,7 @@ delay_t Context::predictArcDelay(const NetInfo *net_info, const PortRef &sink) c
     }
     if (driver_pin == IdString() || sink_pin == IdString())
         return 0;
-    return predictDelay(net_info->driver.cell->bel, driver_pin, sink.cell->bel, sink_pin);
+    return predictDelayCached(net_info->driver.cell->bel, driver_pin, sink.cell->bel, sink_pin);
 }
 
 delay_t Context::getNetinfoRouteDelay(const NetInfo *net_info, const PortRef &user_info) const
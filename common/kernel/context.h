@@ -24,10 +24,21 @@
 #include <boost/lexical_cast.hpp>
 
 #include "arch.h"
+#include "delay_cache.h"
 #include "deterministic_rng.h"
+#include "thread_pool.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
+// The last flow stage run before a checkpoint was written
+enum class CheckpointStage : uint32_t
+{
+    NETLIST,
+    PACKED,
+    PLACED,
+    ROUTED,
+};
+
 struct Context : Arch, DeterministicRNG
 {
     bool verbose = false;
@@ -39,11 +50,18 @@ struct Context : Arch, DeterministicRNG
     // True when detailed per-net timing is to be stored / reported
     bool detailed_timing_report = false;
 
-    Context(ArchArgs args) : Arch(args) { BaseCtx::as_ctx = this; }
+    Context(ArchArgs args) : Arch(args), delay_cache(this) { BaseCtx::as_ctx = this; }
 
     // --------------------------------------------------------------
 
     delay_t predictArcDelay(const NetInfo *net_info, const PortRef &sink) const;
+    // predictDelay, through the cache of predictions if it is enabled. Safe to call from several threads at once.
+    delay_t predictDelayCached(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const
+    {
+        return delay_cache.enabled ? delay_cache.predict(src_bel, src_pin, dst_bel, dst_pin)
+                                   : predictDelay(src_bel, src_pin, dst_bel, dst_pin);
+    }
+    mutable PredictDelayCache delay_cache;
 
     WireId getNetinfoSourceWire(const NetInfo *net_info) const;
     SSOArray<WireId, 2> getNetinfoSinkWires(const NetInfo *net_info, const PortRef &sink) const;
@@ -82,7 +100,7 @@ struct Context : Arch, DeterministicRNG
     // --------------------------------------------------------------
 
     // provided by sdf.cc
-    void writeSDF(std::ostream &out, bool cvc_mode = false) const;
+    void writeSDF(std::ostream &out, bool cvc_mode = false);
 
     // --------------------------------------------------------------
 
@@ -94,6 +112,13 @@ struct Context : Arch, DeterministicRNG
     // provided by report.cc
     void writeJsonReport(std::ostream &out) const;
 
+    // --------------------------------------------------------------
+
+    // provided by checkpoint.cc
+    void writeCheckpoint(std::ostream &out, CheckpointStage stage) const;
+    // Load a checkpoint into an empty context, returning the stage it was written after
+    CheckpointStage readCheckpoint(const std::string &filename);
+
     // provided by timing_log.cc
     void log_timing_results(TimingResult &result, bool print_histogram, bool print_fmax, bool print_path,
                             bool warn_on_failure);
@@ -105,6 +130,14 @@ struct Context : Arch, DeterministicRNG
 
     uint32_t checksum() const;
 
+    // --------------------------------------------------------------
+
+    // Worker threads shared by all passes, sized by the threads setting (the --threads option) when first used. Later
+    // changes to the setting have no effect
+    ThreadPool &get_thread_pool();
+
+    // --------------------------------------------------------------
+
     void check() const;
     void archcheck() const;
 
@@ -131,6 +164,9 @@ struct Context : Arch, DeterministicRNG
         else
             throw std::runtime_error("settings does not exists");
     }
+
+  private:
+    std::unique_ptr<ThreadPool> thread_pool;
 };
 
 NEXTPNR_NAMESPACE_END
@@ -0,0 +1,136 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "delay_cache.h"
+
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+constexpr uint64_t initial_capacity = 1024;
+
+uint64_t delay_bits(delay_t delay)
+{
+    static_assert(sizeof(delay_t) <= sizeof(uint64_t), "delay_t must fit in a table value");
+    uint64_t bits = 0;
+    std::memcpy(&bits, &delay, sizeof(delay));
+    return bits;
+}
+
+delay_t bits_delay(uint64_t bits)
+{
+    delay_t delay;
+    std::memcpy(&delay, &bits, sizeof(delay));
+    return delay;
+}
+
+bool any(uint64_t) { return true; }
+} // namespace
+
+PredictDelayCache::PredictDelayCache(const Context *ctx) : ctx(ctx), delays(initial_capacity) { clear(); }
+
+int PredictDelayCache::stripe()
+{
+    static thread_local int s = int(std::hash<std::thread::id>{}(std::this_thread::get_id()) % stripes);
+    return s;
+}
+
+delay_t PredictDelayCache::predict(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin)
+{
+    NPNR_ASSERT(enabled);
+    int pp = find_pin_pair(PinPair{ctx->getBelType(src_bel), src_pin, ctx->getBelType(dst_bel), dst_pin});
+    Loc src_loc = ctx->getBelLocation(src_bel), dst_loc = ctx->getBelLocation(dst_bel);
+    uint64_t key = (uint64_t(pp + 1) << 32) | (uint64_t(uint16_t(dst_loc.x - src_loc.x)) << 16) |
+                   uint64_t(uint16_t(dst_loc.y - src_loc.y));
+    // mix is a bijection, so the hash identifies the key
+    uint64_t h = ConcurrentHashTable::mix(key), bits;
+    if (delays.find(h, bits, any)) {
+        hit_count[stripe()].value.fetch_add(1, std::memory_order_relaxed);
+        return bits_delay(bits);
+    }
+    // Two threads might miss on the same entry at once; they will both compute the same value and the second insert
+    // finds it already there
+    delay_t delay = ctx->predictDelay(src_bel, src_pin, dst_bel, dst_pin);
+    insert(h, delay);
+    miss_count[stripe()].value.fetch_add(1, std::memory_order_relaxed);
+    return delay;
+}
+
+int PredictDelayCache::find_pin_pair(const PinPair &pp)
+{
+    const PinPairMap *map = pin_pairs.load(std::memory_order_acquire);
+    auto found = map->find(pp);
+    if (found != map->end())
+        return found->second;
+    std::lock_guard<std::mutex> lock(mutex);
+    // Another thread may have added it while we waited for the lock
+    map = pin_pair_maps.back().get();
+    found = map->find(pp);
+    if (found != map->end())
+        return found->second;
+    // There are few distinct pin pairs, so the map is simply copied and republished
+    auto next = std::make_unique<PinPairMap>(*map);
+    int idx = int(next->size());
+    next->emplace(pp, idx);
+    pin_pairs.store(pin_pair_maps.emplace_back(std::move(next)).get(), std::memory_order_release);
+    return idx;
+}
+
+void PredictDelayCache::insert(uint64_t h, delay_t delay)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t bits;
+    if (!delays.find(h, bits, any))
+        delays.insert(h, delay_bits(delay));
+}
+
+void PredictDelayCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pin_pair_maps.clear();
+    pin_pairs.store(pin_pair_maps.emplace_back(std::make_unique<PinPairMap>()).get(), std::memory_order_release);
+    delays.clear();
+    for (int i = 0; i < stripes; i++) {
+        hit_count[i].value.store(0, std::memory_order_relaxed);
+        miss_count[i].value.store(0, std::memory_order_relaxed);
+    }
+}
+
+int64_t PredictDelayCache::hits() const
+{
+    int64_t total = 0;
+    for (int i = 0; i < stripes; i++)
+        total += hit_count[i].value.load(std::memory_order_relaxed);
+    return total;
+}
+
+int64_t PredictDelayCache::misses() const
+{
+    int64_t total = 0;
+    for (int i = 0; i < stripes; i++)
+        total += miss_count[i].value.load(std::memory_order_relaxed);
+    return total;
+}
+
+int64_t PredictDelayCache::entries() const { return delays.count(); }
+
+NEXTPNR_NAMESPACE_END
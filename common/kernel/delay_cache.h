@@ -0,0 +1,109 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef DELAY_CACHE_H
+#define DELAY_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "concurrent_hash_table.h"
+#include "hashlib.h"
+#include "nextpnr_types.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+struct Context;
+
+// A cache of predictDelay results, used by Context::predictArcDelay and so by the placers and timing analysis.
+//
+// It can only be enabled for arches where isPredictDelayRelative() is true, that is where a prediction only depends on
+// the types of the two bels, the pins and the x/y offset between the bels, so that arcs between different bels of the
+// same shape share an entry. It is off by default (see the --predict-delay-cache option) as it only pays off when
+// predictDelay is more expensive than a hash lookup.
+//
+// Entries are filled in on first use, and lookups may be made from several threads at once. Each distinct combination
+// of bel types and pins gets a small index, and the delays are kept in a ConcurrentHashTable keyed by that index and
+// the offset. The pin pair map is copied and republished when it changes. Both are only written with a mutex held, so
+// looking up an existing entry never takes a lock.
+struct PredictDelayCache
+{
+    explicit PredictDelayCache(const Context *ctx);
+
+    PredictDelayCache(const PredictDelayCache &) = delete;
+    PredictDelayCache &operator=(const PredictDelayCache &) = delete;
+
+    // Only to be changed while nothing is using the cache
+    bool enabled = false;
+
+    // Only valid when enabled, see Context::predictDelayCached
+    delay_t predict(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin);
+
+    // Drop all the entries, for example if the delay model has changed. Must not be called with lookups in flight.
+    void clear();
+
+    // Statistics since creation or the last clear()
+    int64_t hits() const;
+    int64_t misses() const;
+    int64_t entries() const;
+
+  private:
+    // The bel types and pins of an arc
+    struct PinPair
+    {
+        IdString src_type, src_pin, dst_type, dst_pin;
+        bool operator==(const PinPair &other) const
+        {
+            return src_type == other.src_type && src_pin == other.src_pin && dst_type == other.dst_type &&
+                   dst_pin == other.dst_pin;
+        }
+        unsigned int hash() const
+        {
+            return mkhash(mkhash(src_type.hash(), src_pin.hash()), mkhash(dst_type.hash(), dst_pin.hash()));
+        }
+    };
+    typedef dict<PinPair, int> PinPairMap;
+
+    // Striped to keep threads from fighting over one counter
+    struct alignas(64) Counter
+    {
+        std::atomic<int64_t> value{0};
+    };
+    static constexpr int stripes = 16;
+
+    const Context *ctx;
+    std::atomic<const PinPairMap *> pin_pairs{nullptr};
+    // Keyed by the mix of (pin pair index + 1) above the 16-bit x and y offsets, which is never zero
+    ConcurrentHashTable delays;
+    Counter hit_count[stripes], miss_count[stripes];
+
+    // Everything below is only touched with the mutex held, as are writes to delays
+    std::mutex mutex;
+    // All the pin pair maps used so far, kept as readers may still be looking at old ones
+    std::vector<std::unique_ptr<PinPairMap>> pin_pair_maps;
+
+    static int stripe();
+    int find_pin_pair(const PinPair &pp);
+    void insert(uint64_t h, delay_t delay);
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif /* DELAY_CACHE_H */
@@ -0,0 +1,110 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "idstring_db.h"
+
+#include <functional>
+#include <thread>
+
+NEXTPNR_NAMESPACE_BEGIN
+
+IdStringDB::IdStringDB()
+{
+    for (auto &chunk : chunks)
+        chunk.store(nullptr, std::memory_order_relaxed);
+}
+
+IdStringDB::~IdStringDB()
+{
+    for (auto &chunk : chunks)
+        delete[] chunk.load(std::memory_order_relaxed);
+}
+
+uint64_t IdStringDB::hash(std::string_view s)
+{
+    // std::hash may be an identity-like function or only 32 bits wide, so finish it with a mixer. Zero is not a valid
+    // hash in the tables.
+    uint64_t h = ConcurrentHashTable::mix(std::hash<std::string_view>{}(s));
+    return h == 0 ? 1 : h;
+}
+
+int IdStringDB::probe(const Shard &shard, uint64_t h, std::string_view s) const
+{
+    uint64_t idx;
+    if (shard.table.find(h, idx, [&](uint64_t candidate) { return str(int(candidate)) == s; }))
+        return int(idx);
+    return -1;
+}
+
+void IdStringDB::add_string(int idx, const std::string *str)
+{
+    int chunk, offset;
+    locate(idx, chunk, offset);
+    auto *entries = chunks[chunk].load(std::memory_order_acquire);
+    if (entries == nullptr) {
+        // Several shards may need the same new chunk at once; the first one to get there wins
+        auto *fresh = new std::atomic<const std::string *>[size_t(1) << (chunk + first_chunk_bits)];
+        if (chunks[chunk].compare_exchange_strong(entries, fresh, std::memory_order_acq_rel))
+            entries = fresh;
+        else
+            delete[] fresh;
+    }
+    entries[offset].store(str, std::memory_order_release);
+}
+
+void IdStringDB::publish(int idx)
+{
+    // Other shards may be filling in lower indices at the same time, and size() must not cover them until they are in
+    // place, so wait for them. They already hold their own shard's mutex and never wait on a higher index, so this
+    // can't deadlock.
+    int expected = idx;
+    while (!published.compare_exchange_weak(expected, idx + 1, std::memory_order_release, std::memory_order_relaxed)) {
+        expected = idx;
+        std::this_thread::yield();
+    }
+}
+
+int IdStringDB::find(std::string_view s) const
+{
+    uint64_t h = hash(s);
+    return probe(shard_of(h), h, s);
+}
+
+int IdStringDB::get(std::string_view s)
+{
+    uint64_t h = hash(s);
+    Shard &shard = shard_of(h);
+    // Fast path: the string already exists
+    int idx = probe(shard, h, s);
+    if (idx != -1)
+        return idx;
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // Another thread may have added it while we waited for the lock
+    idx = probe(shard, h, s);
+    if (idx != -1)
+        return idx;
+
+    idx = next_index.fetch_add(1, std::memory_order_relaxed);
+    NPNR_ASSERT(idx >= 0);
+    add_string(idx, &shard.strings.emplace_back(s));
+    publish(idx);
+    shard.table.insert(h, uint64_t(idx));
+    return idx;
+}
+
+NEXTPNR_NAMESPACE_END
@@ -0,0 +1,112 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef IDSTRING_DB_H
+#define IDSTRING_DB_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "concurrent_hash_table.h"
+#include "nextpnr_assertions.h"
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// The string table behind IdString, safe to use from several threads at once.
+//
+// Strings are spread over shards by hash. Each shard has a ConcurrentHashTable from string hashes to indices that is
+// only written with the shard's mutex held, so looking up a string that is already present never takes a lock. Indices
+// are handed out from a single counter and are dense, as before. The strings themselves never move, so the references
+// returned by str() stay valid for the lifetime of the database.
+struct IdStringDB
+{
+    IdStringDB();
+    ~IdStringDB();
+
+    IdStringDB(const IdStringDB &) = delete;
+    IdStringDB &operator=(const IdStringDB &) = delete;
+
+    // Returns the index of s, adding it if it is not already present
+    int get(std::string_view s);
+    // Returns the index of s, or -1 if it is not present
+    int find(std::string_view s) const;
+
+    const std::string &str(int idx) const
+    {
+        NPNR_ASSERT(idx >= 0 && idx < size());
+        int chunk, offset;
+        locate(idx, chunk, offset);
+        return *chunks[chunk].load(std::memory_order_acquire)[offset].load(std::memory_order_acquire);
+    }
+
+    int size() const { return published.load(std::memory_order_acquire); }
+
+  private:
+    static constexpr int shard_bits = 6;
+    static constexpr int first_chunk_bits = 10;
+    static constexpr int max_chunks = 32 - first_chunk_bits;
+
+    struct alignas(64) Shard
+    {
+        ConcurrentHashTable table;
+        // Only touched with the mutex held
+        std::mutex mutex;
+        std::deque<std::string> strings;
+    };
+
+    Shard shards[1 << shard_bits];
+
+    // Index to string, in chunks that double in size so that existing entries never move
+    std::atomic<std::atomic<const std::string *> *> chunks[max_chunks];
+    // Indices are handed out from next_index. Only those below published, which grows in order, have their string in
+    // place and can be found.
+    std::atomic<int> next_index{0};
+    std::atomic<int> published{0};
+
+    static uint64_t hash(std::string_view s);
+    static void locate(int idx, int &chunk, int &offset)
+    {
+        uint32_t i = uint32_t(idx) + (1U << first_chunk_bits);
+#if defined(_MSC_VER)
+        unsigned long msb;
+        _BitScanReverse(&msb, i);
+#else
+        int msb = 31 - __builtin_clz(i);
+#endif
+        chunk = int(msb) - first_chunk_bits;
+        offset = int(i - (1U << msb));
+    }
+
+    const Shard &shard_of(uint64_t h) const { return shards[h >> (64 - shard_bits)]; }
+    Shard &shard_of(uint64_t h) { return shards[h >> (64 - shard_bits)]; }
+    int probe(const Shard &shard, uint64_t h, std::string_view s) const;
+    void add_string(int idx, const std::string *str);
+    void publish(int idx);
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif /* IDSTRING_DB_H */
@@ -199,9 +199,9 @@ std::ifstream open_ifstream_and_log_error(std::string filename, const char *file
     return file;
 }
 
-std::ofstream open_ofstream_and_log_error(std::string filename, const char *file_description)
+std::ofstream open_ofstream_and_log_error(std::string filename, const char *file_description, bool binary)
 {
-    std::ofstream file(filename);
+    std::ofstream file(filename, binary ? (std::ios::out | std::ios::binary) : std::ios::out);
     if (!file.is_open()) {
         log_error("Failed to open %s '%s' for writing: %s.\n", file_description, filename.c_str(),
                   std::error_code(errno, std::generic_category()).message().c_str());
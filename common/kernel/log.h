@@ -94,7 +94,7 @@ static inline void log_assert_worker(bool cond, const char *expr, const char *fi
 std::ifstream open_ifstream_and_log_error(std::string filename, const char *file_description);
 
 /// open `filename`, if error log "Failed to open {file_description} '{filename}' for writing" with cause
-std::ofstream open_ofstream_and_log_error(std::string filename, const char *file_description);
+std::ofstream open_ofstream_and_log_error(std::string filename, const char *file_description, bool binary = false);
 
 NEXTPNR_NAMESPACE_END
 
@@ -23,7 +23,10 @@
 #include "nextpnr.h"
 
 #include <algorithm>
+#include <cctype>
 #include <iterator>
+#include <regex>
+#include <string_view>
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -88,6 +91,123 @@ struct SdcValue
     std::vector<SdcEntity> list; // list of entities
 };
 
+// A get_* pattern: a Tcl style glob (* and ?) or, with -regexp, a regular expression, matched against the whole name.
+// Unless -hierarchical, wildcards do not match the hierarchy separator '/'.
+struct SdcPattern
+{
+    SdcPattern(const std::string &pattern, bool regexp, bool nocase, bool hierarchical)
+            : pattern(pattern), regexp(regexp), nocase(nocase), hierarchical(hierarchical)
+    {
+        if (regexp)
+            re = std::regex(pattern, nocase ? (std::regex::ECMAScript | std::regex::icase) : std::regex::ECMAScript);
+        if (nocase)
+            return;
+        // Literal characters up to the first special one
+        if (!regexp) {
+            prefix = pattern.substr(0, pattern.find_first_of("*?"));
+        } else if (pattern.find('|') == std::string::npos) {
+            size_t start = (!pattern.empty() && pattern.front() == '^') ? 1 : 0;
+            size_t end = pattern.find_first_of(".[]{}()\\*+?|^$", start);
+            prefix = pattern.substr(start, (end == std::string::npos) ? std::string::npos : end - start);
+            // A quantifier makes the character before it optional
+            if (end != std::string::npos && std::string("*+?{").find(pattern.at(end)) != std::string::npos &&
+                !prefix.empty())
+                prefix.pop_back();
+        }
+    }
+
+    // True if the pattern matches only the name equal to it
+    bool is_literal() const { return !regexp && !nocase && prefix.size() == pattern.size(); }
+
+    bool matches(std::string_view name) const
+    {
+        if (regexp)
+            return std::regex_match(name.begin(), name.end(), re);
+        return glob_match(name);
+    }
+
+    std::string pattern;
+    bool regexp, nocase, hierarchical;
+    std::regex re;
+    // All names that match start with this
+    std::string prefix;
+
+  private:
+    bool char_match(char p, char c) const
+    {
+        return (p == c) || (nocase && std::tolower((unsigned char)p) == std::tolower((unsigned char)c));
+    }
+
+    bool glob_match(std::string_view name) const
+    {
+        // Backtracking to the last *, which is enough as * can match anything a later * would have
+        size_t p = 0, n = 0, star_p = std::string::npos, star_n = 0;
+        while (n < name.size()) {
+            if (p < pattern.size() && pattern.at(p) == '*') {
+                star_p = p++;
+                star_n = n;
+            } else if (p < pattern.size() && ((pattern.at(p) == '?') ? (hierarchical || name.at(n) != '/')
+                                                                   : char_match(pattern.at(p), name.at(n)))) {
+                ++p;
+                ++n;
+            } else if (star_p != std::string::npos && (hierarchical || name.at(star_n) != '/')) {
+                p = star_p + 1;
+                n = ++star_n;
+            } else {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern.at(p) == '*')
+            ++p;
+        return p == pattern.size();
+    }
+};
+
+// The names of one kind of object sorted, so that patterns with a literal prefix only look at the names starting
+// with it
+struct SdcNameIndex
+{
+    // (name, object named); a net's aliases each have their own entry
+    std::vector<std::pair<std::string_view, IdString>> names;
+
+    void add(const Context *ctx, IdString name, IdString object) { names.emplace_back(name.str(ctx), object); }
+
+    void sort() { std::sort(names.begin(), names.end()); }
+
+    // Below this many names to check, handing work to the thread pool costs more than it saves
+    static constexpr int min_parallel_names = 4096;
+
+    // The objects with a name matching pattern, in name order
+    std::vector<IdString> match(Context *ctx, const SdcPattern &pattern) const
+    {
+        auto begin = std::lower_bound(names.begin(), names.end(),
+                                      std::make_pair(std::string_view(pattern.prefix), IdString()));
+        auto end = std::partition_point(begin, names.end(), [&](const std::pair<std::string_view, IdString> &entry) {
+            return entry.first.substr(0, pattern.prefix.size()) == pattern.prefix;
+        });
+        int count = int(end - begin);
+        auto &thread_pool = ctx->get_thread_pool();
+        int blocks = (thread_pool.size() == 1 || count < min_parallel_names) ? 1 : thread_pool.size();
+        int block_size = (count + blocks - 1) / blocks;
+        std::vector<std::vector<IdString>> found(blocks);
+        auto match_block = [&](int block) {
+            auto block_begin = begin + std::min(count, block * block_size);
+            auto block_end = begin + std::min(count, (block + 1) * block_size);
+            for (auto it = block_begin; it != block_end; ++it)
+                if (pattern.matches(it->first))
+                    found.at(block).push_back(it->second);
+        };
+        if (blocks == 1)
+            match_block(0);
+        else
+            thread_pool.run(blocks, match_block);
+        std::vector<IdString> result;
+        for (auto &block : found)
+            result.insert(result.end(), block.begin(), block.end());
+        return result;
+    }
+};
+
 struct SDCParser
 {
     std::string buf;
@@ -95,6 +215,9 @@ struct SDCParser
     int lineno = 1;
     Context *ctx;
 
+    // Built on the first pattern query of each kind
+    std::unique_ptr<SdcNameIndex> cell_index, net_index, port_index;
+
     SDCParser(const std::string &buf, Context *ctx) : buf(buf), ctx(ctx) {};
 
     inline bool eof() const { return pos == int(buf.size()); }
@@ -254,77 +377,153 @@ struct SDCParser
         return args;
     }
 
-    SdcValue cmd_get_nets(const std::vector<SdcValue> &arguments)
+    struct SdcQuery
     {
-        std::vector<SdcEntity> nets;
+        bool hierarchical = false, regexp = false, nocase = false, quiet = false;
+        std::vector<std::string> patterns;
+    };
+
+    SdcQuery parse_query(const char *cmd, const std::vector<SdcValue> &arguments)
+    {
+        SdcQuery query;
         for (int i = 1; i < int(arguments.size()); i++) {
             auto &arg = arguments.at(i);
             if (!arg.is_string)
-                log_error("get_nets expected string arguments (line %d)\n", lineno);
-            std::string s = arg.str;
-            if (s.at(0) == '-')
-                log_error("unsupported argument '%s' to get_nets (line %d)\n", s.c_str(), lineno);
-            IdString id = ctx->id(s);
-            if (ctx->nets.count(id) || ctx->net_aliases.count(id))
-                nets.emplace_back(SdcEntity::ENTITY_NET, ctx->net_aliases.count(id) ? ctx->net_aliases.at(id) : id);
+                log_error("%s expected string arguments (line %d)\n", cmd, lineno);
+            const std::string &s = arg.str;
+            if (s.empty())
+                continue;
+            if (s == "-hierarchical" || s == "-hier")
+                query.hierarchical = true;
+            else if (s == "-regexp")
+                query.regexp = true;
+            else if (s == "-nocase")
+                query.nocase = true;
+            else if (s == "-quiet")
+                query.quiet = true;
+            else if (s.at(0) == '-')
+                log_error("unsupported argument '%s' to %s (line %d)\n", s.c_str(), cmd, lineno);
             else
-                log_warning("get_nets argument '%s' matched no objects.\n", s.c_str());
+                query.patterns.push_back(s);
         }
-        return nets;
+        return query;
     }
 
-    SdcValue cmd_get_ports(const std::vector<SdcValue> &arguments)
+    SdcPattern make_pattern(const SdcQuery &query, const std::string &pattern)
     {
-        std::vector<SdcEntity> ports;
-        for (int i = 1; i < int(arguments.size()); i++) {
-            auto &arg = arguments.at(i);
-            if (!arg.is_string)
-                log_error("get_ports expected string arguments (line %d)\n", lineno);
-            std::string s = arg.str;
-            if (s.at(0) == '-')
-                log_error("unsupported argument '%s' to get_ports (line %d)\n", s.c_str(), lineno);
-            IdString id = ctx->id(s);
-            if (ctx->ports.count(id))
-                ports.emplace_back(SdcEntity::ENTITY_PORT, id);
+        try {
+            return SdcPattern(pattern, query.regexp, query.nocase, query.hierarchical);
+        } catch (const std::regex_error &e) {
+            log_error("invalid regular expression '%s': %s (line %d)\n", pattern.c_str(), e.what(), lineno);
         }
-        return ports;
     }
 
-    SdcValue cmd_get_cells(const std::vector<SdcValue> &arguments)
+    const SdcNameIndex &get_index(SdcEntity::EntityType type)
     {
-        std::vector<SdcEntity> cells;
-        for (int i = 1; i < int(arguments.size()); i++) {
-            auto &arg = arguments.at(i);
-            if (!arg.is_string)
-                log_error("get_cells expected string arguments (line %d)\n", lineno);
-            std::string s = arg.str;
-            if (s.at(0) == '-')
-                log_error("unsupported argument '%s' to get_cells (line %d)\n", s.c_str(), lineno);
+        auto &index = (type == SdcEntity::ENTITY_CELL) ? cell_index
+                      : (type == SdcEntity::ENTITY_NET) ? net_index
+                                                         : port_index;
+        if (!index) {
+            index = std::make_unique<SdcNameIndex>();
+            if (type == SdcEntity::ENTITY_CELL) {
+                for (auto &cell : ctx->cells)
+                    index->add(ctx, cell.first, cell.first);
+            } else if (type == SdcEntity::ENTITY_NET) {
+                for (auto &alias : ctx->net_aliases)
+                    index->add(ctx, alias.first, alias.second);
+                for (auto &net : ctx->nets)
+                    if (!ctx->net_aliases.count(net.first))
+                        index->add(ctx, net.first, net.first);
+            } else {
+                for (auto &port : ctx->ports)
+                    index->add(ctx, port.first, port.first);
+            }
+            index->sort();
+        }
+        return *index;
+    }
+
+    // The objects of a kind matching a pattern; exact names are looked up directly
+    std::vector<IdString> query_names(const SdcQuery &query, SdcEntity::EntityType type, const std::string &s)
+    {
+        SdcPattern pattern = make_pattern(query, s);
+        if (pattern.is_literal()) {
             IdString id = ctx->id(s);
-            if (ctx->cells.count(id))
-                cells.emplace_back(SdcEntity::ENTITY_CELL, id);
+            if (type == SdcEntity::ENTITY_CELL && ctx->cells.count(id))
+                return {id};
+            if (type == SdcEntity::ENTITY_NET && ctx->net_aliases.count(id))
+                return {ctx->net_aliases.at(id)};
+            if (type == SdcEntity::ENTITY_NET && ctx->nets.count(id))
+                return {id};
+            if (type == SdcEntity::ENTITY_PORT && ctx->ports.count(id))
+                return {id};
+            return {};
+        }
+        return get_index(type).match(ctx, pattern);
+    }
+
+    SdcValue query_objects(const char *cmd, SdcEntity::EntityType type, const std::vector<SdcValue> &arguments)
+    {
+        SdcQuery query = parse_query(cmd, arguments);
+        std::vector<SdcEntity> result;
+        // Several aliases of a net may match
+        pool<IdString> seen;
+        for (auto &s : query.patterns) {
+            auto found = query_names(query, type, s);
+            if (found.empty() && !query.quiet)
+                log_warning("%s argument '%s' matched no objects.\n", cmd, s.c_str());
+            for (auto name : found)
+                if (seen.insert(name).second)
+                    result.emplace_back(type, name);
         }
-        return cells;
+        return result;
     }
 
+    SdcValue cmd_get_nets(const std::vector<SdcValue> &arguments)
+    {
+        return query_objects("get_nets", SdcEntity::ENTITY_NET, arguments);
+    }
+
+    SdcValue cmd_get_ports(const std::vector<SdcValue> &arguments)
+    {
+        return query_objects("get_ports", SdcEntity::ENTITY_PORT, arguments);
+    }
+
+    SdcValue cmd_get_cells(const std::vector<SdcValue> &arguments)
+    {
+        return query_objects("get_cells", SdcEntity::ENTITY_CELL, arguments);
+    }
+
+    // Pins are written cell/pin, where the cell part is queried as by get_cells and the pin part is matched against
+    // the ports of each cell found
     SdcValue cmd_get_pins(const std::vector<SdcValue> &arguments)
     {
+        SdcQuery query = parse_query("get_pins", arguments);
         std::vector<SdcEntity> pins;
-        for (int i = 1; i < int(arguments.size()); i++) {
-            auto &arg = arguments.at(i);
-            if (!arg.is_string)
-                log_error("get_pins expected string arguments (line %d)\n", lineno);
-            std::string s = arg.str;
-            if (s.at(0) == '-')
-                log_error("unsupported argument '%s' to get_pins (line %d)\n", s.c_str(), lineno);
+        for (auto &s : query.patterns) {
             auto pos = s.rfind('/');
             if (pos == std::string::npos)
                 log_error("expected / in cell pin name '%s' (line %d)\n", s.c_str(), lineno);
-            pins.emplace_back(SdcEntity::ENTITY_PIN, ctx->id(s.substr(0, pos)), ctx->id(s.substr(pos + 1)));
-            if (pins.back().get_net(ctx) == nullptr) {
-                log_warning("cell pin '%s' not found\n", s.c_str());
-                pins.pop_back();
+            SdcPattern pin_pattern = make_pattern(query, s.substr(pos + 1));
+            size_t count = pins.size();
+            for (auto cell_name : query_names(query, SdcEntity::ENTITY_CELL, s.substr(0, pos))) {
+                if (pin_pattern.is_literal()) {
+                    pins.emplace_back(SdcEntity::ENTITY_PIN, cell_name, ctx->id(pin_pattern.pattern));
+                    if (pins.back().get_net(ctx) == nullptr)
+                        pins.pop_back();
+                    continue;
+                }
+                // Only connected pins, in name order
+                std::vector<std::pair<std::string_view, IdString>> cell_pins;
+                for (auto &port : ctx->cells.at(cell_name)->ports)
+                    if (port.second.net != nullptr && pin_pattern.matches(port.first.str(ctx)))
+                        cell_pins.emplace_back(port.first.str(ctx), port.first);
+                std::sort(cell_pins.begin(), cell_pins.end());
+                for (auto &pin : cell_pins)
+                    pins.emplace_back(SdcEntity::ENTITY_PIN, cell_name, pin.second);
             }
+            if (pins.size() == count && !query.quiet)
+                log_warning("cell pin '%s' not found\n", s.c_str());
         }
         return pins;
     }
@@ -17,6 +17,8 @@
  *
  */
 
+#include <algorithm>
+#include <sstream>
 #include "nextpnr.h"
 #include "util.h"
 
@@ -79,11 +81,9 @@ struct Interconnect
 struct SDFWriter
 {
     bool cvc_mode = false;
-    std::vector<Cell> cells;
-    std::vector<Interconnect> conn;
     std::string sdfversion, design, vendor, program;
 
-    std::string format_name(const std::string &name)
+    std::string format_name(const std::string &name) const
     {
         std::string fmt = "\"";
         for (char c : name) {
@@ -95,7 +95,7 @@ struct SDFWriter
         return fmt;
     }
 
-    std::string escape_name(const std::string &name)
+    std::string escape_name(const std::string &name) const
     {
         std::string esc;
         for (char c : name) {
@@ -106,7 +106,7 @@ struct SDFWriter
         return esc;
     }
 
-    std::string timing_check_name(TimingCheck::CheckType type)
+    std::string timing_check_name(TimingCheck::CheckType type) const
     {
         switch (type) {
         case TimingCheck::SETUPHOLD:
@@ -120,14 +120,14 @@ struct SDFWriter
         }
     }
 
-    void write_delay(std::ostream &out, const RiseFallDelay &delay)
+    void write_delay(std::ostream &out, const RiseFallDelay &delay) const
     {
         write_delay(out, delay.rise);
         out << " ";
         write_delay(out, delay.fall);
     }
 
-    void write_delay(std::ostream &out, const MinMaxTyp &delay)
+    void write_delay(std::ostream &out, const MinMaxTyp &delay) const
     {
         if (cvc_mode)
             out << "(" << int(delay.min) << ":" << int(delay.typ) << ":" << int(delay.max) << ")";
@@ -135,7 +135,7 @@ struct SDFWriter
             out << "(" << delay.min << ":" << delay.typ << ":" << delay.max << ")";
     }
 
-    void write_port(std::ostream &out, const CellPort &port)
+    void write_port(std::ostream &out, const CellPort &port) const
     {
         if (cvc_mode)
             out << escape_name(port.cell) + "." + escape_name(port.port);
@@ -143,12 +143,13 @@ struct SDFWriter
             out << escape_name(port.cell + "/" + port.port);
     }
 
-    void write_portedge(std::ostream &out, const PortAndEdge &pe)
+    void write_portedge(std::ostream &out, const PortAndEdge &pe) const
     {
         out << "(" << (pe.edge == RISING_EDGE ? "posedge" : "negedge") << " " << escape_name(pe.port) << ")";
     }
 
-    void write(std::ostream &out)
+    // Everything up to the interconnect delays, which are in the main design as a "cell"
+    void write_header(std::ostream &out) const
     {
         out << "(DELAYFILE" << std::endl;
         // Headers and  metadata
@@ -158,69 +159,122 @@ struct SDFWriter
         out << "  (PROGRAM " << format_name(program) << ")" << std::endl;
         out << "  (DIVIDER " << (cvc_mode ? "." : "/") << ")" << std::endl;
         out << "  (TIMESCALE 1ps)" << std::endl;
-        // Write interconnect delays, with the main design begin a "cell"
         out << "  (CELL" << std::endl;
         out << "    (CELLTYPE " << format_name(design) << ")" << std::endl;
         out << "    (INSTANCE )" << std::endl;
         out << "    (DELAY" << std::endl;
         out << "      (ABSOLUTE" << std::endl;
-        for (auto &ic : conn) {
-            out << "        (INTERCONNECT ";
-            write_port(out, ic.from);
-            out << " ";
-            write_port(out, ic.to);
-            out << " ";
-            write_delay(out, ic.delay);
-            out << ")" << std::endl;
-        }
+    }
+
+    // Called for many items from several threads, so ends lines with '\n' rather than flushing with std::endl
+    void write_interconnect(std::ostream &out, const Interconnect &ic) const
+    {
+        out << "        (INTERCONNECT ";
+        write_port(out, ic.from);
+        out << " ";
+        write_port(out, ic.to);
+        out << " ";
+        write_delay(out, ic.delay);
+        out << ")\n";
+    }
+
+    void write_interconnect_end(std::ostream &out) const
+    {
         out << "      )" << std::endl;
         out << "    )" << std::endl;
         out << "  )" << std::endl;
-        // Write cells
-        for (auto &cell : cells) {
-            out << "  (CELL" << std::endl;
-            out << "    (CELLTYPE " << format_name(cell.celltype) << ")" << std::endl;
-            out << "    (INSTANCE " << escape_name(cell.instance) << ")" << std::endl;
-            // IOPATHs (combinational delay and clock-to-q)
-            if (!cell.iopaths.empty()) {
-                out << "    (DELAY" << std::endl;
-                out << "      (ABSOLUTE" << std::endl;
-                for (auto &path : cell.iopaths) {
-                    out << "        (IOPATH " << escape_name(path.from) << " " << escape_name(path.to) << " ";
-                    write_delay(out, path.delay);
-                    out << ")" << std::endl;
-                }
-                out << "      )" << std::endl;
-                out << "    )" << std::endl;
+    }
+
+    // As write_interconnect, ends lines with '\n'
+    void write_cell(std::ostream &out, const Cell &cell) const
+    {
+        out << "  (CELL\n";
+        out << "    (CELLTYPE " << format_name(cell.celltype) << ")\n";
+        out << "    (INSTANCE " << escape_name(cell.instance) << ")\n";
+        // IOPATHs (combinational delay and clock-to-q)
+        if (!cell.iopaths.empty()) {
+            out << "    (DELAY\n";
+            out << "      (ABSOLUTE\n";
+            for (auto &path : cell.iopaths) {
+                out << "        (IOPATH " << escape_name(path.from) << " " << escape_name(path.to) << " ";
+                write_delay(out, path.delay);
+                out << ")\n";
             }
-            // Timing Checks (setup/hold, period, width)
-            if (!cell.checks.empty()) {
-                out << "    (TIMINGCHECK" << std::endl;
-                for (auto &check : cell.checks) {
-                    out << "      (" << timing_check_name(check.type) << " ";
-                    write_portedge(out, check.from);
+            out << "      )\n";
+            out << "    )\n";
+        }
+        // Timing Checks (setup/hold, period, width)
+        if (!cell.checks.empty()) {
+            out << "    (TIMINGCHECK\n";
+            for (auto &check : cell.checks) {
+                out << "      (" << timing_check_name(check.type) << " ";
+                write_portedge(out, check.from);
+                out << " ";
+                if (check.type == TimingCheck::SETUPHOLD) {
+                    write_portedge(out, check.to);
                     out << " ";
-                    if (check.type == TimingCheck::SETUPHOLD) {
-                        write_portedge(out, check.to);
-                        out << " ";
-                    }
-                    if (check.type == TimingCheck::SETUPHOLD)
-                        write_delay(out, check.delay);
-                    else
-                        write_delay(out, check.delay.rise);
-                    out << ")" << std::endl;
                 }
-                out << "    )" << std::endl;
+                if (check.type == TimingCheck::SETUPHOLD)
+                    write_delay(out, check.delay);
+                else
+                    write_delay(out, check.delay.rise);
+                out << ")\n";
             }
-            out << "    )" << std::endl;
+            out << "    )\n";
         }
-        out << ")" << std::endl;
+        out << "    )\n";
     }
+
+    void write_footer(std::ostream &out) const { out << ")" << std::endl; }
 };
 
+// Items per chunk formatted by one thread
+static constexpr int chunk_size = 256;
+
+// Writes the items i in [0, count) in rounds of one chunk per thread. In each round, make_item(i) is called for every
+// item on the calling thread, as it queries the arch, which need not be thread safe. Only write_item(buffer, item),
+// which just formats the result, is run in parallel. Each round is written to out in order before the next starts, so
+// output is streamed rather than the whole design being held first. The buffers take on the number formatting of out,
+// so that the output is the same as writing to it directly.
+template <typename Tm, typename Tw>
+void write_chunked(Context *ctx, std::ostream &out, int count, Tm make_item, Tw write_item)
+{
+    ThreadPool &thread_pool = ctx->get_thread_pool();
+    int threads = thread_pool.size();
+    std::vector<std::ostringstream> buffers(threads);
+    for (auto &buffer : buffers) {
+        buffer.flags(out.flags());
+        buffer.precision(out.precision());
+        buffer.imbue(out.getloc());
+    }
+    std::vector<decltype(make_item(0))> items;
+    for (int round_begin = 0; round_begin < count; round_begin += threads * chunk_size) {
+        int round_end = std::min(count, round_begin + threads * chunk_size);
+        items.clear();
+        for (int i = round_begin; i < round_end; i++)
+            items.push_back(make_item(i));
+        int chunks = (round_end - round_begin + chunk_size - 1) / chunk_size;
+        auto write_chunk = [&](int chunk) {
+            int begin = chunk * chunk_size;
+            int end = std::min(int(items.size()), begin + chunk_size);
+            for (int i = begin; i < end; i++)
+                write_item(buffers.at(chunk), items.at(i));
+        };
+        if (chunks == 1)
+            write_chunk(0);
+        else
+            thread_pool.run(chunks, write_chunk);
+        for (int chunk = 0; chunk < chunks; chunk++) {
+            std::string text = buffers.at(chunk).str();
+            out.write(text.data(), text.size());
+            buffers.at(chunk).str(std::string());
+        }
+    }
+}
+
 } // namespace SDF
 
-void Context::writeSDF(std::ostream &out, bool cvc_mode) const
+void Context::writeSDF(std::ostream &out, bool cvc_mode)
 {
     using namespace SDF;
     SDFWriter wr;
@@ -254,9 +308,8 @@ void Context::writeSDF(std::ostream &out, bool cvc_mode) const
         return rf;
     };
 
-    for (const auto &cell : cells) {
+    auto make_cell = [&](const CellInfo *ci) {
         Cell sc;
-        const CellInfo *ci = cell.second.get();
         sc.instance = ci->name.str(this);
         sc.celltype = ci->type.str(this);
         for (auto port : ci->ports) {
@@ -310,25 +363,45 @@ void Context::writeSDF(std::ostream &out, bool cvc_mode) const
                 }
             }
         }
-        wr.cells.push_back(sc);
-    }
+        return sc;
+    };
 
-    for (auto &net : nets) {
-        NetInfo *ni = net.second.get();
-        if (ni->driver.cell == nullptr)
-            continue;
-        for (auto &usr : ni->users) {
-            Interconnect ic;
-            ic.from.cell = ni->driver.cell->name.str(this);
-            ic.from.port = ni->driver.port.str(this);
-            ic.to.cell = usr.cell->name.str(this);
-            ic.to.port = usr.port.str(this);
-            // FIXME: min/max routing delay
-            ic.delay = convert_delay(getNetinfoRouteDelayQuad(ni, usr));
-            wr.conn.push_back(ic);
-        }
-    }
-    wr.write(out);
+    wr.write_header(out);
+
+    std::vector<const NetInfo *> driven_nets;
+    for (auto &net : nets)
+        if (net.second->driver.cell != nullptr)
+            driven_nets.push_back(net.second.get());
+    write_chunked(
+            this, out, int(driven_nets.size()),
+            [&](int i) {
+                const NetInfo *ni = driven_nets.at(i);
+                std::vector<Interconnect> ics;
+                for (auto &usr : ni->users) {
+                    Interconnect ic;
+                    ic.from.cell = ni->driver.cell->name.str(this);
+                    ic.from.port = ni->driver.port.str(this);
+                    ic.to.cell = usr.cell->name.str(this);
+                    ic.to.port = usr.port.str(this);
+                    // FIXME: min/max routing delay
+                    ic.delay = convert_delay(getNetinfoRouteDelayQuad(ni, usr));
+                    ics.push_back(ic);
+                }
+                return ics;
+            },
+            [&](std::ostream &buffer, const std::vector<Interconnect> &ics) {
+                for (auto &ic : ics)
+                    wr.write_interconnect(buffer, ic);
+            });
+    wr.write_interconnect_end(out);
+
+    std::vector<const CellInfo *> all_cells;
+    for (auto &cell : cells)
+        all_cells.push_back(cell.second.get());
+    write_chunked(
+            this, out, int(all_cells.size()), [&](int i) { return make_cell(all_cells.at(i)); },
+            [&](std::ostream &buffer, const Cell &cell) { wr.write_cell(buffer, cell); });
+    wr.write_footer(out);
 }
 
 NEXTPNR_NAMESPACE_END
@@ -0,0 +1,118 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2022  gatecat <gatecat@ds0.me>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+
+NEXTPNR_NAMESPACE_BEGIN
+
+#ifndef NPNR_DISABLE_THREADS
+
+// Set while a thread is running work for a pool, so nested calls to run() don't wait on themselves
+static thread_local bool in_pool_work = false;
+
+ThreadPool::ThreadPool(int thread_count) : blocks(std::max(1, thread_count))
+{
+    for (int i = 1; i < size(); i++)
+        threads.emplace_back([this, i]() { this->worker(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lk(mutex);
+        shutdown = true;
+    }
+    cv_start.notify_all();
+    for (auto &t : threads)
+        t.join();
+}
+
+void ThreadPool::run(int N, std::function<void(int)> func)
+{
+    std::unique_lock run_lk(run_mutex, std::defer_lock);
+    if (threads.empty() || N <= 1 || in_pool_work || !run_lk.try_lock()) {
+        for (int i = 0; i < N; i++)
+            func(i);
+        return;
+    }
+    int block_size = (N + size() - 1) / size();
+    for (int i = 0; i < size(); i++) {
+        blocks.at(i).next = std::min(N, i * block_size);
+        blocks.at(i).end = std::min(N, (i + 1) * block_size);
+    }
+    {
+        std::lock_guard lk(mutex);
+        work = &func;
+        pending = int(threads.size());
+        error = nullptr;
+        ++generation;
+    }
+    cv_start.notify_all();
+    // The calling thread takes the first block
+    process(0);
+    std::unique_lock lk(mutex);
+    cv_done.wait(lk, [this] { return pending == 0; });
+    work = nullptr;
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void ThreadPool::worker(int idx)
+{
+    uint64_t last_generation = 0;
+    while (true) {
+        std::unique_lock lk(mutex);
+        cv_start.wait(lk, [&] { return shutdown || generation != last_generation; });
+        if (shutdown)
+            break;
+        last_generation = generation;
+        lk.unlock();
+
+        process(idx);
+
+        lk.lock();
+        if (--pending == 0)
+            cv_done.notify_one();
+    }
+}
+
+void ThreadPool::process(int idx)
+{
+    in_pool_work = true;
+    try {
+        // Our own block first, then steal from the others
+        for (int i = 0; i < size(); i++) {
+            auto &block = blocks.at((idx + i) % size());
+            int j;
+            while ((j = block.next++) < block.end)
+                (*work)(j);
+        }
+    } catch (...) {
+        std::lock_guard lk(mutex);
+        if (!error)
+            error = std::current_exception();
+    }
+    in_pool_work = false;
+}
+
+#endif
+
+NEXTPNR_NAMESPACE_END
@@ -0,0 +1,100 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2022  gatecat <gatecat@ds0.me>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "nextpnr_namespaces.h"
+
+#ifndef NPNR_DISABLE_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#endif
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// A fixed set of worker threads, shared by all the passes (see Context::get_thread_pool). The thread calling run()
+// works alongside the workers, so a pool of size N has N - 1 worker threads.
+//
+// run(N, func) calls func(0) ... func(N - 1) and returns once all calls are done. Each thread starts on its own
+// contiguous block of indices, and once that is exhausted steals indices from the blocks of the other threads, so
+// uneven work is balanced out. Exceptions thrown by func are passed on to the caller of run().
+//
+// Calls to run() from inside a func, or with the pool busy on another thread, run serially on the calling thread.
+#ifdef NPNR_DISABLE_THREADS
+struct ThreadPool
+{
+    ThreadPool(int) {};
+
+    int size() const { return 1; }
+
+    void run(int N, std::function<void(int)> func)
+    {
+        for (int i = 0; i < N; i++)
+            func(i);
+    };
+};
+#else
+struct ThreadPool
+{
+    ThreadPool(int thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return int(blocks.size()); }
+
+    void run(int N, std::function<void(int)> func);
+
+  private:
+    // The indices [next, end) not yet started of a thread's block
+    struct alignas(64) Block
+    {
+        std::atomic<int> next{0};
+        int end = 0;
+    };
+    std::vector<Block> blocks;
+    std::vector<std::thread> threads;
+
+    std::mutex run_mutex;
+    std::mutex mutex;
+    std::condition_variable cv_start, cv_done;
+    // Incremented for every run(), so workers know there is new work
+    uint64_t generation = 0;
+    int pending = 0;
+    bool shutdown = false;
+    const std::function<void(int)> *work = nullptr;
+    std::exception_ptr error;
+
+    void worker(int idx);
+    void process(int idx);
+};
+#endif
+
+NEXTPNR_NAMESPACE_END
+
+#endif
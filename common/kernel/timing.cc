@@ -39,8 +39,10 @@ TimingAnalyser::TimingAnalyser(Context *ctx) : ctx(ctx)
 
 void TimingAnalyser::setup(bool update_net_timings, bool update_histogram, bool update_crit_paths)
 {
+    need_full_run = true;
     init_ports();
     get_cell_delays();
+    build_graph();
     topo_sort();
     setup_port_domains();
     identify_related_domains();
@@ -50,13 +52,19 @@ void TimingAnalyser::setup(bool update_net_timings, bool update_histogram, bool
 void TimingAnalyser::run(bool update_route_delays, bool update_net_timings, bool update_histogram,
                          bool update_crit_paths)
 {
-    reset_times();
     if (update_route_delays)
         get_route_delays();
-    walk_forward();
-    walk_backward();
-    compute_slack();
-    compute_criticality();
+    if (!incremental || !run_incremental()) {
+        reset_times();
+        walk_forward();
+        walk_backward();
+        compute_slack();
+        compute_criticality();
+        need_full_run = false;
+        last_setup_only = setup_only;
+        last_with_clock_skew = with_clock_skew;
+    }
+    clear_dirty_ports();
 
     // Ensure we clear all timing results if any of them has been marked as
     // as to be updated. This is done so we ensure it's not possible to have
@@ -84,9 +92,13 @@ void TimingAnalyser::init_ports()
     for (auto &cell : ctx->cells) {
         CellInfo *ci = cell.second.get();
         for (auto &port : ci->ports) {
-            auto &data = ports[CellPortKey(ci->name, port.first)];
+            CellPortKey key(ci->name, port.first);
+            auto inserted = port_to_idx.emplace(key, int(ports.size()));
+            if (inserted.second)
+                ports.emplace_back();
+            auto &data = ports.at(inserted.first->second);
             data.type = port.second.type;
-            data.cell_port = CellPortKey(ci->name, port.first);
+            data.cell_port = key;
         }
     }
 }
@@ -95,12 +107,11 @@ void TimingAnalyser::get_cell_delays()
 {
     auto async_clk_key = domains.at(async_clock_id);
 
-    for (auto &port : ports) {
-        CellInfo *ci = cell_info(port.first);
-        auto &pi = port_info(port.first);
-        auto &pd = port.second;
+    for (auto &pd : ports) {
+        CellInfo *ci = cell_info(pd.cell_port);
+        auto &pi = port_info(pd.cell_port);
 
-        IdString name = port.first.port;
+        IdString name = pd.cell_port.port;
         // Ignore dangling ports altogether for timing purposes
         if (!pi.net)
             continue;
@@ -166,6 +177,62 @@ void TimingAnalyser::get_cell_delays()
     }
 }
 
+void TimingAnalyser::build_graph()
+{
+    int port_count = int(ports.size());
+    fwd_graph.build(port_count, [&](int i, std::vector<TimingEdge> &edges) {
+        auto &pd = ports.at(i);
+        if (pd.type == PORT_IN) {
+            // inputs: combinational arcs through the cell
+            for (int j = 0; j < int(pd.cell_arcs.size()); j++) {
+                auto &arc = pd.cell_arcs.at(j);
+                if (arc.type == CellArc::COMBINATIONAL)
+                    edges.push_back(TimingEdge{port_index(CellPortKey(pd.cell_port.cell, arc.other_port)), j});
+            }
+        } else if (pd.type == PORT_OUT) {
+            // outputs: routing to the users of the net
+            const NetInfo *net = port_info(pd.cell_port).net;
+            if (net != nullptr)
+                for (auto &usr : net->users)
+                    edges.push_back(TimingEdge{port_index(CellPortKey(usr)), -1});
+        }
+    });
+    bwd_graph.build(port_count, [&](int i, std::vector<TimingEdge> &edges) {
+        auto &pd = ports.at(i);
+        if (pd.type == PORT_IN) {
+            // inputs: routing back to the net driver
+            const NetInfo *net = port_info(pd.cell_port).net;
+            if (net != nullptr && net->driver.cell != nullptr)
+                edges.push_back(TimingEdge{port_index(CellPortKey(net->driver)), -1});
+        } else if (pd.type == PORT_OUT) {
+            // outputs: combinational arcs back through the cell
+            for (int j = 0; j < int(pd.cell_arcs.size()); j++) {
+                auto &arc = pd.cell_arcs.at(j);
+                if (arc.type == CellArc::COMBINATIONAL)
+                    edges.push_back(TimingEdge{port_index(CellPortKey(pd.cell_port.cell, arc.other_port)), j});
+            }
+        }
+    });
+    fwd_graph_rev.build_reversed(fwd_graph);
+    bwd_graph_rev.build_reversed(bwd_graph);
+}
+
+void TimingAnalyser::TimingGraph::build_reversed(const TimingGraph &other)
+{
+    int port_count = int(other.offsets.size()) - 1;
+    // Count the incoming edges of each port, then place them
+    offsets.assign(port_count + 1, 0);
+    for (auto &edge : other.edges)
+        ++offsets.at(edge.port + 1);
+    for (int i = 0; i < port_count; i++)
+        offsets.at(i + 1) += offsets.at(i);
+    edges.resize(other.edges.size());
+    std::vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < port_count; i++)
+        for (auto &edge : other[i])
+            edges.at(next.at(edge.port)++) = TimingEdge{i, edge.arc};
+}
+
 void TimingAnalyser::get_route_delays()
 {
     for (auto &net : ctx->nets) {
@@ -176,35 +243,45 @@ void TimingAnalyser::get_route_delays()
         for (auto &usr : ni->users) {
             if (usr.cell->bel == BelId())
                 continue;
-            ports.at(CellPortKey(usr)).route_delay = DelayPair(ctx->getNetinfoRouteDelay(ni, usr));
+            set_route_delay(CellPortKey(usr), DelayPair(ctx->getNetinfoRouteDelay(ni, usr)));
         }
     }
 }
 
-void TimingAnalyser::set_route_delay(CellPortKey port, DelayPair value) { ports.at(port).route_delay = value; }
+void TimingAnalyser::set_route_delay(int port, DelayPair value)
+{
+    auto &pd = ports.at(port);
+    if (pd.route_delay.min_delay == value.min_delay && pd.route_delay.max_delay == value.max_delay)
+        return;
+    pd.route_delay = value;
+    mark_route_delay_dirty(port);
+}
+
+void TimingAnalyser::mark_route_delay_dirty(int port)
+{
+    auto &pd = ports.at(port);
+    if (pd.route_delay_dirty)
+        return;
+    pd.route_delay_dirty = true;
+    dirty_ports.push_back(port);
+}
+
+void TimingAnalyser::clear_dirty_ports()
+{
+    for (auto &port : dirty_ports)
+        ports.at(port).route_delay_dirty = false;
+    dirty_ports.clear();
+}
 
 void TimingAnalyser::topo_sort()
 {
+    // Sorting by CellPortKey rather than index keeps the order (and so tie-breaking) independent of port numbering
     TopoSort<CellPortKey> topo;
-    for (auto &port : ports) {
-        auto &pd = port.second;
-        // All ports are nodes
-        topo.node(port.first);
-        if (pd.type == PORT_IN) {
-            // inputs: combinational arcs through the cell are edges
-            for (auto &arc : pd.cell_arcs) {
-                if (arc.type != CellArc::COMBINATIONAL)
-                    continue;
-                topo.edge(port.first, CellPortKey(port.first.cell, arc.other_port));
-            }
-        } else if (pd.type == PORT_OUT) {
-            // output: routing arcs are edges
-            const NetInfo *pn = port_info(port.first).net;
-            if (pn != nullptr) {
-                for (auto &usr : pn->users)
-                    topo.edge(port.first, CellPortKey(usr));
-            }
-        }
+    for (int i = 0; i < int(ports.size()); i++) {
+        // All ports are nodes; combinational arcs through cells and routing arcs are edges
+        topo.node(ports.at(i).cell_port);
+        for (auto &edge : fwd_graph[i])
+            topo.edge(ports.at(i).cell_port, ports.at(edge.port).cell_port);
     }
 
     bool ignore_loops = bool_or_default(ctx->settings, ctx->id("timing/ignoreLoops"), false);
@@ -226,7 +303,85 @@ void TimingAnalyser::topo_sort()
             log_error("Timing analysis failed due to combinational loops.\n");
     }
     have_loops = !no_loops;
-    std::swap(topological_order, topo.sorted);
+    topological_order.clear();
+    for (auto &key : topo.sorted)
+        topological_order.push_back(port_index(key));
+    for (int i = 0; i < int(topological_order.size()); i++)
+        ports.at(topological_order.at(i)).topo_index = i;
+    build_levels();
+}
+
+void TimingAnalyser::build_levels()
+{
+    // Pulls visit the fanin/fanout of a port in the order a serial walk would have pushed from them, so that ties
+    // between equal times are broken the same way
+    fwd_graph_rev.sort_edges([&](const TimingEdge &a, const TimingEdge &b) {
+        return ports.at(a.port).topo_index < ports.at(b.port).topo_index;
+    });
+    bwd_graph_rev.sort_edges([&](const TimingEdge &a, const TimingEdge &b) {
+        return ports.at(a.port).topo_index > ports.at(b.port).topo_index;
+    });
+
+    // Edges that go backwards in the walk order only exist with combinational loops, and are left out of the levels
+    std::vector<int> level(ports.size(), 0);
+    for (int p : topological_order)
+        for (auto &edge : fwd_graph[p])
+            if (ports.at(edge.port).topo_index > ports.at(p).topo_index)
+                level.at(edge.port) = std::max(level.at(edge.port), level.at(p) + 1);
+    arrival_levels.build(topological_order, level);
+
+    std::vector<int> reverse_order(topological_order.rbegin(), topological_order.rend());
+    std::fill(level.begin(), level.end(), 0);
+    for (int p : reverse_order)
+        for (auto &edge : bwd_graph[p])
+            if (ports.at(edge.port).topo_index < ports.at(p).topo_index)
+                level.at(edge.port) = std::max(level.at(edge.port), level.at(p) + 1);
+    required_levels.build(reverse_order, level);
+}
+
+void TimingAnalyser::TimingLevels::build(const std::vector<int> &order, const std::vector<int> &level)
+{
+    int level_count = 0;
+    for (int p : order)
+        level_count = std::max(level_count, level.at(p) + 1);
+    // Counting sort by level, keeping the walk order within each level
+    offsets.assign(level_count + 1, 0);
+    for (int p : order)
+        ++offsets.at(level.at(p) + 1);
+    for (int i = 0; i < level_count; i++)
+        offsets.at(i + 1) += offsets.at(i);
+    ports.resize(order.size());
+    std::vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (int p : order)
+        ports.at(next.at(level.at(p))++) = p;
+}
+
+// Below this many ports, handing work to the thread pool costs more than it saves
+static constexpr int min_parallel_ports = 512;
+
+template <typename Tf> int TimingAnalyser::parallel_blocks(int count, Tf func)
+{
+    auto &thread_pool = ctx->get_thread_pool();
+    if (thread_pool.size() == 1 || count < min_parallel_ports) {
+        func(0, 0, count);
+        return 1;
+    }
+    int blocks = thread_pool.size();
+    int block_size = (count + blocks - 1) / blocks;
+    thread_pool.run(blocks, [&](int block) {
+        int begin = std::min(count, block * block_size);
+        int end = std::min(count, begin + block_size);
+        func(block, begin, end);
+    });
+    return blocks;
+}
+
+template <typename Tf> void TimingAnalyser::parallel_for(int count, Tf func)
+{
+    parallel_blocks(count, [&](int, int begin, int end) {
+        for (int i = begin; i < end; i++)
+            func(i);
+    });
 }
 
 void TimingAnalyser::setup_port_domains()
@@ -239,73 +394,66 @@ void TimingAnalyser::setup_port_domains()
     do {
         // Go forward through the topological order (domains from the PoV of arrival time)
         updated_domains = false;
-        for (auto port : topological_order) {
-            auto &pd = ports.at(port);
-            auto &pi = port_info(port);
-            if (pi.type == PORT_OUT) {
-                if (first_iter) {
-                    for (auto &fanin : pd.cell_arcs) {
-                        domain_id_t dom;
-                        // registered outputs are startpoints
-                        if (fanin.type == CellArc::CLK_TO_Q)
-                            dom = domain_id(port.cell, fanin.other_port, fanin.edge);
-                        else if (fanin.type == CellArc::STARTPOINT)
-                            dom = async_clock_id;
-                        else
-                            continue;
-                        // create per-domain data
-                        pd.arrival[dom];
-                        domains.at(dom).startpoints.emplace_back(port, fanin.other_port);
-                    }
-                }
-                // copy domains across routing
-                if (pi.net != nullptr)
-                    for (auto &usr : pi.net->users)
-                        copy_domains(port, CellPortKey(usr), false);
-            } else {
-                // copy domains from input to output
-                for (auto &fanout : pd.cell_arcs) {
-                    if (fanout.type != CellArc::COMBINATIONAL)
+        for (int p : topological_order) {
+            auto &pd = ports.at(p);
+            auto &pi = port_info(pd.cell_port);
+            if (pi.type == PORT_OUT && first_iter) {
+                for (auto &fanin : pd.cell_arcs) {
+                    domain_id_t dom;
+                    // registered outputs are startpoints
+                    if (fanin.type == CellArc::CLK_TO_Q)
+                        dom = domain_id(pd.cell_port.cell, fanin.other_port, fanin.edge);
+                    else if (fanin.type == CellArc::STARTPOINT)
+                        dom = async_clock_id;
+                    else
                         continue;
-                    copy_domains(port, CellPortKey(port.cell, fanout.other_port), false);
+                    // create per-domain data
+                    pd.arrival[dom];
+                    int clock = (fanin.other_port == IdString())
+                                        ? -1
+                                        : port_index(CellPortKey(pd.cell_port.cell, fanin.other_port));
+                    domains.at(dom).startpoints.emplace_back(p, clock);
                 }
             }
+            // copy domains across routing (from outputs) or from input to output
+            for (auto &edge : fwd_graph[p])
+                copy_domains(p, edge.port, false);
         }
         // Go backward through the topological order (domains from the PoV of required time)
-        for (auto port : reversed_range(topological_order)) {
-            auto &pd = ports.at(port);
-            auto &pi = port_info(port);
+        for (int p : reversed_range(topological_order)) {
+            auto &pd = ports.at(p);
+            auto &pi = port_info(pd.cell_port);
             if (pi.type == PORT_OUT) {
                 // copy domains from output to input
-                for (auto &fanin : pd.cell_arcs) {
-                    if (fanin.type != CellArc::COMBINATIONAL)
-                        continue;
-                    copy_domains(port, CellPortKey(port.cell, fanin.other_port), true);
-                }
+                for (auto &edge : bwd_graph[p])
+                    copy_domains(p, edge.port, true);
             } else {
                 if (first_iter) {
                     for (auto &fanout : pd.cell_arcs) {
                         domain_id_t dom;
                         // registered inputs are endpoints
                         if (fanout.type == CellArc::SETUP)
-                            dom = domain_id(port.cell, fanout.other_port, fanout.edge);
+                            dom = domain_id(pd.cell_port.cell, fanout.other_port, fanout.edge);
                         else if (fanout.type == CellArc::ENDPOINT)
                             dom = async_clock_id;
                         else
                             continue;
                         // create per-domain data
                         pd.required[dom];
-                        domains.at(dom).endpoints.emplace_back(port, fanout.other_port);
+                        int clock = (fanout.other_port == IdString())
+                                            ? -1
+                                            : port_index(CellPortKey(pd.cell_port.cell, fanout.other_port));
+                        domains.at(dom).endpoints.emplace_back(p, clock);
                     }
                 }
                 // copy port to driver
                 if (pi.net != nullptr && pi.net->driver.cell != nullptr)
-                    copy_domains(port, CellPortKey(pi.net->driver), true);
+                    copy_domains(p, port_index(CellPortKey(pi.net->driver)), true);
             }
         }
         // Iterate over ports and find domain pairs
-        for (auto port : topological_order) {
-            auto &pd = ports.at(port);
+        for (int p : topological_order) {
+            auto &pd = ports.at(p);
             for (auto &arr : pd.arrival)
                 for (auto &req : pd.required) {
                     pd.domain_pairs[domain_pair_id(arr.first, req.first)];
@@ -500,35 +648,52 @@ void TimingAnalyser::identify_related_domains()
     }
 }
 
-void TimingAnalyser::reset_times()
+template <typename T> static void reset_arriv_req_times(T &times)
 {
     static const auto init_delay =
             DelayPair(std::numeric_limits<delay_t>::max(), std::numeric_limits<delay_t>::lowest());
-    for (auto &port : ports) {
-        auto do_reset = [&](dict<domain_id_t, ArrivReqTime> &times) {
-            for (auto &t : times) {
-                t.second.value = init_delay;
-                t.second.path_length = 0;
-                t.second.bwd_min = CellPortKey();
-                t.second.bwd_max = CellPortKey();
-            }
-        };
-        do_reset(port.second.arrival);
-        do_reset(port.second.required);
-        for (auto &dp : port.second.domain_pairs) {
-            dp.second.setup_slack = std::numeric_limits<delay_t>::max();
-            dp.second.hold_slack = std::numeric_limits<delay_t>::max();
-            dp.second.max_path_length = 0;
-            dp.second.criticality = 0;
-        }
-        port.second.worst_crit = 0;
-        port.second.worst_setup_slack = std::numeric_limits<delay_t>::max();
-        port.second.worst_hold_slack = std::numeric_limits<delay_t>::max();
+    for (auto &t : times) {
+        t.second.value = init_delay;
+        t.second.path_length = 0;
+        t.second.bwd_min = -1;
+        t.second.bwd_max = -1;
+    }
+}
+
+void TimingAnalyser::reset_arrival(PerPort &pd) { reset_arriv_req_times(pd.arrival); }
+
+void TimingAnalyser::reset_required(PerPort &pd) { reset_arriv_req_times(pd.required); }
+
+void TimingAnalyser::reset_slack(PerPort &pd)
+{
+    for (auto &dp : pd.domain_pairs) {
+        dp.second.setup_slack = std::numeric_limits<delay_t>::max();
+        dp.second.hold_slack = std::numeric_limits<delay_t>::max();
+        dp.second.max_path_length = 0;
     }
+    pd.worst_setup_slack = std::numeric_limits<delay_t>::max();
+    pd.worst_hold_slack = std::numeric_limits<delay_t>::max();
+}
+
+void TimingAnalyser::reset_criticality(PerPort &pd)
+{
+    for (auto &dp : pd.domain_pairs)
+        dp.second.criticality = 0;
+    pd.worst_crit = 0;
+}
+
+void TimingAnalyser::reset_times()
+{
+    parallel_for(int(ports.size()), [&](int i) {
+        auto &pd = ports.at(i);
+        reset_arrival(pd);
+        reset_required(pd);
+        reset_slack(pd);
+        reset_criticality(pd);
+    });
 }
 
-void TimingAnalyser::set_arrival_time(CellPortKey target, domain_id_t domain, DelayPair arrival, int path_length,
-                                      CellPortKey prev)
+void TimingAnalyser::set_arrival_time(int target, domain_id_t domain, DelayPair arrival, int path_length, int prev)
 {
     auto &arr = ports.at(target).arrival.at(domain);
     if (arrival.max_delay > arr.value.max_delay) {
@@ -542,8 +707,8 @@ void TimingAnalyser::set_arrival_time(CellPortKey target, domain_id_t domain, De
     arr.path_length = std::max(arr.path_length, path_length);
 }
 
-void TimingAnalyser::set_required_time(CellPortKey target, domain_id_t domain, DelayPair required, int path_length,
-                                       CellPortKey prev)
+void TimingAnalyser::set_required_time(int target, domain_id_t domain, DelayPair required, int path_length,
+                                       int prev)
 {
     auto &req = ports.at(target).required.at(domain);
     if (required.min_delay < req.value.min_delay) {
@@ -557,114 +722,317 @@ void TimingAnalyser::set_required_time(CellPortKey target, domain_id_t domain, D
     req.path_length = std::max(req.path_length, path_length);
 }
 
+void TimingAnalyser::init_startpoint_arrival(domain_id_t dom_id, const DomainPort &sp)
+{
+    auto &pd = ports.at(sp.port);
+    DelayPair init_arrival(0);
+    if (sp.clock != -1) {
+        // clocked startpoints have a clock-to-out time
+        IdString clock_port = ports.at(sp.clock).cell_port.port;
+        for (auto &fanin : pd.cell_arcs) {
+            if (fanin.type == CellArc::CLK_TO_Q && fanin.other_port == clock_port) {
+                init_arrival += fanin.value.delayPair();
+                // Include the clock delay if clock_skew analysis is enabled
+                if (with_clock_skew) {
+                    init_arrival += ports.at(sp.clock).route_delay;
+                }
+                break;
+            }
+        }
+    }
+    set_arrival_time(sp.port, dom_id, init_arrival, 1, sp.clock);
+}
+
+void TimingAnalyser::push_arrival(int from, const TimingEdge &edge)
+{
+    auto &pd = ports.at(from);
+    auto &next_pd = ports.at(edge.port);
+    for (auto &arr : pd.arrival) {
+        if (edge.arc == -1) {
+            // Output port: propagate delay through net, adding route delay
+            auto next_arr = arr.second.value + next_pd.route_delay;
+            set_arrival_time(edge.port, arr.first, next_arr, arr.second.path_length, from);
+        } else {
+            // Input port; propagate delay through cell, adding combinational delay
+            auto next_arr = arr.second.value + pd.cell_arcs.at(edge.arc).value.delayPair();
+            set_arrival_time(edge.port, arr.first, next_arr, arr.second.path_length + 1, from);
+        }
+    }
+}
+
+void TimingAnalyser::pull_arrival(int p)
+{
+    int topo_index = ports.at(p).topo_index;
+    for (auto &edge : fwd_graph_rev[p]) {
+        if (ports.at(edge.port).topo_index < topo_index)
+            push_arrival(edge.port, TimingEdge{p, edge.arc});
+    }
+}
+
+void TimingAnalyser::propagate_arrival(int p)
+{
+    for (auto &edge : fwd_graph[p]) {
+        if (ports.at(edge.port).in_fwd_cone)
+            push_arrival(p, edge);
+    }
+}
+
 void TimingAnalyser::walk_forward()
 {
     // Assign initial arrival time to domain startpoints
     for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
-        auto &dom = domains.at(dom_id);
-        for (auto &sp : dom.startpoints) {
-            auto &pd = ports.at(sp.first);
-            DelayPair init_arrival(0);
-            CellPortKey clock_key;
-            if (sp.second != IdString()) {
-                // clocked startpoints have a clock-to-out time
-                for (auto &fanin : pd.cell_arcs) {
-                    if (fanin.type == CellArc::CLK_TO_Q && fanin.other_port == sp.second) {
-                        init_arrival += fanin.value.delayPair();
-                        // Include the clock delay if clock_skew analysis is enabled
-                        if (with_clock_skew) {
-                            init_arrival += ports.at(CellPortKey(sp.first.cell, fanin.other_port)).route_delay;
-                        }
-                        break;
-                    }
+        for (auto &sp : domains.at(dom_id).startpoints)
+            init_startpoint_arrival(dom_id, sp);
+    }
+    // Walk forward level by level
+    for (int l = 0; l < arrival_levels.count(); l++) {
+        int begin = arrival_levels.offsets.at(l);
+        parallel_for(arrival_levels.offsets.at(l + 1) - begin,
+                     [&](int i) { pull_arrival(arrival_levels.ports.at(begin + i)); });
+    }
+    if (have_loops) {
+        // Apply the edges that go backwards in topological order, skipped by the pulls, as a serial walk would have
+        for (int p : topological_order)
+            for (auto &edge : fwd_graph[p])
+                if (ports.at(edge.port).topo_index <= ports.at(p).topo_index)
+                    push_arrival(p, edge);
+    }
+}
+
+void TimingAnalyser::init_endpoint_required(domain_id_t dom_id, const DomainPort &ep)
+{
+    auto &pd = ports.at(ep.port);
+    DelayPair init_required(0);
+    // TODO: clock routing delay, if analysis of that is enabled
+    if (ep.clock != -1) {
+        // Add setup/hold time, if this endpoint is clocked
+        IdString clock_port = ports.at(ep.clock).cell_port.port;
+        for (auto &fanin : pd.cell_arcs) {
+
+            if (fanin.type == CellArc::SETUP && fanin.other_port == clock_port) {
+                if (with_clock_skew) {
+                    init_required += ports.at(ep.clock).route_delay;
                 }
-                clock_key = CellPortKey(sp.first.cell, sp.second);
+                init_required.min_delay -= fanin.value.maxDelay();
             }
-            set_arrival_time(sp.first, dom_id, init_arrival, 1, clock_key);
+            if (fanin.type == CellArc::HOLD && fanin.other_port == clock_port)
+                init_required.max_delay += fanin.value.maxDelay();
         }
     }
-    // Walk forward in topological order
-    for (auto p : topological_order) {
-        auto &pd = ports.at(p);
-        for (auto &arr : pd.arrival) {
-            if (pd.type == PORT_OUT) {
-                // Output port: propagate delay through net, adding route delay
-                NetInfo *net = port_info(p).net;
-                if (net != nullptr)
-                    for (auto &usr : net->users) {
-                        CellPortKey usr_key(usr);
-                        auto &usr_pd = ports.at(usr_key);
-                        auto next_arr = arr.second.value + usr_pd.route_delay;
-                        set_arrival_time(usr_key, arr.first, next_arr, arr.second.path_length, p);
-                    }
-            } else if (pd.type == PORT_IN) {
-                // Input port; propagate delay through cell, adding combinational delay
-                for (auto &fanout : pd.cell_arcs) {
-                    if (fanout.type != CellArc::COMBINATIONAL)
-                        continue;
+    set_required_time(ep.port, dom_id, init_required, 1, ep.clock);
+}
 
-                    auto next_arr = arr.second.value + fanout.value.delayPair();
-                    set_arrival_time(CellPortKey(p.cell, fanout.other_port), arr.first, next_arr,
-                                     arr.second.path_length + 1, p);
-                }
-            }
+void TimingAnalyser::push_required(int from, const TimingEdge &edge)
+{
+    auto &pd = ports.at(from);
+    for (auto &req : pd.required) {
+        if (edge.arc == -1) {
+            // Input port: propagate delay back through net, subtracting route delay
+            set_required_time(edge.port, req.first, req.second.value - DelayPair(pd.route_delay.maxDelay()),
+                              req.second.path_length, from);
+        } else {
+            // Output port : propagate delay back through cell, subtracting combinational delay
+            set_required_time(edge.port, req.first,
+                              req.second.value - DelayPair(pd.cell_arcs.at(edge.arc).value.maxDelay()),
+                              req.second.path_length + 1, from);
         }
     }
 }
 
+void TimingAnalyser::pull_required(int p)
+{
+    int topo_index = ports.at(p).topo_index;
+    for (auto &edge : bwd_graph_rev[p]) {
+        if (ports.at(edge.port).topo_index > topo_index)
+            push_required(edge.port, TimingEdge{p, edge.arc});
+    }
+}
+
+void TimingAnalyser::propagate_required(int p)
+{
+    for (auto &edge : bwd_graph[p]) {
+        if (ports.at(edge.port).in_bwd_cone)
+            push_required(p, edge);
+    }
+}
+
 void TimingAnalyser::walk_backward()
 {
     // Assign initial required time to domain endpoints
     // Note that clock frequency will be considered later in the analysis for, for now all required times are normalised
     // to 0ns
     for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
-        auto &dom = domains.at(dom_id);
-        for (auto &ep : dom.endpoints) {
-            auto &pd = ports.at(ep.first);
-            DelayPair init_required(0);
-            CellPortKey clock_key;
-            // TODO: clock routing delay, if analysis of that is enabled
-            if (ep.second != IdString()) {
-                // Add setup/hold time, if this endpoint is clocked
-                for (auto &fanin : pd.cell_arcs) {
+        for (auto &ep : domains.at(dom_id).endpoints)
+            init_endpoint_required(dom_id, ep);
+    }
+    // Walk backwards level by level
+    for (int l = 0; l < required_levels.count(); l++) {
+        int begin = required_levels.offsets.at(l);
+        parallel_for(required_levels.offsets.at(l + 1) - begin,
+                     [&](int i) { pull_required(required_levels.ports.at(begin + i)); });
+    }
+    if (have_loops) {
+        // Apply the edges that go forwards in topological order, skipped by the pulls, as a serial walk would have
+        for (int p : reversed_range(topological_order))
+            for (auto &edge : bwd_graph[p])
+                if (ports.at(edge.port).topo_index >= ports.at(p).topo_index)
+                    push_required(p, edge);
+    }
+}
 
-                    if (fanin.type == CellArc::SETUP && fanin.other_port == ep.second) {
-                        if (with_clock_skew) {
-                            init_required += ports.at(CellPortKey(ep.first.cell, fanin.other_port)).route_delay;
-                        }
-                        init_required.min_delay -= fanin.value.maxDelay();
-                    }
-                    if (fanin.type == CellArc::HOLD && fanin.other_port == ep.second)
-                        init_required.max_delay += fanin.value.maxDelay();
-                }
-                clock_key = CellPortKey(ep.first.cell, ep.second);
-            }
-            set_required_time(ep.first, dom_id, init_required, 1, clock_key);
+bool TimingAnalyser::run_incremental()
+{
+    if (need_full_run || have_loops || setup_only != last_setup_only || with_clock_skew != last_with_clock_skew)
+        return false;
+
+    // Find the cones of ports whose arrival (forward) and required (backward) times might have changed
+    std::vector<int> fwd_cone, bwd_cone;
+    auto add_fwd = [&](int p) {
+        auto &pd = ports.at(p);
+        if (!pd.in_fwd_cone) {
+            pd.in_fwd_cone = true;
+            fwd_cone.push_back(p);
         }
-    }
-    // Walk backwards in topological order
-    for (auto p : reversed_range(topological_order)) {
+    };
+    auto add_bwd = [&](int p) {
         auto &pd = ports.at(p);
-        for (auto &req : pd.required) {
-            if (pd.type == PORT_IN) {
-                // Input port: propagate delay back through net, subtracting route delay
-                NetInfo *net = port_info(p).net;
-                if (net != nullptr && net->driver.cell != nullptr)
-                    set_required_time(CellPortKey(net->driver), req.first,
-                                      req.second.value - DelayPair(pd.route_delay.maxDelay()), req.second.path_length,
-                                      p);
-            } else if (pd.type == PORT_OUT) {
-                // Output port : propagate delay back through cell, subtracting combinational delay
-                for (auto &fanin : pd.cell_arcs) {
-                    if (fanin.type != CellArc::COMBINATIONAL)
+        if (!pd.in_bwd_cone) {
+            pd.in_bwd_cone = true;
+            bwd_cone.push_back(p);
+        }
+    };
+    for (int p : dirty_ports) {
+        // The route delay into a port is part of its arrival time, and of the required time at its driver
+        add_fwd(p);
+        for (auto &edge : bwd_graph[p])
+            if (edge.arc == -1)
+                add_bwd(edge.port);
+        if (with_clock_skew) {
+            // Clock routing delays are part of startpoint arrival and endpoint required times
+            const CellPortKey &key = ports.at(p).cell_port;
+            for (auto &port : cell_info(key)->ports) {
+                int other = port_index(CellPortKey(key.cell, port.first));
+                for (auto &arc : ports.at(other).cell_arcs) {
+                    if (arc.other_port != key.port)
                         continue;
-                    set_required_time(CellPortKey(p.cell, fanin.other_port), req.first,
-                                      req.second.value - DelayPair(fanin.value.maxDelay()), req.second.path_length + 1,
-                                      p);
+                    if (arc.type == CellArc::CLK_TO_Q)
+                        add_fwd(other);
+                    else if (arc.type == CellArc::SETUP)
+                        add_bwd(other);
                 }
             }
         }
     }
+    for (size_t i = 0; i < fwd_cone.size(); i++)
+        for (auto &edge : fwd_graph[fwd_cone.at(i)])
+            add_fwd(edge.port);
+    for (size_t i = 0; i < bwd_cone.size(); i++)
+        for (auto &edge : bwd_graph[bwd_cone.at(i)])
+            add_bwd(edge.port);
+
+    auto clear_cones = [&]() {
+        for (int p : fwd_cone)
+            ports.at(p).in_fwd_cone = false;
+        for (int p : bwd_cone)
+            ports.at(p).in_bwd_cone = false;
+    };
+    if (fwd_cone.size() + bwd_cone.size() > ports.size()) {
+        // Most of the design is affected, a full run is cheaper
+        clear_cones();
+        return false;
+    }
+
+    // To get the same result as a full run, times are pushed into the cone from the same source ports and in the
+    // same order that walk_forward/walk_backward would, but only pushes to ports in the cone are made
+    std::vector<int> sources;
+    auto add_sources = [&](const TimingGraph &rev_graph, int p) {
+        for (auto &edge : rev_graph[p]) {
+            auto &pd = ports.at(edge.port);
+            if (!pd.is_source) {
+                pd.is_source = true;
+                sources.push_back(edge.port);
+            }
+        }
+    };
+    auto sort_sources = [&](bool reverse) {
+        std::sort(sources.begin(), sources.end(), [&](int a, int b) {
+            int ia = ports.at(a).topo_index, ib = ports.at(b).topo_index;
+            return reverse ? (ia > ib) : (ia < ib);
+        });
+    };
+    auto clear_sources = [&]() {
+        for (int p : sources)
+            ports.at(p).is_source = false;
+        sources.clear();
+    };
+
+    // Forward
+    for (int p : fwd_cone) {
+        reset_arrival(ports.at(p));
+        add_sources(fwd_graph_rev, p);
+    }
+    for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
+        for (auto &sp : domains.at(dom_id).startpoints)
+            if (ports.at(sp.port).in_fwd_cone)
+                init_startpoint_arrival(dom_id, sp);
+    }
+    sort_sources(false);
+    for (int p : sources)
+        propagate_arrival(p);
+    clear_sources();
+
+    // Backward
+    for (int p : bwd_cone) {
+        reset_required(ports.at(p));
+        add_sources(bwd_graph_rev, p);
+    }
+    for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
+        for (auto &ep : domains.at(dom_id).endpoints)
+            if (ports.at(ep.port).in_bwd_cone)
+                init_endpoint_required(dom_id, ep);
+    }
+    sort_sources(true);
+    for (int p : sources)
+        propagate_required(p);
+    clear_sources();
+
+    // Slack only changes for ports in either cone; but the worst slack of a domain pair is over all ports
+    std::vector<int> changed(fwd_cone);
+    for (int p : bwd_cone)
+        if (!ports.at(p).in_fwd_cone)
+            changed.push_back(p);
+    clear_cones();
+    for (int p : changed) {
+        auto &pd = ports.at(p);
+        reset_slack(pd);
+        compute_port_slack(pd);
+    }
+    std::vector<delay_t> old_worst_setup;
+    for (auto &dp : domain_pairs) {
+        old_worst_setup.push_back(dp.worst_setup_slack);
+        dp.worst_setup_slack = std::numeric_limits<delay_t>::max();
+        dp.worst_hold_slack = std::numeric_limits<delay_t>::max();
+    }
+    for (auto &pd : ports)
+        update_domain_pair_slack(pd, domain_pairs);
+
+    // Criticality is relative to the worst slack, so if that moved it needs recomputing everywhere
+    bool worst_changed = false;
+    for (size_t i = 0; i < domain_pairs.size(); i++)
+        if (domain_pairs.at(i).worst_setup_slack != old_worst_setup.at(i))
+            worst_changed = true;
+    if (worst_changed) {
+        for (auto &pd : ports)
+            reset_criticality(pd);
+        compute_criticality();
+    } else {
+        for (int p : changed) {
+            auto &pd = ports.at(p);
+            reset_criticality(pd);
+            compute_port_criticality(pd);
+        }
+    }
+    return true;
 }
 
 dict<domain_id_t, delay_t> TimingAnalyser::max_delay_by_domain_pairs()
@@ -675,7 +1043,8 @@ dict<domain_id_t, delay_t> TimingAnalyser::max_delay_by_domain_pairs()
         const auto &capture = domains.at(capture_id);
 
         for (auto &ep : capture.endpoints) {
-            auto &ep_port = ports.at(ep.first);
+            auto &ep_port = ports.at(ep.port);
+            const CellPortKey &ep_key = ep_port.cell_port;
 
             auto &req = ep_port.required.at(capture_id);
 
@@ -700,20 +1069,21 @@ dict<domain_id_t, delay_t> TimingAnalyser::max_delay_by_domain_pairs()
                 if (with_clock_skew && !same_clock && !related_clocks) {
                     for (auto &fanin : ep_port.cell_arcs) {
                         if (fanin.type == CellArc::SETUP) {
-                            auto clock_delay = ports.at(CellPortKey(ep.first.cell, fanin.other_port)).route_delay;
-                            delay += clock_delay.minDelay();
+                            int clock_port = port_index(CellPortKey(ep_key.cell, fanin.other_port));
+                            delay += ports.at(clock_port).route_delay.minDelay();
                         }
                     }
 
                     // walk back to startpoint
-                    auto crit_path = walk_crit_path(domain_pair_id(launch_id, capture_id), ep.first, true);
+                    auto crit_path = walk_crit_path(domain_pair_id(launch_id, capture_id), ep_key, true);
                     auto first_inp = crit_path.back();
                     const auto &sp = first_inp.cell->ports.at(first_inp.port).net->driver;
-                    auto &sp_port = ports.at(CellPortKey{sp.cell->name, sp.port});
+                    auto &sp_port = ports.at(port_index(CellPortKey{sp.cell->name, sp.port}));
 
                     for (auto &fanin : sp_port.cell_arcs) {
                         if (fanin.type == CellArc::CLK_TO_Q) {
-                            auto clock_delay = ports.at(CellPortKey(sp.cell->name, fanin.other_port)).route_delay;
+                            auto clock_delay =
+                                    ports.at(port_index(CellPortKey(sp.cell->name, fanin.other_port))).route_delay;
                             delay -= clock_delay.maxDelay();
                         }
                     }
@@ -729,65 +1099,94 @@ dict<domain_id_t, delay_t> TimingAnalyser::max_delay_by_domain_pairs()
     return domain_delay;
 }
 
+void TimingAnalyser::compute_port_slack(PerPort &pd)
+{
+    for (auto &pdp : pd.domain_pairs) {
+        auto &dp = domain_pairs.at(pdp.first);
+
+        // Get clock names
+        const auto &launch_clock = domains.at(dp.key.launch).key.clock;
+        const auto &capture_clock = domains.at(dp.key.capture).key.clock;
+
+        // Get clock-to-clock delay if any
+        delay_t clock_to_clock = 0;
+        auto clocks = std::make_pair(launch_clock, capture_clock);
+        if (clock_delays.count(clocks)) {
+            clock_to_clock = clock_delays.at(clocks);
+        }
+
+        auto &arr = pd.arrival.at(dp.key.launch);
+        auto &req = pd.required.at(dp.key.capture);
+        pdp.second.setup_slack = 0 - (arr.value.maxDelay() - req.value.minDelay() + clock_to_clock);
+        if (!setup_only)
+            pdp.second.hold_slack = arr.value.minDelay() - req.value.maxDelay() + clock_to_clock;
+        pdp.second.max_path_length = arr.path_length + req.path_length;
+        if (dp.key.launch == dp.key.capture)
+            pd.worst_setup_slack = std::min(pd.worst_setup_slack, dp.period.minDelay() + pdp.second.setup_slack);
+        if (!setup_only)
+            pd.worst_hold_slack = std::min(pd.worst_hold_slack, pdp.second.hold_slack);
+    }
+}
+
+void TimingAnalyser::update_domain_pair_slack(const PerPort &pd, std::vector<PerDomainPair> &pairs)
+{
+    for (auto &pdp : pd.domain_pairs) {
+        auto &dp = pairs.at(pdp.first);
+        dp.worst_setup_slack = std::min(dp.worst_setup_slack, pdp.second.setup_slack);
+        if (!setup_only)
+            dp.worst_hold_slack = std::min(dp.worst_hold_slack, pdp.second.hold_slack);
+    }
+}
+
 void TimingAnalyser::compute_slack()
 {
     for (auto &dp : domain_pairs) {
         dp.worst_setup_slack = std::numeric_limits<delay_t>::max();
         dp.worst_hold_slack = std::numeric_limits<delay_t>::max();
     }
-    for (auto p : topological_order) {
-        auto &pd = ports.at(p);
-        for (auto &pdp : pd.domain_pairs) {
-            auto &dp = domain_pairs.at(pdp.first);
-
-            // Get clock names
-            const auto &launch_clock = domains.at(dp.key.launch).key.clock;
-            const auto &capture_clock = domains.at(dp.key.capture).key.clock;
-
-            // Get clock-to-clock delay if any
-            delay_t clock_to_clock = 0;
-            auto clocks = std::make_pair(launch_clock, capture_clock);
-            if (clock_delays.count(clocks)) {
-                clock_to_clock = clock_delays.at(clocks);
-            }
-
-            auto &arr = pd.arrival.at(dp.key.launch);
-            auto &req = pd.required.at(dp.key.capture);
-            pdp.second.setup_slack = 0 - (arr.value.maxDelay() - req.value.minDelay() + clock_to_clock);
-            if (!setup_only)
-                pdp.second.hold_slack = arr.value.minDelay() - req.value.maxDelay() + clock_to_clock;
-            pdp.second.max_path_length = arr.path_length + req.path_length;
-            if (dp.key.launch == dp.key.capture)
-                pd.worst_setup_slack = std::min(pd.worst_setup_slack, dp.period.minDelay() + pdp.second.setup_slack);
-            dp.worst_setup_slack = std::min(dp.worst_setup_slack, pdp.second.setup_slack);
-            if (!setup_only) {
-                pd.worst_hold_slack = std::min(pd.worst_hold_slack, pdp.second.hold_slack);
-                dp.worst_hold_slack = std::min(dp.worst_hold_slack, pdp.second.hold_slack);
-            }
+    // Each block of ports finds its own worst slack per domain pair, which are then combined; as this is a minimum the
+    // result doesn't depend on how the ports were split
+    std::vector<std::vector<PerDomainPair>> block_pairs(ctx->get_thread_pool().size(), domain_pairs);
+    int blocks = parallel_blocks(int(ports.size()), [&](int block, int begin, int end) {
+        auto &pairs = block_pairs.at(block);
+        for (int i = begin; i < end; i++) {
+            auto &pd = ports.at(i);
+            compute_port_slack(pd);
+            update_domain_pair_slack(pd, pairs);
+        }
+    });
+    for (int block = 0; block < blocks; block++) {
+        for (size_t i = 0; i < domain_pairs.size(); i++) {
+            auto &dp = domain_pairs.at(i);
+            const auto &block_dp = block_pairs.at(block).at(i);
+            dp.worst_setup_slack = std::min(dp.worst_setup_slack, block_dp.worst_setup_slack);
+            dp.worst_hold_slack = std::min(dp.worst_hold_slack, block_dp.worst_hold_slack);
         }
     }
 }
 
-void TimingAnalyser::compute_criticality()
+void TimingAnalyser::compute_port_criticality(PerPort &pd)
 {
-    for (auto p : topological_order) {
-        auto &pd = ports.at(p);
-        for (auto &pdp : pd.domain_pairs) {
-            auto &dp = domain_pairs.at(pdp.first);
-            // Do not set criticality for asynchronous paths
-            if (domains.at(dp.key.launch).key.is_async() || domains.at(dp.key.capture).key.is_async())
-                continue;
+    for (auto &pdp : pd.domain_pairs) {
+        auto &dp = domain_pairs.at(pdp.first);
+        // Do not set criticality for asynchronous paths
+        if (domains.at(dp.key.launch).key.is_async() || domains.at(dp.key.capture).key.is_async())
+            continue;
 
-            float crit =
-                    1.0f - (float(pdp.second.setup_slack) - float(dp.worst_setup_slack)) / float(-dp.worst_setup_slack);
-            crit = std::min(crit, 1.0f);
-            crit = std::max(crit, 0.0f);
-            pdp.second.criticality = crit;
-            pd.worst_crit = std::max(pd.worst_crit, crit);
-        }
+        float crit =
+                1.0f - (float(pdp.second.setup_slack) - float(dp.worst_setup_slack)) / float(-dp.worst_setup_slack);
+        crit = std::min(crit, 1.0f);
+        crit = std::max(crit, 0.0f);
+        pdp.second.criticality = crit;
+        pd.worst_crit = std::max(pd.worst_crit, crit);
     }
 }
 
+void TimingAnalyser::compute_criticality()
+{
+    parallel_for(int(ports.size()), [&](int i) { compute_port_criticality(ports.at(i)); });
+}
+
 void TimingAnalyser::build_detailed_net_timing_report()
 {
     auto &net_timings = result.detailed_net_timings;
@@ -795,8 +1194,8 @@ void TimingAnalyser::build_detailed_net_timing_report()
     for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
         auto &dom = domains.at(dom_id);
         for (auto &ep : dom.endpoints) {
-            auto &pd = ports.at(ep.first);
-            const NetInfo *net = port_info(ep.first).net;
+            auto &pd = ports.at(ep.port);
+            const NetInfo *net = port_info(pd.cell_port).net;
 
             for (auto &arr : pd.arrival) {
                 auto &launch = domains.at(arr.first).key;
@@ -828,12 +1227,12 @@ std::vector<CellPortKey> TimingAnalyser::get_worst_eps(domain_id_t domain_pair,
         CellPortKey next;
         delay_t next_slack = std::numeric_limits<delay_t>::max();
         for (auto ep : cap_d.endpoints) {
-            auto &pd = ports.at(ep.first);
+            auto &pd = ports.at(ep.port);
             if (!pd.domain_pairs.count(domain_pair))
                 continue;
             delay_t ep_slack = pd.domain_pairs.at(domain_pair).setup_slack;
             if (ep_slack < next_slack && ep_slack > last_slack) {
-                next = ep.first;
+                next = pd.cell_port;
                 next_slack = ep_slack;
             }
         }
@@ -872,14 +1271,12 @@ std::vector<PortRef> TimingAnalyser::walk_crit_path(domain_id_t domain_pair, Cel
         if (is_input)
             crit_path_rev.emplace_back(PortRef{cell, port.name});
 
-        if (!ports.at(cursor).arrival.count(dp.key.launch))
+        auto &pd = ports.at(port_index(cursor));
+        if (!pd.arrival.count(dp.key.launch))
             break;
 
-        if (longest_path) {
-            cursor = ports.at(cursor).arrival.at(dp.key.launch).bwd_max;
-        } else {
-            cursor = ports.at(cursor).arrival.at(dp.key.launch).bwd_min;
-        }
+        int prev = longest_path ? pd.arrival.at(dp.key.launch).bwd_max : pd.arrival.at(dp.key.launch).bwd_min;
+        cursor = (prev == -1) ? CellPortKey() : ports.at(prev).cell_port;
         is_startpoint = portClass == TMG_STARTPOINT;
     } while (!is_startpoint);
 
@@ -1170,7 +1567,7 @@ void TimingAnalyser::build_slack_histogram_report()
 
     for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
         for (auto &ep : domains.at(dom_id).endpoints) {
-            auto &pd = ports.at(ep.first);
+            auto &pd = ports.at(ep.port);
 
             for (auto &req : pd.required) {
                 auto &capture = domains.at(req.first).key;
@@ -1207,14 +1604,13 @@ std::vector<CriticalPath> TimingAnalyser::get_min_delay_violations()
         const auto &capture_clock = capture.key.clock;
 
         for (const auto &ep : capture.endpoints) {
-            const CellInfo *ci = cell_info(ep.first);
+            const auto &port = ports.at(ep.port);
+            const CellInfo *ci = cell_info(port.cell_port);
             int clkInfoCount = 0;
-            const TimingPortClass cls = ctx->getPortTimingClass(ci, ep.first.port, clkInfoCount);
+            const TimingPortClass cls = ctx->getPortTimingClass(ci, port.cell_port.port, clkInfoCount);
             if (cls != TMG_REGISTER_INPUT)
                 continue;
 
-            const auto &port = ports.at(ep.first);
-
             const auto &req = port.required.at(capture_id);
 
             for (auto &[launch_id, arr] : port.arrival) {
@@ -1237,7 +1633,7 @@ std::vector<CriticalPath> TimingAnalyser::get_min_delay_violations()
                 auto hold_slack = arr.value.minDelay() - req.value.maxDelay() + clock_to_clock;
 
                 if (hold_slack <= 0) {
-                    auto report = build_critical_path_report(dom_pair_id, ep.first, false);
+                    auto report = build_critical_path_report(dom_pair_id, port.cell_port, false);
                     violations.emplace_back(report);
                 }
             }
@@ -1294,7 +1690,7 @@ domain_id_t TimingAnalyser::domain_pair_id(domain_id_t launch, domain_id_t captu
     return inserted.first->second;
 }
 
-void TimingAnalyser::copy_domains(const CellPortKey &from, const CellPortKey &to, bool backward)
+void TimingAnalyser::copy_domains(int from, int to, bool backward)
 {
     auto &f = ports.at(from), &t = ports.at(to);
     for (auto &dom : (backward ? f.required : f.arrival)) {
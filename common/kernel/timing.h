@@ -82,14 +82,21 @@ struct TimingAnalyser
 
     // This is used when routers etc are not actually binding detailed routing (due to congestion or an abstracted
     // model), but want to re-run STA with their own calculated delays
-    void set_route_delay(CellPortKey port, DelayPair value);
+    void set_route_delay(CellPortKey port, DelayPair value) { set_route_delay(get_port_index(port), value); }
+    void set_route_delay(int port, DelayPair value);
 
-    float get_criticality(CellPortKey port) const { return ports.at(port).worst_crit; }
-    float get_setup_slack(CellPortKey port) const { return ports.at(port).worst_setup_slack; }
+    // Ports are assigned dense indices by setup(), which stay valid until the next setup(). Callers that query the
+    // same ports repeatedly can look up the index once and use the index-based accessors to avoid hashing
+    int get_port_index(CellPortKey port) const { return port_to_idx.at(port); }
+
+    float get_criticality(CellPortKey port) const { return get_criticality(get_port_index(port)); }
+    float get_criticality(int port) const { return ports.at(port).worst_crit; }
+    float get_setup_slack(CellPortKey port) const { return get_setup_slack(get_port_index(port)); }
+    float get_setup_slack(int port) const { return ports.at(port).worst_setup_slack; }
     float get_domain_setup_slack(CellPortKey port) const
     {
         delay_t slack = std::numeric_limits<delay_t>::max();
-        for (const auto &dp : ports.at(port).domain_pairs)
+        for (const auto &dp : ports.at(get_port_index(port)).domain_pairs)
             slack = std::min(slack, domain_pairs.at(dp.first).worst_setup_slack);
         return slack;
     }
@@ -105,9 +112,14 @@ struct TimingAnalyser
     bool have_loops = false;
     bool updated_domains = false;
 
+    // Only re-propagate arrival and required times through the fan-out and fan-in cones of ports whose route delay
+    // changed since the last run, instead of the whole design. The results are identical to a full run.
+    bool incremental = false;
+
   private:
     void init_ports();
     void get_cell_delays();
+    void build_graph();
     void get_route_delays();
     void topo_sort();
     void setup_port_domains();
@@ -117,6 +129,25 @@ struct TimingAnalyser
 
     void walk_forward();
     void walk_backward();
+    struct DomainPort;
+    void init_startpoint_arrival(domain_id_t dom_id, const DomainPort &sp);
+    void init_endpoint_required(domain_id_t dom_id, const DomainPort &ep);
+    struct TimingEdge;
+    // Push times from a port along one of its edges in fwd_graph/bwd_graph
+    void push_arrival(int from, const TimingEdge &edge);
+    void push_required(int from, const TimingEdge &edge);
+    // Pull times into a port from every port before it in the walk order; only writes to that port, so the ports of a
+    // level can be processed in parallel
+    void pull_arrival(int p);
+    void pull_required(int p);
+    // Push times from a port to its fanout/fanin in the incremental update cone
+    void propagate_arrival(int p);
+    void propagate_required(int p);
+
+    // Returns false if a full run is needed instead
+    bool run_incremental();
+    void mark_route_delay_dirty(int port);
+    void clear_dirty_ports();
 
     void compute_slack();
     void compute_criticality();
@@ -140,21 +171,66 @@ struct TimingAnalyser
     std::vector<CellPortKey> get_worst_eps(domain_id_t domain_pair, int count);
 
     // Set arrival/required times if more/less than the current value
-    void set_arrival_time(CellPortKey target, domain_id_t domain, DelayPair arrival, int path_length,
-                          CellPortKey prev = CellPortKey());
-    void set_required_time(CellPortKey target, domain_id_t domain, DelayPair required, int path_length,
-                           CellPortKey prev = CellPortKey());
+    void set_arrival_time(int target, domain_id_t domain, DelayPair arrival, int path_length, int prev = -1);
+    void set_required_time(int target, domain_id_t domain, DelayPair required, int path_length, int prev = -1);
 
     // To avoid storing the domain tag structure (which could get large when considering more complex constrained tag
     // cases), assign each domain an ID and use that instead
-    // An arrival or required time entry. Stores both the min/max delays; and the traversal to reach them for critical
-    // path reporting
+    // An arrival or required time entry. Stores both the min/max delays; and the traversal to reach them (as port
+    // indices, -1 for none) for critical path reporting
     struct ArrivReqTime
     {
         DelayPair value;
-        CellPortKey bwd_min, bwd_max;
+        int bwd_min = -1, bwd_max = -1;
         int path_length;
     };
+
+    // A port is only ever in a handful of domains, so a vector searched linearly is used instead of a hashtable. New
+    // entries are inserted at the front, so that iteration order (which determines domain pair IDs) matches dict
+    template <typename T> struct DomainMap
+    {
+        typedef std::pair<domain_id_t, T> value_type;
+        typedef typename std::vector<value_type>::iterator iterator;
+        typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+        std::vector<value_type> entries;
+
+        iterator find(domain_id_t dom)
+        {
+            return std::find_if(entries.begin(), entries.end(), [&](const value_type &e) { return e.first == dom; });
+        }
+        const_iterator find(domain_id_t dom) const
+        {
+            return std::find_if(entries.begin(), entries.end(), [&](const value_type &e) { return e.first == dom; });
+        }
+        int count(domain_id_t dom) const { return find(dom) != entries.end() ? 1 : 0; }
+        std::pair<iterator, bool> emplace(domain_id_t dom, const T &value)
+        {
+            auto found = find(dom);
+            if (found != entries.end())
+                return std::make_pair(found, false);
+            return std::make_pair(entries.emplace(entries.begin(), dom, value), true);
+        }
+        T &operator[](domain_id_t dom) { return emplace(dom, T{}).first->second; }
+        T &at(domain_id_t dom)
+        {
+            auto found = find(dom);
+            NPNR_ASSERT(found != entries.end());
+            return found->second;
+        }
+        const T &at(domain_id_t dom) const
+        {
+            auto found = find(dom);
+            NPNR_ASSERT(found != entries.end());
+            return found->second;
+        }
+        iterator begin() { return entries.begin(); }
+        iterator end() { return entries.end(); }
+        const_iterator begin() const { return entries.begin(); }
+        const_iterator end() const { return entries.end(); }
+        size_t size() const { return entries.size(); }
+        bool empty() const { return entries.empty(); }
+    };
     // Data per port-domain tuple
     struct PortDomainPairData
     {
@@ -194,9 +270,9 @@ struct TimingAnalyser
         CellPortKey cell_port;
         PortType type;
         // per domain timings
-        dict<domain_id_t, ArrivReqTime> arrival;
-        dict<domain_id_t, ArrivReqTime> required;
-        dict<domain_id_t, PortDomainPairData> domain_pairs;
+        DomainMap<ArrivReqTime> arrival;
+        DomainMap<ArrivReqTime> required;
+        DomainMap<PortDomainPairData> domain_pairs;
         // cell timing arcs to (outputs)/from (inputs)  from this port
         std::vector<CellArc> cell_arcs;
         // routing delay into this port (input ports only)
@@ -205,14 +281,36 @@ struct TimingAnalyser
         float worst_crit = 0;
         delay_t worst_setup_slack = std::numeric_limits<delay_t>::max(),
                 worst_hold_slack = std::numeric_limits<delay_t>::max();
+        // position in topological_order
+        int topo_index = -1;
+        // incremental update state
+        bool route_delay_dirty = false;
+        bool in_fwd_cone = false, in_bwd_cone = false, is_source = false;
+    };
+
+    void reset_arrival(PerPort &pd);
+    void reset_required(PerPort &pd);
+    void reset_slack(PerPort &pd);
+    void reset_criticality(PerPort &pd);
+
+    void compute_port_slack(PerPort &pd);
+    struct PerDomainPair;
+    // Fold the slack of a port into the worst slack of each of its domain pairs in pairs
+    void update_domain_pair_slack(const PerPort &pd, std::vector<PerDomainPair> &pairs);
+    void compute_port_criticality(PerPort &pd);
+
+    // A domain startpoint or endpoint: the index of the signal port and of its clock port (-1 if not clocked)
+    struct DomainPort
+    {
+        DomainPort(int port, int clock) : port(port), clock(clock) {};
+        int port, clock;
     };
 
     struct PerDomain
     {
         PerDomain(ClockDomainKey key) : key(key) {};
         ClockDomainKey key;
-        // these are pairs (signal port; clock port)
-        std::vector<std::pair<CellPortKey, IdString>> startpoints, endpoints;
+        std::vector<DomainPort> startpoints, endpoints;
     };
 
     struct PerDomainPair
@@ -223,25 +321,102 @@ struct TimingAnalyser
         delay_t worst_setup_slack, worst_hold_slack;
     };
 
+    // An edge of the timing graph. arc is the index into the cell_arcs of the port the edge was built from, or -1 for
+    // a routing edge
+    struct TimingEdge
+    {
+        int port;
+        int arc;
+    };
+
+    // Adjacency lists for every port, in compressed sparse row form
+    struct TimingGraph
+    {
+        std::vector<int> offsets;
+        std::vector<TimingEdge> edges;
+
+        struct Range
+        {
+            const TimingEdge *b, *e;
+            const TimingEdge *begin() const { return b; }
+            const TimingEdge *end() const { return e; }
+        };
+        Range operator[](int port) const
+        {
+            return Range{edges.data() + offsets.at(port), edges.data() + offsets.at(port + 1)};
+        }
+
+        template <typename Tf> void sort_edges(Tf cmp)
+        {
+            for (int i = 0; i < int(offsets.size()) - 1; i++)
+                std::stable_sort(edges.begin() + offsets.at(i), edges.begin() + offsets.at(i + 1), cmp);
+        }
+
+        // Build from a function that appends the edges of a port to a vector
+        template <typename Tf> void build(int port_count, Tf get_edges)
+        {
+            offsets.clear();
+            edges.clear();
+            for (int i = 0; i < port_count; i++) {
+                offsets.push_back(int(edges.size()));
+                get_edges(i, edges);
+            }
+            offsets.push_back(int(edges.size()));
+        }
+        // Build the graph with every edge of another one reversed (keeping the arc index of the original edge)
+        void build_reversed(const TimingGraph &other);
+    };
+
+    // Ports grouped into levels, in walk order, such that a port only gets times from ports in earlier levels
+    struct TimingLevels
+    {
+        std::vector<int> offsets;
+        std::vector<int> ports;
+
+        int count() const { return int(offsets.size()) - 1; }
+        // Build from the walk order and the level of each port
+        void build(const std::vector<int> &order, const std::vector<int> &level);
+    };
+
+    void build_levels();
+
+    // Run func(i) for i in [0, count), in parallel if the work is large enough to be worth it
+    template <typename Tf> void parallel_for(int count, Tf func);
+    // Split [0, count) into blocks run in parallel, calling func(block, begin, end); returns the number of blocks
+    template <typename Tf> int parallel_blocks(int count, Tf func);
+
     CellInfo *cell_info(const CellPortKey &key);
     PortInfo &port_info(const CellPortKey &key);
+    int port_index(const CellPortKey &key) const { return port_to_idx.at(key); }
 
     domain_id_t domain_id(IdString cell, IdString clock_port, ClockEdge edge);
     domain_id_t domain_id(const NetInfo *net, ClockEdge edge);
     domain_id_t domain_pair_id(domain_id_t launch, domain_id_t capture);
 
-    void copy_domains(const CellPortKey &from, const CellPortKey &to, bool backwards);
+    void copy_domains(int from, int to, bool backwards);
 
     [[maybe_unused]] static const std::string arcType_to_str(CellArc::ArcType typ);
 
-    dict<CellPortKey, PerPort> ports;
+    // Every cell port, indexed by the ID assigned in init_ports
+    std::vector<PerPort> ports;
+    dict<CellPortKey, int> port_to_idx;
+    // Forward edges carry arrival times (input to output through a cell, output to the users of its net), backward
+    // edges required times (input to its net driver, output back through the cell); plus the reverse of each
+    TimingGraph fwd_graph, fwd_graph_rev, bwd_graph, bwd_graph_rev;
     dict<ClockDomainKey, domain_id_t> domain_to_id;
     dict<ClockDomainPairKey, domain_id_t> pair_to_id;
     std::vector<PerDomain> domains;
     std::vector<PerDomainPair> domain_pairs;
     dict<std::pair<IdString, IdString>, delay_t> clock_delays;
 
-    std::vector<CellPortKey> topological_order;
+    std::vector<int> topological_order;
+    TimingLevels arrival_levels, required_levels;
+
+    // Input ports whose route delay changed since the last run
+    std::vector<int> dirty_ports;
+    // Set when the next run must be a full one, along with the settings used by the last full run
+    bool need_full_run = true;
+    bool last_setup_only = false, last_with_clock_skew = false;
 
     domain_id_t async_clock_id;
 
@@ -0,0 +1,257 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "bel_grid.h"
+#include <algorithm>
+
+NEXTPNR_NAMESPACE_BEGIN
+
+void BelGrid::build(const std::vector<Entry> &entries)
+{
+    w = 0;
+    h = 0;
+    for (auto &e : entries) {
+        w = std::max(w, e.loc.x + 1);
+        h = std::max(h, e.loc.y + 1);
+    }
+    // Counting sort by location
+    loc_start.assign(w * h + 1, 0);
+    for (auto &e : entries)
+        ++loc_start.at(e.loc.x * h + e.loc.y + 1);
+    for (int i = 0; i < w * h; i++)
+        loc_start.at(i + 1) += loc_start.at(i);
+    std::vector<int> next(loc_start.begin(), loc_start.end() - 1);
+    bels.assign(entries.size(), BelId());
+    free_bits.assign((entries.size() + 63) / 64, 0);
+    bel_index.clear();
+    for (auto &e : entries) {
+        int idx = next.at(e.loc.x * h + e.loc.y)++;
+        bels.at(idx) = e.bel;
+        bel_index[e.bel] = idx;
+        if (e.free)
+            free_bits.at(idx / 64) |= (uint64_t(1) << (idx % 64));
+    }
+
+    sat.assign((w + 1) * (h + 1), 0);
+    for (int x = 0; x < w; x++)
+        for (int y = 0; y < h; y++) {
+            int here = loc_start.at(x * h + y + 1) - loc_start.at(x * h + y);
+            sat.at((x + 1) * (h + 1) + (y + 1)) = here + sat.at(x * (h + 1) + (y + 1)) +
+                                                  sat.at((x + 1) * (h + 1) + y) - sat.at(x * (h + 1) + y);
+        }
+
+    fenwick.assign(w * h, 0);
+    free_total = 0;
+    for (int x = 0; x < w; x++)
+        for (int y = 0; y < h; y++)
+            for (int i = loc_start.at(x * h + y); i < loc_start.at(x * h + y + 1); i++)
+                if (is_free(i)) {
+                    fenwick_add(x, y, 1);
+                    ++free_total;
+                }
+}
+
+int BelGrid::count(int x0, int y0, int x1, int y1) const
+{
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, w - 1);
+    y1 = std::min(y1, h - 1);
+    if (x0 > x1 || y0 > y1)
+        return 0;
+    auto at = [&](int x, int y) { return sat.at(x * (h + 1) + y); };
+    return at(x1 + 1, y1 + 1) - at(x0, y1 + 1) - at(x1 + 1, y0) + at(x0, y0);
+}
+
+BelId BelGrid::random_bel(DeterministicRNG &rng, int x0, int y0, int x1, int y1) const
+{
+    int total = count(x0, y0, x1, y1);
+    if (total == 0)
+        return BelId();
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, w - 1);
+    y1 = std::min(y1, h - 1);
+    int k = rng.rng(total);
+    // First column where the count up to and including it passes k
+    int lo = x0, hi = x1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (count(x0, y0, mid, y1) > k)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    int x = lo;
+    k -= count(x0, y0, x - 1, y1);
+    lo = y0;
+    hi = y1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (count(x, y0, x, mid) > k)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    int y = lo;
+    k -= count(x, y0, x, y - 1);
+    return bels.at(loc_start.at(x * h + y) + k);
+}
+
+void BelGrid::fenwick_add(int x, int y, int delta)
+{
+    for (int i = x; i < w; i |= (i + 1))
+        for (int j = y; j < h; j |= (j + 1))
+            fenwick.at(i * h + j) += delta;
+}
+
+int BelGrid::fenwick_sum(int x, int y) const
+{
+    int result = 0;
+    for (int i = x; i >= 0; i = (i & (i + 1)) - 1)
+        for (int j = y; j >= 0; j = (j & (j + 1)) - 1)
+            result += fenwick.at(i * h + j);
+    return result;
+}
+
+void BelGrid::set_free(BelId bel, bool free)
+{
+    auto found = bel_index.find(bel);
+    if (found == bel_index.end())
+        return;
+    int idx = found->second;
+    if (is_free(idx) == free)
+        return;
+    free_bits.at(idx / 64) ^= (uint64_t(1) << (idx % 64));
+    // Find the location of the bel from its index
+    int loc = int(std::upper_bound(loc_start.begin(), loc_start.end(), idx) - loc_start.begin()) - 1;
+    fenwick_add(loc / h, loc % h, free ? 1 : -1);
+    free_total += free ? 1 : -1;
+}
+
+int BelGrid::count_free(int x0, int y0, int x1, int y1) const
+{
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, w - 1);
+    y1 = std::min(y1, h - 1);
+    if (x0 > x1 || y0 > y1)
+        return 0;
+    return fenwick_sum(x1, y1) - fenwick_sum(x0 - 1, y1) - fenwick_sum(x1, y0 - 1) + fenwick_sum(x0 - 1, y0 - 1);
+}
+
+bool BelGrid::check_free(Context *ctx, int idx)
+{
+    if (ctx->checkBelAvail(bels.at(idx)))
+        return true;
+    set_free(bels.at(idx), false);
+    return false;
+}
+
+BelId BelGrid::random_free_bel(Context *ctx, DeterministicRNG &rng)
+{
+    while (free_total > 0) {
+        int k = rng.rng(free_total);
+        int lo = 0, hi = w - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (count_free(0, 0, mid, h - 1) > k)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        int x = lo;
+        k -= count_free(0, 0, x - 1, h - 1);
+        lo = 0;
+        hi = h - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (count_free(x, 0, x, mid) > k)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        int y = lo;
+        k -= count_free(x, 0, x, y - 1);
+        for (int i = loc_start.at(x * h + y); i < loc_start.at(x * h + y + 1); i++) {
+            if (!is_free(i))
+                continue;
+            if (k-- > 0)
+                continue;
+            if (check_free(ctx, i))
+                return bels.at(i);
+            break;
+        }
+    }
+    return BelId();
+}
+
+BelId BelGrid::nearest_free_bel(Context *ctx, int x, int y, std::function<bool(BelId)> pred)
+{
+    if (free_total == 0)
+        return BelId();
+    x = std::max(0, std::min(w - 1, x));
+    y = std::max(0, std::min(h - 1, y));
+    int max_radius = std::max(w, h);
+    auto free_within = [&](int r) { return count_free(x - r, y - r, x + r, y + r); };
+    // Free bels within the last radius searched, that have been rejected
+    int rejected = 0;
+    int radius = 0;
+    while (radius <= max_radius) {
+        // Skip straight to the next radius that has more free bels
+        int lo = radius, hi = max_radius;
+        if (free_within(hi) <= rejected)
+            break;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (free_within(mid) > rejected)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        radius = lo;
+        // Check the ring at this radius
+        auto check_loc = [&](int cx, int cy) {
+            if (cx < 0 || cx >= w || cy < 0 || cy >= h)
+                return BelId();
+            for (int i = loc_start.at(cx * h + cy); i < loc_start.at(cx * h + cy + 1); i++)
+                if (is_free(i) && check_free(ctx, i) && pred(bels.at(i)))
+                    return bels.at(i);
+            return BelId();
+        };
+        for (int cx = std::max(0, x - radius); cx <= std::min(w - 1, x + radius); cx++) {
+            if (cx == x - radius || cx == x + radius) {
+                for (int cy = std::max(0, y - radius); cy <= std::min(h - 1, y + radius); cy++) {
+                    BelId bel = check_loc(cx, cy);
+                    if (bel != BelId())
+                        return bel;
+                }
+            } else {
+                BelId bel = check_loc(cx, y - radius);
+                if (bel == BelId() && radius > 0)
+                    bel = check_loc(cx, y + radius);
+                if (bel != BelId())
+                    return bel;
+            }
+        }
+        rejected = free_within(radius);
+        ++radius;
+    }
+    return BelId();
+}
+
+NEXTPNR_NAMESPACE_END
@@ -0,0 +1,93 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef BEL_GRID_H
+#define BEL_GRID_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "deterministic_rng.h"
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// A spatial index over a set of bels (e.g. those of one cell type or bel bucket), for counting and picking bels in a
+// box without scanning every location in it.
+//
+// The set of bels is fixed once built, and counts over all of them come from a summed-area table. Each bel also has a
+// free flag, with free counts kept in a 2D Fenwick tree so that they can be updated as bels are bound and unbound.
+// Nothing here watches the context: the owner calls set_free when it binds or unbinds, and the free queries check
+// candidates with checkBelAvail, so a stale flag costs a retry but never returns a bound bel.
+//
+// The const queries are safe to call from several threads; set_free and the free queries (which correct stale flags)
+// are not.
+struct BelGrid
+{
+    struct Entry
+    {
+        BelId bel;
+        Loc loc;
+        bool free;
+    };
+
+    // Build the index. Entries are bucketed by loc, which may differ from the bel location (see FastBels)
+    void build(const std::vector<Entry> &entries);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int size() const { return int(bels.size()); }
+
+    // Number of bels in the box, inclusive, clipped to the grid. O(1)
+    int count(int x0, int y0, int x1, int y1) const;
+    // A bel picked uniformly from those in the box, or BelId() if there are none. O(log width + log height)
+    BelId random_bel(DeterministicRNG &rng, int x0, int y0, int x1, int y1) const;
+
+    void set_free(BelId bel, bool free);
+    int count_free() const { return free_total; }
+    // Number of bels in the box that are marked free. O(log width * log height)
+    int count_free(int x0, int y0, int x1, int y1) const;
+    // A free bel picked uniformly from the whole grid, or BelId() if there are none
+    BelId random_free_bel(Context *ctx, DeterministicRNG &rng);
+    // The free bel closest to (x, y) (in Chebyshev distance, ties in an arbitrary but fixed order) for which pred is
+    // true, or BelId() if there is none
+    BelId nearest_free_bel(Context *ctx, int x, int y, std::function<bool(BelId)> pred);
+
+  private:
+    int w = 0, h = 0;
+    // Bels by location, column major: the bels at (x, y) are bels[loc_start[x * h + y] .. loc_start[x * h + y + 1])
+    std::vector<int> loc_start;
+    std::vector<BelId> bels;
+    dict<BelId, int> bel_index;
+    // Summed-area table of bel counts, (w + 1) * (h + 1), with a zero first row and column
+    std::vector<int> sat;
+    // One bit per entry of bels
+    std::vector<uint64_t> free_bits;
+    // 2D Fenwick tree of free counts by location
+    std::vector<int> fenwick;
+    int free_total = 0;
+
+    bool is_free(int idx) const { return (free_bits.at(idx / 64) >> (idx % 64)) & 1; }
+    void fenwick_add(int x, int y, int delta);
+    // Free count in [0, x] * [0, y]
+    int fenwick_sum(int x, int y) const;
+    // Check a bel that is marked free, clearing the flag if it turns out to be bound
+    bool check_free(Context *ctx, int idx);
+};
+
+NEXTPNR_NAMESPACE_END
+#endif
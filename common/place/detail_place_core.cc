@@ -83,6 +83,51 @@ void PlacePartition::split(Context *ctx, bool yaxis, float pivot, PlacePartition
     }
 }
 
+void DetailPlacerState::setup_flat_indices()
+{
+    flat_nets.clear();
+    flat_nets.reserve(ctx->nets.size());
+    for (auto &net : ctx->nets) {
+        net.second->udata = flat_nets.size();
+        flat_nets.push_back(net.second.get());
+    }
+    flat_cells.clear();
+    flat_cells.reserve(ctx->cells.size());
+    for (auto &cell : ctx->cells) {
+        cell.second->udata = flat_cells.size();
+        flat_cells.push_back(cell.second.get());
+    }
+    region_bounds.clear();
+    dict<IdString, int> region_idx;
+    for (auto &region : ctx->region) {
+        Region *r = region.second.get();
+        NetBB bb;
+        if (r->constr_bels) {
+            bb.x0 = std::numeric_limits<int>::max();
+            bb.x1 = std::numeric_limits<int>::min();
+            bb.y0 = std::numeric_limits<int>::max();
+            bb.y1 = std::numeric_limits<int>::min();
+            for (auto bel : r->bels) {
+                Loc loc = ctx->getBelLocation(bel);
+                bb.x0 = std::min(bb.x0, loc.x);
+                bb.x1 = std::max(bb.x1, loc.x);
+                bb.y0 = std::min(bb.y0, loc.y);
+                bb.y1 = std::max(bb.y1, loc.y);
+            }
+        } else {
+            bb.x0 = 0;
+            bb.y0 = 0;
+            bb.x1 = ctx->getGridDimX();
+            bb.y1 = ctx->getGridDimY();
+        }
+        region_idx[r->name] = region_bounds.size();
+        region_bounds.push_back(bb);
+    }
+    cell_region.clear();
+    for (CellInfo *ci : flat_cells)
+        cell_region.push_back(ci->region ? region_idx.at(ci->region->name) : -1);
+}
+
 void DetailPlacerState::update_global_costs()
 {
     last_bounds.resize(flat_nets.size());
@@ -106,7 +151,7 @@ void DetailPlacerState::update_global_costs()
     }
 }
 
-NetBB NetBB::compute(const Context *ctx, const NetInfo *net, const dict<IdString, BelId> *cell2bel)
+NetBB NetBB::compute(const Context *ctx, const NetInfo *net, const std::vector<BelId> *cell2bel)
 {
     NetBB result{};
     if (!net->driver.cell)
@@ -114,7 +159,7 @@ NetBB NetBB::compute(const Context *ctx, const NetInfo *net, const dict<IdString
     auto bel_loc = [&](const CellInfo *cell) {
         if (cell->isPseudo())
             return cell->getLocation();
-        BelId bel = cell2bel ? cell2bel->at(cell->name) : cell->bel;
+        BelId bel = cell2bel ? cell2bel->at(cell->udata) : cell->bel;
         return ctx->getBelLocation(bel);
     };
     result.nx0 = result.nx1 = result.ny0 = result.ny1 = 1;
@@ -151,6 +196,106 @@ NetBB NetBB::compute(const Context *ctx, const NetInfo *net, const dict<IdString
     return result;
 }
 
+void NetBBChanges::init(const std::vector<NetBB> &net_bounds)
+{
+    new_net_bounds = net_bounds;
+    for (auto &axis : axes) {
+        axis.bounds_changed_nets.clear();
+        axis.already_bounds_changed.assign(net_bounds.size(), NO_CHANGE);
+    }
+}
+
+void NetBBChanges::reset(const std::vector<NetBB> &net_bounds)
+{
+    for (auto &axis : axes) {
+        for (auto bc : axis.bounds_changed_nets) {
+            new_net_bounds.at(bc) = net_bounds.at(bc);
+            axis.already_bounds_changed.at(bc) = NO_CHANGE;
+        }
+        axis.bounds_changed_nets.clear();
+    }
+}
+
+void NetBBChanges::move_pin(int net, Loc old_loc, Loc new_loc)
+{
+    NetBB &new_bounds = new_net_bounds.at(net);
+    // For the x-axis (i=0) and y-axis (i=1)
+    for (int i = 0; i < 2; i++) {
+        auto &axis = axes.at(i);
+        auto &change = axis.already_bounds_changed.at(net);
+        // If a full update is already queued, this can be considered a no-op
+        if (change == FULL_RECOMPUTE)
+            continue;
+        // New and old on this axis
+        int new_pos = i ? new_loc.y : new_loc.x, old_pos = i ? old_loc.y : old_loc.x;
+        // References to updated bounding box entries
+        auto &b0 = i ? new_bounds.y0 : new_bounds.x0;
+        auto &n0 = i ? new_bounds.ny0 : new_bounds.nx0;
+        auto &b1 = i ? new_bounds.y1 : new_bounds.x1;
+        auto &n1 = i ? new_bounds.ny1 : new_bounds.nx1;
+        // Checking the change so far ensures that each net is only added once to bounds_changed_nets, lest we add its
+        // HPWL change multiple times skewing the overall cost change
+        // Lower bound
+        if (new_pos < b0) {
+            // Further out than current lower bound
+            b0 = new_pos;
+            n0 = 1;
+            if (change == NO_CHANGE) {
+                change = CELL_MOVED_OUTWARDS;
+                axis.bounds_changed_nets.push_back(net);
+            }
+        } else if (new_pos == b0 && old_pos > b0) {
+            // Moved from inside into current bound
+            ++n0;
+            if (change == NO_CHANGE) {
+                change = CELL_MOVED_OUTWARDS;
+                axis.bounds_changed_nets.push_back(net);
+            }
+        } else if (old_pos == b0 && new_pos > b0) {
+            // Moved from current bound to inside
+            if (change == NO_CHANGE)
+                axis.bounds_changed_nets.push_back(net);
+            if (n0 == 1) {
+                // Was the last cell on the bound; have to do a full recompute
+                change = FULL_RECOMPUTE;
+            } else {
+                --n0;
+                if (change == NO_CHANGE)
+                    change = CELL_MOVED_INWARDS;
+            }
+        }
+        // Upper bound
+        if (new_pos > b1) {
+            // Further out than current upper bound
+            b1 = new_pos;
+            n1 = 1;
+            if (change == NO_CHANGE) {
+                change = CELL_MOVED_OUTWARDS;
+                axis.bounds_changed_nets.push_back(net);
+            }
+        } else if (new_pos == b1 && old_pos < b1) {
+            // Moved onto current bound
+            ++n1;
+            if (change == NO_CHANGE) {
+                change = CELL_MOVED_OUTWARDS;
+                axis.bounds_changed_nets.push_back(net);
+            }
+        } else if (old_pos == b1 && new_pos < b1) {
+            // Moved from current bound to inside
+            if (change == NO_CHANGE)
+                axis.bounds_changed_nets.push_back(net);
+            if (n1 == 1) {
+                // Was the last cell on the bound; have to do a full recompute
+                change = FULL_RECOMPUTE;
+            } else {
+                --n1;
+                if (change == NO_CHANGE)
+                    change = CELL_MOVED_INWARDS;
+            }
+        }
+    }
+}
+
 void DetailPlacerThreadState::set_partition(const PlacePartition &part)
 {
     p = part;
@@ -178,13 +323,13 @@ void DetailPlacerThreadState::set_partition(const PlacePartition &part)
         tmg_ignored_nets.push_back(g.timing_skip_net(tn));
     }
     // Set up the original cell-bel map for all nets inside the thread
-    local_cell2bel.clear();
+    local_cell2bel.resize(g.flat_cells.size());
     for (NetInfo *net : thread_nets) {
         if (net->driver.cell && !net->driver.cell->isPseudo())
-            local_cell2bel[net->driver.cell->name] = net->driver.cell->bel;
+            local_cell2bel.at(net->driver.cell->udata) = net->driver.cell->bel;
         for (auto &usr : net->users) {
             if (!usr.cell->isPseudo())
-                local_cell2bel[usr.cell->name] = usr.cell->bel;
+                local_cell2bel.at(usr.cell->udata) = usr.cell->bel;
         }
     }
 }
@@ -198,11 +343,7 @@ void DetailPlacerThreadState::setup_initial_state()
         net_bounds.push_back(g.last_bounds.at(tn->udata));
         arc_tmg_cost.push_back(g.last_tmg_costs.at(tn->udata));
     }
-    new_net_bounds = net_bounds;
-    for (int j = 0; j < 2; j++) {
-        auto &a = axes.at(j);
-        a.already_bounds_changed.resize(net_bounds.size());
-    }
+    bb_changes.init(net_bounds);
     already_timing_changed.clear();
     already_timing_changed.resize(net_bounds.size());
     for (size_t i = 0; i < thread_nets.size(); i++)
@@ -232,7 +373,7 @@ bool DetailPlacerThreadState::bind_move()
             success = false;
             break;
         }
-        ctx->bindBel(entry.second.second, ctx->cells.at(entry.first).get(), STRENGTH_WEAK);
+        ctx->bindBel(entry.second.second, entry.first, STRENGTH_WEAK);
     }
     arch_state_dirty = true;
     return success;
@@ -267,28 +408,23 @@ void DetailPlacerThreadState::revert_move()
         std::unique_lock<std::shared_timed_mutex> l(g.archapi_mutex);
 #endif
         for (auto &entry : moved_cells) {
-            BelId curr_bound = ctx->cells.at(entry.first)->bel;
+            BelId curr_bound = entry.first->bel;
             if (curr_bound != BelId())
                 ctx->unbindBel(curr_bound);
         }
         for (auto &entry : moved_cells) {
-            ctx->bindBel(entry.second.first, ctx->cells.at(entry.first).get(), STRENGTH_WEAK);
+            ctx->bindBel(entry.second.first, entry.first, STRENGTH_WEAK);
         }
         arch_state_dirty = false;
     }
     for (auto &entry : moved_cells)
-        local_cell2bel[entry.first] = entry.second.first;
+        local_cell2bel.at(entry.first->udata) = entry.second.first;
 }
 
 void DetailPlacerThreadState::commit_move()
 {
     arch_state_dirty = false;
-    for (auto &axis : axes) {
-        for (auto bc : axis.bounds_changed_nets) {
-            // Commit updated net bounds
-            net_bounds.at(bc) = new_net_bounds.at(bc);
-        }
-    }
+    bb_changes.commit(net_bounds);
     if (g.base_cfg.timing_driven) {
         NPNR_ASSERT(timing_changed_arcs.size() == new_timing_costs.size());
         for (size_t i = 0; i < timing_changed_arcs.size(); i++) {
@@ -309,77 +445,7 @@ void DetailPlacerThreadState::compute_changes_for_cell(CellInfo *cell, BelId old
         int idx = thread_net_idx.at(pn->udata);
         if (ignored_nets.at(idx))
             continue;
-        NetBB &new_bounds = new_net_bounds.at(idx);
-        // For the x-axis (i=0) and y-axis (i=1)
-        for (int i = 0; i < 2; i++) {
-            auto &axis = axes.at(i);
-            // New and old on this axis
-            int new_pos = i ? new_loc.y : new_loc.x, old_pos = i ? old_loc.y : old_loc.x;
-            // References to updated bounding box entries
-            auto &b0 = i ? new_bounds.y0 : new_bounds.x0;
-            auto &n0 = i ? new_bounds.ny0 : new_bounds.nx0;
-            auto &b1 = i ? new_bounds.y1 : new_bounds.x1;
-            auto &n1 = i ? new_bounds.ny1 : new_bounds.nx1;
-            auto &change = axis.already_bounds_changed.at(idx);
-            // Lower bound
-            if (new_pos < b0) {
-                // Further out than current lower bound
-                b0 = new_pos;
-                n0 = 1;
-                if (change == NO_CHANGE) {
-                    change = CELL_MOVED_OUTWARDS;
-                    axis.bounds_changed_nets.push_back(idx);
-                }
-            } else if (new_pos == b0 && old_pos > b0) {
-                // Moved from inside into current bound
-                ++n0;
-                if (change == NO_CHANGE) {
-                    change = CELL_MOVED_OUTWARDS;
-                    axis.bounds_changed_nets.push_back(idx);
-                }
-            } else if (old_pos == b0 && new_pos > b0) {
-                // Moved from current bound to inside
-                if (change == NO_CHANGE)
-                    axis.bounds_changed_nets.push_back(idx);
-                if (n0 == 1) {
-                    // Was the last cell on the bound; have to do a full recompute
-                    change = FULL_RECOMPUTE;
-                } else {
-                    --n0;
-                    if (change == NO_CHANGE)
-                        change = CELL_MOVED_INWARDS;
-                }
-            }
-            // Upper bound
-            if (new_pos > b1) {
-                // Further out than current upper bound
-                b1 = new_pos;
-                n1 = 1;
-                if (change == NO_CHANGE) {
-                    change = CELL_MOVED_OUTWARDS;
-                    axis.bounds_changed_nets.push_back(idx);
-                }
-            } else if (new_pos == b1 && old_pos < b1) {
-                // Moved onto current bound
-                ++n1;
-                if (change == NO_CHANGE) {
-                    change = CELL_MOVED_OUTWARDS;
-                    axis.bounds_changed_nets.push_back(idx);
-                }
-            } else if (old_pos == b1 && new_pos < b1) {
-                // Moved from current bound to inside
-                if (change == NO_CHANGE)
-                    axis.bounds_changed_nets.push_back(idx);
-                if (n1 == 1) {
-                    // Was the last cell on the bound; have to do a full recompute
-                    change = FULL_RECOMPUTE;
-                } else {
-                    --n1;
-                    if (change == NO_CHANGE)
-                        change = CELL_MOVED_INWARDS;
-                }
-            }
-        }
+        bb_changes.move_pin(idx, old_loc, new_loc);
         // Timing updates if timing driven
         if (g.base_cfg.timing_driven && !tmg_ignored_nets.at(idx)) {
             if (port.second.type == PORT_OUT) {
@@ -405,18 +471,8 @@ void DetailPlacerThreadState::compute_changes_for_cell(CellInfo *cell, BelId old
 
 void DetailPlacerThreadState::compute_total_change()
 {
-    auto &xa = axes.at(0), &ya = axes.at(1);
-    for (auto &bc : xa.bounds_changed_nets)
-        if (xa.already_bounds_changed.at(bc) == FULL_RECOMPUTE)
-            new_net_bounds.at(bc) = NetBB::compute(ctx, thread_nets.at(bc), &local_cell2bel);
-    for (auto &bc : ya.bounds_changed_nets)
-        if (xa.already_bounds_changed.at(bc) != FULL_RECOMPUTE && ya.already_bounds_changed.at(bc) == FULL_RECOMPUTE)
-            new_net_bounds.at(bc) = NetBB::compute(ctx, thread_nets.at(bc), &local_cell2bel);
-    for (auto &bc : xa.bounds_changed_nets)
-        wirelen_delta += (new_net_bounds.at(bc).hpwl(g.base_cfg) - net_bounds.at(bc).hpwl(g.base_cfg));
-    for (auto &bc : ya.bounds_changed_nets)
-        if (xa.already_bounds_changed.at(bc) == NO_CHANGE)
-            wirelen_delta += (new_net_bounds.at(bc).hpwl(g.base_cfg) - net_bounds.at(bc).hpwl(g.base_cfg));
+    bb_changes.recompute([&](int bc) { return NetBB::compute(ctx, thread_nets.at(bc), &local_cell2bel); });
+    wirelen_delta += bb_changes.wirelen_delta(net_bounds, g.base_cfg);
     if (g.base_cfg.timing_driven) {
         NPNR_ASSERT(new_timing_costs.empty());
         for (auto arc : timing_changed_arcs) {
@@ -431,13 +487,7 @@ void DetailPlacerThreadState::reset_move_state()
 {
     moved_cells.clear();
     cell_rel.clear();
-    for (auto &axis : axes) {
-        for (auto bc : axis.bounds_changed_nets) {
-            new_net_bounds.at(bc) = net_bounds.at(bc);
-            axis.already_bounds_changed[bc] = NO_CHANGE;
-        }
-        axis.bounds_changed_nets.clear();
-    }
+    bb_changes.reset(net_bounds);
     for (auto &arc : timing_changed_arcs) {
         already_timing_changed.at(arc.first).at(arc.second.idx()) = false;
     }
@@ -453,9 +503,9 @@ bool DetailPlacerThreadState::add_to_move(CellInfo *cell, BelId old_bel, BelId n
         return false;
     if (!ctx->isValidBelForCellType(cell->type, new_bel))
         return false;
-    NPNR_ASSERT(!moved_cells.count(cell->name));
-    moved_cells[cell->name] = std::make_pair(old_bel, new_bel);
-    local_cell2bel[cell->name] = new_bel;
+    NPNR_ASSERT(!moved_cells.count(cell));
+    moved_cells[cell] = std::make_pair(old_bel, new_bel);
+    local_cell2bel.at(cell->udata) = new_bel;
     compute_changes_for_cell(cell, old_bel, new_bel);
     return true;
 }
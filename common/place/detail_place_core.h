@@ -50,6 +50,7 @@ aborts the entire move transaction.
 #include "fast_bels.h"
 #include "timing.h"
 
+#include <array>
 #include <queue>
 
 #if !defined(NPNR_DISABLE_THREADS)
@@ -75,11 +76,75 @@ struct NetBB
     int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
     // Number of cells at each extremity
     int nx0 = 0, nx1 = 0, ny0 = 0, ny1 = 0;
-    inline wirelen_t hpwl(const DetailPlaceCfg &cfg) const
+    template <typename TCfg> inline wirelen_t hpwl(const TCfg &cfg) const
     {
         return wirelen_t(cfg.hpwl_scale_x * (x1 - x0) + cfg.hpwl_scale_y * (y1 - y0));
     }
-    static NetBB compute(const Context *ctx, const NetInfo *net, const dict<IdString, BelId> *cell2bel = nullptr);
+    // cell2bel, if given, is indexed by cell udata
+    static NetBB compute(const Context *ctx, const NetInfo *net, const std::vector<BelId> *cell2bel = nullptr);
+};
+
+// Incremental updates of the bounding boxes of the nets touched by a move, shared by the detail placers. Nets are
+// referred to by whatever flat index the placer uses for them. The pins of the move are moved one at a time, and each
+// box is updated in place using the number of pins on each of its edges, so it only has to be recomputed from scratch
+// when the last pin on an edge moves inwards.
+struct NetBBChanges
+{
+    enum BoundChange
+    {
+        NO_CHANGE,
+        CELL_MOVED_INWARDS,
+        CELL_MOVED_OUTWARDS,
+        FULL_RECOMPUTE
+    };
+    // Changes are tracked on a per-axis basis
+    struct AxisChanges
+    {
+        std::vector<int> bounds_changed_nets;
+        std::vector<BoundChange> already_bounds_changed;
+    };
+    std::array<AxisChanges, 2> axes;
+    std::vector<NetBB> new_net_bounds;
+
+    // Start from the committed bounds of all nets
+    void init(const std::vector<NetBB> &net_bounds);
+    // Discard the changes of the inflight move
+    void reset(const std::vector<NetBB> &net_bounds);
+    // Update the box of a net for one of its pins moving from old_loc to new_loc
+    void move_pin(int net, Loc old_loc, Loc new_loc);
+
+    // Recompute the boxes that can't be updated incrementally, compute(net) returning the box of a net from scratch
+    template <typename TCompute> void recompute(TCompute compute)
+    {
+        auto &xa = axes.at(0), &ya = axes.at(1);
+        for (int bc : xa.bounds_changed_nets)
+            if (xa.already_bounds_changed.at(bc) == FULL_RECOMPUTE)
+                new_net_bounds.at(bc) = compute(bc);
+        for (int bc : ya.bounds_changed_nets)
+            if (xa.already_bounds_changed.at(bc) != FULL_RECOMPUTE &&
+                ya.already_bounds_changed.at(bc) == FULL_RECOMPUTE)
+                new_net_bounds.at(bc) = compute(bc);
+    }
+    // Call func once for each net whose box has changed
+    template <typename TFunc> void for_each_changed(TFunc func) const
+    {
+        auto &xa = axes.at(0), &ya = axes.at(1);
+        for (int bc : xa.bounds_changed_nets)
+            func(bc);
+        for (int bc : ya.bounds_changed_nets)
+            if (xa.already_bounds_changed.at(bc) == NO_CHANGE)
+                func(bc);
+    }
+    template <typename TCfg> wirelen_t wirelen_delta(const std::vector<NetBB> &net_bounds, const TCfg &cfg) const
+    {
+        wirelen_t delta = 0;
+        for_each_changed([&](int bc) { delta += new_net_bounds.at(bc).hpwl(cfg) - net_bounds.at(bc).hpwl(cfg); });
+        return delta;
+    }
+    void commit(std::vector<NetBB> &net_bounds) const
+    {
+        for_each_changed([&](int bc) { net_bounds.at(bc) = new_net_bounds.at(bc); });
+    }
 };
 
 struct DetailPlacerState
@@ -89,10 +154,13 @@ struct DetailPlacerState
     Context *ctx;
     DetailPlaceCfg &base_cfg;
     FastBels bels;
-    std::vector<NetInfo *> flat_nets; // flat array of all nets in the design for fast referencing by index
+    std::vector<NetInfo *> flat_nets;   // flat array of all nets in the design for fast referencing by index
+    std::vector<CellInfo *> flat_cells; // likewise for cells
     std::vector<NetBB> last_bounds;
     std::vector<std::vector<double>> last_tmg_costs;
-    dict<IdString, NetBB> region_bounds;
+    // Bounds of each region, and the index into it of the region of each cell (or -1)
+    std::vector<NetBB> region_bounds;
+    std::vector<int> cell_region;
     TimingAnalyser tmg;
 
     wirelen_t total_wirelen = 0;
@@ -103,7 +171,7 @@ struct DetailPlacerState
 #endif
 
     inline double get_timing_cost(const NetInfo *net, store_index<PortRef> user,
-                                  const dict<IdString, BelId> *cell2bel = nullptr)
+                                  const std::vector<BelId> *cell2bel = nullptr)
     {
         if (!net->driver.cell)
             return 0;
@@ -119,9 +187,9 @@ struct DetailPlacerState
             break;
         }
         float crit = tmg.get_criticality(CellPortKey(sink));
-        BelId src_bel = cell2bel ? cell2bel->at(net->driver.cell->name) : net->driver.cell->bel;
-        BelId dst_bel = cell2bel ? cell2bel->at(sink.cell->name) : sink.cell->bel;
-        double delay = ctx->getDelayNS(ctx->predictDelay(src_bel, driver_pin, dst_bel, sink_pin));
+        BelId src_bel = cell2bel ? cell2bel->at(net->driver.cell->udata) : net->driver.cell->bel;
+        BelId dst_bel = cell2bel ? cell2bel->at(sink.cell->udata) : sink.cell->bel;
+        double delay = ctx->getDelayNS(ctx->predictDelayCached(src_bel, driver_pin, dst_bel, sink_pin));
         return delay * std::pow(crit, base_cfg.crit_exp);
     }
 
@@ -145,6 +213,8 @@ struct DetailPlacerState
         return false;
     }
 
+    // Set up the flat indices of nets and cells, and region bounds
+    void setup_flat_indices();
     void update_global_costs();
 };
 
@@ -166,31 +236,18 @@ struct DetailPlacerThreadState
     std::vector<std::vector<double>> arc_tmg_cost;
     std::vector<bool> ignored_nets, tmg_ignored_nets;
     bool arch_state_dirty = false;
-    // Our local cell-bel map; that won't be affected by out-of-partition moves
-    dict<IdString, BelId> local_cell2bel;
+    // Our local cell-bel map, indexed by cell udata; that won't be affected by out-of-partition moves
+    std::vector<BelId> local_cell2bel;
 
     // Data on an inflight move
-    dict<IdString, std::pair<BelId, BelId>> moved_cells; // cell -> (old; new)
+    dict<CellInfo *, std::pair<BelId, BelId>, hash_ptr_ops> moved_cells; // cell -> (old; new)
     // For cluster moves only
     std::vector<std::pair<CellInfo *, Loc>> cell_rel;
     // For incremental wirelength and delay updates
     wirelen_t wirelen_delta = 0;
     double timing_delta = 0;
-    // Wirelen related are handled on a per-axis basis to reduce
-    enum BoundChange
-    {
-        NO_CHANGE,
-        CELL_MOVED_INWARDS,
-        CELL_MOVED_OUTWARDS,
-        FULL_RECOMPUTE
-    };
-    struct AxisChanges
-    {
-        std::vector<int> bounds_changed_nets;
-        std::vector<BoundChange> already_bounds_changed;
-    };
-    std::array<AxisChanges, 2> axes;
-    std::vector<NetBB> new_net_bounds;
+    // Indexed by thread net index
+    NetBBChanges bb_changes;
 
     std::vector<std::vector<bool>> already_timing_changed;
     std::vector<std::pair<int, store_index<PortRef>>> timing_changed_arcs;
@@ -0,0 +1,170 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2019  gatecat <gatecat@ds0.me>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef EQUATION_SYSTEM_H
+#define EQUATION_SYSTEM_H
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "nextpnr_assertions.h"
+#include "nextpnr_namespaces.h"
+#include "thread_pool.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// A simple internal representation for a sparse system of equations Ax = rhs
+// This is designed to decouple the functions that build the matrix to the engine that
+// solves it, and the representation that requires
+template <typename T> struct EquationSystem
+{
+    // Simple sparse format. The matrix is symmetric, so A[i] is both row and column i.
+    std::vector<std::vector<std::pair<int, T>>> A; // row -> (col, x[row, col]) sorted by col
+    std::vector<T> rhs;                            // RHS vector
+
+    // Prepare to build a new system with the given number of rows. Most of the matrix structure carries over from one
+    // iteration to the next, so the entries used by the last system are kept (zeroed) and add_coeff rarely has to
+    // insert; entries the last system left at zero are dropped.
+    void reset(size_t rows)
+    {
+        if (A.size() != rows) {
+            A.clear();
+            A.resize(rows);
+        }
+        for (auto &Ar : A) {
+            Ar.erase(std::remove_if(Ar.begin(), Ar.end(), [](const std::pair<int, T> &el) { return el.second == T(); }),
+                     Ar.end());
+            for (auto &el : Ar)
+                el.second = T();
+        }
+        rhs.assign(rows, T());
+    }
+
+    void add_coeff(int row, int col, T val)
+    {
+        auto &Ar = A.at(row);
+        // Binary search
+        int b = 0, e = int(Ar.size()) - 1;
+        while (b <= e) {
+            int i = (b + e) / 2;
+            if (Ar.at(i).first == col) {
+                Ar.at(i).second += val;
+                return;
+            }
+            if (Ar.at(i).first > col)
+                e = i - 1;
+            else
+                b = i + 1;
+        }
+        Ar.insert(Ar.begin() + b, std::make_pair(col, val));
+    }
+
+    void add_rhs(int row, T val) { rhs[row] += val; }
+
+    // Conjugate gradient with a Jacobi preconditioner, starting from the guess in x and stopping once
+    // |rhs - Ax| <= tolerance * |rhs| (the same criterion as Eigen's ConjugateGradient). The vector operations are
+    // split into fixed blocks of rows, run on the thread pool if one is given; partial sums are added up in block order
+    // so the result does not depend on the number of threads.
+    void solve(std::vector<T> &x, float tolerance, ThreadPool *pool)
+    {
+        const int n = int(A.size());
+        if (n == 0)
+            return;
+        NPNR_ASSERT(int(x.size()) == n);
+
+        const int block_size = 1024;
+        const int blocks = (n + block_size - 1) / block_size;
+        std::vector<std::array<T, 3>> partial(blocks);
+        auto for_blocks = [&](auto func) {
+            auto do_block = [&](int b) {
+                partial.at(b).fill(T());
+                for (int i = b * block_size; i < std::min(n, (b + 1) * block_size); i++)
+                    func(i, b, partial.at(b));
+            };
+            if (pool != nullptr && blocks > 1)
+                pool->run(blocks, do_block);
+            else
+                for (int b = 0; b < blocks; b++)
+                    do_block(b);
+        };
+        auto sum = [&](int k) {
+            T result = T();
+            for (auto &p : partial)
+                result += p[k];
+            return result;
+        };
+        auto row_dot = [&](int i, const std::vector<T> &v) {
+            T result = T();
+            for (auto &el : A[i])
+                result += el.second * v[el.first];
+            return result;
+        };
+
+        std::vector<T> inv_diag(n), r(n), z(n), p(n), q(n);
+        for_blocks([&](int i, int, std::array<T, 3> &acc) {
+            T diag = T();
+            for (auto &el : A[i])
+                if (el.first == i)
+                    diag = el.second;
+            inv_diag[i] = (diag == T()) ? T(1) : T(1) / diag;
+            r[i] = rhs[i] - row_dot(i, x);
+            z[i] = inv_diag[i] * r[i];
+            p[i] = z[i];
+            acc[0] += rhs[i] * rhs[i];
+            acc[1] += r[i] * r[i];
+            acc[2] += r[i] * z[i];
+        });
+        T rhs_norm2 = sum(0);
+        if (rhs_norm2 == T()) {
+            std::fill(x.begin(), x.end(), T());
+            return;
+        }
+        T threshold = std::max<T>(T(tolerance) * T(tolerance) * rhs_norm2, std::numeric_limits<T>::min());
+        T r_norm2 = sum(1), rz = sum(2);
+
+        for (int iter = 0; iter < 2 * n && r_norm2 >= threshold; iter++) {
+            for_blocks([&](int i, int, std::array<T, 3> &acc) {
+                q[i] = row_dot(i, p);
+                acc[0] += p[i] * q[i];
+            });
+            T alpha = rz / sum(0);
+            for_blocks([&](int i, int, std::array<T, 3> &acc) {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+                z[i] = inv_diag[i] * r[i];
+                acc[0] += r[i] * r[i];
+                acc[1] += r[i] * z[i];
+            });
+            r_norm2 = sum(0);
+            if (r_norm2 < threshold)
+                break;
+            T rz_next = sum(1);
+            T beta = rz_next / rz;
+            rz = rz_next;
+            for_blocks([&](int i, int, std::array<T, 3> &) { p[i] = z[i] + beta * p[i]; });
+        }
+    }
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif
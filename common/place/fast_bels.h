@@ -21,12 +21,16 @@
 #pragma once
 
 #include <cstddef>
+#include "bel_grid.h"
 #include "nextpnr.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
 // FastBels is a lookup class that provides a fast lookup for finding BELs
 // that support a given cell type.
+//
+// Alongside the per-location lists, each cell type and bel bucket has a BelGrid over the same bels, for counting and
+// picking bels in a box without scanning it. Bels that were unavailable when it was built are marked as not free.
 struct FastBels
 {
     struct TypeData
@@ -53,42 +57,15 @@ struct FastBels
         cell_type_data.type_index = type_idx;
 
         fast_bels_by_cell_type.resize(type_idx + 1);
-        auto &bel_data = fast_bels_by_cell_type.at(type_idx);
-        NPNR_ASSERT(bel_data.get() == nullptr);
-        bel_data = std::make_unique<FastBelsData>();
-
-        for (auto bel : ctx->getBels()) {
-            if (!ctx->isValidBelForCellType(cell_type, bel)) {
-                continue;
-            }
-
-            cell_type_data.number_of_possible_bels += 1;
-        }
-
-        for (auto bel : ctx->getBels()) {
-            if (check_bel_available && !ctx->checkBelAvail(bel)) {
-                continue;
-            }
-
-            if (!ctx->isValidBelForCellType(cell_type, bel)) {
-                continue;
-            }
-
-            Loc loc = ctx->getBelLocation(bel);
-            if (minBelsForGridPick >= 0 && cell_type_data.number_of_possible_bels < minBelsForGridPick) {
-                loc.x = loc.y = 0;
-            }
-
-            if (int(bel_data->size()) < (loc.x + 1)) {
-                bel_data->resize(loc.x + 1);
-            }
-
-            if (int(bel_data->at(loc.x).size()) < (loc.y + 1)) {
-                bel_data->at(loc.x).resize(loc.y + 1);
-            }
-
-            bel_data->at(loc.x).at(loc.y).push_back(bel);
-        }
+        grids_by_cell_type.resize(type_idx + 1);
+        // Not every architecture keeps cell types that can use a bel in that bel's bucket (e.g. dummy cells), so this
+        // has to check all bels
+        std::vector<BelId> bels;
+        for (auto bel : ctx->getBels())
+            if (ctx->isValidBelForCellType(cell_type, bel))
+                bels.push_back(bel);
+        cell_type_data.number_of_possible_bels =
+                addBels(bels, fast_bels_by_cell_type.at(type_idx), grids_by_cell_type.at(type_idx));
     }
 
     void addBelBucket(BelBucketId partition)
@@ -104,42 +81,12 @@ struct FastBels
         type_data.type_index = type_idx;
 
         fast_bels_by_partition_type.resize(type_idx + 1);
-        auto &bel_data = fast_bels_by_partition_type.at(type_idx);
-        NPNR_ASSERT(bel_data.get() == nullptr);
-        bel_data = std::make_unique<FastBelsData>();
-
-        for (auto bel : ctx->getBels()) {
-            if (ctx->getBelBucketForBel(bel) != partition) {
-                continue;
-            }
-
-            type_data.number_of_possible_bels += 1;
-        }
-
-        for (auto bel : ctx->getBels()) {
-            if (check_bel_available && !ctx->checkBelAvail(bel)) {
-                continue;
-            }
-
-            if (ctx->getBelBucketForBel(bel) != partition) {
-                continue;
-            }
-
-            Loc loc = ctx->getBelLocation(bel);
-            if (minBelsForGridPick >= 0 && type_data.number_of_possible_bels < minBelsForGridPick) {
-                loc.x = loc.y = 0;
-            }
-
-            if (int(bel_data->size()) < (loc.x + 1)) {
-                bel_data->resize(loc.x + 1);
-            }
-
-            if (int(bel_data->at(loc.x).size()) < (loc.y + 1)) {
-                bel_data->at(loc.x).resize(loc.y + 1);
-            }
-
-            bel_data->at(loc.x).at(loc.y).push_back(bel);
-        }
+        grids_by_partition_type.resize(type_idx + 1);
+        std::vector<BelId> bels;
+        for (auto bel : ctx->getBelsInBucket(partition))
+            bels.push_back(bel);
+        type_data.number_of_possible_bels =
+                addBels(bels, fast_bels_by_partition_type.at(type_idx), grids_by_partition_type.at(type_idx));
     }
 
     typedef std::vector<std::vector<std::vector<BelId>>> FastBelsData;
@@ -174,15 +121,78 @@ struct FastBels
         return type_data.number_of_possible_bels;
     }
 
+    // The grid uses the same locations as the lists from getBelsForCellType, so everything is at (0, 0) for cell types
+    // with fewer than minBelsForGridPick bels
+    BelGrid &getGridForCellType(IdString cell_type)
+    {
+        addCellType(cell_type);
+        return *grids_by_cell_type.at(cell_types.at(cell_type).type_index);
+    }
+
+    BelGrid &getGridForBelBucket(BelBucketId partition)
+    {
+        addBelBucket(partition);
+        return *grids_by_partition_type.at(partition_types.at(partition).type_index);
+    }
+
+    // Update the free flag of a bel in every grid holding it. Nothing here watches the context, so users of the free
+    // queries call this as they bind and unbind bels
+    void setBelFree(BelId bel, bool free)
+    {
+        for (auto &grid : grids_by_cell_type)
+            grid->set_free(bel, free);
+        for (auto &grid : grids_by_partition_type)
+            grid->set_free(bel, free);
+    }
+
     Context *ctx;
     const bool check_bel_available;
     const int minBelsForGridPick;
 
     dict<IdString, TypeData> cell_types;
     std::vector<std::unique_ptr<FastBelsData>> fast_bels_by_cell_type;
+    std::vector<std::unique_ptr<BelGrid>> grids_by_cell_type;
 
     dict<BelBucketId, TypeData> partition_types;
     std::vector<std::unique_ptr<FastBelsData>> fast_bels_by_partition_type;
+    std::vector<std::unique_ptr<BelGrid>> grids_by_partition_type;
+
+  private:
+    // Fill in the lookups for a set of bels, returning the number of bels
+    int addBels(const std::vector<BelId> &bels, std::unique_ptr<FastBelsData> &bel_data, std::unique_ptr<BelGrid> &grid)
+    {
+        NPNR_ASSERT(bel_data.get() == nullptr);
+        bel_data = std::make_unique<FastBelsData>();
+        grid = std::make_unique<BelGrid>();
+        int number_of_possible_bels = int(bels.size());
+        std::vector<BelGrid::Entry> entries;
+        entries.reserve(bels.size());
+
+        for (auto bel : bels) {
+            bool available = ctx->checkBelAvail(bel);
+            Loc loc = ctx->getBelLocation(bel);
+            if (minBelsForGridPick >= 0 && number_of_possible_bels < minBelsForGridPick) {
+                loc.x = loc.y = 0;
+            }
+            if (check_bel_available && !available) {
+                continue;
+            }
+
+            entries.push_back(BelGrid::Entry{bel, loc, available});
+
+            if (int(bel_data->size()) < (loc.x + 1)) {
+                bel_data->resize(loc.x + 1);
+            }
+
+            if (int(bel_data->at(loc.x).size()) < (loc.y + 1)) {
+                bel_data->at(loc.x).resize(loc.y + 1);
+            }
+
+            bel_data->at(loc.x).at(loc.y).push_back(bel);
+        }
+        grid->build(entries);
+        return number_of_possible_bels;
+    }
 };
 
 NEXTPNR_NAMESPACE_END
@@ -28,7 +28,6 @@
 #include <mutex>
 #include <queue>
 #include <shared_mutex>
-#include <thread>
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -117,7 +116,7 @@ struct ThreadState : DetailPlacerThreadState
                 goto fail;
             for (const auto &db : dest_bels) {
                 BelId old_bel = db.first->bel;
-                if (moved_cells.count(db.first->name))
+                if (moved_cells.count(db.first))
                     goto fail;
                 if (!add_to_move(db.first, old_bel, db.second))
                     goto fail;
@@ -132,7 +131,7 @@ struct ThreadState : DetailPlacerThreadState
                     bound = ctx->getBoundBelCell(db.second);
                 }
                 if (bound) {
-                    if (moved_cells.count(bound->name)) {
+                    if (moved_cells.count(bound)) {
                         // Don't move a cell multiple times in the same go
                         goto fail;
                     } else if (bound->belStrength > STRENGTH_STRONG) {
@@ -198,33 +197,31 @@ struct ThreadState : DetailPlacerThreadState
 
         int dx = g.radius, dy = g.radius;
         if (cell->region != nullptr && cell->region->constr_bels) {
-            dx = std::min(g.cfg.hpwl_scale_x * g.radius,
-                          (g.region_bounds[cell->region->name].x1 - g.region_bounds[cell->region->name].x0) + 1);
-            dy = std::min(g.cfg.hpwl_scale_y * g.radius,
-                          (g.region_bounds[cell->region->name].y1 - g.region_bounds[cell->region->name].y0) + 1);
+            const NetBB &region_bb = g.region_bounds.at(g.cell_region.at(cell->udata));
+            dx = std::min(g.cfg.hpwl_scale_x * g.radius, (region_bb.x1 - region_bb.x0) + 1);
+            dy = std::min(g.cfg.hpwl_scale_y * g.radius, (region_bb.y1 - region_bb.y0) + 1);
             // Clamp location to within bounds
-            curr_loc.x = std::max(g.region_bounds[cell->region->name].x0, curr_loc.x);
-            curr_loc.x = std::min(g.region_bounds[cell->region->name].x1, curr_loc.x);
-            curr_loc.y = std::max(g.region_bounds[cell->region->name].y0, curr_loc.y);
-            curr_loc.y = std::min(g.region_bounds[cell->region->name].y1, curr_loc.y);
+            curr_loc.x = std::max(region_bb.x0, curr_loc.x);
+            curr_loc.x = std::min(region_bb.x1, curr_loc.x);
+            curr_loc.y = std::max(region_bb.y0, curr_loc.y);
+            curr_loc.y = std::min(region_bb.y1, curr_loc.y);
         }
 
-        FastBels::FastBelsData *bel_data;
-        auto type_cnt = g.bels.getBelsForCellType(targetType, &bel_data);
+        const BelGrid &grid = g.bels.getGridForCellType(targetType);
+        // Cell types with few bels are all at (0, 0) in the grid
+        int x0 = std::max(curr_loc.x - dx, 0), y0 = std::max(curr_loc.y - dy, 0);
+        int x1 = x0 + 2 * dx, y1 = y0 + 2 * dy;
+        if (grid.count(x0, y0, x1, y1) == 0) {
+            // Nothing in range (e.g. the window is between columns of this type), so look anywhere
+            x0 = y0 = 0;
+            x1 = grid.width() - 1;
+            y1 = grid.height() - 1;
+        }
 
         while (true) {
-            int nx = rng.rng(2 * dx + 1) + std::max(curr_loc.x - dx, 0);
-            int ny = rng.rng(2 * dy + 1) + std::max(curr_loc.y - dy, 0);
-            if (type_cnt < 64)
-                nx = ny = 0;
-            if (nx >= int(bel_data->size()))
-                continue;
-            if (ny >= int(bel_data->at(nx).size()))
-                continue;
-            const auto &fb = bel_data->at(nx).at(ny);
-            if (fb.size() == 0)
-                continue;
-            BelId bel = fb.at(rng.rng(int(fb.size())));
+            BelId bel = grid.random_bel(rng, x0, y0, x1, y1);
+            if (bel == BelId())
+                return bel;
             if (!bounds_check(bel))
                 continue;
             if (force_z != -1) {
@@ -368,41 +365,20 @@ struct ParallelRefine
     Context *ctx;
     GlobalState g;
     std::vector<ThreadState> t;
+    // The flat indices are kept in udata, so the old values are saved here and put back afterwards
+    std::vector<decltype(NetInfo::udata)> old_net_udata;
+    std::vector<decltype(CellInfo::udata)> old_cell_udata;
     ParallelRefine(Context *ctx, ParallelRefineCfg cfg) : ctx(ctx), g(ctx, cfg)
     {
-        g.flat_nets.reserve(ctx->nets.size());
-        for (auto &net : ctx->nets) {
-            net.second->udata = g.flat_nets.size();
-            g.flat_nets.push_back(net.second.get());
-        }
+        for (auto &net : ctx->nets)
+            old_net_udata.push_back(net.second->udata);
+        for (auto &cell : ctx->cells)
+            old_cell_udata.push_back(cell.second->udata);
+        g.setup_flat_indices();
         // Setup per thread context
         for (int i = 0; i < cfg.threads; i++) {
             t.emplace_back(ctx, g, i);
         }
-        // Setup region bounds
-        for (auto &region : ctx->region) {
-            Region *r = region.second.get();
-            NetBB bb;
-            if (r->constr_bels) {
-                bb.x0 = std::numeric_limits<int>::max();
-                bb.x1 = std::numeric_limits<int>::min();
-                bb.y0 = std::numeric_limits<int>::max();
-                bb.y1 = std::numeric_limits<int>::min();
-                for (auto bel : r->bels) {
-                    Loc loc = ctx->getBelLocation(bel);
-                    bb.x0 = std::min(bb.x0, loc.x);
-                    bb.x1 = std::max(bb.x1, loc.x);
-                    bb.y0 = std::min(bb.y0, loc.y);
-                    bb.y1 = std::max(bb.y1, loc.y);
-                }
-            } else {
-                bb.x0 = 0;
-                bb.y0 = 0;
-                bb.x1 = ctx->getGridDimX();
-                bb.y1 = ctx->getGridDimY();
-            }
-            g.region_bounds[r->name] = bb;
-        }
         // Setup fast bels map
         pool<IdString> cell_types_in_use;
         for (auto &cell : ctx->cells) {
@@ -418,6 +394,13 @@ struct ParallelRefine
             g.bels.addCellType(cell_type);
         }
     };
+    ~ParallelRefine()
+    {
+        for (auto &net : ctx->nets)
+            net.second->udata = old_net_udata.at(net.second->udata);
+        for (auto &cell : ctx->cells)
+            cell.second->udata = old_cell_udata.at(cell.second->udata);
+    }
     std::vector<PlacePartition> parts;
     void do_partition()
     {
@@ -437,13 +420,7 @@ struct ParallelRefine
         }
 
         NPNR_ASSERT(parts.size() == t.size());
-        // TODO: thread pool to make this worthwhile...
-        std::vector<std::thread> workers;
-        for (size_t i = 0; i < t.size(); i++) {
-            workers.emplace_back([i, this]() { t.at(i).set_partition(parts.at(i)); });
-        }
-        for (auto &w : workers)
-            w.join();
+        ctx->get_thread_pool().run(int(t.size()), [&](int i) { t.at(i).set_partition(parts.at(i)); });
     }
 
     void run()
@@ -453,6 +430,7 @@ struct ParallelRefine
         auto refine_start = std::chrono::high_resolution_clock::now();
 
         g.tmg.setup_only = true;
+        g.tmg.incremental = true;
         g.tmg.setup();
         do_partition();
         log_info("Running parallel refinement with %d threads.\n", int(t.size()));
@@ -497,12 +475,7 @@ struct ParallelRefine
 
             do_partition();
 
-            std::vector<std::thread> workers;
-            workers.reserve(t.size());
-            for (int j = 0; j < int(t.size()); j++)
-                workers.emplace_back([this, j]() { t.at(j).run_iter(); });
-            for (auto &w : workers)
-                w.join();
+            ctx->get_thread_pool().run(int(t.size()), [&](int j) { t.at(j).run_iter(); });
             g.tmg.run();
             g.update_global_costs();
             iter++;
@@ -40,6 +40,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <vector>
+#include "detail_place_core.h"
 #include "fast_bels.h"
 #include "log.h"
 #include "place_common.h"
@@ -50,19 +51,6 @@ NEXTPNR_NAMESPACE_BEGIN
 
 class SAPlacer
 {
-  private:
-    struct BoundingBox
-    {
-        // Actual bounding box
-        int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
-        // Number of cells at each extremity
-        int nx0 = 0, nx1 = 0, ny0 = 0, ny1 = 0;
-        wirelen_t hpwl(const Placer1Cfg &cfg) const
-        {
-            return wirelen_t(cfg.hpwl_scale_x * (x1 - x0) + cfg.hpwl_scale_y * (y1 - y0));
-        }
-    };
-
   public:
     SAPlacer(Context *ctx, Placer1Cfg cfg)
             : ctx(ctx), fast_bels(ctx, /*check_bel_available=*/false, cfg.minBelsForGridPick), cfg(cfg), tmg(ctx)
@@ -97,9 +85,10 @@ class SAPlacer
             net.second->udata = n++;
             net_by_udata.push_back(net.second.get());
         }
+        dict<IdString, int> region_idx;
         for (auto &region : ctx->region) {
             Region *r = region.second.get();
-            BoundingBox bb;
+            NetBB bb;
             if (r->constr_bels) {
                 bb.x0 = std::numeric_limits<int>::max();
                 bb.x1 = std::numeric_limits<int>::min();
@@ -118,7 +107,16 @@ class SAPlacer
                 bb.x1 = max_x;
                 bb.y1 = max_y;
             }
-            region_bounds[r->name] = bb;
+            region_idx[r->name] = region_bounds.size();
+            region_bounds.push_back(bb);
+        }
+        // Cells are indexed by udata too, to look up their region
+        old_cell_udata.reserve(ctx->cells.size());
+        for (auto &cell : ctx->cells) {
+            CellInfo *ci = cell.second.get();
+            old_cell_udata.emplace_back(ci->udata);
+            ci->udata = cell_region.size();
+            cell_region.push_back(ci->region ? region_idx.at(ci->region->name) : -1);
         }
         for (auto &cell : ctx->cells) {
             CellInfo *ci = cell.second.get();
@@ -132,6 +130,8 @@ class SAPlacer
     {
         for (auto &net : ctx->nets)
             net.second->udata = old_udata[net.second->udata];
+        for (auto &cell : ctx->cells)
+            cell.second->udata = old_cell_udata[cell.second->udata];
     }
 
     bool place(bool refine = false)
@@ -243,6 +243,18 @@ class SAPlacer
         // Calculate costs after initial placement
         setup_costs();
         moveChange.init(this);
+        if (cfg.parallelMoves) {
+            if (cfg.netShareWeight > 0) {
+                log_warning("Parallel SA moves are not supported with net sharing, evaluating moves serially.\n");
+                cfg.parallelMoves = false;
+            } else {
+                batch_scratch.resize(ctx->get_thread_pool().size());
+                for (auto &scratch : batch_scratch)
+                    scratch.init(this);
+                net_commit_stamp.resize(ctx->nets.size(), 0);
+                tile_stamp.resize((max_x + 1) * (max_y + 1), 0);
+            }
+        }
         curr_wirelen_cost = total_wirelen_cost();
         curr_timing_cost = total_timing_cost();
         last_wirelen_cost = curr_wirelen_cost;
@@ -269,13 +281,17 @@ class SAPlacer
 
             for (int m = 0; m < 15; ++m) {
                 // Loop through all automatically placed cells
-                for (auto cell : autoplaced) {
-                    // Find another random Bel for this cell
-                    BelId try_bel = random_bel_for_cell(cell);
-                    // If valid, try and swap to a new position and see if
-                    // the new position is valid/worthwhile
-                    if (try_bel != BelId() && try_bel != cell->bel)
-                        try_swap_position(cell, try_bel);
+                if (cfg.parallelMoves) {
+                    try_swap_positions_batched(autoplaced);
+                } else {
+                    for (auto cell : autoplaced) {
+                        // Find another random Bel for this cell
+                        BelId try_bel = random_bel_for_cell(cell);
+                        // If valid, try and swap to a new position and see if
+                        // the new position is valid/worthwhile
+                        if (try_bel != BelId() && try_bel != cell->bel)
+                            try_swap_position(cell, try_bel);
+                    }
                 }
                 // Also try swapping chains, if applicable
                 for (auto cb : chain_basis) {
@@ -376,7 +392,7 @@ class SAPlacer
             setup_costs();
             // Reset incremental bounds
             moveChange.reset(this);
-            moveChange.new_net_bounds = net_bounds;
+            moveChange.bb.new_net_bounds = net_bounds;
 
             // Recalculate total metric entirely to avoid rounding errors
             // accumulating over time
@@ -423,23 +439,35 @@ class SAPlacer
         while (cell) {
             CellInfo *ripup_target = nullptr;
             if (cell->bel != BelId()) {
-                ctx->unbindBel(cell->bel);
+                BelId old_bel = cell->bel;
+                ctx->unbindBel(old_bel);
+                fast_bels.setBelFree(old_bel, true);
             }
             FastBels::FastBelsData *bel_data;
             auto type_cnt = fast_bels.getBelsForCellType(cell->type, &bel_data);
+            BelGrid &grid = fast_bels.getGridForCellType(cell->type);
+            int tries = 0;
 
             while (true) {
-                int nx = ctx->rng(max_x + 1), ny = ctx->rng(max_y + 1);
-                if (cfg.minBelsForGridPick >= 0 && type_cnt < cfg.minBelsForGridPick)
-                    nx = ny = 0;
-                if (nx >= int(bel_data->size()))
-                    continue;
-                if (ny >= int(bel_data->at(nx).size()))
-                    continue;
-                const auto &fb = bel_data->at(nx).at(ny);
-                if (fb.size() == 0)
-                    continue;
-                BelId bel = fb.at(ctx->rng(int(fb.size())));
+                BelId bel;
+                // Random locations rarely hit a free bel once the device is nearly full, so after a while alternate
+                // with picking from the bels that are still free (the random pick can also rip up a weak cell, if
+                // none of the free bels are usable)
+                if (++tries > 64 && (tries % 2) == 0)
+                    bel = grid.random_free_bel(ctx, *ctx);
+                if (bel == BelId()) {
+                    int nx = ctx->rng(max_x + 1), ny = ctx->rng(max_y + 1);
+                    if (cfg.minBelsForGridPick >= 0 && type_cnt < cfg.minBelsForGridPick)
+                        nx = ny = 0;
+                    if (nx >= int(bel_data->size()))
+                        continue;
+                    if (ny >= int(bel_data->at(nx).size()))
+                        continue;
+                    const auto &fb = bel_data->at(nx).at(ny);
+                    if (fb.size() == 0)
+                        continue;
+                    bel = fb.at(ctx->rng(int(fb.size())));
+                }
                 if (cell->region && cell->region->constr_bels && !cell->region->bels.count(bel))
                     continue;
                 if (!ctx->isValidBelForCellType(cell->type, bel))
@@ -459,6 +487,7 @@ class SAPlacer
                         ctx->bindBel(bel, ripup_target, STRENGTH_WEAK);
                     continue;
                 }
+                fast_bels.setBelFree(bel, false);
                 break;
             }
             // Back annotate location
@@ -740,15 +769,14 @@ class SAPlacer
 
         int dx = diameter, dy = diameter;
         if (cell->region != nullptr && cell->region->constr_bels) {
-            dx = std::min(cfg.hpwl_scale_x * diameter,
-                          (region_bounds[cell->region->name].x1 - region_bounds[cell->region->name].x0) + 1);
-            dy = std::min(cfg.hpwl_scale_y * diameter,
-                          (region_bounds[cell->region->name].y1 - region_bounds[cell->region->name].y0) + 1);
+            const NetBB &region_bb = region_bounds.at(cell_region.at(cell->udata));
+            dx = std::min(cfg.hpwl_scale_x * diameter, (region_bb.x1 - region_bb.x0) + 1);
+            dy = std::min(cfg.hpwl_scale_y * diameter, (region_bb.y1 - region_bb.y0) + 1);
             // Clamp location to within bounds
-            curr_loc.x = std::max(region_bounds[cell->region->name].x0, curr_loc.x);
-            curr_loc.x = std::min(region_bounds[cell->region->name].x1, curr_loc.x);
-            curr_loc.y = std::max(region_bounds[cell->region->name].y0, curr_loc.y);
-            curr_loc.y = std::min(region_bounds[cell->region->name].y1, curr_loc.y);
+            curr_loc.x = std::max(region_bb.x0, curr_loc.x);
+            curr_loc.x = std::min(region_bb.x1, curr_loc.x);
+            curr_loc.y = std::max(region_bb.y0, curr_loc.y);
+            curr_loc.y = std::min(region_bb.y1, curr_loc.y);
         }
 
         FastBels::FastBelsData *bel_data;
@@ -787,12 +815,39 @@ class SAPlacer
                ctx->getBelGlobalBuf(net->driver.cell->bel);
     }
 
+    // A swap of two cells (or a move of one to a free bel) that is being evaluated without being bound yet
+    struct PendingMove
+    {
+        CellInfo *cell = nullptr, *other = nullptr;
+        BelId old_bel, new_bel;
+        // Results of evaluating the move
+        wirelen_t wirelen_delta = 0;
+        double timing_delta = 0;
+        std::vector<std::pair<decltype(NetInfo::udata), NetBB>> new_bounds;
+        std::vector<std::pair<std::pair<decltype(NetInfo::udata), store_index<PortRef>>, double>> new_arc_costs;
+        // All the nets the evaluation depends on
+        std::vector<decltype(NetInfo::udata)> nets;
+
+        BelId bel_of(const CellInfo *ci) const
+        {
+            return (ci == cell) ? new_bel : ((ci == other) ? old_bel : ci->bel);
+        }
+    };
+
+    // Location of a cell, as if the pending move (if any) had been made
+    inline Loc cell_loc(const CellInfo *ci, const PendingMove *pm)
+    {
+        if (pm == nullptr || ci->isPseudo())
+            return ci->getLocation();
+        return ctx->getBelLocation(pm->bel_of(ci));
+    }
+
     // Get the bounding box for a net
-    inline BoundingBox get_net_bounds(NetInfo *net)
+    inline NetBB get_net_bounds(NetInfo *net, const PendingMove *pm = nullptr)
     {
-        BoundingBox bb;
+        NetBB bb;
         NPNR_ASSERT(net->driver.cell != nullptr);
-        Loc dloc = net->driver.cell->getLocation();
+        Loc dloc = cell_loc(net->driver.cell, pm);
         bb.x0 = dloc.x;
         bb.x1 = dloc.x;
         bb.y0 = dloc.y;
@@ -804,7 +859,7 @@ class SAPlacer
         for (auto user : net->users) {
             if (!user.cell->isPseudo() && user.cell->bel == BelId())
                 continue;
-            Loc uloc = user.cell->getLocation();
+            Loc uloc = cell_loc(user.cell, pm);
             if (bb.x0 == uloc.x)
                 ++bb.nx0;
             else if (uloc.x < bb.x0) {
@@ -835,7 +890,7 @@ class SAPlacer
     }
 
     // Get the timing cost for an arc of a net
-    inline double get_timing_cost(NetInfo *net, const PortRef &user)
+    inline double get_timing_cost(NetInfo *net, const PortRef &user, const PendingMove *pm = nullptr)
     {
         int cc;
         if (net->driver.cell == nullptr)
@@ -844,10 +899,35 @@ class SAPlacer
             return 0;
 
         float crit = tmg.get_criticality(CellPortKey(user));
-        double delay = ctx->getDelayNS(ctx->predictArcDelay(net, user));
+        double delay = ctx->getDelayNS(pm != nullptr ? predict_pending_arc_delay(net, user, *pm)
+                                                     : ctx->predictArcDelay(net, user));
         return delay * std::pow(crit, crit_exp);
     }
 
+    // As Context::predictArcDelay, but with the cells of a pending move at their new bels. The bel pins are the ones
+    // the cells use where they are bound now.
+    delay_t predict_pending_arc_delay(const NetInfo *net, const PortRef &sink, const PendingMove &pm)
+    {
+        CellInfo *driver = net->driver.cell;
+        if (driver != pm.cell && driver != pm.other && sink.cell != pm.cell && sink.cell != pm.other)
+            return ctx->predictArcDelay(net, sink);
+        BelId driver_bel = pm.bel_of(driver), sink_bel = pm.bel_of(sink.cell);
+        if (driver_bel == BelId() || sink_bel == BelId())
+            return 0;
+        IdString driver_pin, sink_pin;
+        for (auto pin : ctx->getBelPinsForCellPin(driver, net->driver.port)) {
+            driver_pin = pin;
+            break;
+        }
+        for (auto pin : ctx->getBelPinsForCellPin(sink.cell, sink.port)) {
+            sink_pin = pin;
+            break;
+        }
+        if (driver_pin == IdString() || sink_pin == IdString())
+            return 0;
+        return ctx->predictDelayCached(driver_bel, driver_pin, sink_bel, sink_pin);
+    }
+
     // Set up the cost maps
     void setup_costs()
     {
@@ -887,21 +967,11 @@ class SAPlacer
     struct MoveChangeData
     {
 
-        enum BoundChangeType
-        {
-            NO_CHANGE,
-            CELL_MOVED_INWARDS,
-            CELL_MOVED_OUTWARDS,
-            FULL_RECOMPUTE
-        };
-
-        std::vector<decltype(NetInfo::udata)> bounds_changed_nets_x, bounds_changed_nets_y;
+        // Bounding boxes, indexed by net udata
+        NetBBChanges bb;
         std::vector<std::pair<decltype(NetInfo::udata), store_index<PortRef>>> changed_arcs;
-
-        std::vector<BoundChangeType> already_bounds_changed_x, already_bounds_changed_y;
         std::vector<std::vector<bool>> already_changed_arcs;
 
-        std::vector<BoundingBox> new_net_bounds;
         std::vector<std::pair<std::pair<decltype(NetInfo::udata), store_index<PortRef>>, double>> new_arc_costs;
 
         wirelen_t wirelen_delta = 0;
@@ -909,29 +979,18 @@ class SAPlacer
 
         void init(SAPlacer *p)
         {
-            already_bounds_changed_x.resize(p->ctx->nets.size());
-            already_bounds_changed_y.resize(p->ctx->nets.size());
+            bb.init(p->net_bounds);
             already_changed_arcs.resize(p->ctx->nets.size());
             for (auto &net : p->ctx->nets) {
                 already_changed_arcs.at(net.second->udata).resize(net.second->users.capacity());
             }
-            new_net_bounds = p->net_bounds;
         }
 
         void reset(SAPlacer *p)
         {
-            for (auto bc : bounds_changed_nets_x) {
-                new_net_bounds[bc] = p->net_bounds[bc];
-                already_bounds_changed_x[bc] = NO_CHANGE;
-            }
-            for (auto bc : bounds_changed_nets_y) {
-                new_net_bounds[bc] = p->net_bounds[bc];
-                already_bounds_changed_y[bc] = NO_CHANGE;
-            }
+            bb.reset(p->net_bounds);
             for (const auto &tc : changed_arcs)
                 already_changed_arcs[tc.first][tc.second.idx()] = false;
-            bounds_changed_nets_x.clear();
-            bounds_changed_nets_y.clear();
             changed_arcs.clear();
             new_arc_costs.clear();
             wirelen_delta = 0;
@@ -940,9 +999,9 @@ class SAPlacer
 
     } moveChange;
 
-    void add_move_cell(MoveChangeData &mc, CellInfo *cell, BelId old_bel)
+    void add_move_cell(MoveChangeData &mc, CellInfo *cell, BelId old_bel, const PendingMove *pm = nullptr)
     {
-        Loc curr_loc = ctx->getBelLocation(cell->bel);
+        Loc curr_loc = ctx->getBelLocation(pm != nullptr ? pm->bel_of(cell) : cell->bel);
         Loc old_loc = ctx->getBelLocation(old_bel);
         // Check net bounds
         for (const auto &port : cell->ports) {
@@ -951,127 +1010,7 @@ class SAPlacer
                 continue;
             if (ignore_net(pn))
                 continue;
-            BoundingBox &curr_bounds = mc.new_net_bounds[pn->udata];
-            // Incremental bounding box updates
-            // Note that everything other than full updates are applied immediately rather than being queued,
-            // so further updates to the same net in the same move are dealt with correctly.
-            // If a full update is already queued, this can be considered a no-op
-            if (mc.already_bounds_changed_x[pn->udata] != MoveChangeData::FULL_RECOMPUTE) {
-                // Bounds x0
-                if (curr_loc.x < curr_bounds.x0) {
-                    // Further out than current bounds x0
-                    curr_bounds.x0 = curr_loc.x;
-                    curr_bounds.nx0 = 1;
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        // Checking already_bounds_changed_x ensures that each net is only added once
-                        // to bounds_changed_nets, lest we add its HPWL change multiple times skewing the
-                        // overall cost change
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    }
-                } else if (curr_loc.x == curr_bounds.x0 && old_loc.x > curr_bounds.x0) {
-                    curr_bounds.nx0++;
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    }
-                } else if (old_loc.x == curr_bounds.x0 && curr_loc.x > curr_bounds.x0) {
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE)
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    if (curr_bounds.nx0 == 1) {
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::FULL_RECOMPUTE;
-                    } else {
-                        curr_bounds.nx0--;
-                        if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE)
-                            mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_INWARDS;
-                    }
-                }
-
-                // Bounds x1
-                if (curr_loc.x > curr_bounds.x1) {
-                    // Further out than current bounds x1
-                    curr_bounds.x1 = curr_loc.x;
-                    curr_bounds.nx1 = 1;
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        // Checking already_bounds_changed_x ensures that each net is only added once
-                        // to bounds_changed_nets, lest we add its HPWL change multiple times skewing the
-                        // overall cost change
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    }
-                } else if (curr_loc.x == curr_bounds.x1 && old_loc.x < curr_bounds.x1) {
-                    curr_bounds.nx1++;
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    }
-                } else if (old_loc.x == curr_bounds.x1 && curr_loc.x < curr_bounds.x1) {
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE)
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    if (curr_bounds.nx1 == 1) {
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::FULL_RECOMPUTE;
-                    } else {
-                        curr_bounds.nx1--;
-                        if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE)
-                            mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_INWARDS;
-                    }
-                }
-            }
-            if (mc.already_bounds_changed_y[pn->udata] != MoveChangeData::FULL_RECOMPUTE) {
-                // Bounds y0
-                if (curr_loc.y < curr_bounds.y0) {
-                    // Further out than current bounds y0
-                    curr_bounds.y0 = curr_loc.y;
-                    curr_bounds.ny0 = 1;
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    }
-                } else if (curr_loc.y == curr_bounds.y0 && old_loc.y > curr_bounds.y0) {
-                    curr_bounds.ny0++;
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    }
-                } else if (old_loc.y == curr_bounds.y0 && curr_loc.y > curr_bounds.y0) {
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE)
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    if (curr_bounds.ny0 == 1) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::FULL_RECOMPUTE;
-                    } else {
-                        curr_bounds.ny0--;
-                        if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE)
-                            mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_INWARDS;
-                    }
-                }
-
-                // Bounds y1
-                if (curr_loc.y > curr_bounds.y1) {
-                    // Further out than current bounds y1
-                    curr_bounds.y1 = curr_loc.y;
-                    curr_bounds.ny1 = 1;
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    }
-                } else if (curr_loc.y == curr_bounds.y1 && old_loc.y < curr_bounds.y1) {
-                    curr_bounds.ny1++;
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    }
-                } else if (old_loc.y == curr_bounds.y1 && curr_loc.y < curr_bounds.y1) {
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE)
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    if (curr_bounds.ny1 == 1) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::FULL_RECOMPUTE;
-                    } else {
-                        curr_bounds.ny1--;
-                        if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE)
-                            mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_INWARDS;
-                    }
-                }
-            }
+            mc.bb.move_pin(pn->udata, old_loc, curr_loc);
 
             if (cfg.timing_driven && int(pn->users.entries()) < cfg.timingFanoutThresh) {
                 // Output ports - all arcs change timing
@@ -1095,29 +1034,16 @@ class SAPlacer
         }
     }
 
-    void compute_cost_changes(MoveChangeData &md)
+    void compute_cost_changes(MoveChangeData &md, const PendingMove *pm = nullptr)
     {
-        for (const auto &bc : md.bounds_changed_nets_x) {
-            if (md.already_bounds_changed_x[bc] == MoveChangeData::FULL_RECOMPUTE)
-                md.new_net_bounds[bc] = get_net_bounds(net_by_udata[bc]);
-        }
-        for (const auto &bc : md.bounds_changed_nets_y) {
-            if (md.already_bounds_changed_x[bc] != MoveChangeData::FULL_RECOMPUTE &&
-                md.already_bounds_changed_y[bc] == MoveChangeData::FULL_RECOMPUTE)
-                md.new_net_bounds[bc] = get_net_bounds(net_by_udata[bc]);
-        }
-
-        for (const auto &bc : md.bounds_changed_nets_x)
-            md.wirelen_delta += md.new_net_bounds[bc].hpwl(cfg) - net_bounds[bc].hpwl(cfg);
-        for (const auto &bc : md.bounds_changed_nets_y)
-            if (md.already_bounds_changed_x[bc] == MoveChangeData::NO_CHANGE)
-                md.wirelen_delta += md.new_net_bounds[bc].hpwl(cfg) - net_bounds[bc].hpwl(cfg);
+        md.bb.recompute([&](int bc) { return get_net_bounds(net_by_udata[bc], pm); });
+        md.wirelen_delta += md.bb.wirelen_delta(net_bounds, cfg);
 
         if (cfg.timing_driven) {
             for (const auto &tc : md.changed_arcs) {
                 double old_cost = net_arc_tcost.at(tc.first).at(tc.second.idx());
-                double new_cost =
-                        get_timing_cost(net_by_udata.at(tc.first), net_by_udata.at(tc.first)->users.at(tc.second));
+                double new_cost = get_timing_cost(net_by_udata.at(tc.first),
+                                                  net_by_udata.at(tc.first)->users.at(tc.second), pm);
                 md.new_arc_costs.emplace_back(std::make_pair(tc, new_cost));
                 md.timing_delta += (new_cost - old_cost);
                 md.already_changed_arcs[tc.first][tc.second.idx()] = false;
@@ -1127,16 +1053,160 @@ class SAPlacer
 
     void commit_cost_changes(MoveChangeData &md)
     {
-        for (const auto &bc : md.bounds_changed_nets_x)
-            net_bounds[bc] = md.new_net_bounds[bc];
-        for (const auto &bc : md.bounds_changed_nets_y)
-            net_bounds[bc] = md.new_net_bounds[bc];
+        md.bb.commit(net_bounds);
         for (const auto &tc : md.new_arc_costs)
             net_arc_tcost[tc.first.first].at(tc.first.second.idx()) = tc.second;
         curr_wirelen_cost += md.wirelen_delta;
         curr_timing_cost += md.timing_delta;
     }
 
+    // Parallel version of trying a random move for each of the cells, see placer1/parallelMoves.
+    //
+    // Moves are proposed in order and collected into batches in which no two moves touch the same tile, so that the
+    // legality of each move doesn't depend on the others; a move that clashes with the batch waits for the next one.
+    // The cost deltas of the batch are computed in parallel with the cells at their proposed bels but without binding
+    // anything. Then, in order, each move is accepted or rejected and accepted moves are bound and committed. A move
+    // that shares a net with a move committed earlier in the same batch is re-evaluated first, so committed costs
+    // are always exact. Moves of clustered cells are made serially, between batches.
+    void try_swap_positions_batched(const std::vector<CellInfo *> &cells)
+    {
+        std::vector<PendingMove> batch, waiting, next_waiting;
+        auto flush = [&]() {
+            run_batch(batch);
+            batch.clear();
+            ++batch_stamp;
+        };
+        size_t next_cell = 0;
+        while (next_cell < cells.size() || !waiting.empty()) {
+            for (auto &move : waiting)
+                if (!add_to_batch(batch, move))
+                    next_waiting.push_back(move);
+            std::swap(waiting, next_waiting);
+            next_waiting.clear();
+            while (int(batch.size()) < cfg.moveBatchSize && next_cell < cells.size()) {
+                CellInfo *cell = cells.at(next_cell++);
+                BelId try_bel = random_bel_for_cell(cell);
+                if (try_bel == BelId() || try_bel == cell->bel)
+                    continue;
+                CellInfo *other_cell = ctx->getBoundBelCell(try_bel);
+                if (cell->cluster != ClusterId() || (other_cell != nullptr && other_cell->cluster != ClusterId())) {
+                    flush();
+                    try_swap_position(cell, try_bel);
+                    continue;
+                }
+                PendingMove move;
+                move.cell = cell;
+                move.new_bel = try_bel;
+                if (!add_to_batch(batch, move))
+                    waiting.push_back(move);
+            }
+            flush();
+        }
+    }
+
+    // Add a move to the batch if it doesn't clash with it. Returns false if the move should wait for the next batch.
+    bool add_to_batch(std::vector<PendingMove> &batch, PendingMove &move)
+    {
+        // The cell may have been moved since the move was proposed
+        move.old_bel = move.cell->bel;
+        if (move.new_bel == move.old_bel)
+            return true;
+        move.other = ctx->getBoundBelCell(move.new_bel);
+        if (move.other != nullptr && (move.other->cluster != ClusterId() || move.other->belStrength > STRENGTH_WEAK))
+            return true;
+        if (!ctx->isValidBelForCellType(move.cell->type, move.new_bel))
+            return true;
+        if (move.other != nullptr && !ctx->isValidBelForCellType(move.other->type, move.old_bel))
+            return true;
+        Loc old_loc = ctx->getBelLocation(move.old_bel), new_loc = ctx->getBelLocation(move.new_bel);
+        int &old_tile = tile_stamp.at(old_loc.y * (max_x + 1) + old_loc.x);
+        int &new_tile = tile_stamp.at(new_loc.y * (max_x + 1) + new_loc.x);
+        if (old_tile == batch_stamp || new_tile == batch_stamp)
+            return false;
+        old_tile = new_tile = batch_stamp;
+        batch.push_back(move);
+        return true;
+    }
+
+    // Compute the cost deltas of a move that hasn't been bound
+    void evaluate_move(PendingMove &move, MoveChangeData &mc)
+    {
+        mc.reset(this);
+        move.nets.clear();
+        for (CellInfo *ci : {move.cell, move.other}) {
+            if (ci == nullptr)
+                continue;
+            for (const auto &port : ci->ports) {
+                NetInfo *pn = port.second.net;
+                if (pn == nullptr || ignore_net(pn))
+                    continue;
+                // Bounds for nets untouched by this scratch data may be out of date
+                mc.bb.new_net_bounds[pn->udata] = net_bounds[pn->udata];
+                move.nets.push_back(pn->udata);
+            }
+        }
+        add_move_cell(mc, move.cell, move.old_bel, &move);
+        if (move.other != nullptr)
+            add_move_cell(mc, move.other, move.new_bel, &move);
+        compute_cost_changes(mc, &move);
+        move.wirelen_delta = mc.wirelen_delta;
+        move.timing_delta = mc.timing_delta;
+        move.new_bounds.clear();
+        mc.bb.for_each_changed([&](int bc) { move.new_bounds.emplace_back(bc, mc.bb.new_net_bounds.at(bc)); });
+        move.new_arc_costs = mc.new_arc_costs;
+    }
+
+    void run_batch(std::vector<PendingMove> &batch)
+    {
+        static const double epsilon = 1e-20;
+        if (batch.empty())
+            return;
+        int threads = std::min(int(batch_scratch.size()), int(batch.size()));
+        ctx->get_thread_pool().run(threads, [&](int t) {
+            for (int i = t; i < int(batch.size()); i += threads)
+                evaluate_move(batch.at(i), batch_scratch.at(t));
+        });
+        ++commit_stamp;
+        for (auto &move : batch) {
+            if (std::any_of(move.nets.begin(), move.nets.end(),
+                            [&](decltype(NetInfo::udata) n) { return net_commit_stamp.at(n) == commit_stamp; }))
+                evaluate_move(move, moveChange);
+            double delta =
+                    lambda * (move.timing_delta / std::max<double>(last_timing_cost, epsilon)) +
+                    (1 - lambda) * (double(move.wirelen_delta) / std::max<double>(last_wirelen_cost, epsilon));
+            n_move++;
+            // SA acceptance criteria
+            if (!(delta < 0 || (temp > 1e-8 && (ctx->rng() / float(0x3fffffff)) <= std::exp(-delta / temp))))
+                continue;
+            ctx->unbindBel(move.old_bel);
+            if (move.other != nullptr)
+                ctx->unbindBel(move.new_bel);
+            ctx->bindBel(move.new_bel, move.cell, STRENGTH_WEAK);
+            if (move.other != nullptr)
+                ctx->bindBel(move.old_bel, move.other, STRENGTH_WEAK);
+            if (!ctx->isBelLocationValid(move.new_bel) || !ctx->isBelLocationValid(move.old_bel)) {
+                ctx->unbindBel(move.new_bel);
+                if (move.other != nullptr) {
+                    ctx->unbindBel(move.old_bel);
+                    ctx->bindBel(move.new_bel, move.other, STRENGTH_WEAK);
+                }
+                ctx->bindBel(move.old_bel, move.cell, STRENGTH_WEAK);
+                continue;
+            }
+            n_accept++;
+            for (const auto &nb : move.new_bounds) {
+                net_bounds[nb.first] = nb.second;
+                moveChange.bb.new_net_bounds[nb.first] = nb.second;
+            }
+            for (const auto &tc : move.new_arc_costs)
+                net_arc_tcost[tc.first.first].at(tc.first.second.idx()) = tc.second;
+            curr_wirelen_cost += move.wirelen_delta;
+            curr_timing_cost += move.timing_delta;
+            for (auto n : move.nets)
+                net_commit_stamp.at(n) = commit_stamp;
+        }
+    }
+
     // Simple routeability driven placement
     const int large_cell_thresh = 50;
     int total_net_share = 0;
@@ -1199,13 +1269,19 @@ class SAPlacer
     }
 
     // Map nets to their bounding box (so we can skip recompute for moves that do not exceed the bounds
-    std::vector<BoundingBox> net_bounds;
+    std::vector<NetBB> net_bounds;
     // Map net arcs to their timing cost (criticality * delay ns)
     std::vector<std::vector<double>> net_arc_tcost;
 
     // Fast lookup for cell to clusters
     dict<ClusterId, std::vector<CellInfo *>> cluster2cell;
 
+    // Per-thread scratch data for evaluating batches of moves
+    std::vector<MoveChangeData> batch_scratch;
+    // The batch that last claimed each tile, and the batch commit that last changed each net
+    std::vector<int> tile_stamp, net_commit_stamp;
+    int batch_stamp = 1, commit_stamp = 0;
+
     // Wirelength and timing cost at last and current iteration
     wirelen_t last_wirelen_cost, curr_wirelen_cost;
     double last_timing_cost, curr_timing_cost;
@@ -1218,11 +1294,14 @@ class SAPlacer
     int n_move, n_accept;
     int diameter = 35, max_x = 1, max_y = 1;
     dict<IdString, std::tuple<int, int>> bel_types;
-    dict<IdString, BoundingBox> region_bounds;
+    // Bounds of each region, and the index into it of the region of each cell (by udata) or -1
+    std::vector<NetBB> region_bounds;
+    std::vector<int> cell_region;
     FastBels fast_bels;
     pool<BelId> locked_bels;
     std::vector<NetInfo *> net_by_udata;
     std::vector<decltype(NetInfo::udata)> old_udata;
+    std::vector<decltype(CellInfo::udata)> old_cell_udata;
     bool require_legal = true;
     const int legalise_dia = 4;
     Placer1Cfg cfg;
@@ -1240,6 +1319,8 @@ Placer1Cfg::Placer1Cfg(Context *ctx)
     timing_driven = ctx->setting<bool>("timing_driven");
     hpwl_scale_x = 1;
     hpwl_scale_y = 1;
+    parallelMoves = ctx->setting<bool>("placer1/parallelMoves", false);
+    moveBatchSize = ctx->setting<int>("placer1/moveBatchSize", 256);
 }
 
 bool placer1(Context *ctx, Placer1Cfg cfg)
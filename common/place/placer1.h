@@ -33,6 +33,9 @@ struct Placer1Cfg
     int timingFanoutThresh;
     bool timing_driven;
     int hpwl_scale_x, hpwl_scale_y;
+    // Evaluate batches of moves on the thread pool rather than one at a time
+    bool parallelMoves;
+    int moveBatchSize;
 };
 
 extern bool placer1(Context *ctx, Placer1Cfg cfg);
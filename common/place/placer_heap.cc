@@ -32,8 +32,7 @@
  */
 
 #include "placer_heap.h"
-#include <Eigen/Core>
-#include <Eigen/IterativeLinearSolvers>
+#include <array>
 #include <boost/optional.hpp>
 #include <chrono>
 #include <deque>
@@ -43,96 +42,20 @@
 #include <queue>
 #include <tuple>
 #include "array2d.h"
+#include "equation_system.h"
 #include "fast_bels.h"
 #include "log.h"
 #include "nextpnr.h"
 #include "parallel_refine.h"
 #include "place_common.h"
 #include "placer1.h"
+#include "placer_multilevel.h"
 #include "timing.h"
 #include "util.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
 namespace {
-// A simple internal representation for a sparse system of equations Ax = rhs
-// This is designed to decouple the functions that build the matrix to the engine that
-// solves it, and the representation that requires
-template <typename T> struct EquationSystem
-{
-
-    EquationSystem(size_t rows, size_t cols)
-    {
-        A.resize(cols);
-        rhs.resize(rows);
-    }
-
-    // Simple sparse format, easy to convert to CCS for solver
-    std::vector<std::vector<std::pair<int, T>>> A; // col -> (row, x[row, col]) sorted by row
-    std::vector<T> rhs;                            // RHS vector
-    void reset()
-    {
-        for (auto &col : A)
-            col.clear();
-        std::fill(rhs.begin(), rhs.end(), T());
-    }
-
-    void add_coeff(int row, int col, T val)
-    {
-        auto &Ac = A.at(col);
-        // Binary search
-        int b = 0, e = int(Ac.size()) - 1;
-        while (b <= e) {
-            int i = (b + e) / 2;
-            if (Ac.at(i).first == row) {
-                Ac.at(i).second += val;
-                return;
-            }
-            if (Ac.at(i).first > row)
-                e = i - 1;
-            else
-                b = i + 1;
-        }
-        Ac.insert(Ac.begin() + b, std::make_pair(row, val));
-    }
-
-    void add_rhs(int row, T val) { rhs[row] += val; }
-
-    void solve(std::vector<T> &x, float tolerance)
-    {
-        using namespace Eigen;
-        if (x.empty())
-            return;
-        NPNR_ASSERT(x.size() == A.size());
-
-        VectorXd vx(x.size()), vb(rhs.size());
-        SparseMatrix<T> mat(A.size(), A.size());
-
-        std::vector<int> colnnz;
-        for (auto &Ac : A)
-            colnnz.push_back(int(Ac.size()));
-        mat.reserve(colnnz);
-        for (int col = 0; col < int(A.size()); col++) {
-            auto &Ac = A.at(col);
-            for (auto &el : Ac)
-                mat.insert(el.first, col) = el.second;
-        }
-
-        for (int i = 0; i < int(x.size()); i++)
-            vx[i] = x.at(i);
-        for (int i = 0; i < int(rhs.size()); i++)
-            vb[i] = rhs.at(i);
-
-        ConjugateGradient<SparseMatrix<T>, Lower | Upper> solver;
-        solver.setTolerance(tolerance);
-        VectorXd xr = solver.compute(mat).solveWithGuess(vb, vx);
-        for (int i = 0; i < int(x.size()); i++)
-            x.at(i) = xr[i];
-        // for (int i = 0; i < int(x.size()); i++)
-        //    log_info("x[%d] = %f\n", i, x.at(i));
-    }
-};
-
 struct ControlSetState
 {
     int32_t ctrl_set = -1;
@@ -185,24 +108,23 @@ class HeAPPlacer
         wirelen_t hpwl = total_hpwl();
         log_info("Creating initial analytic placement for %d cells, random placement wirelen = %d.\n",
                  int(place_cells.size()), int(hpwl));
-        for (int i = 0; i < 4; i++) {
-            setup_solve_cells();
-            auto solve_startt = std::chrono::high_resolution_clock::now();
-#ifdef NPNR_DISABLE_THREADS
-            build_solve_direction(false, -1);
-            build_solve_direction(true, -1);
-#else
-            boost::thread xaxis([&]() { build_solve_direction(false, -1); });
-            build_solve_direction(true, -1);
-            xaxis.join();
-#endif
-            auto solve_endt = std::chrono::high_resolution_clock::now();
-            solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
-
+        if (cfg.multilevel) {
+            seed_multilevel();
             update_all_chains();
+            log_info("    after multilevel placement, wirelen = %d\n", int(total_hpwl()));
+        } else {
+            for (int i = 0; i < 4; i++) {
+                setup_solve_cells();
+                auto solve_startt = std::chrono::high_resolution_clock::now();
+                build_solve(-1);
+                auto solve_endt = std::chrono::high_resolution_clock::now();
+                solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
+
+                update_all_chains();
 
-            hpwl = total_hpwl();
-            log_info("    at initial placer iter %d, wirelen = %d\n", i, int(hpwl));
+                hpwl = total_hpwl();
+                log_info("    at initial placer iter %d, wirelen = %d\n", i, int(hpwl));
+            }
         }
 
         wirelen_t solved_hpwl = 0, spread_hpwl = 0, legal_hpwl = 0, best_hpwl = std::numeric_limits<wirelen_t>::max();
@@ -254,21 +176,11 @@ class HeAPPlacer
                 setup_solve_cells(&run);
                 if (solve_cells.empty())
                     continue;
-                // Heuristic: don't bother with threading below a certain size
                 auto solve_startt = std::chrono::high_resolution_clock::now();
 
-                // Build the connectivity matrix and run the solver; multithreaded between x and y axes if applicable
-#ifndef NPNR_DISABLE_THREADS
-                if (solve_cells.size() >= 500) {
-                    boost::thread xaxis([&]() { build_solve_direction(false, (iter == 0) ? -1 : iter); });
-                    build_solve_direction(true, (iter == 0) ? -1 : iter);
-                    xaxis.join();
-                } else
-#endif
-                {
-                    build_solve_direction(false, (iter == 0) ? -1 : iter);
-                    build_solve_direction(true, (iter == 0) ? -1 : iter);
-                }
+                // Build the connectivity matrix and run the solver. A multilevel placement is already spread, so
+                // cells are anchored to it from the start
+                build_solve((iter == 0) ? (cfg.multilevel ? 1 : -1) : iter);
                 auto solve_endt = std::chrono::high_resolution_clock::now();
                 solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
                 update_all_chains();
@@ -384,7 +296,7 @@ class HeAPPlacer
 
         auto endtt = std::chrono::high_resolution_clock::now();
         log_info("HeAP Placer Time: %.02fs\n", std::chrono::duration<double>(endtt - startt).count());
-        log_info("  of which solving equations: %.02fs\n", solve_time);
+        log_info("  of which solving equations: %.02fs (building them: %.02fs)\n", solve_time, build_time);
         log_info("  of which spreading cells: %.02fs\n", cl_time);
         log_info("  of which strict legalisation: %.02fs\n", sl_time);
 
@@ -448,6 +360,8 @@ class HeAPPlacer
     // The cells in the current equation being solved (a subset of place_cells in some cases, where we only place
     // cells of a certain type)
     std::vector<CellInfo *> solve_cells;
+    // The equations for the x and y axes, kept between solves so the matrix structure can be reused
+    std::array<EquationSystem<double>, 2> equations;
 
     dict<ClusterId, std::vector<CellInfo *>> cluster2cells;
     dict<IdString, int> cell_ctrl_set;
@@ -456,7 +370,7 @@ class HeAPPlacer
     array2d<std::vector<ControlSetState>> control_sets;
     dict<int, int> z_to_ctrl_set;
     // Performance counting
-    double solve_time = 0, cl_time = 0, sl_time = 0;
+    double solve_time = 0, build_time = 0, cl_time = 0, sl_time = 0;
     int iter = 0;
 
     // Place cells with the BEL attribute set to constrain them
@@ -653,16 +567,18 @@ class HeAPPlacer
         return ctrl_set;
     }
 
-    std::vector<Loc> find_control_set_candidates(int cx, int cy, int32_t ctrl_set, int max_radius, int &nonempty)
+    // Only tiles within (x0, y0) to (x1, y1) are searched
+    std::vector<Loc> find_control_set_candidates(int cx, int cy, int32_t ctrl_set, int max_radius, int &nonempty,
+                                                 int x0, int y0, int x1, int y1)
     {
         std::vector<Loc> result;
 
         int radius = 1;
         nonempty = 0;
         auto process_location = [&](int x, int y) {
-            if (y < 0 || y > max_y)
+            if (y < std::max(0, y0) || y > std::min(max_y, y1))
                 return;
-            if (x < 0 || x > max_x)
+            if (x < std::max(0, x0) || x > std::min(max_x, x1))
                 return;
             const auto &tile = control_sets.at(x, y);
             if (tile.empty())
@@ -696,13 +612,23 @@ class HeAPPlacer
         return result;
     }
 
-    // Build and solve in one direction
-    void build_solve_direction(bool yaxis, int iter)
+    // Build and solve in both directions. The two axes are independent, so they are built side by side; each solve
+    // is multithreaded internally.
+    void build_solve(int iter)
     {
+        // Heuristic: don't bother with threading below a certain size
+        ThreadPool *pool = (solve_cells.size() >= 500) ? &ctx->get_thread_pool() : nullptr;
         for (int i = 0; i < 5; i++) {
-            EquationSystem<double> esx(solve_cells.size(), solve_cells.size());
-            build_equations(esx, yaxis, iter);
-            solve_equations(esx, yaxis);
+            auto build_startt = std::chrono::high_resolution_clock::now();
+            if (pool != nullptr)
+                pool->run(2, [&](int axis) { build_equations(equations[axis], axis == 1, iter); });
+            else
+                for (int axis = 0; axis < 2; axis++)
+                    build_equations(equations[axis], axis == 1, iter);
+            auto build_endt = std::chrono::high_resolution_clock::now();
+            build_time += std::chrono::duration<double>(build_endt - build_startt).count();
+            for (int axis = 0; axis < 2; axis++)
+                solve_equations(equations[axis], axis == 1, pool);
         }
     }
 
@@ -829,6 +755,29 @@ class HeAPPlacer
         }
     }
 
+    // Replace the random placement of the cells to be placed with a multilevel one, which is also used as the
+    // legal position that the first solve is anchored to
+    void seed_multilevel()
+    {
+        PlacerMultilevelCfg ml_cfg(ctx);
+        ml_cfg.hpwl_scale_x = cfg.hpwl_scale_x;
+        ml_cfg.hpwl_scale_y = cfg.hpwl_scale_y;
+        auto result = placer_multilevel(ctx, ml_cfg, place_cells, [&](const CellInfo *ci, Loc &loc) {
+            auto found = cell_locs.find(ci->name);
+            if (found == cell_locs.end() || !found->second.locked)
+                return false;
+            loc = Loc(found->second.x, found->second.y, 0);
+            return true;
+        });
+        for (size_t i = 0; i < place_cells.size(); i++) {
+            auto &cl = cell_locs[place_cells.at(i)->name];
+            cl.rawx = result.at(i).x;
+            cl.rawy = result.at(i).y;
+            cl.x = cl.legal_x = std::max(0, std::min(max_x, int(result.at(i).x)));
+            cl.y = cl.legal_y = std::max(0, std::min(max_y, int(result.at(i).y)));
+        }
+    }
+
     // Setup the cells to be solved, returns the number of rows
     int setup_solve_cells(pool<BelBucketId> *buckets = nullptr)
     {
@@ -888,7 +837,17 @@ class HeAPPlacer
             return yaxis ? cell_locs.at(cell->name).legal_y : cell_locs.at(cell->name).legal_x;
         };
 
-        es.reset();
+        es.reset(solve_cells.size());
+
+        struct NetPort
+        {
+            int pos;
+            int row;
+            bool clustered = false;
+            int offset = 0;
+            double timing_factor = 1.0;
+        };
+        std::vector<NetPort> ports;
 
         for (auto &net : ctx->nets) {
             NetInfo *ni = net.second.get();
@@ -898,65 +857,65 @@ class HeAPPlacer
                 continue;
             if (cell_locs.at(ni->driver.cell->name).global)
                 continue;
-            // Find the bounds of the net in this axis, and the ports that correspond to these bounds
-            PortRef *lbport = nullptr, *ubport = nullptr;
-            int lbpos = std::numeric_limits<int>::max(), ubpos = std::numeric_limits<int>::min();
+            // Look up the position, equation row and cluster offset of each port once
+            ports.clear();
             foreach_port(ni, [&](PortRef &port, store_index<PortRef> user_idx) {
-                int pos = cell_pos(port.cell);
-                if (pos < lbpos) {
-                    lbpos = pos;
-                    lbport = &port;
-                }
-                if (pos > ubpos) {
-                    ubpos = pos;
-                    ubport = &port;
+                NetPort np;
+                np.pos = cell_pos(port.cell);
+                np.row = port.cell->udata;
+                if (port.cell->cluster != ClusterId()) {
+                    Loc offset = ctx->getClusterOffset(port.cell);
+                    np.clustered = true;
+                    np.offset = yaxis ? offset.y : offset.x;
                 }
+                if (user_idx)
+                    np.timing_factor = 1.0 + cfg.timingWeight * std::pow(tmg.get_criticality(CellPortKey(port)),
+                                                                         cfg.criticalityExponent);
+                ports.push_back(np);
             });
-            NPNR_ASSERT(lbport != nullptr);
-            NPNR_ASSERT(ubport != nullptr);
+            // Find the bounds of the net in this axis, and the ports that correspond to these bounds
+            int lb = 0, ub = 0;
+            for (int i = 1; i < int(ports.size()); i++) {
+                if (ports.at(i).pos < ports.at(lb).pos)
+                    lb = i;
+                if (ports.at(i).pos > ports.at(ub).pos)
+                    ub = i;
+            }
 
-            auto stamp_equation = [&](PortRef &var, PortRef &eqn, double weight) {
-                if (eqn.cell->udata == dont_solve)
+            auto stamp_equation = [&](const NetPort &var, const NetPort &eqn, double weight) {
+                if (eqn.row == dont_solve)
                     return;
-                int row = eqn.cell->udata;
-                int v_pos = cell_pos(var.cell);
-                if (var.cell->udata != dont_solve) {
-                    es.add_coeff(row, var.cell->udata, weight);
+                if (var.row != dont_solve) {
+                    es.add_coeff(eqn.row, var.row, weight);
                 } else {
-                    es.add_rhs(row, -v_pos * weight);
-                }
-                if (var.cell->cluster != ClusterId()) {
-                    Loc offset = ctx->getClusterOffset(var.cell);
-                    es.add_rhs(row, -(yaxis ? offset.y : offset.x) * weight);
+                    es.add_rhs(eqn.row, -var.pos * weight);
                 }
+                if (var.clustered)
+                    es.add_rhs(eqn.row, -var.offset * weight);
             };
 
             // Add all relevant connections to the matrix
-            foreach_port(ni, [&](PortRef &port, store_index<PortRef> user_idx) {
-                int this_pos = cell_pos(port.cell);
-                auto process_arc = [&](PortRef *other) {
-                    if (other == &port)
+            for (int i = 0; i < int(ports.size()); i++) {
+                const NetPort &port = ports.at(i);
+                auto process_arc = [&](int other_idx) {
+                    if (other_idx == i)
                         return;
-                    int o_pos = cell_pos(other->cell);
+                    const NetPort &other = ports.at(other_idx);
                     double weight = 1.0 / (ni->users.entries() *
                                            std::max<double>(1, (yaxis ? cfg.hpwl_scale_y : cfg.hpwl_scale_x) *
-                                                                       std::abs(o_pos - this_pos)));
-
-                    if (user_idx) {
-                        weight *= (1.0 + cfg.timingWeight * std::pow(tmg.get_criticality(CellPortKey(port)),
-                                                                     cfg.criticalityExponent));
-                    }
+                                                                       std::abs(other.pos - port.pos)));
+                    weight *= port.timing_factor;
 
                     // If cell 0 is not fixed, it will stamp +w on its equation and -w on the other end's equation,
                     // if the other end isn't fixed
                     stamp_equation(port, port, weight);
-                    stamp_equation(port, *other, -weight);
-                    stamp_equation(*other, *other, weight);
-                    stamp_equation(*other, port, -weight);
+                    stamp_equation(port, other, -weight);
+                    stamp_equation(other, other, weight);
+                    stamp_equation(other, port, -weight);
                 };
-                process_arc(lbport);
-                process_arc(ubport);
-            });
+                process_arc(lb);
+                process_arc(ub);
+            }
         }
         if (iter != -1) {
             float alpha = cfg.alpha;
@@ -975,13 +934,18 @@ class HeAPPlacer
     }
 
     // Build the system of equations for either X or Y
-    void solve_equations(EquationSystem<double> &es, bool yaxis)
+    void solve_equations(EquationSystem<double> &es, bool yaxis, ThreadPool *pool)
     {
-        // Return the x or y position of a cell, depending on ydir
-        auto cell_pos = [&](CellInfo *cell) { return yaxis ? cell_locs.at(cell->name).y : cell_locs.at(cell->name).x; };
+        // Start from the unrounded result of the last solve, if the cell hasn't been moved since
+        auto start_pos = [&](CellInfo *cell) {
+            const auto &loc = cell_locs.at(cell->name);
+            int pos = yaxis ? loc.y : loc.x;
+            double raw = yaxis ? loc.rawy : loc.rawx;
+            return (int(raw) == pos) ? raw : double(pos);
+        };
         std::vector<double> vals;
-        std::transform(solve_cells.begin(), solve_cells.end(), std::back_inserter(vals), cell_pos);
-        es.solve(vals, cfg.solverTolerance);
+        std::transform(solve_cells.begin(), solve_cells.end(), std::back_inserter(vals), start_pos);
+        es.solve(vals, cfg.solverTolerance, pool);
         for (size_t i = 0; i < vals.size(); i++)
             if (yaxis) {
                 cell_locs.at(solve_cells.at(i)->name).rawy = vals.at(i);
@@ -1067,7 +1031,7 @@ class HeAPPlacer
     class StrictLegaliser
     {
       public:
-        StrictLegaliser(HeAPPlacer *p) : p(p), ctx(p->ctx) {};
+        StrictLegaliser(HeAPPlacer *p) : p(p), ctx(p->ctx), rng(p->ctx) {};
 
         void run()
         {
@@ -1084,16 +1048,70 @@ class HeAPPlacer
                 }
             }
 
-            // At the moment we don't follow the full HeAP algorithm using cuts for legalisation, instead using
-            // the simple greedy largest-macro-first approach.
-            for (auto cell : p->solve_cells) {
-                remaining.emplace(p->chain_size[cell->name] * p->cfg.get_cell_legalisation_weight(ctx, cell),
-                                  cell->name);
-            }
+            x0 = 0;
+            y0 = 0;
+            x1 = p->max_x;
+            y1 = p->max_y;
+            max_radius = std::max(p->max_x, p->max_y);
+            cell_count = int(p->solve_cells.size());
             ripup_radius = 2;
             chain_ripup_radius = std::max(p->max_x, p->max_y); // only ripup chains as last resort
             total_iters = 0;
             total_iters_noreset = 0;
+
+            // At the moment we don't follow the full HeAP algorithm using cuts for legalisation, instead using
+            // the simple greedy largest-macro-first approach.
+            //
+            // For large designs, the device is split into a grid of regions that are legalised in parallel, each
+            // with its own queue and only using the bels inside it. Macros spanning several tiles and cells with region
+            // constraints are legalised serially beforehand; cells that couldn't be placed within their region (usually
+            // because they are close to its edge and it is full) are legalised serially at the end.
+            auto regions = setup_regions();
+            for (auto cell : p->solve_cells) {
+                int r = regions.empty() ? -1 : region_for_cell(regions, cell);
+                if (r == -1)
+                    remaining.emplace(priority(cell), cell->name);
+                else
+                    regions.at(r)->remaining.emplace(priority(cell), cell->name);
+            }
+            legalise_remaining();
+
+            if (!regions.empty()) {
+                // Make sure the fast bels tables exist for any cell that might be legalised, as they are built lazily
+                for (auto &cell : ctx->cells)
+                    if (!cell.second->isPseudo())
+                        p->fast_bels.getBelsForCellType(cell.second->type, &fb);
+                p->ctx->get_thread_pool().run(int(regions.size()),
+                                              [&](int i) { regions.at(i)->legalise_remaining(); });
+                int region_cells = 0, deferred_count = 0;
+                for (auto &region : regions) {
+                    region_cells += region->cell_count;
+                    for (auto &loc : region->locs) {
+                        p->cell_locs.at(loc.first).x = loc.second.x;
+                        p->cell_locs.at(loc.first).y = loc.second.y;
+                    }
+                    for (auto &entry : region->time_per_cell_type)
+                        time_per_cell_type[entry.first] += entry.second;
+                    for (auto name : region->deferred)
+                        remaining.emplace(priority(ctx->cells.at(name).get()), name);
+                    deferred_count += int(region->deferred.size());
+                }
+                if (ctx->verbose)
+                    log_info("    legalised %d cells in %d regions in parallel, %d left for the serial pass\n",
+                             region_cells, int(regions.size()), deferred_count);
+                legalise_remaining();
+            }
+
+            for (auto &entry : time_per_cell_type)
+                p->time_per_cell_type[entry.first] += entry.second;
+            auto endt = std::chrono::high_resolution_clock::now();
+            p->sl_time += std::chrono::duration<float>(endt - startt).count();
+        }
+
+      private:
+        // Legalise everything in the queue
+        void legalise_remaining()
+        {
             while (!remaining.empty()) {
                 auto top = remaining.top();
                 remaining.pop();
@@ -1106,23 +1124,144 @@ class HeAPPlacer
                 if (ctx->verbose)
                     ci_startt = std::chrono::high_resolution_clock::now();
 
-                if (ctx->debug)
+                if (ctx->debug) {
+                    auto lock = lock_arch();
                     log_info("   Legalising %s (%s) priority=%d\n", top.second.c_str(ctx), ci->type.c_str(ctx),
                              top.first);
+                }
 
-                legalise_cell(ci);
+                if (!legalise_cell(ci)) {
+                    // Out of luck within this region, leave it and everything else still queued to the serial pass
+                    deferred.push_back(ci->name);
+                    if (total_iters_noreset > iter_limit()) {
+                        for (; !remaining.empty(); remaining.pop())
+                            deferred.push_back(remaining.top().second);
+                    }
+                }
 
                 if (ctx->verbose) {
                     auto ci_endt = std::chrono::high_resolution_clock::now();
-                    p->time_per_cell_type[ci->type] += std::chrono::duration<float>(ci_endt - ci_startt).count();
+                    time_per_cell_type[ci->type] += std::chrono::duration<float>(ci_endt - ci_startt).count();
                 }
             }
-            auto endt = std::chrono::high_resolution_clock::now();
-            p->sl_time += std::chrono::duration<float>(endt - startt).count();
         }
-        void legalise_cell(CellInfo *ci)
+
+        // Split the device into regions to legalise in parallel, or none if it's not worth it. The cuts are placed so
+        // that the regions get similar numbers of cells.
+        std::vector<std::unique_ptr<StrictLegaliser>> setup_regions()
+        {
+            std::vector<std::unique_ptr<StrictLegaliser>> regions;
+            int threads = p->ctx->get_thread_pool().size();
+            if (threads <= 1 || p->solve_cells.size() < 500)
+                return regions;
+            std::vector<int> xs, ys;
+            for (auto cell : p->solve_cells) {
+                xs.push_back(p->cell_locs.at(cell->name).x);
+                ys.push_back(p->cell_locs.at(cell->name).y);
+            }
+            // Aim for a couple of regions per thread for load balancing, but no narrower than min_region_size tiles
+            const int min_region_size = 4;
+            int grid = int(std::ceil(std::sqrt(2.0 * threads)));
+            auto make_cuts = [&](std::vector<int> &coords, int max_coord) {
+                std::sort(coords.begin(), coords.end());
+                std::vector<int> cuts{0};
+                for (int i = 1; i < grid; i++) {
+                    int c = coords.at((i * coords.size()) / grid);
+                    if (c - cuts.back() >= min_region_size && max_coord + 1 - c >= min_region_size)
+                        cuts.push_back(c);
+                }
+                cuts.push_back(max_coord + 1);
+                return cuts;
+            };
+            x_cuts = make_cuts(xs, p->max_x);
+            y_cuts = make_cuts(ys, p->max_y);
+            if (x_cuts.size() * y_cuts.size() < 6)
+                return regions;
+            for (int ry = 0; ry < int(y_cuts.size()) - 1; ry++)
+                for (int rx = 0; rx < int(x_cuts.size()) - 1; rx++) {
+                    auto region = std::make_unique<StrictLegaliser>(p);
+                    region->x0 = x_cuts.at(rx);
+                    region->x1 = x_cuts.at(rx + 1) - 1;
+                    region->y0 = y_cuts.at(ry);
+                    region->y1 = y_cuts.at(ry + 1) - 1;
+                    region->max_radius = std::max(region->x1 - region->x0, region->y1 - region->y0);
+                    region->region_rng.rngseed(ctx->rng64());
+                    region->rng = &region->region_rng;
+                    region->arch_mutex = &region_mutex;
+                    region->ripup_radius = 2;
+                    region->chain_ripup_radius = std::max(p->max_x, p->max_y);
+                    region->total_iters = 0;
+                    region->total_iters_noreset = 0;
+                    regions.push_back(std::move(region));
+                }
+            return regions;
+        }
+
+        // The region to legalise a cell in, or -1 if it must be legalised serially
+        int region_for_cell(std::vector<std::unique_ptr<StrictLegaliser>> &regions, CellInfo *ci)
+        {
+            if (ci->region != nullptr)
+                return -1;
+            if (ci->cluster != ClusterId()) {
+                // Only clusters that fit in a single tile, bigger ones go first
+                for (auto cell : p->cluster2cells.at(ci->cluster)) {
+                    Loc offset = ctx->getClusterOffset(cell);
+                    if (offset.x != 0 || offset.y != 0 || cell->region != nullptr)
+                        return -1;
+                }
+            }
+            const auto &loc = p->cell_locs.at(ci->name);
+            int rx = int(std::upper_bound(x_cuts.begin(), x_cuts.end(), loc.x) - x_cuts.begin()) - 1;
+            int ry = int(std::upper_bound(y_cuts.begin(), y_cuts.end(), loc.y) - y_cuts.begin()) - 1;
+            int nx = int(x_cuts.size()) - 1, ny = int(y_cuts.size()) - 1;
+            NPNR_ASSERT(rx >= 0 && rx < nx && ry >= 0 && ry < ny);
+            regions.at(ry * nx + rx)->cell_count++;
+            return ry * nx + rx;
+        }
+
+        int priority(CellInfo *ci) const
+        {
+            auto fnd = p->chain_size.find(ci->name);
+            return (fnd == p->chain_size.end() ? 0 : fnd->second) * p->cfg.get_cell_legalisation_weight(ctx, ci);
+        }
+
+        int iter_limit() const
+        {
+            return std::max(5000, 8 * int(arch_mutex == nullptr ? ctx->cells.size() : cell_count));
+        }
+
+        // Where a cell is currently placed, or wants to be. Regions legalised in parallel keep their own results, so
+        // that they only ever see the state of other regions from before they started.
+        Loc get_loc(CellInfo *ci) const
+        {
+            auto fnd = locs.find(ci->name);
+            if (fnd != locs.end())
+                return fnd->second;
+            const auto &cl = p->cell_locs.at(ci->name);
+            return Loc(cl.x, cl.y, 0);
+        }
+
+        void set_loc(CellInfo *ci, Loc loc)
+        {
+            if (arch_mutex != nullptr) {
+                locs[ci->name] = loc;
+            } else {
+                p->cell_locs.at(ci->name).x = loc.x;
+                p->cell_locs.at(ci->name).y = loc.y;
+            }
+        }
+
+        // Arch API calls are serialised between regions legalised in parallel, as for parallel_refine
+        std::unique_lock<std::mutex> lock_arch()
+        {
+            return arch_mutex != nullptr ? std::unique_lock<std::mutex>(*arch_mutex) : std::unique_lock<std::mutex>();
+        }
+
+        // Returns false if a region legalised in parallel gives up on the cell
+        bool legalise_cell(CellInfo *ci)
         {
             p->fast_bels.getBelsForCellType(ci->type, &fb);
+            grid = &p->fast_bels.getGridForCellType(ci->type);
             radius = 0;
             iter = 0;
             iter_at_radius = 0;
@@ -1133,12 +1272,14 @@ class HeAPPlacer
 
             total_iters++;
             total_iters_noreset++;
-            if (total_iters > int(p->solve_cells.size())) {
+            if (total_iters > cell_count) {
                 total_iters = 0;
-                ripup_radius = std::min(std::max(p->max_x, p->max_y), ripup_radius * 2);
+                ripup_radius = std::min(max_radius, ripup_radius * 2);
             }
 
-            if (total_iters_noreset > std::max(5000, 8 * int(ctx->cells.size()))) {
+            if (total_iters_noreset > iter_limit()) {
+                if (arch_mutex != nullptr)
+                    return false;
                 log_error("Unable to find legal placement for all cells, design is probably at utilisation limit.\n");
             }
 
@@ -1154,9 +1295,9 @@ class HeAPPlacer
                     int nonempty = 0;
                     int ctrl_set_radius = p->cfg.ctrl_set_max_radius.at(
                             std::min(p->iter, int(p->cfg.ctrl_set_max_radius.size()) - 1));
-                    auto candidates =
-                            p->find_control_set_candidates(p->cell_locs.at(ci->name).x, p->cell_locs.at(ci->name).y,
-                                                           ctrl_set, ctrl_set_radius, nonempty);
+                    Loc loc = get_loc(ci);
+                    auto candidates = p->find_control_set_candidates(loc.x, loc.y, ctrl_set, ctrl_set_radius,
+                                                                     nonempty, x0, y0, x1, y1);
                     // log_info("%s %d/%d %d (%d, %d)\n", ci->name.c_str(ctx), int(candidates.size()), nonempty,
                     // ctrl_set,
                     //    int(p->cell_locs.at(ci->name).x), int(p->cell_locs.at(ci->name).y));
@@ -1169,7 +1310,7 @@ class HeAPPlacer
                         }
 
                         if (placed) {
-                            return;
+                            return true;
                         }
                     }
                 }
@@ -1188,26 +1329,16 @@ class HeAPPlacer
                 iter++;
                 iter_at_radius++;
                 if (iter >= (10 * (radius + 1))) {
-                    // No luck yet, increase radius
-                    radius = std::min(std::max(p->max_x, p->max_y), radius + 1);
-                    while (radius < std::max(p->max_x, p->max_y)) {
-                        // Keep increasing the radius until it will actually increase the number of cells we are
-                        // checking (e.g. BRAM and DSP will not be in all cols/rows), so we don't waste effort
-                        for (int x = std::max(0, p->cell_locs.at(ci->name).x - radius);
-                             x <= std::min(p->max_x, p->cell_locs.at(ci->name).x + radius); x++) {
-                            if (x >= int(fb->size()))
-                                break;
-                            for (int y = std::max(0, p->cell_locs.at(ci->name).y - radius);
-                                 y <= std::min(p->max_y, p->cell_locs.at(ci->name).y + radius); y++) {
-                                if (y >= int(fb->at(x).size()))
-                                    break;
-                                if (fb->at(x).at(y).size() > 0)
-                                    goto notempty;
-                            }
-                        }
-                        radius = std::min(std::max(p->max_x, p->max_y), radius + 1);
-                    }
-                notempty:
+                    // No luck yet, increase radius; unless the search already covers all of this region
+                    if (arch_mutex != nullptr && radius >= max_radius)
+                        return false;
+                    Loc loc = get_loc(ci);
+                    radius = std::min(max_radius, radius + 1);
+                    // Keep increasing the radius until it will actually increase the number of cells we are
+                    // checking (e.g. BRAM and DSP will not be in all cols/rows), so we don't waste effort
+                    while (radius < max_radius && grid->count(loc.x - radius, loc.y - radius, loc.x + radius,
+                                                              loc.y + radius) == 0)
+                        radius = std::min(max_radius, radius + 1);
                     iter_at_radius = 0;
                     iter = 0;
                 }
@@ -1231,19 +1362,17 @@ class HeAPPlacer
                 // If we have found at least one legal location; and made enough attempts; assume it's good enough and
                 // finish
                 if (iter_at_radius >= need_to_explore && bestBel != BelId()) {
+                    auto lock = lock_arch();
                     CellInfo *bound = ctx->getBoundBelCell(bestBel);
                     if (bound != nullptr) {
                         p->unbind_ctrl_set(bound->bel);
                         ctx->unbindBel(bound->bel);
-                        remaining.emplace(p->chain_size[bound->name] * p->cfg.get_cell_legalisation_weight(ctx, bound),
-                                          bound->name);
+                        remaining.emplace(priority(bound), bound->name);
                     }
                     p->bind_ctrl_set(bestBel, ci->name);
                     ctx->bindBel(bestBel, ci, STRENGTH_WEAK);
                     placed = true;
-                    Loc loc = ctx->getBelLocation(bestBel);
-                    p->cell_locs[ci->name].x = loc.x;
-                    p->cell_locs[ci->name].y = loc.y;
+                    set_loc(ci, ctx->getBelLocation(bestBel));
                     break;
                 }
 
@@ -1255,15 +1384,29 @@ class HeAPPlacer
 
                 total_iters_for_cell++;
             }
+            return true;
         }
 
-      private:
         HeAPPlacer *p;
         Context *ctx;
+        DeterministicRNG *rng;
 
+        // The area this legaliser may place cells in, and the largest useful search radius within it
+        int x0, y0, x1, y1, max_radius;
+        int cell_count = 0;
         int ripup_radius, chain_ripup_radius, total_iters, total_iters_noreset;
 
+        // State for regions legalised in parallel
+        std::vector<int> x_cuts, y_cuts;
+        std::mutex region_mutex;
+        std::mutex *arch_mutex = nullptr;
+        DeterministicRNG region_rng;
+        dict<IdString, Loc> locs;
+        std::vector<IdString> deferred;
+        dict<IdString, float> time_per_cell_type;
+
         FastBels::FastBelsData *fb;
+        BelGrid *grid;
 
         int radius, iter, iter_at_radius, total_iters_for_cell, need_to_explore;
         bool placed;
@@ -1278,10 +1421,11 @@ class HeAPPlacer
         {
             // Determine a search radius around the solver location (which increases over time) that is clamped to
             // the region constraint for the cell (if applicable)
-            int x0 = std::max(p->cell_locs.at(ci->name).x - radius, 0);
-            int y0 = std::max(p->cell_locs.at(ci->name).y - radius, 0);
-            int x1 = p->cell_locs.at(ci->name).x + radius;
-            int y1 = p->cell_locs.at(ci->name).y + radius;
+            Loc loc = get_loc(ci);
+            int x0 = std::max(loc.x - radius, 0);
+            int y0 = std::max(loc.y - radius, 0);
+            int x1 = loc.x + radius;
+            int y1 = loc.y + radius;
 
             if (ci->region != nullptr) {
                 auto &r = p->constraint_region_bounds[ci->region->name];
@@ -1296,9 +1440,17 @@ class HeAPPlacer
                     std::swap(y0, y1);
             }
 
+            if (arch_mutex != nullptr) {
+                // Keep within the region being legalised
+                x0 = std::max(x0, this->x0);
+                y0 = std::max(y0, this->y0);
+                x1 = std::max(x0, std::min(x1, this->x1));
+                y1 = std::max(y0, std::min(y1, this->y1));
+            }
+
             // Pick a random X and Y location within our search radius / search box
-            int nx = ctx->rng(x1 - x0 + 1) + x0;
-            int ny = ctx->rng(y1 - y0 + 1) + y0;
+            int nx = rng->rng(x1 - x0 + 1) + x0;
+            int ny = rng->rng(y1 - y0 + 1) + y0;
             return std::make_pair(nx, ny);
         }
 
@@ -1314,8 +1466,9 @@ class HeAPPlacer
                     continue;
                 // Prefer available bels; unless we are dealing with a wide radius (e.g. difficult control sets)
                 // or occasionally trigger a tiebreaker
+                auto lock = lock_arch();
                 if (ctx->checkBelAvail(sz) ||
-                    (ctrl_set_group == -1 && (radius > ripup_radius || ctx->rng(20000) < 10))) {
+                    (ctrl_set_group == -1 && (radius > ripup_radius || rng->rng(20000) < 10))) {
                     CellInfo *bound = ctx->getBoundBelCell(sz);
                     if (bound != nullptr) {
                         // Only rip up cells without constraints
@@ -1351,7 +1504,8 @@ class HeAPPlacer
                                 continue;
                             if (drv_loc->second.global)
                                 continue;
-                            input_len += std::abs(drv_loc->second.x - nx) + std::abs(drv_loc->second.y - ny);
+                            Loc dl = get_loc(drv);
+                            input_len += std::abs(dl.x - nx) + std::abs(dl.y - ny);
                         }
                         if (input_len < best_inp_len) {
                             best_inp_len = input_len;
@@ -1362,14 +1516,10 @@ class HeAPPlacer
                         // It's legal, and we've tried enough. Finish.
                         if (bound != nullptr) {
                             p->unbind_ctrl_set(sz);
-                            remaining.emplace(p->chain_size[bound->name] *
-                                                      p->cfg.get_cell_legalisation_weight(ctx, bound),
-                                              bound->name);
+                            remaining.emplace(priority(bound), bound->name);
                         }
-                        Loc loc = ctx->getBelLocation(sz);
                         p->bind_ctrl_set(sz, ci->name);
-                        p->cell_locs[ci->name].x = loc.x;
-                        p->cell_locs[ci->name].y = loc.y;
+                        set_loc(ci, ctx->getBelLocation(sz));
                         placed = true;
                         break;
                     }
@@ -1386,6 +1536,7 @@ class HeAPPlacer
                 // List of bels we placed things at; and the cell that was there before if applicable
                 dict<BelId, CellInfo *> moves_made;
 
+                auto lock = lock_arch();
                 if (!ctx->getClusterPlacement(ci->cluster, sz, targets))
                     continue;
 
@@ -1395,6 +1546,12 @@ class HeAPPlacer
                     // Check it satisfies the region constraint if applicable
                     if (!target.first->testRegion(target.second))
                         goto fail;
+                    if (arch_mutex != nullptr) {
+                        // Stay within the region being legalised
+                        Loc loc = ctx->getBelLocation(target.second);
+                        if (loc.x < x0 || loc.x > x1 || loc.y < y0 || loc.y > y1)
+                            goto fail;
+                    }
                     if (ctrl_set_group != -1 && ctx->getBelBucketForBel(target.second) == p->cfg.ff_bel_bucket &&
                         p->z_to_ctrl_set.at(ctx->getBelLocation(target.second).z) == ctrl_set_group)
                         ctrl_set_match = true;
@@ -1405,7 +1562,8 @@ class HeAPPlacer
                             goto fail;
                         if (bound->belStrength > (p->cfg.chainRipup ? STRENGTH_STRONG : STRENGTH_WEAK))
                             goto fail;
-                        if (bound->cluster != ClusterId() && (!p->cfg.chainRipup || radius < chain_ripup_radius))
+                        if (bound->cluster != ClusterId() &&
+                            (!p->cfg.chainRipup || radius < chain_ripup_radius || arch_mutex != nullptr))
                             goto fail;
                     }
                 }
@@ -1455,9 +1613,7 @@ class HeAPPlacer
                         p->unbind_ctrl_set(move.first);
                 }
                 for (auto &target : targets) {
-                    Loc loc = ctx->getBelLocation(target.second);
-                    p->cell_locs[target.first->name].x = loc.x;
-                    p->cell_locs[target.first->name].y = loc.y;
+                    set_loc(target.first, ctx->getBelLocation(target.second));
                     p->bind_ctrl_set(target.second, target.first->name);
                     // log_info("%s %d %d %d\n", target.first->name.c_str(ctx), loc.x, loc.y, loc.z);
                 }
@@ -1465,9 +1621,7 @@ class HeAPPlacer
                     // Where we have ripped up cells; add them to the queue
                     if (move.second != nullptr && (move.second->cluster == ClusterId() ||
                                                    ctx->getClusterRootCell(move.second->cluster) == move.second))
-                        remaining.emplace(p->chain_size[move.second->name] *
-                                                  p->cfg.get_cell_legalisation_weight(ctx, move.second),
-                                          move.second->name);
+                        remaining.emplace(priority(move.second), move.second->name);
                 }
 
                 placed = true;
@@ -2172,6 +2326,7 @@ PlacerHeapCfg::PlacerHeapCfg(Context *ctx)
     solverTolerance = 1e-5;
     placeAllAtOnce = false;
     chainRipup = false;
+    multilevel = ctx->setting<bool>("placerHeap/multilevel", false);
 
     int timeout_divisor = ctx->setting<int>("placerHeap/cellPlacementTimeout", 8);
     if (timeout_divisor > 0) {
@@ -47,6 +47,8 @@ struct PlacerHeapCfg
     bool parallelRefine;
     bool chainRipup;
     int cell_placement_timeout;
+    // Start from a multilevel placement (see placer_multilevel.h) rather than from unconstrained solves of every cell
+    bool multilevel;
 
     int hpwl_scale_x, hpwl_scale_y;
     int spread_scale_x, spread_scale_y;
@@ -0,0 +1,556 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "placer_multilevel.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include "array2d.h"
+#include "equation_system.h"
+#include "log.h"
+#include "place_common.h"
+#include "util.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+
+// A net, in terms of the clusters of one level
+struct MultilevelNet
+{
+    std::vector<int> clusters;
+    // Ports on cells that are not being placed
+    std::vector<MultilevelLoc> fixed;
+    // Ports on the original net, for the bound2bound weights
+    int port_count;
+};
+
+struct MultilevelLevel
+{
+    // Number of cells in each cluster
+    std::vector<int> size;
+    // Constraint region of each cluster, as an index into region_bounds, or -1
+    std::vector<int> region;
+    std::vector<MultilevelNet> nets;
+    // The cluster at the next coarser level that each cluster was merged into
+    std::vector<int> parent;
+
+    int count() const { return int(size.size()); }
+};
+
+class MultilevelPlacer
+{
+  public:
+    MultilevelPlacer(Context *ctx, const PlacerMultilevelCfg &cfg) : ctx(ctx), cfg(cfg) {}
+
+    std::vector<MultilevelLoc> place(const std::vector<CellInfo *> &cells,
+                                     std::function<bool(const CellInfo *, Loc &)> fixed_loc)
+    {
+        auto startt = std::chrono::high_resolution_clock::now();
+        levels.emplace_back();
+        setup_grid();
+        setup_top(cells, fixed_loc);
+        setup_capacity(cells);
+        while (int(levels.size()) < cfg.max_levels && levels.back().count() > cfg.min_clusters)
+            if (!coarsen())
+                break;
+        log_info("Running multilevel placement for %d cells, %d levels down to %d clusters.\n", int(cells.size()),
+                 int(levels.size()), levels.back().count());
+
+        // Everything starts around the middle of the device, or of its region. Cells at exactly the same location
+        // can't be told apart by spreading, so there is a little noise.
+        std::vector<MultilevelLoc> pos(levels.back().count());
+        for (int c = 0; c < levels.back().count(); c++) {
+            int region = levels.back().region.at(c);
+            MultilevelLoc centre{max_x / 2.0, max_y / 2.0};
+            if (region != -1) {
+                const auto &bb = region_bounds.at(region);
+                centre = MultilevelLoc{(bb.x0 + bb.x1) / 2.0, (bb.y0 + bb.y1) / 2.0};
+            }
+            pos.at(c) = clamp(region, jitter(centre, 1.0));
+        }
+        std::vector<MultilevelLoc> anchor = pos;
+        int iter = 0;
+        for (int l = int(levels.size()) - 1; l >= 0; l--) {
+            auto level_startt = std::chrono::high_resolution_clock::now();
+            if (l != int(levels.size()) - 1) {
+                // Start each cluster where its parent ended up
+                const auto &parent = levels.at(l).parent;
+                std::vector<MultilevelLoc> fine_pos(levels.at(l).count());
+                for (int c = 0; c < levels.at(l).count(); c++)
+                    fine_pos.at(c) = clamp(levels.at(l).region.at(c), jitter(pos.at(parent.at(c)), 0.5));
+                pos = std::move(fine_pos);
+                anchor = pos;
+            }
+            for (int i = 0; i < cfg.level_iters; i++, iter++) {
+                solve(levels.at(l), pos, anchor, iter);
+                spread(levels.at(l), pos);
+                anchor = pos;
+            }
+            auto level_endt = std::chrono::high_resolution_clock::now();
+            log_info("    at level %d, %d clusters: wirelen = %d; time = %.02fs\n", l, levels.at(l).count(),
+                     int(total_hpwl(l, pos)), std::chrono::duration<double>(level_endt - level_startt).count());
+        }
+        auto endt = std::chrono::high_resolution_clock::now();
+        log_info("Multilevel placement time: %.02fs\n", std::chrono::duration<double>(endt - startt).count());
+        log_info("  of which coarsening: %.02fs\n", coarsen_time);
+        log_info("  of which solving equations: %.02fs\n", solve_time);
+        log_info("  of which spreading cells: %.02fs\n", spread_time);
+        return pos;
+    }
+
+  private:
+    Context *ctx;
+    const PlacerMultilevelCfg &cfg;
+
+    int max_x = 0, max_y = 0;
+    // Levels from the finest (one cluster per placed cell or macro) to the coarsest
+    std::vector<MultilevelLevel> levels;
+    std::vector<BoundingBox> region_bounds;
+    // Estimated number of the placed cells that fit at each location
+    array2d<double> capacity;
+    std::array<EquationSystem<double>, 2> equations;
+
+    double coarsen_time = 0, solve_time = 0, spread_time = 0;
+
+    void setup_grid()
+    {
+        for (auto bel : ctx->getBels()) {
+            Loc loc = ctx->getBelLocation(bel);
+            max_x = std::max(max_x, loc.x);
+            max_y = std::max(max_y, loc.y);
+        }
+    }
+
+    // Find the clusters and nets of the finest level
+    void setup_top(const std::vector<CellInfo *> &cells, std::function<bool(const CellInfo *, Loc &)> &fixed_loc)
+    {
+        auto &top = levels.front();
+        dict<ClusterId, std::vector<CellInfo *>> cluster2cells;
+        for (auto &cell : ctx->cells)
+            if (cell.second->cluster != ClusterId())
+                cluster2cells[cell.second->cluster].push_back(cell.second.get());
+        dict<IdString, int> region_idx;
+        dict<IdString, int> cell2cluster;
+        for (auto ci : cells) {
+            int c = top.count();
+            int size = 0;
+            if (ci->cluster != ClusterId()) {
+                for (auto member : cluster2cells.at(ci->cluster))
+                    if (cell2cluster.emplace(member->name, c).second)
+                        ++size;
+            } else if (cell2cluster.emplace(ci->name, c).second) {
+                ++size;
+            }
+            top.size.push_back(std::max(size, 1));
+            int region = -1;
+            if (ci->region != nullptr && ci->region->constr_bels) {
+                auto found = region_idx.find(ci->region->name);
+                if (found == region_idx.end()) {
+                    BoundingBox bb(std::numeric_limits<int>::max(), std::numeric_limits<int>::max(),
+                                   std::numeric_limits<int>::min(), std::numeric_limits<int>::min());
+                    for (auto bel : ci->region->bels) {
+                        Loc loc = ctx->getBelLocation(bel);
+                        bb.x0 = std::min(bb.x0, loc.x);
+                        bb.x1 = std::max(bb.x1, loc.x);
+                        bb.y0 = std::min(bb.y0, loc.y);
+                        bb.y1 = std::max(bb.y1, loc.y);
+                    }
+                    found = region_idx.emplace(ci->region->name, int(region_bounds.size())).first;
+                    region_bounds.push_back(bb);
+                }
+                region = found->second;
+            }
+            top.region.push_back(region);
+        }
+
+        for (auto &net : ctx->nets) {
+            NetInfo *ni = net.second.get();
+            if (ni->driver.cell == nullptr || ni->users.empty())
+                continue;
+            // Global nets have their own routing, so they don't pull cells together
+            if (ni->driver.cell->bel != BelId() && ctx->getBelGlobalBuf(ni->driver.cell->bel))
+                continue;
+            MultilevelNet mn;
+            mn.port_count = int(ni->users.entries()) + 1;
+            auto add_port = [&](const PortRef &port) {
+                auto found = cell2cluster.find(port.cell->name);
+                Loc loc;
+                if (found != cell2cluster.end())
+                    mn.clusters.push_back(found->second);
+                else if (fixed_loc(port.cell, loc))
+                    mn.fixed.push_back(MultilevelLoc{double(loc.x), double(loc.y)});
+            };
+            add_port(ni->driver);
+            for (auto &usr : ni->users)
+                add_port(usr);
+            add_net(top, std::move(mn));
+        }
+    }
+
+    // Add a net to a level, unless it no longer connects anything
+    static void add_net(MultilevelLevel &level, MultilevelNet &&net)
+    {
+        std::sort(net.clusters.begin(), net.clusters.end());
+        net.clusters.erase(std::unique(net.clusters.begin(), net.clusters.end()), net.clusters.end());
+        if (net.clusters.empty() || (net.clusters.size() + net.fixed.size()) < 2)
+            return;
+        level.nets.push_back(std::move(net));
+    }
+
+    // The bels of each bucket that is used, weighted by the share of cells that use it, so that the capacity of a
+    // location is roughly the number of cells that it could take
+    void setup_capacity(const std::vector<CellInfo *> &cells)
+    {
+        dict<BelBucketId, int> bucket_cells;
+        int total_cells = 0;
+        for (auto ci : cells) {
+            bucket_cells[ctx->getBelBucketForCellType(ci->type)]++;
+            ++total_cells;
+        }
+        dict<BelBucketId, int> bucket_bels;
+        for (auto bel : ctx->getBels())
+            if (ctx->checkBelAvail(bel))
+                bucket_bels[ctx->getBelBucketForBel(bel)]++;
+        capacity.reset(max_x + 1, max_y + 1, 0.0);
+        for (auto bel : ctx->getBels()) {
+            if (!ctx->checkBelAvail(bel))
+                continue;
+            auto found = bucket_cells.find(ctx->getBelBucketForBel(bel));
+            if (found == bucket_cells.end())
+                continue;
+            Loc loc = ctx->getBelLocation(bel);
+            capacity.at(loc.x, loc.y) += double(found->second) / total_cells;
+        }
+    }
+
+    // Merge pairs of strongly connected clusters into the next level (heavy-edge matching). Returns false, and adds no
+    // level, if too few clusters could be merged for another level to be worthwhile.
+    bool coarsen()
+    {
+        auto startt = std::chrono::high_resolution_clock::now();
+        MultilevelLevel &fine = levels.back();
+        int n = fine.count();
+        std::vector<std::vector<int>> cluster_nets(n);
+        for (int i = 0; i < int(fine.nets.size()); i++) {
+            const auto &net = fine.nets.at(i);
+            if (net.clusters.size() < 2 || int(net.clusters.size() + net.fixed.size()) > cfg.max_cluster_net_size)
+                continue;
+            for (int c : net.clusters)
+                cluster_nets.at(c).push_back(i);
+        }
+
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        ctx->shuffle(order);
+        std::vector<int> match(n, -1);
+        std::vector<double> score(n, 0);
+        std::vector<int> touched;
+        for (int u : order) {
+            if (match.at(u) != -1)
+                continue;
+            touched.clear();
+            for (int i : cluster_nets.at(u)) {
+                const auto &net = fine.nets.at(i);
+                double weight = 1.0 / (net.clusters.size() - 1);
+                for (int v : net.clusters) {
+                    if (v == u || match.at(v) != -1)
+                        continue;
+                    if (score.at(v) == 0)
+                        touched.push_back(v);
+                    score.at(v) += weight;
+                }
+            }
+            // Prefer merging small clusters, to keep their sizes even
+            int best = -1;
+            double best_score = 0;
+            for (int v : touched) {
+                int size = fine.size.at(u) + fine.size.at(v);
+                if (size <= cfg.max_cluster_cells && fine.region.at(u) == fine.region.at(v) &&
+                    score.at(v) / size > best_score) {
+                    best = v;
+                    best_score = score.at(v) / size;
+                }
+                score.at(v) = 0;
+            }
+            if (best != -1) {
+                match.at(u) = best;
+                match.at(best) = u;
+            }
+        }
+
+        MultilevelLevel coarse;
+        fine.parent.assign(n, -1);
+        for (int u = 0; u < n; u++) {
+            if (fine.parent.at(u) != -1)
+                continue;
+            int c = coarse.count();
+            fine.parent.at(u) = c;
+            int size = fine.size.at(u);
+            if (match.at(u) != -1) {
+                fine.parent.at(match.at(u)) = c;
+                size += fine.size.at(match.at(u));
+            }
+            coarse.size.push_back(size);
+            coarse.region.push_back(fine.region.at(u));
+        }
+        auto endt = std::chrono::high_resolution_clock::now();
+        coarsen_time += std::chrono::duration<double>(endt - startt).count();
+        if (coarse.count() > 0.9 * n) {
+            fine.parent.clear();
+            return false;
+        }
+        for (const auto &net : fine.nets) {
+            MultilevelNet coarse_net;
+            coarse_net.port_count = net.port_count;
+            coarse_net.fixed = net.fixed;
+            for (int c : net.clusters)
+                coarse_net.clusters.push_back(fine.parent.at(c));
+            add_net(coarse, std::move(coarse_net));
+        }
+        levels.push_back(std::move(coarse));
+        coarsen_time += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - endt).count();
+        return true;
+    }
+
+    MultilevelLoc jitter(MultilevelLoc loc, double radius)
+    {
+        return MultilevelLoc{loc.x + radius * (2 * ctx->rngf(1.0) - 1), loc.y + radius * (2 * ctx->rngf(1.0) - 1)};
+    }
+
+    MultilevelLoc clamp(int region, MultilevelLoc loc) const
+    {
+        double x0 = 0, y0 = 0, x1 = max_x, y1 = max_y;
+        if (region != -1) {
+            const auto &bb = region_bounds.at(region);
+            x0 = bb.x0;
+            y0 = bb.y0;
+            x1 = bb.x1;
+            y1 = bb.y1;
+        }
+        // Keep locations strictly inside the last row and column, so that they round down into the grid
+        return MultilevelLoc{std::max(x0, std::min(x1 + 0.999, loc.x)), std::max(y0, std::min(y1 + 0.999, loc.y))};
+    }
+
+    // Bound2bound quadratic solve of one level, with each cluster pulled towards its anchor from the last iteration
+    void solve(const MultilevelLevel &level, std::vector<MultilevelLoc> &pos, const std::vector<MultilevelLoc> &anchor,
+               int iter)
+    {
+        auto startt = std::chrono::high_resolution_clock::now();
+        ThreadPool *pool = (level.count() >= 500) ? &ctx->get_thread_pool() : nullptr;
+        // The bound2bound model is linearised around the current positions, so it is rebuilt a few times
+        for (int pass = 0; pass < 3; pass++) {
+            if (pool != nullptr)
+                pool->run(2, [&](int axis) { build_equations(level, pos, anchor, iter, axis == 1); });
+            else
+                for (int axis = 0; axis < 2; axis++)
+                    build_equations(level, pos, anchor, iter, axis == 1);
+            for (int axis = 0; axis < 2; axis++) {
+                std::vector<double> vals(level.count());
+                for (int c = 0; c < level.count(); c++)
+                    vals.at(c) = axis ? pos.at(c).y : pos.at(c).x;
+                equations[axis].solve(vals, cfg.solver_tolerance, pool);
+                for (int c = 0; c < level.count(); c++)
+                    (axis ? pos.at(c).y : pos.at(c).x) = vals.at(c);
+            }
+            for (int c = 0; c < level.count(); c++)
+                pos.at(c) = clamp(level.region.at(c), pos.at(c));
+        }
+        solve_time += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startt).count();
+    }
+
+    void build_equations(const MultilevelLevel &level, const std::vector<MultilevelLoc> &pos,
+                         const std::vector<MultilevelLoc> &anchor, int iter, bool yaxis)
+    {
+        auto &es = equations[yaxis];
+        es.reset(level.count());
+        double scale = yaxis ? cfg.hpwl_scale_y : cfg.hpwl_scale_x;
+
+        struct NetPort
+        {
+            double pos;
+            int row; // -1 for fixed ports
+        };
+        std::vector<NetPort> ports;
+        for (const auto &net : level.nets) {
+            ports.clear();
+            for (int c : net.clusters)
+                ports.push_back(NetPort{yaxis ? pos.at(c).y : pos.at(c).x, c});
+            for (const auto &loc : net.fixed)
+                ports.push_back(NetPort{yaxis ? loc.y : loc.x, -1});
+            int lb = 0, ub = 0;
+            for (int i = 1; i < int(ports.size()); i++) {
+                if (ports.at(i).pos < ports.at(lb).pos)
+                    lb = i;
+                if (ports.at(i).pos > ports.at(ub).pos)
+                    ub = i;
+            }
+            auto stamp_equation = [&](const NetPort &var, const NetPort &eqn, double weight) {
+                if (eqn.row == -1)
+                    return;
+                if (var.row != -1)
+                    es.add_coeff(eqn.row, var.row, weight);
+                else
+                    es.add_rhs(eqn.row, -var.pos * weight);
+            };
+            for (int i = 0; i < int(ports.size()); i++) {
+                const NetPort &port = ports.at(i);
+                auto process_arc = [&](int other_idx) {
+                    if (other_idx == i)
+                        return;
+                    const NetPort &other = ports.at(other_idx);
+                    // Ports of a net that ended up in the same cluster no longer pull on anything
+                    if (other.row != -1 && other.row == port.row)
+                        return;
+                    double weight =
+                            1.0 / ((net.port_count - 1) * std::max<double>(1, scale * std::abs(other.pos - port.pos)));
+                    stamp_equation(port, port, weight);
+                    stamp_equation(port, other, -weight);
+                    stamp_equation(other, other, weight);
+                    stamp_equation(other, port, -weight);
+                };
+                process_arc(lb);
+                process_arc(ub);
+            }
+        }
+        // Before anything has been spread, only a weak pull towards the starting point, which keeps clusters with no
+        // fixed connections from collapsing to the origin
+        for (int c = 0; c < level.count(); c++) {
+            double a_pos = yaxis ? anchor.at(c).y : anchor.at(c).x, c_pos = yaxis ? pos.at(c).y : pos.at(c).x;
+            double weight = 1e-3;
+            if (iter > 0)
+                weight = cfg.alpha * iter / std::max<double>(1, scale * std::abs(a_pos - c_pos));
+            es.add_coeff(c, c, weight);
+            es.add_rhs(c, weight * a_pos);
+        }
+    }
+
+    // Cell shifting as in FastPlace: within each row of bins, bin boundaries are moved towards less utilised bins and
+    // the clusters in each bin are stretched to fit. Repeated for columns, and a few times over.
+    void spread(const MultilevelLevel &level, std::vector<MultilevelLoc> &pos)
+    {
+        auto startt = std::chrono::high_resolution_clock::now();
+        // Each pass can at most about triple the span of a crowded group of clusters, so a collapsed solution takes a
+        // few passes to spread out; stop once nothing is overfull
+        for (int pass = 0; pass < 16; pass++) {
+            double overfull = std::max(shift(level, pos, false), shift(level, pos, true));
+            if (overfull <= 1.0)
+                break;
+        }
+        for (int c = 0; c < level.count(); c++)
+            pos.at(c) = clamp(level.region.at(c), pos.at(c));
+        spread_time += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startt).count();
+    }
+
+    // One cell shifting pass along each row (or column) of grid locations, which are the bins. Returns the highest
+    // utilisation of any bin before shifting.
+    double shift(const MultilevelLevel &level, std::vector<MultilevelLoc> &pos, bool yaxis)
+    {
+        // Bins below this utilisation are not worth spreading into each other
+        const double target_util = 0.7, delta = 0.5;
+        int bins = (yaxis ? max_y : max_x) + 1, lines = (yaxis ? max_x : max_y) + 1;
+        auto bin_of = [&](double v, int count) { return std::max(0, std::min(count - 1, int(v))); };
+        auto cap = [&](int l, int b) { return yaxis ? capacity.at(l, b) : capacity.at(b, l); };
+
+        std::vector<double> area(lines * bins, 0);
+        for (int c = 0; c < level.count(); c++)
+            area.at(bin_of(yaxis ? pos.at(c).x : pos.at(c).y, lines) * bins +
+                    bin_of(yaxis ? pos.at(c).y : pos.at(c).x, bins)) += level.size.at(c);
+
+        // New boundaries, bins + 1 per line
+        std::vector<double> bounds(lines * (bins + 1));
+        double max_util = 0;
+        for (int l = 0; l < lines; l++) {
+            auto util = [&](int b) {
+                double c = cap(l, b), a = area.at(l * bins + b);
+                if (c == 0)
+                    return (a > 0) ? 10.0 * (1 + a) : target_util;
+                return std::max(target_util, a / c);
+            };
+            double *nb = &bounds.at(l * (bins + 1));
+            nb[0] = 0;
+            nb[bins] = bins;
+            for (int b = 0; b < bins; b++)
+                max_util = std::max(max_util, (area.at(l * bins + b) > 0) ? util(b) : 0);
+            for (int b = 1; b < bins; b++) {
+                double u_l = util(b - 1), u_r = util(b);
+                nb[b] = ((b + 1) * (u_l + delta) + (b - 1) * (u_r + delta)) / (u_l + u_r + 2 * delta);
+                nb[b] = std::max(nb[b], nb[b - 1]);
+            }
+        }
+        for (int c = 0; c < level.count(); c++) {
+            double &v = yaxis ? pos.at(c).y : pos.at(c).x;
+            int l = bin_of(yaxis ? pos.at(c).x : pos.at(c).y, lines), b = bin_of(v, bins);
+            const double *nb = &bounds.at(l * (bins + 1));
+            v = nb[b] + (v - b) * (nb[b + 1] - nb[b]);
+        }
+        return max_util;
+    }
+
+    // Wirelength of the original nets, with each cell at the location of its cluster at the given level
+    wirelen_t total_hpwl(int level, const std::vector<MultilevelLoc> &pos) const
+    {
+        std::vector<int> top2level(levels.front().count());
+        for (int c = 0; c < int(top2level.size()); c++) {
+            int idx = c;
+            for (int l = 0; l < level; l++)
+                idx = levels.at(l).parent.at(idx);
+            top2level.at(c) = idx;
+        }
+        wirelen_t hpwl = 0;
+        for (const auto &net : levels.front().nets) {
+            double x0 = std::numeric_limits<double>::max(), y0 = x0, x1 = std::numeric_limits<double>::lowest(),
+                   y1 = x1;
+            auto extend = [&](const MultilevelLoc &loc) {
+                x0 = std::min(x0, loc.x);
+                y0 = std::min(y0, loc.y);
+                x1 = std::max(x1, loc.x);
+                y1 = std::max(y1, loc.y);
+            };
+            for (int c : net.clusters)
+                extend(pos.at(top2level.at(c)));
+            for (const auto &loc : net.fixed)
+                extend(loc);
+            hpwl += wirelen_t(cfg.hpwl_scale_x * (x1 - x0) + cfg.hpwl_scale_y * (y1 - y0));
+        }
+        return hpwl;
+    }
+};
+
+} // namespace
+
+PlacerMultilevelCfg::PlacerMultilevelCfg(Context *ctx)
+{
+    min_clusters = ctx->setting<int>("placerMultilevel/minClusters", 500);
+    max_levels = ctx->setting<int>("placerMultilevel/maxLevels", 10);
+    max_cluster_cells = ctx->setting<int>("placerMultilevel/maxClusterCells", 64);
+    max_cluster_net_size = ctx->setting<int>("placerMultilevel/maxClusterNetSize", 16);
+    level_iters = ctx->setting<int>("placerMultilevel/levelIters", 3);
+    alpha = ctx->setting<float>("placerMultilevel/alpha", 0.1);
+    solver_tolerance = 1e-5;
+}
+
+std::vector<MultilevelLoc> placer_multilevel(Context *ctx, const PlacerMultilevelCfg &cfg,
+                                             const std::vector<CellInfo *> &cells,
+                                             std::function<bool(const CellInfo *, Loc &)> fixed_loc)
+{
+    return MultilevelPlacer(ctx, cfg).place(cells, fixed_loc);
+}
+
+NEXTPNR_NAMESPACE_END
@@ -0,0 +1,75 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  [[cite]] mPL
+ *  Multilevel Optimization for Large-Scale Circuit Placement, Tony F. Chan, Jason Cong, Tianming Kong and Joseph R.
+ *  Shinnerl, ICCAD 2000
+ *
+ *  [[cite]] FastPlace
+ *  FastPlace: Efficient Analytical Placement using Cell Shifting, Iterative Local Refinement and a Hybrid Net Model,
+ *  Natarajan Viswanathan and Chris Chong-Nuen Chu, ISPD 2004
+ */
+
+#ifndef PLACER_MULTILEVEL_H
+#define PLACER_MULTILEVEL_H
+
+#include <functional>
+#include <vector>
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+struct PlacerMultilevelCfg
+{
+    PlacerMultilevelCfg(Context *ctx);
+
+    // Coarsening stops at this many clusters, after max_levels levels, or once a level merges too few clusters
+    int min_clusters;
+    int max_levels;
+    // Largest number of cells that may be merged into one cluster
+    int max_cluster_cells;
+    // Nets with more ports than this are not used to choose clusters, as they say little about which cells belong
+    // together (they are still used for placement)
+    int max_cluster_net_size;
+    // Number of solve-and-spread iterations at each level
+    int level_iters;
+    // Weight of the pseudo-nets pulling clusters towards their spread location, multiplied by the iteration count
+    float alpha;
+    float solver_tolerance;
+
+    int hpwl_scale_x = 1, hpwl_scale_y = 1;
+};
+
+struct MultilevelLoc
+{
+    double x = 0, y = 0;
+};
+
+// A multilevel global placement, for the analytic placers to start from.
+//
+// The netlist is coarsened by repeatedly merging pairs of strongly connected clusters (starting with the given cells,
+// with ClusterId macros treated as one cell), then the coarsest netlist is placed with a bound2bound quadratic solve
+// and cell-shifting spreading. Each finer level starts from the placement of the one above, and gets a few more
+// solve/spread iterations. The number of unknowns in the coarse solves is the number of clusters at that level.
+//
+// `cells` are the cells to place. Any other cell in the same macro as one of these is moved with it. Other cells
+// connected to them are fixed at the location that `fixed_loc` returns, or are ignored if it returns false. The result
+// is the location of each of `cells`, in bel grid coordinates, after spreading at the finest level.
+std::vector<MultilevelLoc> placer_multilevel(Context *ctx, const PlacerMultilevelCfg &cfg,
+                                             const std::vector<CellInfo *> &cells,
+                                             std::function<bool(const CellInfo *, Loc &)> fixed_loc);
+
+NEXTPNR_NAMESPACE_END
+#endif
@@ -24,6 +24,7 @@
 #include <chrono>
 #include <deque>
 #include <fstream>
+#include <mutex>
 #include <numeric>
 #include <queue>
 #include <tuple>
@@ -34,19 +35,12 @@
 #include "parallel_refine.h"
 #include "place_common.h"
 #include "placer1.h"
+#include "placer_multilevel.h"
 #include "timing.h"
 #include "util.h"
 
 #include "fftsg.h"
 
-#ifndef NPNR_DISABLE_THREADS
-#include <atomic>
-#include <condition_variable>
-#include <mutex>
-#include <thread>
-
-#endif
-
 NEXTPNR_NAMESPACE_BEGIN
 
 using namespace StaticUtil;
@@ -152,92 +146,6 @@ struct PlacerNet
     int hpwl() { return (b1.x - b0.x) + (b1.y - b0.y); }
 };
 
-#ifdef NPNR_DISABLE_THREADS
-struct ThreadPool
-{
-    ThreadPool(int) {};
-
-    void run(int N, std::function<void(int)> func)
-    {
-        for (int i = 0; i < N; i++)
-            func(i);
-    };
-};
-#else
-struct ThreadPool
-{
-    ThreadPool(int thread_count)
-    {
-        done.resize(thread_count, false);
-        for (int i = 0; i < thread_count; i++) {
-            threads.emplace_back([this, i]() { this->worker(i); });
-        }
-    }
-    std::vector<std::thread> threads;
-    std::condition_variable cv_start, cv_done;
-    std::mutex mutex;
-
-    bool work_available = false;
-    bool shutdown = false;
-    std::vector<bool> done;
-    std::function<void(int)> work;
-    int work_count;
-
-    ~ThreadPool()
-    {
-        {
-            std::lock_guard lk(mutex);
-            shutdown = true;
-        }
-        cv_start.notify_all();
-        for (auto &t : threads)
-            t.join();
-    }
-
-    void run(int N, std::function<void(int)> func)
-    {
-        {
-            std::lock_guard lk(mutex);
-            work = func;
-            work_count = N;
-            work_available = true;
-            std::fill(done.begin(), done.end(), false);
-        }
-        cv_start.notify_all();
-        {
-            std::unique_lock lk(mutex);
-            cv_done.wait(lk, [this] { return std::all_of(done.begin(), done.end(), [](bool x) { return x; }); });
-            work_available = false;
-        }
-    }
-
-    void worker(int idx)
-    {
-        while (true) {
-            std::unique_lock lk(mutex);
-            cv_start.wait(lk, [this, idx] { return (work_available && !done.at(idx)) || shutdown; });
-            if (shutdown) {
-                lk.unlock();
-                break;
-            } else if (work_available && !done.at(idx)) {
-                int work_per_thread = (work_count + int(threads.size()) - 1) / threads.size();
-                int begin = work_per_thread * idx;
-                int end = std::min(work_count, work_per_thread * (idx + 1));
-                lk.unlock();
-
-                for (int j = begin; j < end; j++) {
-                    work(j);
-                }
-
-                lk.lock();
-                done.at(idx) = true;
-                lk.unlock();
-                cv_done.notify_one();
-            }
-        }
-    }
-};
-#endif
 
 class StaticPlacer
 {
@@ -253,7 +161,7 @@ class StaticPlacer
 
     FastBels fast_bels;
     TimingAnalyser tmg;
-    ThreadPool pool;
+    ThreadPool &pool;
 
     int width, height;
     int bel_width, bel_height;
@@ -266,6 +174,8 @@ class StaticPlacer
 
     // legalisation queue
     std::priority_queue<std::pair<int, IdString>> to_legalise;
+    // serialises arch calls between regions being legalised in parallel
+    std::mutex legalise_mutex;
 
     std::vector<int> place_x_to_bel_x, place_y_to_bel_y;
     std::vector<int> bel_x_to_place_x, bel_y_to_place_y;
@@ -525,17 +435,17 @@ class StaticPlacer
             // Mismatched group case
             if (!lookup_group(ci, cell_group, rect)) {
                 if (ci->bel == BelId()) {
-                    for (auto bel : ctx->getBels()) {
-                        if (ctx->isValidBelForCellType(ci->type, bel) && ctx->checkBelAvail(bel)) {
-                            ctx->bindBel(bel, ci, STRENGTH_STRONG);
-                            if (!ctx->isBelLocationValid(bel)) {
-                                ctx->unbindBel(bel);
-                            } else {
-                                log_info("    placed potpourri cell '%s' at bel '%s'\n", ctx->nameOf(ci),
-                                         ctx->nameOfBel(bel));
-                                break;
-                            }
-                        }
+                    BelGrid &grid = fast_bels.getGridForCellType(ci->type);
+                    BelId bel = grid.nearest_free_bel(ctx, 0, 0, [&](BelId bel) {
+                        ctx->bindBel(bel, ci, STRENGTH_STRONG);
+                        if (ctx->isBelLocationValid(bel))
+                            return true;
+                        ctx->unbindBel(bel);
+                        return false;
+                    });
+                    if (bel != BelId()) {
+                        fast_bels.setBelFree(bel, false);
+                        log_info("    placed potpourri cell '%s' at bel '%s'\n", ctx->nameOf(ci), ctx->nameOfBel(bel));
                     }
                 }
                 continue;
@@ -632,6 +542,68 @@ class StaticPlacer
         }
     }
 
+    // Convert a bel grid coordinate to the placer grid, where rows and columns without bels are skipped
+    float bel_to_place_coord(const std::vector<int> &bel_to_place, int size, double v)
+    {
+        int col = std::max(0, std::min(int(bel_to_place.size()) - 1, int(v)));
+        float frac = (col == int(v)) ? float(v - col) : 0.5f;
+        for (int next = col; next < int(bel_to_place.size()); next++)
+            if (bel_to_place.at(next) != -1)
+                return std::min<float>(size - 1, bel_to_place.at(next) + ((next == col) ? frac : 0.f));
+        for (int prev = col; prev >= 0; prev--)
+            if (bel_to_place.at(prev) != -1)
+                return float(bel_to_place.at(prev));
+        return 0;
+    }
+
+    // Replace the random initial locations of movable cells with a multilevel placement
+    void seed_multilevel()
+    {
+        std::vector<CellInfo *> cells;
+        std::vector<int> cell_macro;
+        for (int i = 0; i < int(macros.size()); i++) {
+            auto &m = macros.at(i);
+            if (std::any_of(m.conc_cells.begin(), m.conc_cells.end(),
+                            [&](int idx) { return !mcells.at(idx).is_fixed; })) {
+                cells.push_back(m.root);
+                cell_macro.push_back(i);
+            }
+        }
+        for (auto &cell : ctx->cells) {
+            CellInfo *ci = cell.second.get();
+            if (ci->cluster == ClusterId() && ci->udata != -1 && !mcells.at(ci->udata).is_fixed) {
+                cells.push_back(ci);
+                cell_macro.push_back(-1);
+            }
+        }
+        PlacerMultilevelCfg ml_cfg(ctx);
+        ml_cfg.hpwl_scale_x = cfg.hpwl_scale_x;
+        ml_cfg.hpwl_scale_y = cfg.hpwl_scale_y;
+        auto result = placer_multilevel(ctx, ml_cfg, cells, [&](const CellInfo *ci, Loc &loc) {
+            if (ci->bel == BelId())
+                return false;
+            loc = ctx->getBelLocation(ci->bel);
+            return true;
+        });
+        for (int i = 0; i < int(cells.size()); i++) {
+            RealPair pos(bel_to_place_coord(bel_x_to_place_x, width, result.at(i).x),
+                         bel_to_place_coord(bel_y_to_place_y, height, result.at(i).y));
+            if (cell_macro.at(i) == -1) {
+                mcells.at(cells.at(i)->udata).pos = limit_to_reg(cells.at(i)->region, pos);
+                continue;
+            }
+            const auto &m = macros.at(cell_macro.at(i));
+            for (int idx : m.conc_cells) {
+                auto &mc = mcells.at(idx);
+                if (mc.is_fixed)
+                    continue;
+                const auto &cc = ccells.at(idx);
+                mc.pos = limit_to_reg(cc.base_cell->region,
+                                      clamp_loc(pos + RealPair(cc.chunk_dx, cc.chunk_dy) - m.centroid));
+            }
+        }
+    }
+
     const double target_util = 0.7;
 
     void insert_dark()
@@ -706,6 +678,10 @@ class StaticPlacer
         cs_table_fft.resize(m * 3 / 2, 0);
         work_area_fft.resize(std::round(std::sqrt(m)) + 2, 0);
         work_area_fft.at(0) = 0;
+        // The Ooura routines fill in their tables on first use; do that now so that they are only read afterwards,
+        // when transforms run in parallel
+        std::vector<float> dummy(m, 0);
+        ddct(m, -1, dummy.data(), work_area_fft.data(), cs_table_fft.data());
     }
 
     template <typename TFunc> void iter_slithers(RealPair pos, StaticRect rect, TFunc func)
@@ -810,18 +786,99 @@ class StaticPlacer
         log_info("overlap: %s\n", overlap_str.c_str());
     }
 
-    void run_fft(int group)
+    enum class Transform1D
+    {
+        DCT,
+        DST
+    };
+
+    // A 2D transform of an m x m array: tx along x (the first index), ty along y
+    struct Transform2D
+    {
+        FFTArray *array;
+        Transform1D tx, ty;
+        int isgn;
+    };
+
+    // Rows or columns per task when transforming
+    static constexpr int fft_block = 16;
+
+    void transform_1d(Transform1D kind, int isgn, float *data)
+    {
+        if (kind == Transform1D::DCT)
+            ddct(m, isgn, data, work_area_fft.data(), cs_table_fft.data());
+        else
+            ddst(m, isgn, data, work_area_fft.data(), cs_table_fft.data());
+    }
+
+    // Equivalent to running Ooura's ddct2d/ddsct2d/ddcst2d on each array, but with the row and column passes of all of
+    // them split into blocks that run on the thread pool. Each row and column goes through the same 1D transform as
+    // it would there, so the results are identical.
+    void run_transforms(const std::vector<Transform2D> &transforms)
+    {
+        int blocks = (m + fft_block - 1) / fft_block;
+        // Along y first, where the data for each x is already contiguous
+        pool.run(int(transforms.size()) * blocks, [&](int i) {
+            auto &t = transforms.at(i / blocks);
+            int x0 = (i % blocks) * fft_block, x1 = std::min(m, x0 + fft_block);
+            for (int x = x0; x < x1; x++)
+                transform_1d(t.ty, t.isgn, t.array->data()[x]);
+        });
+        // Then along x, gathering a block of columns at a time
+        pool.run(int(transforms.size()) * blocks, [&](int i) {
+            auto &t = transforms.at(i / blocks);
+            float **a = t.array->data();
+            int y0 = (i % blocks) * fft_block, y1 = std::min(m, y0 + fft_block);
+            std::vector<float> columns(size_t(m) * (y1 - y0));
+            for (int x = 0; x < m; x++)
+                for (int y = y0; y < y1; y++)
+                    columns[size_t(y - y0) * m + x] = a[x][y];
+            for (int y = y0; y < y1; y++)
+                transform_1d(t.tx, t.isgn, &columns[size_t(y - y0) * m]);
+            for (int x = 0; x < m; x++)
+                for (int y = y0; y < y1; y++)
+                    a[x][y] = columns[size_t(y - y0) * m + x];
+        });
+    }
+
+    // Solve for the electrostatic potential and field of every group
+    void run_fft()
     {
         // get data into form that fft wants
-        auto &g = groups.at(group);
-        for (auto entry : g.density)
-            g.density_fft.at(entry.x, entry.y) = entry.value;
-        if (fft_debug || dump_density)
-            g.density_fft.write_csv(stringf("out_bin_density_%d_%d.csv", iter, group));
+        std::vector<Transform2D> transforms;
+        for (int group = 0; group < int(groups.size()); group++) {
+            auto &g = groups.at(group);
+            for (auto entry : g.density)
+                g.density_fft.at(entry.x, entry.y) = entry.value;
+            if (fft_debug || dump_density)
+                g.density_fft.write_csv(stringf("out_bin_density_%d_%d.csv", iter, group));
+            transforms.push_back({&g.density_fft, Transform1D::DCT, Transform1D::DCT, -1});
+        }
         // Based on
         // https://github.com/ALIGN-analoglayout/ALIGN-public/blob/master/PlaceRouteHierFlow/EA_placer/FFT/fft.cpp
         // initial DCT for coefficients
-        ddct2d(m, m, -1, g.density_fft.data(), nullptr, work_area_fft.data(), cs_table_fft.data());
+        run_transforms(transforms);
+        pool.run(groups.size(), [&](int group) { scale_fft_coefficients(groups.at(group)); });
+        // IDCT for potential; 2D derivatives for field
+        transforms.clear();
+        for (auto &g : groups) {
+            transforms.push_back({&g.electro_phi, Transform1D::DCT, Transform1D::DCT, 1});
+            transforms.push_back({&g.electro_fx, Transform1D::DST, Transform1D::DCT, 1});
+            transforms.push_back({&g.electro_fy, Transform1D::DCT, Transform1D::DST, 1});
+        }
+        run_transforms(transforms);
+        if (fft_debug) {
+            for (int group = 0; group < int(groups.size()); group++) {
+                auto &g = groups.at(group);
+                g.electro_phi.write_csv(stringf("out_bin_phi_%d_%d.csv", iter, group));
+                g.electro_fx.write_csv(stringf("out_bin_ex_%d_%d.csv", iter, group));
+                g.electro_fy.write_csv(stringf("out_bin_ey_%d_%d.csv", iter, group));
+            }
+        }
+    }
+
+    void scale_fft_coefficients(PlacerGroup &g)
+    {
         // postprocess coefficients
         for (int x = 0; x < m; x++)
             g.density_fft.at(x, 0) *= 0.5f;
@@ -852,15 +909,6 @@ class StaticPlacer
                 g.electro_fy.at(x, y) = ey;
             }
         }
-        // IDCT for potential; 2D derivatives for field
-        ddct2d(m, m, 1, g.electro_phi.data(), nullptr, work_area_fft.data(), cs_table_fft.data());
-        ddsct2d(m, m, 1, g.electro_fx.data(), nullptr, work_area_fft.data(), cs_table_fft.data());
-        ddcst2d(m, m, 1, g.electro_fy.data(), nullptr, work_area_fft.data(), cs_table_fft.data());
-        if (fft_debug) {
-            g.electro_phi.write_csv(stringf("out_bin_phi_%d_%d.csv", iter, group));
-            g.electro_fx.write_csv(stringf("out_bin_ex_%d_%d.csv", iter, group));
-            g.electro_fy.write_csv(stringf("out_bin_ey_%d_%d.csv", iter, group));
-        }
     }
 
     void compute_bounds(PlacerNet &net, Axis axis, bool ref)
@@ -980,14 +1028,45 @@ class StaticPlacer
     std::vector<float> dens_penalty;
     float nesterov_a = 1.0f;
 
+    // Time spent in each part of the ePlace iterations
+    struct StepTimes
+    {
+        double density = 0, fft = 0, wirelen = 0, gradients = 0, timing = 0;
+
+        void operator+=(const StepTimes &other)
+        {
+            density += other.density;
+            fft += other.fft;
+            wirelen += other.wirelen;
+            gradients += other.gradients;
+            timing += other.timing;
+        }
+        std::string to_string() const
+        {
+            return stringf("density %.03fs, FFT %.03fs, wirelength %.03fs, other gradients %.03fs, timing %.03fs",
+                           density, fft, wirelen, gradients, timing);
+        }
+    };
+    StepTimes step_times, total_times;
+
+    static double elapsed_since(std::chrono::high_resolution_clock::time_point &startt)
+    {
+        auto endt = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double>(endt - startt).count();
+        startt = endt;
+        return elapsed;
+    }
+
     void update_gradients(bool ref = true, bool set_prev = true, bool init_penalty = false)
     {
+        auto startt = std::chrono::high_resolution_clock::now();
         // TODO: skip non-group cells more efficiently?
-        pool.run(groups.size(), [&](int group) {
-            compute_density(group, ref);
-            run_fft(group);
-        });
+        pool.run(groups.size(), [&](int group) { compute_density(group, ref); });
+        step_times.density += elapsed_since(startt);
+        run_fft();
+        step_times.fft += elapsed_since(startt);
         update_nets(ref);
+        step_times.wirelen += elapsed_since(startt);
         // First loop: back up gradients if required; set to zero; and compute density gradient
         for (auto &cell : mcells) {
             auto &g = groups.at(cell.group);
@@ -1007,6 +1086,7 @@ class StaticPlacer
             // total gradient computed at the end
             (ref ? cell.ref_total_grad : cell.total_grad) = RealPair(0, 0);
         }
+        step_times.gradients += elapsed_since(startt);
         if (gathered_wirelen_grad.empty()) {
             for (auto &cell : ctx->cells) {
                 CellInfo *ci = cell.second.get();
@@ -1023,6 +1103,7 @@ class StaticPlacer
             float wl_gy = wirelen_grad(ci, Axis::Y, ref);
             entry.second = RealPair(wl_gx, wl_gy);
         });
+        step_times.wirelen += elapsed_since(startt);
         // Second loop: sum up wirelength gradients across concrete cell instances
         for (auto entry : gathered_wirelen_grad) {
             auto &mc = mcells.at(entry.first->udata);
@@ -1063,6 +1144,7 @@ class StaticPlacer
                 cell.total_grad = ((cell.wl_grad * -1) - cell.dens_grad * dens_penalty[cell.group]) / precond;
             }
         }
+        step_times.gradients += elapsed_since(startt);
     }
 
     float steplen = 0.01;
@@ -1280,8 +1362,15 @@ class StaticPlacer
         }
         log_info("   system potential: %f hpwl: %f\n", system_potential(), system_hpwl());
         compute_overlap();
-        if ((iter % 10) == 0)
+        if ((iter % 10) == 0) {
+            auto startt = std::chrono::high_resolution_clock::now();
             update_timing();
+            step_times.timing += elapsed_since(startt);
+        }
+        if (ctx->verbose)
+            log_info("   time: %s\n", step_times.to_string().c_str());
+        total_times += step_times;
+        step_times = StepTimes();
     }
 
     void update_timing()
@@ -1346,40 +1435,241 @@ class StaticPlacer
         }
     }
 
-    void enqueue_legalise(int cell_idx)
+    std::pair<int, IdString> legalise_entry(int cell_idx) const
     {
         NPNR_ASSERT(cell_idx < int(ccells.size())); // we should never be legalising spacers or dark nodes
         auto &ccell = ccells.at(cell_idx);
         if (ccell.macro_idx != -1) {
             // is a macro
             auto &macro = macros.at(ccell.macro_idx);
-            to_legalise.emplace(int(macro.cells.size()), macro.root->name);
+            return {int(macro.cells.size()), macro.root->name};
         } else {
-            to_legalise.emplace(1, ccell.base_cell->name);
+            return {1, ccell.base_cell->name};
         }
     }
 
-    void enqueue_legalise(CellInfo *ci)
+    std::pair<int, IdString> legalise_entry(CellInfo *ci) const
     {
         if (ci->udata != -1) {
             // managed by static
-            enqueue_legalise(ci->udata);
+            return legalise_entry(ci->udata);
         } else {
             // special case
-            to_legalise.emplace(1, ci->name);
+            return {1, ci->name};
         }
     }
+
+    void enqueue_legalise(int cell_idx) { to_legalise.push(legalise_entry(cell_idx)); }
+
+    void enqueue_legalise(CellInfo *ci) { to_legalise.push(legalise_entry(ci)); }
+
+    // State for legalising either the whole device serially, or one region of it in parallel with the others
+    struct LegaliseRegion
+    {
+        // Bounds in bel grid coordinates
+        int x0, y0, x1, y1;
+        int max_radius;
+        int cell_count = 0;
+        std::priority_queue<std::pair<int, IdString>> queue;
+        DeterministicRNG *rng;
+        // Only set for regions legalised in parallel
+        std::mutex *arch_mutex = nullptr;
+        DeterministicRNG region_rng;
+        // Where cells were placed, applied to mcells once all regions are done so that regions only ever see the
+        // positions of cells in other regions from before they started
+        dict<int32_t, RealPair> placed_pos;
+        // Cells that couldn't be placed within the region
+        std::vector<IdString> deferred;
+    };
+
     // Strict placement legalisation, performed after the initial HeAP spreading
+    //
+    // For large designs, the bel grid is split into regions that are legalised in parallel, each with its own queue
+    // and only using the bels inside it. Macros spanning several tiles, cells with region constraints and special cells
+    // are legalised serially beforehand; cells that couldn't be placed within their region (usually because they are
+    // close to its edge and it is full) are legalised serially at the end.
     void legalise_placement_strict(bool require_validity = true)
+    {
+        LegaliseRegion all;
+        all.x0 = 0;
+        all.y0 = 0;
+        all.x1 = bel_width + 1;
+        all.y1 = bel_height + 1;
+        all.max_radius = std::max(bel_width + 1, bel_height + 1);
+        all.cell_count = int(ccells.size());
+        all.rng = ctx;
+
+        std::vector<std::pair<int, IdString>> entries;
+        for (; !to_legalise.empty(); to_legalise.pop())
+            entries.push_back(to_legalise.top());
+        std::vector<int> x_cuts, y_cuts;
+        auto regions = setup_legalise_regions(entries, x_cuts, y_cuts);
+        int nx = int(x_cuts.size()) - 1;
+        for (auto &entry : entries) {
+            CellInfo *ci = ctx->cells.at(entry.second).get();
+            int r = -1;
+            if (!regions.empty() && legalise_in_region(ci)) {
+                Loc loc = legalise_target(ci, all);
+                int rx = int(std::upper_bound(x_cuts.begin(), x_cuts.end(), loc.x) - x_cuts.begin()) - 1;
+                int ry = int(std::upper_bound(y_cuts.begin(), y_cuts.end(), loc.y) - y_cuts.begin()) - 1;
+                r = ry * nx + rx;
+            }
+            if (r == -1) {
+                all.queue.push(entry);
+            } else {
+                regions.at(r).queue.push(entry);
+                regions.at(r).cell_count++;
+            }
+        }
+        legalise_queue(all, require_validity);
+
+        if (!regions.empty()) {
+            // Make sure the fast bels tables exist for any cell that might be legalised, as they are built lazily
+            FastBels::FastBelsData *fb;
+            for (auto &cell : ctx->cells)
+                if (!cell.second->isPseudo())
+                    fast_bels.getBelsForCellType(cell.second->type, &fb);
+            pool.run(int(regions.size()), [&](int i) { legalise_queue(regions.at(i), require_validity); });
+            int region_cells = 0, deferred_count = 0;
+            for (auto &region : regions) {
+                for (auto &entry : region.placed_pos) {
+                    auto &mc = mcells.at(entry.first);
+                    mc.pos = mc.ref_pos = entry.second;
+                    mc.is_fixed = true;
+                }
+                for (auto name : region.deferred)
+                    all.queue.push(legalise_entry(ctx->cells.at(name).get()));
+                region_cells += region.cell_count;
+                deferred_count += int(region.deferred.size());
+            }
+            if (ctx->verbose)
+                log_info("    legalised %d cells in %d regions in parallel, %d left for the serial pass\n",
+                         region_cells, int(regions.size()), deferred_count);
+            legalise_queue(all, require_validity);
+        }
+    }
+
+    // Split the bel grid into regions to legalise in parallel, or none if it's not worth it. The cuts are placed so
+    // that the regions get similar numbers of cells.
+    std::vector<LegaliseRegion> setup_legalise_regions(const std::vector<std::pair<int, IdString>> &entries,
+                                                       std::vector<int> &x_cuts, std::vector<int> &y_cuts)
+    {
+        std::vector<LegaliseRegion> regions;
+        if (pool.size() <= 1 || entries.size() < 500)
+            return regions;
+        LegaliseRegion all;
+        std::vector<int> xs, ys;
+        for (auto &entry : entries) {
+            CellInfo *ci = ctx->cells.at(entry.second).get();
+            if (!legalise_in_region(ci))
+                continue;
+            Loc loc = legalise_target(ci, all);
+            xs.push_back(loc.x);
+            ys.push_back(loc.y);
+        }
+        if (xs.size() < 500)
+            return regions;
+        // Aim for a couple of regions per thread for load balancing, but no narrower than min_region_size
+        const int min_region_size = 4;
+        int grid = int(std::ceil(std::sqrt(2.0 * pool.size())));
+        auto make_cuts = [&](std::vector<int> &coords, int size) {
+            std::sort(coords.begin(), coords.end());
+            std::vector<int> cuts{0};
+            for (int i = 1; i < grid; i++) {
+                int c = coords.at((i * coords.size()) / grid);
+                if (c - cuts.back() >= min_region_size && size - c >= min_region_size)
+                    cuts.push_back(c);
+            }
+            cuts.push_back(size);
+            return cuts;
+        };
+        x_cuts = make_cuts(xs, bel_width);
+        y_cuts = make_cuts(ys, bel_height);
+        if (x_cuts.size() * y_cuts.size() < 6)
+            return regions;
+        regions.resize((x_cuts.size() - 1) * (y_cuts.size() - 1));
+        for (int ry = 0; ry < int(y_cuts.size()) - 1; ry++)
+            for (int rx = 0; rx < int(x_cuts.size()) - 1; rx++) {
+                auto &region = regions.at(ry * (x_cuts.size() - 1) + rx);
+                region.x0 = x_cuts.at(rx);
+                region.x1 = x_cuts.at(rx + 1) - 1;
+                region.y0 = y_cuts.at(ry);
+                region.y1 = y_cuts.at(ry + 1) - 1;
+                region.max_radius = std::max(region.x1 - region.x0, region.y1 - region.y0);
+                region.region_rng.rngseed(ctx->rng64());
+                region.rng = &region.region_rng;
+                region.arch_mutex = &legalise_mutex;
+            }
+        return regions;
+    }
+
+    // Whether a cell can be legalised in a region in parallel: not special, without a region constraint, and if a macro
+    // then one that fits in a single tile
+    bool legalise_in_region(CellInfo *ci) const
+    {
+        if (ci->udata == -1 || ci->region != nullptr)
+            return false;
+        auto &ccell = ccells.at(ci->udata);
+        if (ccell.macro_idx != -1) {
+            for (auto &entry : macros.at(ccell.macro_idx).cells) {
+                if (entry.first.dx != 0 || entry.first.dy != 0)
+                    return false;
+                for (auto cell : entry.second)
+                    if (cell->region != nullptr)
+                        return false;
+            }
+        }
+        return true;
+    }
+
+    // The bel grid location that a cell would like to be legalised at
+    Loc legalise_target(CellInfo *ci, const LegaliseRegion &r) const
+    {
+        if (ci->udata == -1)
+            return Loc(bel_width / 2, bel_height / 2, 0);
+        RealPair pos = legalise_pos(ci->udata, r);
+        int cx = place_x_to_bel_x.at(std::max(0, std::min(int(pos.x), width - 1)));
+        int cy = place_y_to_bel_y.at(std::max(0, std::min(int(pos.y), height - 1)));
+        return Loc(cx, cy, 0);
+    }
+
+    RealPair legalise_pos(int32_t cell_idx, const LegaliseRegion &r) const
+    {
+        auto fnd = r.placed_pos.find(cell_idx);
+        return (fnd != r.placed_pos.end()) ? fnd->second : mcells.at(cell_idx).pos;
+    }
+
+    void set_legalised_pos(CellInfo *ci, Loc loc, LegaliseRegion &r)
+    {
+        if (ci->udata == -1)
+            return;
+        if (r.arch_mutex != nullptr) {
+            r.placed_pos[ci->udata] = RealPair(loc, 0.5);
+        } else {
+            auto &mc = mcells.at(ci->udata);
+            mc.pos = mc.ref_pos = RealPair(loc, 0.5);
+            mc.is_fixed = true;
+        }
+    }
+
+    // Arch API calls are serialised between regions legalised in parallel, as for parallel_refine
+    std::unique_lock<std::mutex> lock_arch(const LegaliseRegion &r)
+    {
+        return r.arch_mutex != nullptr ? std::unique_lock<std::mutex>(*r.arch_mutex) : std::unique_lock<std::mutex>();
+    }
+
+    // Legalise everything in a region's queue
+    void legalise_queue(LegaliseRegion &r, bool require_validity)
     {
         // At the moment we don't follow the full HeAP algorithm using cuts for legalisation, instead using
         // the simple greedy largest-macro-first approach.
         int ripup_radius = 2;
         int total_iters = 0;
         int total_iters_noreset = 0;
-        while (!to_legalise.empty()) {
-            auto top = to_legalise.top();
-            to_legalise.pop();
+        int iter_limit = std::max(5000, 8 * int(r.arch_mutex == nullptr ? ctx->cells.size() : r.cell_count));
+        while (!r.queue.empty()) {
+            auto top = r.queue.top();
+            r.queue.pop();
 
             CellInfo *ci = ctx->cells.at(top.second).get();
             // Was now placed, ignore
@@ -1388,6 +1678,7 @@ class StaticPlacer
             // log_info("   Legalising %s (%s) %d\n", top.second.c_str(ctx), ci->type.c_str(ctx), top.first);
             FastBels::FastBelsData *fb;
             fast_bels.getBelsForCellType(ci->type, &fb);
+            const BelGrid &grid = fast_bels.getGridForCellType(ci->type);
             int radius = 0;
             int iter = 0;
             int iter_at_radius = 0;
@@ -1397,12 +1688,19 @@ class StaticPlacer
 
             total_iters++;
             total_iters_noreset++;
-            if (total_iters > int(ccells.size())) {
+            if (total_iters > r.cell_count) {
                 total_iters = 0;
-                ripup_radius = std::min(std::max(bel_width + 1, bel_height + 1), ripup_radius * 2);
+                ripup_radius = std::min(r.max_radius, ripup_radius * 2);
             }
 
-            if (total_iters_noreset > std::max(5000, 8 * int(ctx->cells.size()))) {
+            if (total_iters_noreset > iter_limit) {
+                if (r.arch_mutex != nullptr) {
+                    // Leave this and everything else still queued to the serial pass
+                    r.deferred.push_back(ci->name);
+                    for (; !r.queue.empty(); r.queue.pop())
+                        r.deferred.push_back(r.queue.top().second);
+                    break;
+                }
                 log_error("Unable to find legal placement for all cells, design is probably at utilisation limit.\n");
             }
 
@@ -1412,16 +1710,8 @@ class StaticPlacer
                 int rx = radius, ry = radius;
 
                 // Pick a random X and Y location within our search radius
-                int cx, cy;
-                if (ci->udata == -1) {
-                    cx = bel_width / 2;
-                    cy = bel_height / 2;
-                } else {
-                    cx = int(mcells.at(ci->udata).pos.x);
-                    cy = int(mcells.at(ci->udata).pos.y);
-                    cx = place_x_to_bel_x.at(std::max(0, std::min(cx, width - 1)));
-                    cy = place_y_to_bel_y.at(std::max(0, std::min(cy, height - 1)));
-                }
+                Loc target = legalise_target(ci, r);
+                int cx = target.x, cy = target.y;
 
                 int x0 = std::max(cx - rx, 0);
                 int y0 = std::max(cy - ry, 0);
@@ -1429,42 +1719,42 @@ class StaticPlacer
                 int y1 = cy + ry;
 
                 if (ci->region != nullptr) {
-                    auto &r = constraint_region_bounds_bel[ci->region->name];
+                    auto &cr = constraint_region_bounds_bel[ci->region->name];
                     // Clamp search box to a region
-                    x0 = std::max(x0, r.x0);
-                    y0 = std::max(y0, r.y0);
-                    x1 = std::min(x1, r.x1);
-                    y1 = std::min(y1, r.y1);
+                    x0 = std::max(x0, cr.x0);
+                    y0 = std::max(y0, cr.y0);
+                    x1 = std::min(x1, cr.x1);
+                    y1 = std::min(y1, cr.y1);
                     if (x0 > x1)
                         std::swap(x0, x1);
                     if (y0 > y1)
                         std::swap(y0, y1);
                 }
+                if (r.arch_mutex != nullptr) {
+                    // Also clamp to the part of the grid being legalised
+                    x0 = std::max(x0, r.x0);
+                    y0 = std::max(y0, r.y0);
+                    x1 = std::min(x1, r.x1);
+                    y1 = std::min(y1, r.y1);
+                }
 
-                int nx = ctx->rng(x1 - x0 + 1) + x0;
-                int ny = ctx->rng(y1 - y0 + 1) + y0;
+                int nx = r.rng->rng(x1 - x0 + 1) + x0;
+                int ny = r.rng->rng(y1 - y0 + 1) + y0;
 
                 iter++;
                 iter_at_radius++;
                 if (iter >= (10 * (radius + 1))) {
-                    // No luck yet, increase radius
-                    radius = std::min(std::max(bel_width + 1, bel_height + 1), radius + 1);
-                    while (radius < std::max(bel_width + 1, bel_height + 1)) {
-                        // Keep increasing the radius until it will actually increase the number of cells we are
-                        // checking (e.g. BRAM and DSP will not be in all cols/rows), so we don't waste effort
-                        for (int x = std::max(0, cx - radius); x <= std::min(bel_width + 1, cx + radius); x++) {
-                            if (x >= int(fb->size()))
-                                break;
-                            for (int y = std::max(0, cy - radius); y <= std::min(bel_height + 1, cy + radius); y++) {
-                                if (y >= int(fb->at(x).size()))
-                                    break;
-                                if (fb->at(x).at(y).size() > 0)
-                                    goto notempty;
-                            }
-                        }
-                        radius = std::min(std::max(bel_width + 1, bel_height + 1), radius + 1);
+                    if (r.arch_mutex != nullptr && radius >= r.max_radius) {
+                        // Searched the whole region without luck, leave it to the serial pass
+                        r.deferred.push_back(ci->name);
+                        break;
                     }
-                notempty:
+                    // No luck yet, increase radius
+                    radius = std::min(r.max_radius, radius + 1);
+                    // Keep increasing the radius until it will actually increase the number of cells we are
+                    // checking (e.g. BRAM and DSP will not be in all cols/rows), so we don't waste effort
+                    while (radius < r.max_radius && grid.count(cx - radius, cy - radius, cx + radius, cy + radius) == 0)
+                        radius = std::min(r.max_radius, radius + 1);
                     iter_at_radius = 0;
                     iter = 0;
                 }
@@ -1482,6 +1772,8 @@ class StaticPlacer
                 if (fb->at(nx).at(ny).empty())
                     continue;
 
+                auto lock = lock_arch(r);
+
                 // The number of attempts to find a location to try
                 int need_to_explore = 2 * radius;
 
@@ -1491,16 +1783,11 @@ class StaticPlacer
                     CellInfo *bound = ctx->getBoundBelCell(bestBel);
                     if (bound != nullptr) {
                         ctx->unbindBel(bound->bel);
-                        enqueue_legalise(bound);
+                        r.queue.push(legalise_entry(bound));
                     }
                     ctx->bindBel(bestBel, ci, STRENGTH_WEAK);
                     placed = true;
-                    Loc loc = get_place_loc(ctx->getBelLocation(bestBel));
-                    if (ci->udata != -1) {
-                        auto &mc = mcells.at(ci->udata);
-                        mc.pos = mc.ref_pos = RealPair(loc, 0.5);
-                        mc.is_fixed = true;
-                    }
+                    set_legalised_pos(ci, get_place_loc(ctx->getBelLocation(bestBel)), r);
                     break;
                 }
 
@@ -1512,12 +1799,15 @@ class StaticPlacer
                             continue;
                         // Prefer available bels; unless we are dealing with a wide radius (e.g. difficult control sets)
                         // or occasionally trigger a tiebreaker
-                        if (ctx->checkBelAvail(sz) || (radius > ripup_radius || ctx->rng(20000) < 10)) {
+                        if (ctx->checkBelAvail(sz) || (radius > ripup_radius || r.rng->rng(20000) < 10)) {
                             CellInfo *bound = ctx->getBoundBelCell(sz);
                             if (bound != nullptr) {
-                                // Only rip up cells without constraints
+                                // Only rip up cells without constraints, and when legalising a region only those that
+                                // it can legalise again itself
                                 if (bound->cluster != ClusterId())
                                     continue;
+                                if (r.arch_mutex != nullptr && !legalise_in_region(bound))
+                                    continue;
                                 ctx->unbindBel(bound->bel);
                             }
                             // Provisionally bind the bel
@@ -1543,8 +1833,8 @@ class StaticPlacer
                                     CellInfo *drv = p.net->driver.cell;
                                     if (drv->udata == -1)
                                         continue;
-                                    auto drv_loc = mcells.at(drv->udata);
-                                    input_len += std::abs(int(drv_loc.pos.x) - nx) + std::abs(int(drv_loc.pos.y) - ny);
+                                    RealPair drv_pos = legalise_pos(drv->udata, r);
+                                    input_len += std::abs(int(drv_pos.x) - nx) + std::abs(int(drv_pos.y) - ny);
                                 }
                                 if (input_len < best_inp_len) {
                                     best_inp_len = input_len;
@@ -1554,13 +1844,8 @@ class StaticPlacer
                             } else {
                                 // It's legal, and we've tried enough. Finish.
                                 if (bound != nullptr)
-                                    enqueue_legalise(bound);
-                                Loc loc = get_place_loc(ctx->getBelLocation(sz));
-                                if (ci->udata != -1) {
-                                    auto &mc = mcells.at(ci->udata);
-                                    mc.pos = mc.ref_pos = RealPair(loc, 0.5);
-                                    mc.is_fixed = true;
-                                }
+                                    r.queue.push(legalise_entry(bound));
+                                set_legalised_pos(ci, get_place_loc(ctx->getBelLocation(sz)), r);
                                 placed = true;
                                 break;
                             }
@@ -1581,11 +1866,19 @@ class StaticPlacer
                             // Check it satisfies the region constraint if applicable
                             if (!target.first->testRegion(target.second))
                                 goto fail;
+                            if (r.arch_mutex != nullptr) {
+                                Loc loc = ctx->getBelLocation(target.second);
+                                if (loc.x < r.x0 || loc.x > r.x1 || loc.y < r.y0 || loc.y > r.y1)
+                                    goto fail;
+                            }
                             CellInfo *bound = ctx->getBoundBelCell(target.second);
                             // Chains cannot overlap; so if we have to ripup a cell make sure it isn't part of a chain
-                            if (bound != nullptr)
+                            if (bound != nullptr) {
                                 if (bound->cluster != ClusterId() || bound->belStrength > STRENGTH_WEAK)
                                     goto fail;
+                                if (r.arch_mutex != nullptr && !legalise_in_region(bound))
+                                    goto fail;
+                            }
                         }
                         // Actually perform the move; keeping track of the moves we make so we can revert them if needed
                         for (auto &target : targets) {
@@ -1613,17 +1906,14 @@ class StaticPlacer
                         }
                         for (auto &target : targets) {
                             Loc loc = get_place_loc(ctx->getBelLocation(target.second));
-                            if (ci->udata != -1) {
-                                auto &mc = mcells.at(target.first->udata);
-                                mc.pos = mc.ref_pos = RealPair(loc, 0.5);
-                                mc.is_fixed = true;
-                            }
+                            if (ci->udata != -1)
+                                set_legalised_pos(target.first, loc, r);
                             // log_info("%s %d %d %d\n", target.first->name.c_str(ctx), loc.x, loc.y, loc.z);
                         }
                         for (auto &swap : swaps_made) {
                             // Where we have ripped up cells; add them to the queue
                             if (swap.second != nullptr)
-                                enqueue_legalise(swap.second);
+                                r.queue.push(legalise_entry(swap.second));
                         }
 
                         placed = true;
@@ -1636,10 +1926,11 @@ class StaticPlacer
 
   public:
     StaticPlacer(Context *ctx, PlacerStaticCfg cfg)
-            : ctx(ctx), cfg(cfg), fast_bels(ctx, true, 8), tmg(ctx), pool(ctx->setting<int>("threads", 8))
+            : ctx(ctx), cfg(cfg), fast_bels(ctx, true, 8), tmg(ctx), pool(ctx->get_thread_pool())
     {
         groups.resize(cfg.cell_groups.size());
         tmg.setup_only = true;
+        tmg.incremental = true;
         tmg.setup();
         dump_density = ctx->setting<bool>("static/dump_density", false);
     };
@@ -1650,6 +1941,8 @@ class StaticPlacer
         init_bels();
         prepare_cells();
         init_cells();
+        if (cfg.multilevel)
+            seed_multilevel();
         init_nets();
         insert_dark();
         insert_spacer();
@@ -1698,6 +1991,7 @@ class StaticPlacer
                 }
                 ++iter;
             }
+            log_info("Time spent in %d iterations: %s\n", iter + 1, total_times.to_string().c_str());
         }
         {
             auto placer1_cfg = Placer1Cfg(ctx);
@@ -1718,6 +2012,7 @@ bool placer_static(Context *ctx, PlacerStaticCfg cfg)
 PlacerStaticCfg::PlacerStaticCfg(Context *ctx)
 {
     timing_driven = ctx->setting<bool>("timing_driven");
+    multilevel = ctx->setting<bool>("static/multilevel", false);
 
     hpwl_scale_x = 1;
     hpwl_scale_y = 1;
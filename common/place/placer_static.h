@@ -61,6 +61,8 @@ struct PlacerStaticCfg
     int hpwl_scale_x = 1;
     int hpwl_scale_y = 1;
     bool timing_driven = false;
+    // start from a multilevel placement (see placer_multilevel.h) rather than a random one
+    bool multilevel = false;
     // for calculating timing estimates based on distance
     // estimate = c + mx*dx + my * dy
     delay_t timing_c = 100, timing_mx = 100, timing_my = 100;
@@ -421,21 +421,24 @@ class TimingOptimiser
             }
         }
 
-        // Actual BFS path optimisation algorithm
-        dict<IdString, dict<BelId, delay_t>> cumul_costs;
-        dict<std::pair<IdString, BelId>, std::pair<IdString, BelId>> backtrace;
+        // Actual BFS path optimisation algorithm. Cells are referred to by their index in path_cells.
+        std::vector<CellInfo *> path_cell_info;
+        for (auto cell : path_cells)
+            path_cell_info.push_back(ctx->cells.at(cell).get());
+        std::vector<dict<BelId, delay_t>> cumul_costs(path_cells.size());
+        dict<std::pair<int, BelId>, std::pair<int, BelId>> backtrace;
         std::queue<std::pair<int, BelId>> visit;
         pool<std::pair<int, BelId>> to_visit;
 
         for (auto startbel : cell_neighbour_bels[path_cells.front()]) {
             // Swap for legality check
-            CellInfo *cell = ctx->cells.at(path_cells.front()).get();
+            CellInfo *cell = path_cell_info.front();
             BelId origBel = cell_swap_bel(cell, startbel);
             std::vector<std::pair<CellInfo *, BelId>> move{std::make_pair(cell, origBel)};
             if (acceptable_move(move)) {
                 auto entry = std::make_pair(0, startbel);
                 visit.push(entry);
-                cumul_costs[path_cells.front()][startbel] = 0;
+                cumul_costs.front()[startbel] = 0;
             }
             // Swap back
             cell_swap_bel(cell, origBel);
@@ -444,22 +447,21 @@ class TimingOptimiser
         while (!visit.empty()) {
             auto entry = visit.front();
             visit.pop();
-            auto cellname = path_cells.at(entry.first);
             if (entry.first == int(path_cells.size()) - 1)
                 continue;
             std::vector<std::pair<CellInfo *, BelId>> move;
             // Apply the entire backtrace for accurate legality and delay checks
             // This is probably pretty expensive (but also probably pales in comparison to the number of swaps
             // SA will make...)
-            std::vector<std::pair<IdString, BelId>> route_to_entry;
-            auto cursor = std::make_pair(cellname, entry.second);
+            std::vector<std::pair<int, BelId>> route_to_entry;
+            auto cursor = entry;
             route_to_entry.push_back(cursor);
             while (backtrace.count(cursor)) {
                 cursor = backtrace.at(cursor);
                 route_to_entry.push_back(cursor);
             }
             for (auto rt_entry : boost::adaptors::reverse(route_to_entry)) {
-                CellInfo *cell = ctx->cells.at(rt_entry.first).get();
+                CellInfo *cell = path_cell_info.at(rt_entry.first);
                 BelId origBel = cell_swap_bel(cell, rt_entry.second);
                 move.push_back(std::make_pair(cell, origBel));
             }
@@ -470,8 +472,8 @@ class TimingOptimiser
                 if (neighbour == entry.second)
                     continue;
                 // Experimentally swap the next path cell onto the neighbour bel we are trying
-                IdString ncname = path_cells.at(entry.first + 1);
-                CellInfo *next_cell = ctx->cells.at(ncname).get();
+                int next_idx = entry.first + 1;
+                CellInfo *next_cell = path_cell_info.at(next_idx);
                 BelId origBel = cell_swap_bel(next_cell, neighbour);
                 move.push_back(std::make_pair(next_cell, origBel));
 
@@ -488,14 +490,14 @@ class TimingOptimiser
 
                 // First, check if the move is actually worthwhile from a delay point of view before the expensive
                 // legality check
-                if (!cumul_costs.count(ncname) || !cumul_costs.at(ncname).count(neighbour) ||
-                    cumul_costs.at(ncname).at(neighbour) > total_delay) {
+                auto &next_costs = cumul_costs.at(next_idx);
+                if (!next_costs.count(neighbour) || next_costs.at(neighbour) > total_delay) {
                     // Now check that the swaps we have made to get here are legal and meet max delay requirements
                     if (acceptable_move(move)) {
-                        cumul_costs[ncname][neighbour] = total_delay;
-                        backtrace[std::make_pair(ncname, neighbour)] = std::make_pair(cellname, entry.second);
-                        if (!to_visit.count(std::make_pair(entry.first + 1, neighbour)))
-                            visit.push(std::make_pair(entry.first + 1, neighbour));
+                        next_costs[neighbour] = total_delay;
+                        backtrace[std::make_pair(next_idx, neighbour)] = entry;
+                        if (!to_visit.count(std::make_pair(next_idx, neighbour)))
+                            visit.push(std::make_pair(next_idx, neighbour));
                     }
                 }
                 // Revert the experimental swap
@@ -511,17 +513,17 @@ class TimingOptimiser
         }
 
         // Did we find a solution??
-        if (cumul_costs.count(path_cells.back())) {
+        if (!cumul_costs.back().empty()) {
             // Find the end position with the lowest total delay
-            auto &end_options = cumul_costs.at(path_cells.back());
+            auto &end_options = cumul_costs.back();
             auto lowest = std::min_element(end_options.begin(), end_options.end(),
                                            [](const std::pair<BelId, delay_t> &a, const std::pair<BelId, delay_t> &b) {
                                                return a.second < b.second;
                                            });
             NPNR_ASSERT(lowest != end_options.end());
 
-            std::vector<std::pair<IdString, BelId>> route_to_solution;
-            auto cursor = std::make_pair(path_cells.back(), lowest->first);
+            std::vector<std::pair<int, BelId>> route_to_solution;
+            auto cursor = std::make_pair(int(path_cells.size()) - 1, lowest->first);
             route_to_solution.push_back(cursor);
             while (backtrace.count(cursor)) {
                 cursor = backtrace.at(cursor);
@@ -531,10 +533,10 @@ class TimingOptimiser
                 log_info("Found a solution with cost %.02f ns (existing path %.02f ns)\n",
                          ctx->getDelayNS(lowest->second), ctx->getDelayNS(original_delay));
             for (auto rt_entry : boost::adaptors::reverse(route_to_solution)) {
-                CellInfo *cell = ctx->cells.at(rt_entry.first).get();
+                CellInfo *cell = path_cell_info.at(rt_entry.first);
                 cell_swap_bel(cell, rt_entry.second);
                 if (ctx->debug)
-                    log_info("    %s at %s\n", rt_entry.first.c_str(ctx), ctx->nameOfBel(rt_entry.second));
+                    log_info("    %s at %s\n", ctx->nameOf(cell), ctx->nameOfBel(rt_entry.second));
             }
 
         } else {
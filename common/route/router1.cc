@@ -108,11 +108,45 @@ struct Router1
     dict<arc_key, pool<WireId>> arc_to_wires;
     pool<arc_key> queued_arcs;
 
+    // Every net set up so far, and the source and sink wires of their arcs, to catch nets that share them
+    pool<NetInfo *, hash_ptr_ops> setup_nets;
+    dict<WireId, NetInfo *> src_to_net;
+    dict<WireId, arc_key> dst_to_arc;
+
     std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> queue;
 
-    dict<WireId, int> wireScores;
+    // indexed by getWireIndex()
+    std::vector<int> wireScores;
     dict<NetInfo *, int, hash_ptr_ops> netScores;
 
+    // A* visit data, indexed by getWireIndex(). Entries for wires not visited in the current search have
+    // wire == WireId()
+    std::vector<QueuedWire> visited;
+    std::vector<int> dirty_visited;
+
+    QueuedWire &visited_entry(WireId wire) { return visited.at(ctx->getWireIndex(wire)); }
+
+    const QueuedWire *get_visited(WireId wire)
+    {
+        const QueuedWire &entry = visited_entry(wire);
+        return entry.wire == WireId() ? nullptr : &entry;
+    }
+
+    void set_visited(const QueuedWire &qw)
+    {
+        int idx = ctx->getWireIndex(qw.wire);
+        if (visited.at(idx).wire == WireId())
+            dirty_visited.push_back(idx);
+        visited.at(idx) = qw;
+    }
+
+    void reset_visited()
+    {
+        for (int idx : dirty_visited)
+            visited.at(idx) = QueuedWire();
+        dirty_visited.clear();
+    }
+
     int arcs_with_ripup = 0;
     int arcs_without_ripup = 0;
     bool ripup_flag;
@@ -124,6 +158,8 @@ struct Router1
     Router1(Context *ctx, const Router1Cfg &cfg) : ctx(ctx), cfg(cfg), tmg(ctx)
     {
         timing_driven = ctx->setting<bool>("timing_driven");
+        wireScores.resize(ctx->getWireCount());
+        visited.resize(ctx->getWireCount());
         tmg.setup_only = false;
         tmg.with_clock_skew = true;
         tmg.setup();
@@ -190,6 +226,7 @@ struct Router1
         if (ctx->debug)
             log("      ripup net %s\n", ctx->nameOf(net));
 
+        setup_if_needed(net);
         netScores[net]++;
 
         std::vector<WireId> wires;
@@ -215,7 +252,7 @@ struct Router1
                 log("        unbind wire %s\n", ctx->nameOfWire(w));
 
             ctx->unbindWire(w);
-            wireScores[w]++;
+            wireScores.at(ctx->getWireIndex(w))++;
         }
 
         ripup_flag = true;
@@ -233,6 +270,7 @@ struct Router1
             if (n != nullptr)
                 ripup_net(n);
         } else {
+            setup_if_needed(ctx->getBoundWireNet(w));
             std::vector<arc_key> arcs;
             for (auto &it : wire_to_arcs[w]) {
                 arc_to_wires[it].erase(w);
@@ -248,8 +286,10 @@ struct Router1
             if (ctx->debug)
                 log("      unbind wire %s\n", ctx->nameOfWire(w));
 
-            ctx->unbindWire(w);
-            wireScores[w]++;
+            // Setting up the net above unbinds any of its wires that no arc uses, which may include this one
+            if (ctx->getBoundWireNet(w) != nullptr)
+                ctx->unbindWire(w);
+            wireScores.at(ctx->getWireIndex(w))++;
         }
 
         ripup_flag = true;
@@ -267,6 +307,7 @@ struct Router1
             if (n != nullptr)
                 ripup_net(n);
         } else {
+            setup_if_needed(ctx->getBoundWireNet(w));
             std::vector<arc_key> arcs;
             for (auto &it : wire_to_arcs[w]) {
                 arc_to_wires[it].erase(w);
@@ -282,8 +323,10 @@ struct Router1
             if (ctx->debug)
                 log("      unbind wire %s\n", ctx->nameOfWire(w));
 
-            ctx->unbindWire(w);
-            wireScores[w]++;
+            // Setting up the net above unbinds any of its wires that no arc uses, which may include this one
+            if (ctx->getBoundWireNet(w) != nullptr)
+                ctx->unbindWire(w);
+            wireScores.at(ctx->getWireIndex(w))++;
         }
 
         ripup_flag = true;
@@ -311,7 +354,7 @@ struct Router1
             NetInfo *net_info = net_it.second.get();
             pool<WireId> valid_wires_for_net;
 
-            if (skip_net(net_info))
+            if (skip_net(net_info) || !setup_nets.count(net_info))
                 continue;
 
 #if 0
@@ -367,12 +410,10 @@ struct Router1
 
     void setup()
     {
-        dict<WireId, NetInfo *> src_to_net;
-        dict<WireId, arc_key> dst_to_arc;
-
         std::vector<IdString> net_names;
         for (auto &net_it : ctx->nets)
-            net_names.push_back(net_it.first);
+            if (cfg.onlyNets.empty() || cfg.onlyNets.count(net_it.first))
+                net_names.push_back(net_it.first);
 
         ctx->sorted_shuffle(net_names);
 
@@ -382,90 +423,104 @@ struct Router1
             if (skip_net(net_info))
                 continue;
 
-            auto src_wire = ctx->getNetinfoSourceWire(net_info);
+            setup_net(net_info);
+        }
+    }
 
-            if (src_wire == WireId() && net_info->constant_value == IdString())
-                log_error("No wire found for port %s on source cell %s.\n", ctx->nameOf(net_info->driver.port),
-                          ctx->nameOf(net_info->driver.cell));
+    // Nets left out of the setup by onlyNets are set up when first ripped up, so that their arcs get requeued
+    void setup_if_needed(NetInfo *net_info)
+    {
+        if (net_info != nullptr && !cfg.onlyNets.empty() && !setup_nets.count(net_info) && !skip_net(net_info))
+            setup_net(net_info);
+    }
 
-            if (src_to_net.count(src_wire))
-                log_error("Found two nets with same source wire %s: %s vs %s\n", ctx->nameOfWire(src_wire),
-                          ctx->nameOf(net_info), ctx->nameOf(src_to_net.at(src_wire)));
+    // Queue the arcs of a net that aren't routed legally, and unbind any wires not used by its arcs
+    void setup_net(NetInfo *net_info)
+    {
+        setup_nets.insert(net_info);
+        auto src_wire = ctx->getNetinfoSourceWire(net_info);
 
-            if (dst_to_arc.count(src_wire))
-                log_error("Wire %s is used as source and sink in different nets: %s vs %s (%d)\n",
-                          ctx->nameOfWire(src_wire), ctx->nameOf(net_info),
-                          ctx->nameOf(dst_to_arc.at(src_wire).net_info), dst_to_arc.at(src_wire).user_idx.idx());
+        if (src_wire == WireId() && net_info->constant_value == IdString())
+            log_error("No wire found for port %s on source cell %s.\n", ctx->nameOf(net_info->driver.port),
+                      ctx->nameOf(net_info->driver.cell));
 
-            for (auto user : net_info->users.enumerate()) {
-                unsigned phys_idx = 0;
-                for (auto dst_wire : ctx->getNetinfoSinkWires(net_info, user.value)) {
-                    arc_key arc;
-                    arc.net_info = net_info;
-                    arc.user_idx = user.index;
-                    arc.phys_idx = phys_idx++;
+        if (src_to_net.count(src_wire))
+            log_error("Found two nets with same source wire %s: %s vs %s\n", ctx->nameOfWire(src_wire),
+                      ctx->nameOf(net_info), ctx->nameOf(src_to_net.at(src_wire)));
 
-                    if (dst_wire == WireId())
-                        log_error("No wire found for port %s on destination cell %s.\n", ctx->nameOf(user.value.port),
-                                  ctx->nameOf(user.value.cell));
+        if (dst_to_arc.count(src_wire))
+            log_error("Wire %s is used as source and sink in different nets: %s vs %s (%d)\n",
+                      ctx->nameOfWire(src_wire), ctx->nameOf(net_info),
+                      ctx->nameOf(dst_to_arc.at(src_wire).net_info), dst_to_arc.at(src_wire).user_idx.idx());
 
-                    if (dst_to_arc.count(dst_wire)) {
-                        if (dst_to_arc.at(dst_wire).net_info == net_info)
-                            continue;
-                        log_error("Found two arcs with same sink wire %s: %s (%d) vs %s (%d)\n",
-                                  ctx->nameOfWire(dst_wire), ctx->nameOf(net_info), user.index.idx(),
-                                  ctx->nameOf(dst_to_arc.at(dst_wire).net_info),
-                                  dst_to_arc.at(dst_wire).user_idx.idx());
-                    }
+        for (auto user : net_info->users.enumerate()) {
+            unsigned phys_idx = 0;
+            for (auto dst_wire : ctx->getNetinfoSinkWires(net_info, user.value)) {
+                arc_key arc;
+                arc.net_info = net_info;
+                arc.user_idx = user.index;
+                arc.phys_idx = phys_idx++;
+
+                if (dst_wire == WireId())
+                    log_error("No wire found for port %s on destination cell %s.\n", ctx->nameOf(user.value.port),
+                              ctx->nameOf(user.value.cell));
+
+                if (dst_to_arc.count(dst_wire)) {
+                    if (dst_to_arc.at(dst_wire).net_info == net_info)
+                        continue;
+                    log_error("Found two arcs with same sink wire %s: %s (%d) vs %s (%d)\n",
+                              ctx->nameOfWire(dst_wire), ctx->nameOf(net_info), user.index.idx(),
+                              ctx->nameOf(dst_to_arc.at(dst_wire).net_info),
+                              dst_to_arc.at(dst_wire).user_idx.idx());
+                }
 
-                    if (src_to_net.count(dst_wire))
-                        log_error("Wire %s is used as source and sink in different nets: %s vs %s (%d)\n",
-                                  ctx->nameOfWire(dst_wire), ctx->nameOf(src_to_net.at(dst_wire)),
-                                  ctx->nameOf(net_info), user.index.idx());
+                if (src_to_net.count(dst_wire))
+                    log_error("Wire %s is used as source and sink in different nets: %s vs %s (%d)\n",
+                              ctx->nameOfWire(dst_wire), ctx->nameOf(src_to_net.at(dst_wire)),
+                              ctx->nameOf(net_info), user.index.idx());
 
-                    dst_to_arc[dst_wire] = arc;
+                dst_to_arc[dst_wire] = arc;
 
-                    if (net_info->wires.count(dst_wire) == 0) {
+                if (net_info->wires.count(dst_wire) == 0) {
+                    arc_queue_insert(arc, src_wire, dst_wire);
+                    continue;
+                }
+
+                WireId cursor = dst_wire;
+                wire_to_arcs[cursor].insert(arc);
+                arc_to_wires[arc].insert(cursor);
+
+                while (src_wire != cursor && (net_info->constant_value == IdString() ||
+                                              ctx->getWireConstantValue(cursor) != net_info->constant_value)) {
+                    auto it = net_info->wires.find(cursor);
+                    if (it == net_info->wires.end()) {
                         arc_queue_insert(arc, src_wire, dst_wire);
-                        continue;
+                        break;
                     }
 
-                    WireId cursor = dst_wire;
+                    NPNR_ASSERT(it->second.pip != PipId());
+                    cursor = ctx->getPipSrcWire(it->second.pip);
                     wire_to_arcs[cursor].insert(arc);
                     arc_to_wires[arc].insert(cursor);
-
-                    while (src_wire != cursor && (net_info->constant_value == IdString() ||
-                                                  ctx->getWireConstantValue(cursor) != net_info->constant_value)) {
-                        auto it = net_info->wires.find(cursor);
-                        if (it == net_info->wires.end()) {
-                            arc_queue_insert(arc, src_wire, dst_wire);
-                            break;
-                        }
-
-                        NPNR_ASSERT(it->second.pip != PipId());
-                        cursor = ctx->getPipSrcWire(it->second.pip);
-                        wire_to_arcs[cursor].insert(arc);
-                        arc_to_wires[arc].insert(cursor);
-                    }
                 }
-                // TODO: this matches the situation before supporting multiple cell->bel pins, but do we want to keep
-                // this invariant?
-                if (phys_idx == 0)
-                    log_warning("No wires found for port %s on destination cell %s.\n", ctx->nameOf(user.value.port),
-                                ctx->nameOf(user.value.cell));
             }
+            // TODO: this matches the situation before supporting multiple cell->bel pins, but do we want to keep
+            // this invariant?
+            if (phys_idx == 0)
+                log_warning("No wires found for port %s on destination cell %s.\n", ctx->nameOf(user.value.port),
+                            ctx->nameOf(user.value.cell));
+        }
 
-            src_to_net[src_wire] = net_info;
+        src_to_net[src_wire] = net_info;
 
-            std::vector<WireId> unbind_wires;
+        std::vector<WireId> unbind_wires;
 
-            for (auto &it : net_info->wires)
-                if (it.second.strength < STRENGTH_LOCKED && wire_to_arcs.count(it.first) == 0)
-                    unbind_wires.push_back(it.first);
+        for (auto &it : net_info->wires)
+            if (it.second.strength < STRENGTH_LOCKED && wire_to_arcs.count(it.first) == 0)
+                unbind_wires.push_back(it.first);
 
-            for (auto it : unbind_wires)
-                ctx->unbindWire(it);
-        }
+        for (auto it : unbind_wires)
+            ctx->unbindWire(it);
     }
 
     bool route_arc(const arc_key &arc, bool ripup)
@@ -523,7 +578,7 @@ struct Router1
             std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> new_queue;
             queue.swap(new_queue);
         }
-        dict<WireId, QueuedWire> visited;
+        reset_visited();
 
         // A* main loop
 
@@ -546,7 +601,7 @@ struct Router1
             qw.randtag = ctx->rng();
 
             queue.push(qw);
-            visited[qw.wire] = qw;
+            set_visited(qw);
         }
 
         while (visitCnt++ < maxVisitCnt && !queue.empty()) {
@@ -629,16 +684,12 @@ struct Router1
                         conflictWireNet = nullptr;
 
                     if (conflictWireWire != WireId()) {
-                        auto scores_it = wireScores.find(conflictWireWire);
-                        if (scores_it != wireScores.end())
-                            penalty_delta += scores_it->second * cfg.wireRipupPenalty;
+                        penalty_delta += wireScores.at(ctx->getWireIndex(conflictWireWire)) * cfg.wireRipupPenalty;
                         penalty_delta += cfg.wireRipupPenalty;
                     }
 
                     if (conflictPipWire != WireId()) {
-                        auto scores_it = wireScores.find(conflictPipWire);
-                        if (scores_it != wireScores.end())
-                            penalty_delta += scores_it->second * cfg.wireRipupPenalty;
+                        penalty_delta += wireScores.at(ctx->getWireIndex(conflictPipWire)) * cfg.wireRipupPenalty;
                         penalty_delta += cfg.wireRipupPenalty;
                     }
 
@@ -667,10 +718,10 @@ struct Router1
                 if ((best_score >= 0) && (next_score - next_bonus - cfg.estimatePrecision > best_score))
                     continue;
 
-                auto old_visited_it = visited.find(next_wire);
-                if (old_visited_it != visited.end()) {
-                    delay_t old_delay = old_visited_it->second.delay;
-                    delay_t old_score = old_delay + old_visited_it->second.penalty;
+                const QueuedWire *old_visited = get_visited(next_wire);
+                if (old_visited != nullptr) {
+                    delay_t old_delay = old_visited->delay;
+                    delay_t old_score = old_delay + old_visited->penalty;
                     NPNR_ASSERT(old_score >= 0);
 
                     if (next_score + ctx->getDelayEpsilon() >= old_score)
@@ -681,7 +732,7 @@ struct Router1
                         log("Found better route to %s. Old vs new delay estimate: %.3f (%.3f) %.3f (%.3f)\n",
                             ctx->nameOfWire(next_wire),
                             ctx->getDelayNS(old_score),
-                            ctx->getDelayNS(old_visited_it->second.delay),
+                            ctx->getDelayNS(old_visited->delay),
                             ctx->getDelayNS(next_score),
                             ctx->getDelayNS(next_delay));
 #endif
@@ -712,7 +763,7 @@ struct Router1
                         ctx->getDelayNS(next_delay));
 #endif
 
-                visited[next_qw.wire] = next_qw;
+                set_visited(next_qw);
                 queue.push(next_qw);
 
                 if (next_wire == dst_wire) {
@@ -725,16 +776,16 @@ struct Router1
         if (ctx->debug)
             log("  total number of visited nodes: %d\n", visitCnt);
 
-        if (visited.count(dst_wire) == 0) {
+        if (get_visited(dst_wire) == nullptr) {
             if (ctx->debug)
                 log("  no route found for this arc\n");
             return false;
         }
 
         if (ctx->debug) {
-            log("  final route delay:   %8.2f\n", ctx->getDelayNS(visited[dst_wire].delay));
-            log("  final route penalty: %8.2f\n", ctx->getDelayNS(visited[dst_wire].penalty));
-            log("  final route bonus:   %8.2f\n", ctx->getDelayNS(visited[dst_wire].bonus));
+            log("  final route delay:   %8.2f\n", ctx->getDelayNS(visited_entry(dst_wire).delay));
+            log("  final route penalty: %8.2f\n", ctx->getDelayNS(visited_entry(dst_wire).penalty));
+            log("  final route bonus:   %8.2f\n", ctx->getDelayNS(visited_entry(dst_wire).bonus));
         }
 
         // bind resulting route (and maybe unroute other nets)
@@ -745,7 +796,7 @@ struct Router1
         delay_t accumulated_path_delay = 0;
         delay_t last_path_delay_delta = 0;
         while (1) {
-            auto pip = visited[cursor].pip;
+            auto pip = visited_entry(cursor).pip;
 
             if (ctx->debug) {
                 delay_t path_delay_delta = ctx->estimateDelay(cursor, dst_wire) - accumulated_path_delay;
@@ -854,7 +905,7 @@ struct Router1
             std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> new_queue;
             queue.swap(new_queue);
         }
-        dict<WireId, QueuedWire> visited;
+        reset_visited();
 
         // A* main loop
 
@@ -873,7 +924,7 @@ struct Router1
             qw.randtag = ctx->rng();
 
             queue.push(qw);
-            visited[qw.wire] = qw;
+            set_visited(qw);
         }
 
         while (visitCnt++ < maxVisitCnt && !queue.empty()) {
@@ -958,16 +1009,12 @@ struct Router1
                         conflictWireNet = nullptr;
 
                     if (conflictWireWire != WireId()) {
-                        auto scores_it = wireScores.find(conflictWireWire);
-                        if (scores_it != wireScores.end())
-                            penalty_delta += scores_it->second * cfg.wireRipupPenalty;
+                        penalty_delta += wireScores.at(ctx->getWireIndex(conflictWireWire)) * cfg.wireRipupPenalty;
                         penalty_delta += cfg.wireRipupPenalty;
                     }
 
                     if (conflictPipWire != WireId()) {
-                        auto scores_it = wireScores.find(conflictPipWire);
-                        if (scores_it != wireScores.end())
-                            penalty_delta += scores_it->second * cfg.wireRipupPenalty;
+                        penalty_delta += wireScores.at(ctx->getWireIndex(conflictPipWire)) * cfg.wireRipupPenalty;
                         penalty_delta += cfg.wireRipupPenalty;
                     }
 
@@ -996,8 +1043,8 @@ struct Router1
                 if ((best_score >= 0) && (next_score - next_bonus - cfg.estimatePrecision > best_score))
                     continue;
 
-                auto old_visited_it = visited.find(next_wire);
-                if (old_visited_it != visited.end()) {
+                const QueuedWire *old_visited = get_visited(next_wire);
+                if (old_visited != nullptr) {
                     continue;
                 }
 
@@ -1009,7 +1056,7 @@ struct Router1
                 next_qw.bonus = next_bonus;
                 next_qw.randtag = ctx->rng();
 
-                visited[next_qw.wire] = next_qw;
+                set_visited(next_qw);
                 queue.push(next_qw);
 
                 if (ctx->getWireConstantValue(next_wire) == net_info->constant_value) {
@@ -1032,9 +1079,9 @@ struct Router1
         }
 
         if (ctx->debug) {
-            log("  final route delay:   %8.2f\n", ctx->getDelayNS(visited[dst_wire].delay));
-            log("  final route penalty: %8.2f\n", ctx->getDelayNS(visited[dst_wire].penalty));
-            log("  final route bonus:   %8.2f\n", ctx->getDelayNS(visited[dst_wire].bonus));
+            log("  final route delay:   %8.2f\n", ctx->getDelayNS(visited_entry(dst_wire).delay));
+            log("  final route penalty: %8.2f\n", ctx->getDelayNS(visited_entry(dst_wire).penalty));
+            log("  final route bonus:   %8.2f\n", ctx->getDelayNS(visited_entry(dst_wire).bonus));
         }
 
         // bind resulting route (and maybe unroute other nets)
@@ -1055,7 +1102,7 @@ struct Router1
         arc_to_wires[arc].insert(cursor);
 
         while (1) {
-            auto pip = visited[cursor].pip;
+            auto pip = visited_entry(cursor).pip;
 
             if (pip == PipId()) {
                 NPNR_ASSERT(cursor == dst_wire);
@@ -1267,7 +1314,7 @@ bool router1(Context *ctx, const Router1Cfg &cfg)
                 log_info("    %d arcs ripped up due to negative slack WNS=%.02fns TNS=%.02fns.\n",
                          int(router.arc_queue.size()), ctx->getDelayNS(wns), ctx->getDelayNS(tns));
                 iter_cnt = 0;
-                router.wireScores.clear();
+                std::fill(router.wireScores.begin(), router.wireScores.end(), 0);
                 router.netScores.clear();
             }
         }
@@ -36,6 +36,10 @@ struct Router1Cfg
     delay_t netRipupPenalty;
     delay_t reuseBonus;
     delay_t estimatePrecision;
+
+    // If not empty, only the routing of these nets is checked and repaired up front. The other nets are taken to be
+    // routed legally, and are only set up if routing the others rips them up.
+    pool<IdString> onlyNets;
 };
 
 extern bool router1(Context *ctx, const Router1Cfg &cfg);
@@ -29,6 +29,7 @@
 #include "router2.h"
 
 #include <algorithm>
+#include <atomic>
 #include <boost/container/flat_map.hpp>
 #include <chrono>
 #include <deque>
@@ -38,6 +39,7 @@
 #include <queue>
 #include <set>
 
+#include "json11.hpp"
 #include "log.h"
 #include "nextpnr.h"
 #include "nextpnr_assertions.h"
@@ -47,6 +49,8 @@
 
 NEXTPNR_NAMESPACE_BEGIN
 
+using namespace json11;
+
 namespace {
 struct Router2
 {
@@ -71,6 +75,8 @@ struct Router2
         WireId src_wire;
         dict<WireId, std::pair<PipId, int>> wires;
         std::vector<std::vector<PerArcData>> arcs;
+        // Timing analyser index of the port of each user
+        std::vector<int> tmg_ports;
         dict<GroupId, NetResourceData> resources;
         BoundingBox bb;
         // Coordinates of the center of the net, used for the weight-to-average
@@ -88,23 +94,39 @@ struct Router2
         float total() const { return cost + togo_cost; }
     };
 
-    struct PerWireData
+    // Per-wire data is kept as a structure of arrays indexed by flat wire index (see flat_wire_idx), split by how
+    // it is accessed so that the search loop only touches the data it needs
+    struct WireLoc
     {
-        // nextpnr
-        WireId w;
-        // Historical congestion cost
-        int curr_cong = 0;
-        float hist_cong_cost = 1.0;
-        // Wire is unavailable as locked to another arc
-        bool unavailable = false;
-        // This wire has to be used for this net
-        int reserved_net = -1;
         // The notional location of the wire, to guarantee thread safety
         int16_t x = 0, y = 0;
-        // Visit data
-        PipId pip_fwd, pip_bwd;
-        bool visited_fwd = false, visited_bwd = false;
+    };
+
+    struct WireState
+    {
+        // This wire has to be used for this net
+        int reserved_net = -1;
+        // Wire is unavailable as locked to another arc
+        bool unavailable = false;
+    };
+
+    struct WireCongestion
+    {
+        int curr_cong = 0;
+        // Historical congestion cost
+        float hist_cong_cost = 1.0;
+    };
+
+    // Visit data; only read back in full when tracing back a routed arc
+    struct WireVisit
+    {
         float cost_fwd = 0.0, cost_bwd = 0.0;
+        bool visited_fwd = false, visited_bwd = false;
+    };
+
+    struct WireVisitPips
+    {
+        PipId pip_fwd, pip_bwd;
     };
 
     struct PerResourceData
@@ -122,6 +144,7 @@ struct Router2
     {
         tmg.setup_only = false;
         tmg.with_clock_skew = true;
+        tmg.incremental = true;
         tmg.setup();
     }
 
@@ -143,6 +166,7 @@ struct Router2
             ni->udata = i;
             nets_by_udata.at(i) = ni;
             nets.at(i).arcs.resize(ni->users.capacity());
+            nets.at(i).tmg_ports.resize(ni->users.capacity(), -1);
 
             // Start net bounding box at overall min/max
             nets.at(i).bb.x0 = std::numeric_limits<int>::max();
@@ -159,6 +183,7 @@ struct Router2
             }
 
             for (auto usr : ni->users.enumerate()) {
+                nets.at(i).tmg_ports.at(usr.index.idx()) = tmg.get_port_index(CellPortKey(usr.value));
                 WireId src_wire = ctx->getNetinfoSourceWire(ni);
                 for (auto &dst_wire : ctx->getNetinfoSinkWires(ni, usr.value)) {
                     nets.at(i).src_wire = src_wire;
@@ -204,40 +229,53 @@ struct Router2
         }
     }
 
-    dict<WireId, int> wire_to_idx;
-    std::vector<PerWireData> flat_wires;
+    // Maps getWireIndex() to a flat wire index
+    std::vector<int> wire_to_idx;
+    // Indexed by flat wire index
+    std::vector<WireId> wire_ids;
+    std::vector<WireLoc> wire_locs;
+    std::vector<WireState> wire_state;
+    std::vector<WireCongestion> wire_cong;
+    std::vector<WireVisit> wire_visit;
+    std::vector<WireVisitPips> wire_visit_pips;
 
-    PerWireData &wire_data(WireId w) { return flat_wires[wire_to_idx.at(w)]; }
+    int flat_wire_idx(WireId w) const { return wire_to_idx[ctx->getWireIndex(w)]; }
 
     void setup_wires()
     {
         // Set up per-wire structures, so that MT parts don't have to do any memory allocation
-        // This is possibly quite wasteful and not cache-optimal; further consideration necessary
+        wire_to_idx.assign(ctx->getWireCount(), -1);
         for (auto wire : ctx->getWires()) {
-            PerWireData pwd;
-            pwd.w = wire;
+            WireState state;
+            WireCongestion cong;
             NetInfo *bound = ctx->getBoundWireNet(wire);
             if (bound != nullptr) {
                 auto iter = bound->wires.find(wire);
                 if (iter != bound->wires.end()) {
                     auto &nd = nets.at(bound->udata);
                     nd.wires[wire] = std::make_pair(bound->wires.at(wire).pip, 0);
-                    pwd.curr_cong = 1;
+                    cong.curr_cong = 1;
                     if (bound->wires.at(wire).strength == STRENGTH_PLACER) {
-                        pwd.reserved_net = bound->udata;
+                        state.reserved_net = bound->udata;
                     } else if (bound->wires.at(wire).strength > STRENGTH_PLACER) {
-                        pwd.unavailable = true;
+                        state.unavailable = true;
                     }
                 }
             }
 
-            BoundingBox wire_loc = ctx->getRouteBoundingBox(wire, wire);
-            pwd.x = (wire_loc.x0 + wire_loc.x1) / 2;
-            pwd.y = (wire_loc.y0 + wire_loc.y1) / 2;
+            BoundingBox bb = ctx->getRouteBoundingBox(wire, wire);
+            WireLoc loc;
+            loc.x = (bb.x0 + bb.x1) / 2;
+            loc.y = (bb.y0 + bb.y1) / 2;
 
-            wire_to_idx[wire] = int(flat_wires.size());
-            flat_wires.push_back(pwd);
+            wire_to_idx.at(ctx->getWireIndex(wire)) = int(wire_ids.size());
+            wire_ids.push_back(wire);
+            wire_locs.push_back(loc);
+            wire_state.push_back(state);
+            wire_cong.push_back(cong);
         }
+        wire_visit.resize(wire_ids.size());
+        wire_visit_pips.resize(wire_ids.size());
 
         for (auto &net_pair : ctx->nets) {
             auto *net = net_pair.second.get();
@@ -308,6 +346,31 @@ struct Router2
 
     double curr_cong_weight, hist_cong_weight, estimate_weight;
 
+    // Search statistics, kept per thread and summed up after each iteration
+    struct SearchStats
+    {
+        size_t arcs = 0;
+        // Wires popped from and pushed to the forward and backward queues
+        size_t wires_popped = 0, wires_pushed = 0;
+        // Largest combined size of the queues during a search
+        size_t max_queue_size = 0;
+        // Arcs that started from existing routing near the sink (mode 0), and how many of those were routed that way
+        size_t mode0_tries = 0, mode0_hits = 0;
+        // Arcs that failed inside their bounding box, and had to be retried without it or left for the next iteration
+        size_t bb_retries = 0;
+
+        void add(const SearchStats &other)
+        {
+            arcs += other.arcs;
+            wires_popped += other.wires_popped;
+            wires_pushed += other.wires_pushed;
+            max_queue_size = std::max(max_queue_size, other.max_queue_size);
+            mode0_tries += other.mode0_tries;
+            mode0_hits += other.mode0_hits;
+            bb_retries += other.bb_retries;
+        }
+    };
+
     struct ThreadContext
     {
         // Nets to route
@@ -322,6 +385,9 @@ struct Router2
         pool<WireId> processed_sinks;
 
         std::vector<int> dirty_wires;
+        SearchStats stats;
+        // Time spent routing this thread's nets
+        double route_time = 0;
 
         // Thread bounding box
         BoundingBox bb;
@@ -333,8 +399,9 @@ struct Router2
         dict<std::pair<int, int>, pool<WireId>> wire_by_loc;
     };
 
-    bool thread_test_wire(ThreadContext &t, PerWireData &w)
+    bool thread_test_wire(ThreadContext &t, int wire)
     {
+        const WireLoc &w = wire_locs[wire];
         return w.x >= t.bb.x0 && w.x <= t.bb.x1 && w.y >= t.bb.y0 && w.y <= t.bb.y1;
     }
 
@@ -361,13 +428,13 @@ struct Router2
 
     void bind_pip_internal(PerNetData &net, store_index<PortRef> user, int wire, PipId pip)
     {
-        auto &wd = flat_wires.at(wire);
-        auto wire_found = net.wires.find(wd.w);
+        WireId w = wire_ids.at(wire);
+        auto wire_found = net.wires.find(w);
         if (wire_found == net.wires.end()) {
             // Not yet used for any arcs of this net, add to list
-            net.wires.emplace(wd.w, std::make_pair(pip, 1));
+            net.wires.emplace(w, std::make_pair(pip, 1));
             // Increase bound count of wire by 1
-            ++wd.curr_cong;
+            ++wire_cong.at(wire).curr_cong;
         } else {
             // Already used for at least one other arc of this net
             // Don't allow two uphill PIPs for the same net and wire
@@ -407,15 +474,14 @@ struct Router2
 
     void unbind_pip_internal(PerNetData &net, store_index<PortRef> user, WireId wire)
     {
-        auto &wd = wire_data(wire);
-        auto &wire_found = net.wires.at(wd.w);
+        auto &wire_found = net.wires.at(wire);
         auto pip = wire_found.first;
 
         --wire_found.second;
         if (wire_found.second == 0) {
             // No remaining arcs of this net bound to this wire
-            --wd.curr_cong;
-            net.wires.erase(wd.w);
+            --wire_cong.at(flat_wire_idx(wire)).curr_cong;
+            net.wires.erase(wire);
         }
 
         if (pip == PipId())
@@ -462,11 +528,11 @@ struct Router2
     float score_wire_for_arc(NetInfo *net, store_index<PortRef> user, size_t phys_pin, WireId wire, PipId pip,
                              float crit_weight)
     {
-        auto &wd = wire_data(wire);
+        auto &wc = wire_cong[flat_wire_idx(wire)];
         auto &nd = nets.at(net->udata);
         float base_cost = cfg.get_base_cost(ctx, wire, pip, crit_weight);
-        int overuse = wd.curr_cong;
-        float hist_cost = 1.0f + crit_weight * (wd.hist_cong_cost - 1.0f);
+        int overuse = wc.curr_cong;
+        float hist_cost = 1.0f + crit_weight * (wc.hist_cong_cost - 1.0f);
         float bias_cost = 0;
         float resource_hist_cost = 0.0f;
         float resource_present_cost = 0.0f;
@@ -496,13 +562,13 @@ struct Router2
     float get_togo_cost(NetInfo *net, store_index<PortRef> user, int wire, WireId src_sink, bool bwd, float crit_weight)
     {
         auto &nd = nets.at(net->udata);
-        auto &wd = flat_wires[wire];
+        WireId w = wire_ids[wire];
         int source_uses = 0;
-        if (nd.wires.count(wd.w)) {
-            source_uses = nd.wires.at(wd.w).second;
+        if (nd.wires.count(w)) {
+            source_uses = nd.wires.at(w).second;
         }
         // FIXME: timing/wirelength balance?
-        delay_t est_delay = ctx->estimateDelay(bwd ? src_sink : wd.w, bwd ? wd.w : src_sink);
+        delay_t est_delay = ctx->estimateDelay(bwd ? src_sink : w, bwd ? w : src_sink);
         return (ctx->getDelayNS(est_delay) / (1 + source_uses * crit_weight)) + cfg.ipin_cost_adder;
     }
 
@@ -513,8 +579,7 @@ struct Router2
         WireId src_wire = nets.at(net->udata).src_wire;
         WireId cursor = ad.sink_wire;
         while (nd.wires.count(cursor)) {
-            auto &wd = wire_data(cursor);
-            if (wd.curr_cong != 1)
+            if (wire_cong.at(flat_wire_idx(cursor)).curr_cong != 1)
                 return false;
             auto &uh = nd.wires.at(cursor).first;
             if (uh == PipId())
@@ -541,7 +606,7 @@ struct Router2
         WireId src = nets.at(net->udata).src_wire;
         WireId cursor = ad.sink_wire;
         while (cursor != src) {
-            size_t wire_idx = wire_to_idx.at(cursor);
+            size_t wire_idx = flat_wire_idx(cursor);
             PipId pip = nd.wires.at(cursor).first;
             bind_pip_internal(nd, usr, wire_idx, pip);
             cursor = ctx->getPipSrcWire(pip);
@@ -553,7 +618,8 @@ struct Router2
     {
         if (iter_count > 7)
             return false; // heuristic to assume we've hit general routing
-        if (wire_data(wire).reserved_net != -1 && wire_data(wire).reserved_net != net->udata)
+        auto &ws = wire_state.at(flat_wire_idx(wire));
+        if (ws.reserved_net != -1 && ws.reserved_net != net->udata)
             return true; // reserved for another net
         if (sink_wires.count(wire))
             return false;
@@ -577,9 +643,10 @@ struct Router2
         // and LUT
         if (iter_count > 7)
             return false; // heuristic to assume we've hit general routing
-        if (wire_data(wire).unavailable)
+        auto &ws = wire_state.at(flat_wire_idx(wire));
+        if (ws.unavailable)
             return true;
-        if (wire_data(wire).reserved_net != -1 && wire_data(wire).reserved_net != net->udata)
+        if (ws.reserved_net != -1 && ws.reserved_net != net->udata)
             return true; // reserved for another net
         for (auto bp : ctx->getWireBelPins(wire))
             if ((net->driver.cell == nullptr || bp.bel == net->driver.cell->bel) &&
@@ -609,7 +676,7 @@ struct Router2
             }
 
             while (!done) {
-                auto &wd = wire_data(cursor);
+                auto &wd = wire_state.at(flat_wire_idx(cursor));
                 if (ctx->debug)
                     log("      %s (driver output)\n", ctx->nameOfWire(cursor));
                 did_something |= (wd.reserved_net != net->udata);
@@ -656,7 +723,7 @@ struct Router2
                 log("   with sink wire %s\n", ctx->nameOfWire(ad.sink_wire));
             }
             while (!done) {
-                auto &wd = wire_data(cursor);
+                auto &wd = wire_state.at(flat_wire_idx(cursor));
                 if (ctx->debug)
                     log("      %s (sink input)\n", ctx->nameOfWire(cursor));
                 did_something |= (wd.reserved_net != net->udata);
@@ -719,12 +786,8 @@ struct Router2
     void reset_wires(ThreadContext &t)
     {
         for (auto w : t.dirty_wires) {
-            flat_wires[w].pip_fwd = PipId();
-            flat_wires[w].pip_bwd = PipId();
-            flat_wires[w].visited_fwd = false;
-            flat_wires[w].visited_bwd = false;
-            flat_wires[w].cost_fwd = 0.0;
-            flat_wires[w].cost_bwd = 0.0;
+            wire_visit[w] = WireVisit();
+            wire_visit_pips[w] = WireVisitPips();
         }
         t.dirty_wires.clear();
     }
@@ -757,43 +820,45 @@ struct Router2
     // Functions for marking wires as visited, and checking if they have already been visited
     void set_visited_fwd(ThreadContext &t, int wire, PipId pip, float cost)
     {
-        auto &wd = flat_wires.at(wire);
-        if (!wd.visited_fwd && !wd.visited_bwd)
+        auto &wv = wire_visit.at(wire);
+        if (!wv.visited_fwd && !wv.visited_bwd)
             t.dirty_wires.push_back(wire);
-        wd.pip_fwd = pip;
-        wd.visited_fwd = true;
-        wd.cost_fwd = cost;
+        wv.visited_fwd = true;
+        wv.cost_fwd = cost;
+        wire_visit_pips[wire].pip_fwd = pip;
     }
     void set_visited_bwd(ThreadContext &t, int wire, PipId pip, float cost)
     {
-        auto &wd = flat_wires.at(wire);
-        if (!wd.visited_fwd && !wd.visited_bwd)
+        auto &wv = wire_visit.at(wire);
+        if (!wv.visited_fwd && !wv.visited_bwd)
             t.dirty_wires.push_back(wire);
-        wd.pip_bwd = pip;
-        wd.visited_bwd = true;
-        wd.cost_bwd = cost;
+        wv.visited_bwd = true;
+        wv.cost_bwd = cost;
+        wire_visit_pips[wire].pip_bwd = pip;
     }
 
     bool was_visited_fwd(int wire, float cost)
     {
-        return flat_wires.at(wire).visited_fwd && flat_wires.at(wire).cost_fwd <= cost;
+        const auto &wv = wire_visit.at(wire);
+        return wv.visited_fwd && wv.cost_fwd <= cost;
     }
     bool was_visited_bwd(int wire, float cost)
     {
-        return flat_wires.at(wire).visited_bwd && flat_wires.at(wire).cost_bwd <= cost;
+        const auto &wv = wire_visit.at(wire);
+        return wv.visited_bwd && wv.cost_bwd <= cost;
     }
 
     float get_arc_crit(NetInfo *net, store_index<PortRef> i)
     {
         if (!timing_driven)
             return 0;
-        return tmg.get_criticality(CellPortKey(net->users.at(i)));
+        return tmg.get_criticality(nets.at(net->udata).tmg_ports.at(i.idx()));
     }
 
     bool arc_failed_slack(NetInfo *net, store_index<PortRef> usr_idx)
     {
         return timing_driven_ripup &&
-               (tmg.get_setup_slack(CellPortKey(net->users.at(usr_idx))) < (2 * ctx->getDelayEpsilon()));
+               (tmg.get_setup_slack(nets.at(net->udata).tmg_ports.at(usr_idx.idx())) < (2 * ctx->getDelayEpsilon()));
     }
 
     ArcRouteResult route_arc(ThreadContext &t, NetInfo *net, store_index<PortRef> i, size_t phys_pin, bool is_mt,
@@ -814,8 +879,8 @@ struct Router2
         if (dst_wire == WireId())
             ARC_LOG_ERR("No wire found for port %s on destination cell %s.\n", ctx->nameOf(usr.port),
                         ctx->nameOf(usr.cell));
-        int src_wire_idx = const_mode ? -1 : wire_to_idx.at(src_wire);
-        int dst_wire_idx = wire_to_idx.at(dst_wire);
+        int src_wire_idx = const_mode ? -1 : flat_wire_idx(src_wire);
+        int dst_wire_idx = flat_wire_idx(dst_wire);
         // Calculate a timing weight based on criticality
         float crit = get_arc_crit(net, i);
         float crit_weight = std::max<float>(0.05f, (1.0f - std::pow(crit, 2)));
@@ -830,6 +895,9 @@ struct Router2
         int mode = 0;
         if (net->users.entries() < 4 || nd.wires.empty() || (crit > 0.95))
             mode = 1;
+        ++t.stats.arcs;
+        if (mode == 0)
+            ++t.stats.mode0_tries;
 
         // This records the point where forwards and backwards routing met
         int midpoint_wire = -1;
@@ -856,12 +924,12 @@ struct Router2
                 WireScore base_score;
                 base_score.delay = 0;
                 base_score.cost = 0;
-                int wire_idx = wire_to_idx.at(wire);
+                int wire_idx = flat_wire_idx(wire);
                 base_score.togo_cost = get_togo_cost(net, i, wire_idx, dst_wire, false, crit_weight);
                 t.fwd_queue.push(QueuedWire(wire_idx, base_score));
                 set_visited_fwd(t, wire_idx, PipId(), 0.0);
             };
-            auto &dst_data = flat_wires.at(dst_wire_idx);
+            auto &dst_data = wire_locs.at(dst_wire_idx);
             // Look for nearby existing routing
             for (int dy = -cfg.bb_margin_y; dy <= cfg.bb_margin_y; dy++)
                 for (int dx = -cfg.bb_margin_x; dx <= cfg.bb_margin_x; dx++) {
@@ -888,7 +956,7 @@ struct Router2
                 WireScore base_score;
                 base_score.delay = 0;
                 base_score.cost = 0;
-                int wire_idx = wire_to_idx.at(wire);
+                int wire_idx = flat_wire_idx(wire);
                 base_score.togo_cost = get_togo_cost(net, i, wire_idx, src_wire, true, crit_weight);
                 t.bwd_queue.push(QueuedWire(wire_idx, base_score));
                 set_visited_bwd(t, wire_idx, PipId(), 0.0);
@@ -905,6 +973,7 @@ struct Router2
                                 : (!t.fwd_queue.empty() || !t.bwd_queue.empty())) &&
                    ((!is_bb && midpoint_wire == -1) || iter < toexplore)) {
                 ++iter;
+                t.stats.max_queue_size = std::max(t.stats.max_queue_size, t.fwd_queue.size() + t.bwd_queue.size());
                 if (!t.fwd_queue.empty() && !const_mode) {
                     // Explore forwards
                     auto curr = t.fwd_queue.top();
@@ -915,15 +984,14 @@ struct Router2
                         midpoint_wire = curr.wire;
                         break;
                     }
-                    auto &curr_data = flat_wires.at(curr.wire);
-                    for (PipId dh : ctx->getPipsDownhill(curr_data.w)) {
+                    for (PipId dh : ctx->getPipsDownhill(wire_ids.at(curr.wire))) {
                         // Skip pips outside of box in bounding-box mode
                         if (is_bb && !hit_test_pip(nd.bb, ctx->getPipLocation(dh)))
                             continue;
                         if (!ctx->checkPipAvailForNet(dh, net))
                             continue;
                         WireId next = ctx->getPipDstWire(dh);
-                        int next_idx = wire_to_idx.at(next);
+                        int next_idx = flat_wire_idx(next);
                         WireScore next_score;
                         next_score.delay = curr.score.delay + cfg.get_base_cost(ctx, next, dh, crit_weight);
                         next_score.cost = curr.score.cost + score_wire_for_arc(net, i, phys_pin, next, dh, crit_weight);
@@ -933,7 +1001,7 @@ struct Router2
                             // Don't expand the same node twice.
                             continue;
                         }
-                        auto &nwd = flat_wires.at(next_idx);
+                        auto &nwd = wire_state.at(next_idx);
                         if (nwd.unavailable)
                             continue;
                         // Reserved for another net
@@ -951,10 +1019,11 @@ struct Router2
                                 fnd_resource->second.value != ctx->getResourceValueForPip(dh))
                                 continue;
                         }
-                        if (!thread_test_wire(t, nwd))
+                        if (!thread_test_wire(t, next_idx))
                             continue; // thread safety issue
                         set_visited_fwd(t, next_idx, dh, next_score.delay);
                         t.fwd_queue.push(QueuedWire(next_idx, next_score, t.rng.rng()));
+                        ++t.stats.wires_pushed;
                     }
                 }
                 if (!t.bwd_queue.empty()) {
@@ -962,8 +1031,8 @@ struct Router2
                     auto curr = t.bwd_queue.top();
                     t.bwd_queue.pop();
                     ++explored;
-                    auto &curr_data = flat_wires.at(curr.wire);
-                    if (const_mode && ctx->getWireConstantValue(curr_data.w) == net->constant_value) {
+                    WireId curr_w = wire_ids.at(curr.wire);
+                    if (const_mode && ctx->getWireConstantValue(curr_w) == net->constant_value) {
                         if (midpoint_wire == -1) {
                             midpoint_wire = curr.wire;
                             best_midpoint_cost = curr.score.cost;
@@ -986,11 +1055,11 @@ struct Router2
                     }
                     // Don't allow the same wire to be bound to the same net with a different driving pip
                     PipId bound_pip;
-                    auto fnd_wire = nd.wires.find(curr_data.w);
+                    auto fnd_wire = nd.wires.find(curr_w);
                     if (fnd_wire != nd.wires.end())
                         bound_pip = fnd_wire->second.first;
 
-                    for (PipId uh : ctx->getPipsUphill(curr_data.w)) {
+                    for (PipId uh : ctx->getPipsUphill(curr_w)) {
                         if (bound_pip != PipId() && bound_pip != uh)
                             continue;
                         if (is_bb && !hit_test_pip(nd.bb, ctx->getPipLocation(uh)))
@@ -998,7 +1067,7 @@ struct Router2
                         if (!ctx->checkPipAvailForNet(uh, net))
                             continue;
                         WireId next = ctx->getPipSrcWire(uh);
-                        int next_idx = wire_to_idx.at(next);
+                        int next_idx = flat_wire_idx(next);
                         WireScore next_score;
                         next_score.delay = curr.score.delay + cfg.get_base_cost(ctx, next, uh, crit_weight);
                         next_score.cost = curr.score.cost + score_wire_for_arc(net, i, phys_pin, next, uh, crit_weight);
@@ -1010,7 +1079,7 @@ struct Router2
                             // Don't expand the same node twice.
                             continue;
                         }
-                        auto &nwd = flat_wires.at(next_idx);
+                        auto &nwd = wire_state.at(next_idx);
                         if (nwd.unavailable)
                             continue;
                         // Reserved for another net
@@ -1024,10 +1093,11 @@ struct Router2
                                 fnd_resource->second.value != ctx->getResourceValueForPip(uh))
                                 continue;
                         }
-                        if (!thread_test_wire(t, nwd))
+                        if (!thread_test_wire(t, next_idx))
                             continue; // thread safety issue
                         set_visited_bwd(t, next_idx, uh, next_score.delay);
                         t.bwd_queue.push(QueuedWire(next_idx, next_score, t.rng.rng()));
+                        ++t.stats.wires_pushed;
                     }
                 }
             }
@@ -1037,19 +1107,22 @@ struct Router2
         ArcRouteResult result = ARC_SUCCESS;
         if (midpoint_wire != -1) {
             ROUTE_LOG_DBG("   Routed (explored %d wires): ", explored);
+            if (mode == 0)
+                ++t.stats.mode0_hits;
             if (const_mode) {
                 bind_pip_internal(nd, i, midpoint_wire, PipId());
             } else {
                 int cursor_bwd = midpoint_wire;
                 while (was_visited_fwd(cursor_bwd, std::numeric_limits<float>::max())) {
-                    PipId pip = flat_wires.at(cursor_bwd).pip_fwd;
+                    PipId pip = wire_visit_pips.at(cursor_bwd).pip_fwd;
                     if (pip == PipId() && cursor_bwd != src_wire_idx)
                         break;
                     bind_pip_internal(nd, i, cursor_bwd, pip);
                     if (ctx->debug && !is_mt) {
-                        auto &wd = flat_wires.at(cursor_bwd);
-                        ROUTE_LOG_DBG("      fwd wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(wd.w),
-                                      wd.curr_cong - 1, wd.hist_cong_cost, nd.wires.at(wd.w).second);
+                        WireId w = wire_ids.at(cursor_bwd);
+                        auto &wc = wire_cong.at(cursor_bwd);
+                        ROUTE_LOG_DBG("      fwd wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(w),
+                                      wc.curr_cong - 1, wc.hist_cong_cost, nd.wires.at(w).second);
                     }
                     if (pip == PipId()) {
                         break;
@@ -1063,25 +1136,25 @@ struct Router2
                         ROUTE_LOG_DBG("         fwd pip: %s (%d, %d)\n", ctx->nameOfPip(pip),
                                       ctx->getPipLocation(pip).x, ctx->getPipLocation(pip).y);
                     }
-                    cursor_bwd = wire_to_idx.at(ctx->getPipSrcWire(pip));
+                    cursor_bwd = flat_wire_idx(ctx->getPipSrcWire(pip));
                 }
 
                 while (cursor_bwd != src_wire_idx) {
                     // Tack onto existing routing
-                    WireId bwd_w = flat_wires.at(cursor_bwd).w;
+                    WireId bwd_w = wire_ids.at(cursor_bwd);
                     if (!nd.wires.count(bwd_w))
                         break;
                     auto &bound = nd.wires.at(bwd_w);
                     PipId pip = bound.first;
                     if (ctx->debug && !is_mt) {
-                        auto &wd = flat_wires.at(cursor_bwd);
-                        ROUTE_LOG_DBG("      ext wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(wd.w),
-                                      wd.curr_cong - 1, wd.hist_cong_cost, bound.second);
+                        auto &wc = wire_cong.at(cursor_bwd);
+                        ROUTE_LOG_DBG("      ext wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(bwd_w),
+                                      wc.curr_cong - 1, wc.hist_cong_cost, bound.second);
                     }
                     bind_pip_internal(nd, i, cursor_bwd, pip);
                     if (pip == PipId())
                         break;
-                    cursor_bwd = wire_to_idx.at(ctx->getPipSrcWire(pip));
+                    cursor_bwd = flat_wire_idx(ctx->getPipSrcWire(pip));
                 }
 
                 NPNR_ASSERT(cursor_bwd == src_wire_idx);
@@ -1089,7 +1162,7 @@ struct Router2
 
             int cursor_fwd = midpoint_wire;
             while (was_visited_bwd(cursor_fwd, std::numeric_limits<float>::max())) {
-                PipId pip = flat_wires.at(cursor_fwd).pip_bwd;
+                PipId pip = wire_visit_pips.at(cursor_fwd).pip_bwd;
                 if (pip == PipId()) {
                     break;
                 }
@@ -1103,12 +1176,13 @@ struct Router2
                                   ctx->getPipLocation(pip).y);
                 }
 
-                cursor_fwd = wire_to_idx.at(ctx->getPipDstWire(pip));
+                cursor_fwd = flat_wire_idx(ctx->getPipDstWire(pip));
                 bind_pip_internal(nd, i, cursor_fwd, pip);
                 if (ctx->debug && !is_mt) {
-                    auto &wd = flat_wires.at(cursor_fwd);
-                    ROUTE_LOG_DBG("      bwd wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(wd.w),
-                                  wd.curr_cong - 1, wd.hist_cong_cost, nd.wires.at(wd.w).second);
+                    WireId w = wire_ids.at(cursor_fwd);
+                    auto &wc = wire_cong.at(cursor_fwd);
+                    ROUTE_LOG_DBG("      bwd wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(w),
+                                  wc.curr_cong - 1, wc.hist_cong_cost, nd.wires.at(w).second);
                 }
             }
             NPNR_ASSERT(cursor_fwd == dst_wire_idx);
@@ -1126,6 +1200,7 @@ struct Router2
             result = ARC_RETRY_WITHOUT_BB;
         }
         reset_wires(t);
+        t.stats.wires_popped += explored;
         return result;
     }
 #undef ARC_ERR
@@ -1180,6 +1255,7 @@ struct Router2
             if (res1 == ARC_FATAL)
                 return false; // Arc failed irrecoverably
             else if (res1 == ARC_RETRY_WITHOUT_BB) {
+                ++t.stats.bb_retries;
                 if (is_mt) {
                     // Can't break out of bounding box in multi-threaded mode, so mark this arc as a failure
                     have_failures = true;
@@ -1239,7 +1315,7 @@ struct Router2
             auto &nd = nets.at(i);
             for (const auto &w : nd.wires) {
                 ++total_wire_use;
-                auto &wd = wire_data(w.first);
+                auto &wd = wire_cong.at(flat_wire_idx(w.first));
                 if (wd.curr_cong > 1) {
                     if (already_updated_wires.count(w.first)) {
                         ++total_wire_overuse;
@@ -1415,14 +1491,122 @@ struct Router2
         return success;
     }
 
+    // Follow the bound route of an arc back from its sink, marking the wires it uses. The route is legal if every wire
+    // is bound to the net and the path reaches the source (or, for constant nets, a wire driving the constant).
+    bool check_arc_routing(NetInfo *net, WireId src_wire, WireId dst_wire, pool<WireId> &used_wires)
+    {
+        WireId cursor = dst_wire;
+        // A legal route can't visit more wires than the net has bound, so this also catches loops
+        for (size_t i = 0; i <= net->wires.size(); i++) {
+            auto found = net->wires.find(cursor);
+            if (found == net->wires.end() || ctx->getBoundWireNet(cursor) != net)
+                return false;
+            used_wires.insert(cursor);
+            if (cursor == src_wire ||
+                (net->constant_value != IdString() && ctx->getWireConstantValue(cursor) == net->constant_value))
+                return true;
+            if (found->second.pip == PipId())
+                return false;
+            cursor = ctx->getPipSrcWire(found->second.pip);
+        }
+        return false;
+    }
+
+    // Returns the number of arcs of a net without a legal bound route, plus the number of bound wires not used by any
+    // arc. These are the cases that router1 would reroute or rip up when it sets up.
+    int check_net_routing(NetInfo *net)
+    {
+#ifdef ARCH_ECP5
+        if (net->is_global)
+            return 0;
+#endif
+        if (net->driver.cell == nullptr && net->constant_value == IdString())
+            return 0;
+        int failed = 0;
+        WireId src_wire = ctx->getNetinfoSourceWire(net);
+        pool<WireId> used_wires;
+        for (auto usr : net->users.enumerate()) {
+            for (WireId dst_wire : ctx->getNetinfoSinkWires(net, usr.value)) {
+                if (!check_arc_routing(net, src_wire, dst_wire, used_wires))
+                    ++failed;
+            }
+        }
+        for (auto &w : net->wires) {
+            if (w.second.strength < STRENGTH_LOCKED && !used_wires.count(w.first))
+                ++failed;
+        }
+        return failed;
+    }
+
+    // Returns the total number of failures, and adds the names of the nets with any to illegal_nets
+    int check_all_routing(pool<IdString> &illegal_nets)
+    {
+        std::vector<int> failed(nets_by_udata.size());
+        ctx->get_thread_pool().run(int(nets_by_udata.size()),
+                                   [&](int i) { failed.at(i) = check_net_routing(nets_by_udata.at(i)); });
+        int total = 0;
+        for (size_t i = 0; i < nets_by_udata.size(); i++) {
+            if (failed.at(i) > 0)
+                illegal_nets.insert(nets_by_udata.at(i)->name);
+            total += failed.at(i);
+        }
+        return total;
+    }
+
+    void write_perf_json(std::ostream &out, double route_time)
+    {
+        auto search_json = [](Json::object &obj, const SearchStats &stats) {
+            obj["arcs"] = double(stats.arcs);
+            obj["wires_popped"] = double(stats.wires_popped);
+            obj["wires_pushed"] = double(stats.wires_pushed);
+            obj["wires_popped_per_arc"] = stats.arcs > 0 ? double(stats.wires_popped) / stats.arcs : 0.0;
+            obj["wires_pushed_per_arc"] = stats.arcs > 0 ? double(stats.wires_pushed) / stats.arcs : 0.0;
+            obj["max_queue_size"] = double(stats.max_queue_size);
+            obj["mode0_tries"] = double(stats.mode0_tries);
+            obj["mode0_hits"] = double(stats.mode0_hits);
+            obj["mode0_hit_rate"] = stats.mode0_tries > 0 ? double(stats.mode0_hits) / stats.mode0_tries : 0.0;
+            obj["bb_retries"] = double(stats.bb_retries);
+        };
+        Json::array iters;
+        for (auto &stats : iter_stats) {
+            Json::object iter_obj{
+                    {"iter", stats.iter},
+                    {"nets", stats.nets},
+                    {"time", stats.time},
+                    {"parallel_time", stats.parallel_time},
+                    {"serial_time", stats.serial_time},
+                    {"wires", stats.wires},
+                    {"overused_wires", stats.overused_wires},
+                    {"tmgfail", stats.tmgfail},
+            };
+            search_json(iter_obj, stats.search);
+            Json::array regions;
+            for (auto &region : stats.regions)
+                regions.push_back(Json::object{{"region", region.region},
+                                               {"level", region.level},
+                                               {"nets", region.nets},
+                                               {"time", region.time}});
+            iter_obj["regions"] = regions;
+            iters.push_back(iter_obj);
+        }
+        Json::object total{
+                {"iterations", int(iter_stats.size())},
+                {"threads", ctx->get_thread_pool().size()},
+                {"time", route_time},
+                {"search_time", search_time},
+        };
+        search_json(total, total_stats);
+        out << Json(Json::object{{"total", total}, {"iterations", iters}}).dump() << std::endl;
+    }
+
     void write_congestion_by_wiretype_heatmap(std::ostream &out)
     {
         dict<IdString, std::vector<int>> cong_by_type;
         size_t max_cong = 0;
         // Build histogram
-        for (auto &wd : flat_wires) {
-            size_t val = wd.curr_cong;
-            IdString type = ctx->getWireType(wd.w);
+        for (size_t i = 0; i < wire_ids.size(); i++) {
+            size_t val = wire_cong.at(i).curr_cong;
+            IdString type = ctx->getWireType(wire_ids.at(i));
             max_cong = std::max(max_cong, val);
             if (cong_by_type[type].size() <= max_cong)
                 cong_by_type[type].resize(max_cong + 1);
@@ -1444,10 +1628,11 @@ struct Router2
     void write_utilisation_by_wiretype_heatmap(std::ostream &out)
     {
         dict<IdString, int> util_by_type;
-        for (auto &wd : flat_wires) {
-            IdString type = ctx->getWireType(wd.w);
-            if (wd.curr_cong > 0)
-                util_by_type[type] += wd.curr_cong;
+        for (size_t i = 0; i < wire_ids.size(); i++) {
+            IdString type = ctx->getWireType(wire_ids.at(i));
+            int curr_cong = wire_cong.at(i).curr_cong;
+            if (curr_cong > 0)
+                util_by_type[type] += curr_cong;
         }
         // Write csv
         for (auto &u : util_by_type)
@@ -1458,9 +1643,9 @@ struct Router2
     {
         auto util_by_coord =
                 std::vector<std::vector<int>>(ctx->getGridDimX() + 1, std::vector<int>(ctx->getGridDimY() + 1, 0));
-        for (auto &wd : flat_wires)
-            if (wd.curr_cong > 1)
-                util_by_coord[wd.x][wd.y] += wd.curr_cong;
+        for (size_t i = 0; i < wire_ids.size(); i++)
+            if (wire_cong.at(i).curr_cong > 1)
+                util_by_coord[wire_locs.at(i).x][wire_locs.at(i).y] += wire_cong.at(i).curr_cong;
         // Write csv
         for (auto &x : util_by_coord) {
             for (auto y : x)
@@ -1475,7 +1660,7 @@ struct Router2
         for (size_t i = 0; i < nets_by_udata.size(); i++) {
             IdString name = nets_by_udata.at(i)->name;
             for (const auto &wire : nets.at(i).wires) {
-                const auto &wd = flat_wires.at(wire_to_idx.at(wire.first));
+                const auto &wd = wire_cong.at(flat_wire_idx(wire.first));
                 if (wd.curr_cong > 1)
                     congestion_by_net[name] += (wd.curr_cong - 1);
             }
@@ -1485,64 +1670,175 @@ struct Router2
             out << u.first.c_str(ctx) << "," << u.second << std::endl;
     }
 
-    int mid_x = 0, mid_y = 0;
+    // The device is recursively bisected into a tree of regions for multithreaded routing. Nets that fit entirely
+    // within one half of a node are pushed down into that child; nets straddling a split stay in the node itself.
+    // Nodes on the same level cover disjoint regions so can be routed concurrently, working upwards from the leaves
+    // until the root, which is routed single-threaded.
+    struct PartitionNode
+    {
+        BoundingBox bb;
+        int level = 0;
+        int parent = -1;
+        // Split along X if true, otherwise along Y; nets entirely <= split_pos go to children[0]
+        bool split_x = false;
+        int split_pos = -1;
+        int children[2] = {-1, -1};
+    };
 
-    void partition_nets()
+    std::vector<PartitionNode> partition_tree;
+    int partition_depth = 0;
+
+    bool net_in_partition(const PerNetData &nd, const BoundingBox &bb)
+    {
+        return nd.bb.x0 >= bb.x0 && nd.bb.x1 <= bb.x1 && nd.bb.y0 >= bb.y0 && nd.bb.y1 <= bb.y1;
+    }
+
+    // Find the deepest partition node that fully contains a net's bounding box
+    int find_partition(const PerNetData &nd)
     {
-        // Create a histogram of positions in X and Y positions
-        std::map<int, int> cxs, cys;
-        for (auto &n : nets) {
-            if (n.cx != -1)
-                ++cxs[n.cx];
-            if (n.cy != -1)
-                ++cys[n.cy];
+        int node = 0;
+        while (partition_tree.at(node).children[0] != -1) {
+            auto &pn = partition_tree.at(node);
+            int lo = pn.split_x ? nd.bb.x0 : nd.bb.y0;
+            int hi = pn.split_x ? nd.bb.x1 : nd.bb.y1;
+            if (hi <= pn.split_pos)
+                node = pn.children[0];
+            else if (lo > pn.split_pos)
+                node = pn.children[1];
+            else
+                break;
         }
-        // 4-way split for now
-        int accum_x = 0, accum_y = 0;
-        int halfway = int(nets.size()) / 2;
-        for (auto &p : cxs) {
-            if (accum_x < halfway && (accum_x + p.second) >= halfway)
-                mid_x = p.first;
-            accum_x += p.second;
+        return node;
+    }
+
+    // Pick the median net centre along an axis as a candidate split, and count how many nets would straddle it
+    std::pair<int, int> find_split(const std::vector<int> &net_idxs, bool split_x)
+    {
+        std::vector<int> centres;
+        centres.reserve(net_idxs.size());
+        for (int n : net_idxs)
+            centres.push_back(split_x ? nets.at(n).cx : nets.at(n).cy);
+        auto mid = centres.begin() + centres.size() / 2;
+        std::nth_element(centres.begin(), mid, centres.end());
+        int split_pos = *mid;
+        int straddling = 0;
+        for (int n : net_idxs) {
+            auto &nd = nets.at(n);
+            int lo = split_x ? nd.bb.x0 : nd.bb.y0;
+            int hi = split_x ? nd.bb.x1 : nd.bb.y1;
+            if (lo <= split_pos && hi > split_pos)
+                ++straddling;
         }
-        for (auto &p : cys) {
-            if (accum_y < halfway && (accum_y + p.second) >= halfway)
-                mid_y = p.first;
-            accum_y += p.second;
+        return std::make_pair(split_pos, straddling);
+    }
+
+    int build_partition(BoundingBox bb, int parent, int level, const std::vector<int> &net_idxs)
+    {
+        int idx = int(partition_tree.size());
+        partition_tree.emplace_back();
+        partition_tree.back().bb = bb;
+        partition_tree.back().parent = parent;
+        partition_tree.back().level = level;
+        partition_depth = std::max(partition_depth, level);
+        // Don't split small regions, where the overhead of an extra level outweighs any gain
+        const int min_split_nets = 64;
+        if (level >= cfg.partition_max_depth || int(net_idxs.size()) < min_split_nets)
+            return idx;
+        // Try both axes, at the median net centre so each half gets a similar amount of work, and choose whichever
+        // leaves fewer nets stuck at this level
+        auto split_x = find_split(net_idxs, true), split_y = find_split(net_idxs, false);
+        bool use_x = (split_x.second < split_y.second) ||
+                     (split_x.second == split_y.second && (bb.x1 - bb.x0) >= (bb.y1 - bb.y0));
+        int split_pos = use_x ? split_x.first : split_y.first;
+        BoundingBox bb0 = bb, bb1 = bb;
+        if (use_x) {
+            if (split_pos < bb.x0 || split_pos >= bb.x1)
+                return idx;
+            bb0.x1 = split_pos;
+            bb1.x0 = split_pos + 1;
+        } else {
+            if (split_pos < bb.y0 || split_pos >= bb.y1)
+                return idx;
+            bb0.y1 = split_pos;
+            bb1.y0 = split_pos + 1;
         }
-        if (ctx->verbose) {
-            log_info("    x splitpoint: %d\n", mid_x);
-            log_info("    y splitpoint: %d\n", mid_y);
+        std::vector<int> nets0, nets1;
+        for (int n : net_idxs) {
+            if (net_in_partition(nets.at(n), bb0))
+                nets0.push_back(n);
+            else if (net_in_partition(nets.at(n), bb1))
+                nets1.push_back(n);
         }
-        std::vector<int> bins(5, 0);
-        for (auto &n : nets) {
-            if (n.bb.x0 < mid_x && n.bb.x1 < mid_x && n.bb.y0 < mid_y && n.bb.y1 < mid_y)
-                ++bins[0]; // TL
-            else if (n.bb.x0 >= mid_x && n.bb.x1 >= mid_x && n.bb.y0 < mid_y && n.bb.y1 < mid_y)
-                ++bins[1]; // TR
-            else if (n.bb.x0 < mid_x && n.bb.x1 < mid_x && n.bb.y0 >= mid_y && n.bb.y1 >= mid_y)
-                ++bins[2]; // BL
-            else if (n.bb.x0 >= mid_x && n.bb.x1 >= mid_x && n.bb.y0 >= mid_y && n.bb.y1 >= mid_y)
-                ++bins[3]; // BR
-            else
-                ++bins[4]; // cross-boundary
+        partition_tree.at(idx).split_x = use_x;
+        partition_tree.at(idx).split_pos = split_pos;
+        int child0 = build_partition(bb0, idx, level + 1, nets0);
+        int child1 = build_partition(bb1, idx, level + 1, nets1);
+        partition_tree.at(idx).children[0] = child0;
+        partition_tree.at(idx).children[1] = child1;
+        return idx;
+    }
+
+    void partition_nets()
+    {
+        partition_tree.clear();
+        partition_depth = 0;
+        std::vector<int> net_idxs;
+        for (int i = 0; i < int(nets.size()); i++)
+            if (nets_by_udata.at(i)->driver.cell != nullptr)
+                net_idxs.push_back(i);
+        build_partition(BoundingBox(0, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max()), -1, 0,
+                        net_idxs);
+        if (ctx->verbose) {
+            std::vector<int> nets_by_level(partition_depth + 1, 0), nodes_by_level(partition_depth + 1, 0);
+            for (int n : net_idxs)
+                ++nets_by_level.at(partition_tree.at(find_partition(nets.at(n))).level);
+            for (auto &pn : partition_tree)
+                ++nodes_by_level.at(pn.level);
+            log_info("    partitioned into %d regions over %d levels\n", int(partition_tree.size()),
+                     partition_depth + 1);
+            for (int i = 0; i <= partition_depth; i++)
+                log_info("        level %d: %d regions N=%d\n", i, nodes_by_level.at(i), nets_by_level.at(i));
         }
-        if (ctx->verbose)
-            for (int i = 0; i < 5; i++)
-                log_info("        bin %d N=%d\n", i, bins[i]);
     }
 
     void router_thread(ThreadContext &t, bool is_mt)
     {
+        auto thread_start = std::chrono::high_resolution_clock::now();
         for (auto n : t.route_nets) {
             bool result = route_net(t, n, is_mt);
             if (!result)
                 t.failed_nets.push_back(n);
         }
+        auto thread_end = std::chrono::high_resolution_clock::now();
+        t.route_time += std::chrono::duration<double>(thread_end - thread_start).count();
     }
 
-    void do_route()
+    struct RegionStats
+    {
+        int region, level, nets;
+        double time;
+    };
+
+    // Performance statistics for one iteration of the main router loop
+    struct IterStats
     {
+        int iter = 0, nets = 0;
+        SearchStats search;
+        // Time in do_route() spent routing partition regions concurrently, and routing the remaining nets serially
+        double parallel_time = 0, serial_time = 0;
+        std::vector<RegionStats> regions;
+        double time = 0;
+        int wires = 0, overused_wires = 0, tmgfail = 0;
+    };
+
+    // Search statistics, summed over all iterations
+    SearchStats total_stats;
+    double search_time = 0;
+    std::vector<IterStats> iter_stats;
+
+    void do_route(IterStats &stats)
+    {
+        auto route_start = std::chrono::high_resolution_clock::now();
         // Don't multithread if fewer than 200 nets (heuristic)
         if (route_queue.size() < 200) {
             ThreadContext st;
@@ -1551,105 +1847,65 @@ struct Router2
             for (size_t j = 0; j < route_queue.size(); j++) {
                 route_net(st, nets_by_udata[route_queue[j]], false);
             }
+            stats.search.add(st.stats);
+            auto route_end = std::chrono::high_resolution_clock::now();
+            stats.serial_time = std::chrono::duration<double>(route_end - route_start).count();
             return;
         }
-        const int Nq = 4, Nv = 2, Nh = 2;
-        const int N = Nq + Nv + Nh;
-        std::vector<ThreadContext> tcs(N + 1);
-        for (auto &th : tcs) {
-            th.rng.rngseed(ctx->rng64());
-        }
-        int le_x = mid_x;
-        int rs_x = mid_x;
-        int le_y = mid_y;
-        int rs_y = mid_y;
-        // Set up thread bounding boxes
-        tcs.at(0).bb = BoundingBox(0, 0, mid_x, mid_y);
-        tcs.at(1).bb = BoundingBox(mid_x + 1, 0, std::numeric_limits<int>::max(), le_y);
-        tcs.at(2).bb = BoundingBox(0, mid_y + 1, mid_x, std::numeric_limits<int>::max());
-        tcs.at(3).bb =
-                BoundingBox(mid_x + 1, mid_y + 1, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        tcs.at(4).bb = BoundingBox(0, 0, std::numeric_limits<int>::max(), mid_y);
-        tcs.at(5).bb = BoundingBox(0, mid_y + 1, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        tcs.at(6).bb = BoundingBox(0, 0, mid_x, std::numeric_limits<int>::max());
-        tcs.at(7).bb = BoundingBox(mid_x + 1, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        tcs.at(8).bb = BoundingBox(0, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        for (auto n : route_queue) {
-            auto &nd = nets.at(n);
-            auto ni = nets_by_udata.at(n);
-            int bin = N;
-            // Quadrants
-            if (nd.bb.x0 < le_x && nd.bb.x1 < le_x && nd.bb.y0 < le_y && nd.bb.y1 < le_y)
-                bin = 0;
-            else if (nd.bb.x0 >= rs_x && nd.bb.x1 >= rs_x && nd.bb.y0 < le_y && nd.bb.y1 < le_y)
-                bin = 1;
-            else if (nd.bb.x0 < le_x && nd.bb.x1 < le_x && nd.bb.y0 >= rs_y && nd.bb.y1 >= rs_y)
-                bin = 2;
-            else if (nd.bb.x0 >= rs_x && nd.bb.x1 >= rs_x && nd.bb.y0 >= rs_y && nd.bb.y1 >= rs_y)
-                bin = 3;
-            // Vertical split
-            else if (nd.bb.y0 < le_y && nd.bb.y1 < le_y)
-                bin = Nq + 0;
-            else if (nd.bb.y0 >= rs_y && nd.bb.y1 >= rs_y)
-                bin = Nq + 1;
-            // Horizontal split
-            else if (nd.bb.x0 < le_x && nd.bb.x1 < le_x)
-                bin = Nq + Nv + 0;
-            else if (nd.bb.x0 >= rs_x && nd.bb.x1 >= rs_x)
-                bin = Nq + Nv + 1;
-            tcs.at(bin).route_nets.push_back(ni);
+        std::vector<ThreadContext> tcs(partition_tree.size());
+        for (size_t i = 0; i < tcs.size(); i++) {
+            tcs.at(i).rng.rngseed(ctx->rng64());
+            tcs.at(i).bb = partition_tree.at(i).bb;
         }
+        for (auto n : route_queue)
+            tcs.at(find_partition(nets.at(n))).route_nets.push_back(nets_by_udata.at(n));
         if (ctx->verbose)
-            log_info("%d/%d nets not multi-threadable\n", int(tcs.at(N).route_nets.size()), int(route_queue.size()));
-#ifdef NPNR_DISABLE_THREADS
-        // Singlethreaded routing - quadrants
-        for (int i = 0; i < Nq; i++) {
-            router_thread(tcs.at(i), /*is_mt=*/false);
-        }
-        // Vertical splits
-        for (int i = Nq; i < Nq + Nv; i++) {
-            router_thread(tcs.at(i), /*is_mt=*/false);
-        }
-        // Horizontal splits
-        for (int i = Nq + Nv; i < Nq + Nv + Nh; i++) {
-            router_thread(tcs.at(i), /*is_mt=*/false);
-        }
-#else
-        // Multithreaded part of routing - quadrants
-        std::vector<boost::thread> threads;
-        for (int i = 0; i < Nq; i++) {
-            threads.emplace_back([this, &tcs, i]() { router_thread(tcs.at(i), /*is_mt=*/true); });
-        }
-        for (auto &t : threads)
-            t.join();
-        threads.clear();
-        // Vertical splits
-        for (int i = Nq; i < Nq + Nv; i++) {
-            threads.emplace_back([this, &tcs, i]() { router_thread(tcs.at(i), /*is_mt=*/true); });
+            log_info("%d/%d nets not multi-threadable\n", int(tcs.at(0).route_nets.size()), int(route_queue.size()));
+        // Work upwards from the leaves; all the regions in a level are disjoint so can be routed concurrently
+        std::vector<int> level_nodes;
+        for (int level = partition_depth; level > 0; level--) {
+            level_nodes.clear();
+            for (int i = 0; i < int(partition_tree.size()); i++)
+                if (partition_tree.at(i).level == level && !tcs.at(i).route_nets.empty())
+                    level_nodes.push_back(i);
+            // Start the biggest regions first, for better load balancing
+            std::stable_sort(level_nodes.begin(), level_nodes.end(), [&](int a, int b) {
+                return tcs.at(a).route_nets.size() > tcs.at(b).route_nets.size();
+            });
+            // Regions are only routed concurrently, and so need to stay within their bounds, with more than one thread
+            auto &thread_pool = ctx->get_thread_pool();
+            bool is_mt = thread_pool.size() > 1;
+            std::atomic<size_t> next_node{0};
+            thread_pool.run(thread_pool.size(), [&](int) {
+                size_t j;
+                while ((j = next_node++) < level_nodes.size())
+                    router_thread(tcs.at(level_nodes.at(j)), is_mt);
+            });
+            // Nets that failed get another attempt in the parent region, which has more room to route in. Iterate in
+            // index order rather than scheduling order to stay deterministic
+            for (int i = 0; i < int(partition_tree.size()); i++) {
+                if (partition_tree.at(i).level != level)
+                    continue;
+                auto &parent = tcs.at(partition_tree.at(i).parent);
+                for (auto fail : tcs.at(i).failed_nets)
+                    parent.route_nets.push_back(fail);
+            }
         }
-        for (auto &t : threads)
-            t.join();
-        threads.clear();
-        // Horizontal splits
-        for (int i = Nq + Nv; i < Nq + Nv + Nh; i++) {
-            threads.emplace_back([this, &tcs, i]() { router_thread(tcs.at(i), /*is_mt=*/true); });
+        auto parallel_end = std::chrono::high_resolution_clock::now();
+        // Singlethreaded part of routing - nets that cross the top-level split
+        // or failed within all the regions below
+        for (auto st_net : tcs.at(0).route_nets)
+            route_net(tcs.at(0), st_net, false);
+        auto route_end = std::chrono::high_resolution_clock::now();
+        stats.parallel_time = std::chrono::duration<double>(parallel_end - route_start).count();
+        stats.serial_time = std::chrono::duration<double>(route_end - parallel_end).count();
+        for (int i = 0; i < int(tcs.size()); i++) {
+            auto &t = tcs.at(i);
+            stats.search.add(t.stats);
+            if (i != 0 && !t.route_nets.empty())
+                stats.regions.push_back(
+                        RegionStats{i, partition_tree.at(i).level, int(t.route_nets.size()), t.route_time});
         }
-        for (auto &t : threads)
-            t.join();
-        threads.clear();
-#endif
-        // Singlethreaded part of routing - nets that cross partitions
-        // or don't fit within bounding box
-        for (auto st_net : tcs.at(N).route_nets)
-            route_net(tcs.at(N), st_net, false);
-        // Failed nets
-        for (int i = 0; i < N; i++)
-            for (auto fail : tcs.at(i).failed_nets)
-                route_net(tcs.at(N), fail, false);
     }
 
     delay_t get_route_delay(int net, store_index<PortRef> usr_idx, int phys_idx)
@@ -1689,7 +1945,7 @@ struct Router2
                 delay_t arc_delay = 0;
                 for (int j = 0; j < int(nd.arcs.at(usr.index.idx()).size()); j++)
                     arc_delay = std::max(arc_delay, get_route_delay(net, usr.index, j));
-                tmg.set_route_delay(CellPortKey(usr.value), DelayPair(arc_delay));
+                tmg.set_route_delay(nd.tmg_ports.at(usr.index.idx()), DelayPair(arc_delay));
             }
         }
     }
@@ -1723,6 +1979,10 @@ struct Router2
         if (timing_driven)
             tmg.run(true);
         do {
+            auto iter_start = std::chrono::high_resolution_clock::now();
+            IterStats stats;
+            stats.iter = iter;
+            stats.nets = int(route_queue.size());
             ctx->sorted_shuffle(route_queue);
 
             if (timing_driven && int(route_queue.size()) >= 30) {
@@ -1730,8 +1990,8 @@ struct Router2
                     NetInfo *ni = nets_by_udata.at(n);
                     auto &net = nets.at(n);
                     net.max_crit = 0;
-                    for (auto &usr : ni->users) {
-                        float c = tmg.get_criticality(CellPortKey(usr));
+                    for (auto usr : ni->users.enumerate()) {
+                        float c = tmg.get_criticality(net.tmg_ports.at(usr.index.idx()));
                         net.max_crit = std::max(net.max_crit, c);
                     }
                 }
@@ -1739,7 +1999,11 @@ struct Router2
                                  [&](int na, int nb) { return nets.at(na).max_crit > nets.at(nb).max_crit; });
             }
 
-            do_route();
+            auto search_start = std::chrono::high_resolution_clock::now();
+            do_route(stats);
+            auto search_end = std::chrono::high_resolution_clock::now();
+            search_time += std::chrono::duration<double>(search_end - search_start).count();
+            total_stats.add(stats.search);
             update_route_delays();
             route_queue.clear();
             update_congestion();
@@ -1803,6 +2067,12 @@ struct Router2
                 log_info("    iter=%d wires=%d overused=%d overuse=%d %sarchfail=%s\n", iter, total_wire_use,
                          overused_wires, total_wire_overuse, resource_str.c_str(),
                          (overused_wires > 0 || tmgfail > 0) ? "NA" : std::to_string(arch_fail).c_str());
+            auto iter_end = std::chrono::high_resolution_clock::now();
+            stats.time = std::chrono::duration<double>(iter_end - iter_start).count();
+            stats.wires = total_wire_use;
+            stats.overused_wires = overused_wires;
+            stats.tmgfail = tmgfail;
+            iter_stats.push_back(std::move(stats));
             ++iter;
             if (curr_cong_weight < 1e9)
                 curr_cong_weight += cfg.curr_cong_mult;
@@ -1819,15 +2089,54 @@ struct Router2
                     int(ctx->nets.at(nets_by_runtime.at(i).second)->users.entries()),
                     nets_by_runtime.at(i).first / 1000.0);
             }
+            double parallel_time = 0, serial_time = 0;
+            for (auto &stats : iter_stats) {
+                parallel_time += stats.parallel_time;
+                serial_time += stats.serial_time;
+            }
+            log_info("Routed %zu arcs, %.1f wires explored per arc, %zu bounding box retries\n", total_stats.arcs,
+                     total_stats.arcs > 0 ? double(total_stats.wires_popped) / total_stats.arcs : 0.0,
+                     total_stats.bb_retries);
+            log_info("Started %zu arcs from nearby routing, %zu (%.1f%%) routed that way\n", total_stats.mode0_tries,
+                     total_stats.mode0_hits,
+                     total_stats.mode0_tries > 0 ? (100.0 * total_stats.mode0_hits) / total_stats.mode0_tries : 0.0);
+            log_info("Spent %.02fs routing regions in parallel, %.02fs routing serially\n", parallel_time, serial_time);
         }
         auto rend = std::chrono::high_resolution_clock::now();
         log_info("Router2 time %.02fs\n", std::chrono::duration<float>(rend - rstart).count());
+        log_info("Router2 explored %.02fM wires in %.02fs of search (%.02fM wires/s)\n",
+                 total_stats.wires_popped / 1e6, search_time,
+                 search_time > 0 ? (total_stats.wires_popped / 1e6) / search_time : 0.0);
+        if (!cfg.perf_json.empty()) {
+            auto perf_json = open_ofstream_and_log_error(cfg.perf_json, "router2 performance statistics");
+            write_perf_json(perf_json, std::chrono::duration<double>(rend - rstart).count());
+            log_info("Wrote router2 performance statistics to %s.\n", cfg.perf_json.c_str());
+        }
 
-        log_info("Running router1 to check that route is legal...\n");
+        pool<IdString> illegal_nets;
+        int illegal = check_all_routing(illegal_nets);
+        if (illegal > 0) {
+            log_info("Running router1 to fix up %d illegally routed arcs and wires in %d nets...\n", illegal,
+                     int(illegal_nets.size()));
 
-        lock.unlock();
+            lock.unlock();
+
+            // Only the nets that failed the check are set up, so router1 doesn't go over the whole design again
+            Router1Cfg router1_cfg(ctx);
+            router1_cfg.onlyNets = std::move(illegal_nets);
+            router1(ctx, router1_cfg);
+            return;
+        }
 
-        router1(ctx, Router1Cfg(ctx));
+        log_info("Route is legal, router1 not needed.\n");
+#ifndef NDEBUG
+        ctx->check();
+        log_assert(ctx->checkRoutedDesign());
+#endif
+        lock.unlock();
+        log_info("Checksum: 0x%08x\n", ctx->checksum());
+        timing_analysis(ctx, true /* slack_histogram */, true /* print_fmax */, true /* print_path */,
+                        true /* warn_on_failure */, true /* update_results */);
     }
 };
 } // namespace
@@ -1858,11 +2167,21 @@ Router2Cfg::Router2Cfg(Context *ctx)
         curr_cong_mult = ctx->setting<float>("router2/currCongWeightMult", 2.0f);
         estimate_weight = ctx->setting<float>("router2/estimateWeight", 1.25f);
     }
+    // By default, aim for about twice as many leaf regions as threads, to allow some load balancing
+    int threads = ctx->get_thread_pool().size();
+    int default_depth = 2;
+    while ((1 << default_depth) < 2 * threads)
+        ++default_depth;
+    partition_max_depth = ctx->setting<int>("router2/partitionDepth", default_depth);
     perf_profile = ctx->setting<bool>("router2/perfProfile", false);
     if (ctx->settings.count(ctx->id("router2/heatmap")))
         heatmap = ctx->settings.at(ctx->id("router2/heatmap")).as_string();
     else
         heatmap = "";
+    if (ctx->settings.count(ctx->id("router2/perfJson")))
+        perf_json = ctx->settings.at(ctx->id("router2/perfJson")).as_string();
+    else if (!heatmap.empty())
+        perf_json = heatmap + "_perf.json";
 }
 
 NEXTPNR_NAMESPACE_END
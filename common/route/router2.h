@@ -54,10 +54,16 @@ struct Router2Cfg
     // of choosing a less congestion/delay-optimal route
     float estimate_weight;
 
+    // Maximum depth of the recursive partitioning of the device used to divide nets between the threads of the
+    // context's thread pool
+    int partition_max_depth;
+
     // Print additional performance profiling information
     bool perf_profile = false;
 
     std::string heatmap;
+    // File to write per-iteration performance statistics to as JSON, by default alongside the heatmaps
+    std::string perf_json;
     std::function<float(Context *ctx, WireId wire, PipId pip, float crit_weight)> get_base_cost = default_base_cost;
 };
 
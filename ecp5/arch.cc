@@ -329,40 +329,38 @@ PipId Arch::getPipByName(IdStringList name) const
 {
     if (name.size() != 3)
         return PipId();
-    auto it = pip_by_name.find(name);
-    if (it != pip_by_name.end())
-        return it->second;
 
     PipId ret;
-    Location loc;
-    std::string basename;
-    loc.x = id_to_x.at(name[0]);
-    loc.y = id_to_y.at(name[1]);
-    ret.location = loc;
-    const LocationTypePOD *loci = loc_info(ret);
-    for (int i = 0; i < loci->pip_data.ssize(); i++) {
-        PipId curr;
-        curr.location = loc;
-        curr.index = i;
-        pip_by_name[getPipName(curr)] = curr;
+    ret.location.x = id_to_x.at(name[0]);
+    ret.location.y = id_to_y.at(name[1]);
+    const std::string &basename = name[2].str(this);
+    auto &pip_names = loc_info(ret)->pip_names;
+    uint32_t hash = pip_name_hash(basename.c_str());
+    auto fnd = std::lower_bound(pip_names.begin(), pip_names.end(), hash,
+                                [](const PipNamePOD &entry, uint32_t value) { return entry.name_hash < value; });
+    // Check every pip with a matching hash, in case of collisions
+    for (; fnd != pip_names.end() && fnd->name_hash == hash; ++fnd) {
+        ret.index = fnd->index;
+        if (get_pip_basename(ret) == basename)
+            return ret;
     }
-    if (pip_by_name.find(name) == pip_by_name.end())
-        NPNR_ASSERT_FALSE_STR("no pip named " + name.str(getCtx()));
-    return pip_by_name[name];
+    NPNR_ASSERT_FALSE_STR("no pip named " + name.str(getCtx()));
 }
 
-IdStringList Arch::getPipName(PipId pip) const
+std::string Arch::get_pip_basename(PipId pip) const
 {
-    NPNR_ASSERT(pip != PipId());
-
-    // TODO: can we improve how pip names are stored/built?
     auto &pip_data = loc_info(pip)->pip_data[pip.index];
     WireId src = getPipSrcWire(pip), dst = getPipDstWire(pip);
-    std::string pip_name = stringf("%d_%d_%s->%d_%d_%s", pip_data.rel_src_loc.x, pip_data.rel_src_loc.y,
-                                   get_wire_basename(src).c_str(this), pip_data.rel_dst_loc.x, pip_data.rel_dst_loc.y,
-                                   get_wire_basename(dst).c_str(this));
+    return stringf("%d_%d_%s->%d_%d_%s", pip_data.rel_src_loc.x, pip_data.rel_src_loc.y,
+                   loc_info(src)->wire_data[src.index].name.get(), pip_data.rel_dst_loc.x, pip_data.rel_dst_loc.y,
+                   loc_info(dst)->wire_data[dst.index].name.get());
+}
 
-    std::array<IdString, 3> ids{x_ids.at(pip.location.x), y_ids.at(pip.location.y), id(pip_name)};
+IdStringList Arch::getPipName(PipId pip) const
+{
+    NPNR_ASSERT(pip != PipId());
+
+    std::array<IdString, 3> ids{x_ids.at(pip.location.x), y_ids.at(pip.location.y), id(get_pip_basename(pip))};
     return IdStringList(ids);
 }
 
@@ -822,46 +820,45 @@ DecalXY Arch::getGroupDecal(GroupId group) const
 
 // -----------------------------------------------------------------------
 
+const CellTimingPOD *Arch::get_cell_timing(IdString tctype) const
+{
+    auto &cell_timings = speed_grade->cell_timings;
+    auto fnd = std::lower_bound(cell_timings.begin(), cell_timings.end(), tctype.index,
+                                [](const CellTimingPOD &tc, int32_t value) { return tc.cell_type < value; });
+    if (fnd == cell_timings.end() || fnd->cell_type != tctype.index)
+        NPNR_ASSERT_FALSE("failed to find timing cell in db");
+    return fnd;
+}
+
 bool Arch::get_delay_from_tmg_db(IdString tctype, IdString from, IdString to, DelayQuad &delay) const
 {
-    auto fnd_dk = celldelay_cache.find({tctype, from, to});
-    if (fnd_dk != celldelay_cache.end()) {
-        delay = fnd_dk->second.second;
-        return fnd_dk->second.first;
-    }
-    for (auto &tc : speed_grade->cell_timings) {
-        if (tc.cell_type == tctype.index) {
-            for (auto &dly : tc.prop_delays) {
-                if (dly.from_port == from.index && dly.to_port == to.index) {
-                    delay = DelayQuad(dly.min_delay, dly.max_delay);
-                    celldelay_cache[{tctype, from, to}] = std::make_pair(true, delay);
-                    return true;
-                }
-            }
-            celldelay_cache[{tctype, from, to}] = std::make_pair(false, DelayQuad());
-            return false;
-        }
-    }
-    NPNR_ASSERT_FALSE("failed to find timing cell in db");
+    auto &prop_delays = get_cell_timing(tctype)->prop_delays;
+    auto key = std::make_pair(from.index, to.index);
+    auto fnd = std::lower_bound(prop_delays.begin(), prop_delays.end(), key,
+                                [](const CellPropDelayPOD &dly, const std::pair<int32_t, int32_t> &value) {
+                                    return std::make_pair(dly.from_port, dly.to_port) < value;
+                                });
+    if (fnd == prop_delays.end() || fnd->from_port != from.index || fnd->to_port != to.index)
+        return false;
+    delay = DelayQuad(fnd->min_delay, fnd->max_delay);
+    return true;
 }
 
 void Arch::get_setuphold_from_tmg_db(IdString tctype, IdString clock, IdString port, DelayPair &setup,
                                      DelayPair &hold) const
 {
-    for (auto &tc : speed_grade->cell_timings) {
-        if (tc.cell_type == tctype.index) {
-            for (auto &sh : tc.setup_holds) {
-                if (sh.clock_port == clock.index && sh.sig_port == port.index) {
-                    setup.max_delay = sh.max_setup;
-                    setup.min_delay = sh.min_setup;
-                    hold.max_delay = sh.max_hold;
-                    hold.min_delay = sh.min_hold;
-                    return;
-                }
-            }
-        }
-    }
-    NPNR_ASSERT_FALSE("failed to find timing cell in db");
+    auto &setup_holds = get_cell_timing(tctype)->setup_holds;
+    auto key = std::make_pair(clock.index, port.index);
+    auto fnd = std::lower_bound(setup_holds.begin(), setup_holds.end(), key,
+                                [](const CellSetupHoldPOD &sh, const std::pair<int32_t, int32_t> &value) {
+                                    return std::make_pair(sh.clock_port, sh.sig_port) < value;
+                                });
+    if (fnd == setup_holds.end() || fnd->clock_port != clock.index || fnd->sig_port != port.index)
+        NPNR_ASSERT_FALSE("failed to find timing cell in db");
+    setup.max_delay = fnd->max_setup;
+    setup.min_delay = fnd->min_setup;
+    hold.max_delay = fnd->max_hold;
+    hold.min_delay = fnd->min_hold;
 }
 
 bool Arch::getCellDelay(const CellInfo *cell, IdString fromPort, IdString toPort, DelayQuad &delay) const
@@ -80,10 +80,17 @@ NPNR_PACKED_STRUCT(struct WireInfoPOD {
     RelSlice<BelPortPOD> bel_pins;
 });
 
+// Pips of a location type sorted by pip_name_hash of their basename, so that getPipByName is a binary search
+NPNR_PACKED_STRUCT(struct PipNamePOD {
+    uint32_t name_hash;
+    int32_t index;
+});
+
 NPNR_PACKED_STRUCT(struct LocationTypePOD {
     RelSlice<BelInfoPOD> bel_data;
     RelSlice<WireInfoPOD> wire_data;
     RelSlice<PipInfoPOD> pip_data;
+    RelSlice<PipNamePOD> pip_names;
 });
 
 NPNR_PACKED_STRUCT(struct PIOInfoPOD {
@@ -151,6 +158,8 @@ NPNR_PACKED_STRUCT(struct CellSetupHoldPOD {
     int32_t max_hold;
 });
 
+// Cell timings are sorted by cell_type, their prop_delays by (from_port, to_port) and their setup_holds by
+// (clock_port, sig_port)
 NPNR_PACKED_STRUCT(struct CellTimingPOD {
     int32_t cell_type;
     RelSlice<CellPropDelayPOD> prop_delays;
@@ -183,6 +192,15 @@ NPNR_PACKED_STRUCT(struct ChipInfoPOD {
     RelSlice<SpeedGradePOD> speed_grades;
 });
 
+// 32-bit FNV-1a, must match pip_name_hash in trellis_import.py
+inline uint32_t pip_name_hash(const char *name)
+{
+    uint32_t hash = 0x811c9dc5;
+    for (; *name; ++name)
+        hash = (hash ^ uint8_t(*name)) * 0x01000193;
+    return hash;
+}
+
 /************************ End of chipdb section. ************************/
 
 struct BelIterator
@@ -418,16 +436,6 @@ struct ArchArgs
     } speed = SPEED_6;
 };
 
-struct DelayKey
-{
-    IdString celltype, from, to;
-    inline bool operator==(const DelayKey &other) const
-    {
-        return celltype == other.celltype && from == other.from && to == other.to;
-    }
-    unsigned int hash() const { return mkhash(celltype.hash(), mkhash(from.hash(), to.hash())); }
-};
-
 struct ArchRanges : BaseArchRanges
 {
     using ArchArgsT = ArchArgs;
@@ -450,8 +458,6 @@ struct Arch : BaseArch<ArchRanges>
     const PackageInfoPOD *package_info;
     const SpeedGradePOD *speed_grade;
 
-    mutable dict<IdStringList, PipId> pip_by_name;
-
     enum class LutPermRule
     {
         NONE,
@@ -747,6 +753,9 @@ struct Arch : BaseArch<ArchRanges>
     virtual bool checkWireAvail(WireId wire) const override { return getBoundWireNet(wire) == nullptr; }
     NetInfo *getBoundWireNet(WireId wire) const override { return wire2net.at(get_wire_vecidx(wire)); }
 
+    int getWireIndex(WireId wire) const override { return get_wire_vecidx(wire); }
+    int getWireCount() const override { return int(wire2net.size()); }
+
     DelayQuad getWireDelay(WireId wire) const override { return DelayQuad(0); }
 
     WireRange getWires() const override
@@ -781,6 +790,8 @@ struct Arch : BaseArch<ArchRanges>
 
     PipId getPipByName(IdStringList name) const override;
     IdStringList getPipName(PipId pip) const override;
+    // The last element of the pip name, which is unique within a location
+    std::string get_pip_basename(PipId pip) const;
 
     uint32_t getPipChecksum(PipId pip) const override { return pip.index; }
 
@@ -1003,6 +1014,8 @@ struct Arch : BaseArch<ArchRanges>
     // Return true if a port is a net
     bool is_global_net(const NetInfo *net) const;
 
+    // Lookups into the speed grade's timing tables, which are immutable and so safe to use from any thread
+    const CellTimingPOD *get_cell_timing(IdString tctype) const;
     bool get_delay_from_tmg_db(IdString tctype, IdString from, IdString to, DelayQuad &delay) const;
     void get_setuphold_from_tmg_db(IdString tctype, IdString clock, IdString port, DelayPair &setup,
                                    DelayPair &hold) const;
@@ -1073,8 +1086,6 @@ struct Arch : BaseArch<ArchRanges>
     dict<WireId, std::pair<int, int>> wire_loc_overrides;
     void setup_wire_locations();
 
-    mutable dict<DelayKey, std::pair<bool, DelayQuad>> celldelay_cache;
-
     static const std::string defaultPlacer;
     static const std::vector<std::string> availablePlacers;
     static const std::string defaultRouter;
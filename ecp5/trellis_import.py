@@ -412,6 +412,12 @@ def process_timing_data():
                     assert False, entry["type"]
             cells.append((celltype, delays, setupholds))
         postprocess_timing_data(cells)
+        # Sorted so that Arch can binary search them. The sorts are stable, so where there are duplicate keys the first
+        # one still wins, as with a linear scan
+        cells.sort(key=lambda c: c[0])
+        for celltype, delays, setupholds in cells:
+            delays.sort(key=lambda d: (d[0], d[1]))
+            setupholds.sort(key=lambda sh: (sh[1], sh[0]))
         pip_class_delays = []
         for i in range(len(pip_class_to_idx)):
             pip_class_delays.append((50, 50, 0, 0))
@@ -434,6 +440,13 @@ def process_timing_data():
         speed_grade_pips[grade] = pip_class_delays
 
 
+# 32-bit FNV-1a, must match pip_name_hash in arch.h
+def pip_name_hash(name):
+    h = 0x811c9dc5
+    for c in name.encode():
+        h = ((h ^ c) * 0x01000193) & 0xffffffff
+    return h
+
 def get_pip_class(wire_from, wire_to):
 
     if "FCO" in wire_from or "FCI" in wire_to:
@@ -459,11 +472,21 @@ def write_database(dev_name, chip, ddrg, endianness):
         for x in range(0, max_col+1):
             loc_with_type[loctypes.index(ddrg.typeAtLocation[pytrellis.Location(x, y)])] = (x, y)
 
-    def get_wire_name(arc_loctype, rel, idx):
+    def get_wire_basename(arc_loctype, rel, idx):
         loc = loc_with_type[arc_loctype]
         lt = ddrg.typeAtLocation[pytrellis.Location(loc[0] + rel.x, loc[1] + rel.y)]
-        wire = ddrg.locationTypes[lt].wires[idx]
-        return "R{}C{}_{}".format(loc[1] + rel.y, loc[0] + rel.x, ddrg.to_str(wire.name))
+        return ddrg.to_str(ddrg.locationTypes[lt].wires[idx].name)
+
+    def get_wire_name(arc_loctype, rel, idx):
+        loc = loc_with_type[arc_loctype]
+        return "R{}C{}_{}".format(loc[1] + rel.y, loc[0] + rel.x, get_wire_basename(arc_loctype, rel, idx))
+
+    # Must match Arch::get_pip_basename
+    def get_pip_basename(arc_loctype, arc):
+        return "{}_{}_{}->{}_{}_{}".format(arc.srcWire.rel.x, arc.srcWire.rel.y,
+            get_wire_basename(arc_loctype, arc.srcWire.rel, arc.srcWire.id),
+            arc.sinkWire.rel.x, arc.sinkWire.rel.y,
+            get_wire_basename(arc_loctype, arc.sinkWire.rel, arc.sinkWire.id))
 
     bba = BinaryBlobAssembler()
     bba.pre('#include "nextpnr.h"')
@@ -494,6 +517,11 @@ def write_database(dev_name, chip, ddrg, endianness):
                 bba.u8(cls, "pip_type")
                 bba.u16(arc.lutperm_flags, "lutperm_flags")
                 bba.u16(0, "padding")
+            bba.l("loc%d_pip_names" % idx, "PipNamePOD")
+            pip_hashes = sorted((pip_name_hash(get_pip_basename(idx, arc)), arc_idx) for arc_idx, arc in enumerate(loctype.arcs))
+            for name_hash, arc_idx in pip_hashes:
+                bba.u32(name_hash, "name_hash")
+                bba.u32(arc_idx, "index")
         if len(loctype.wires) > 0:
             for wire_idx in range(len(loctype.wires)):
                 wire = loctype.wires[wire_idx]
@@ -549,6 +577,7 @@ def write_database(dev_name, chip, ddrg, endianness):
         bba.r_slice("loc%d_bels" % idx if len(loctype.bels) > 0 else None, len(loctype.bels), "bel_data")
         bba.r_slice("loc%d_wires" % idx if len(loctype.wires) > 0 else None, len(loctype.wires), "wire_data")
         bba.r_slice("loc%d_pips" % idx if len(loctype.arcs) > 0 else None, len(loctype.arcs), "pips_data")
+        bba.r_slice("loc%d_pip_names" % idx if len(loctype.arcs) > 0 else None, len(loctype.arcs), "pip_names")
 
     for y in range(0, max_row+1):
         for x in range(0, max_col+1):
@@ -632,7 +661,7 @@ def write_database(dev_name, chip, ddrg, endianness):
             celltype, delays, setupholds = cell
             bba.u32(celltype, "cell_type")
             bba.r_slice("cell_%d_delays_%s" % (celltype, grade) if len(delays) > 0 else None, len(delays), "delays")
-            bba.r_slice("cell_%d_setupholds_%s" % (celltype, grade) if len(delays) > 0 else None, len(setupholds), "setupholds")
+            bba.r_slice("cell_%d_setupholds_%s" % (celltype, grade) if len(setupholds) > 0 else None, len(setupholds), "setupholds")
         bba.l("pip_timing_data_%s" % grade)
         for pipclass in speed_grade_pips[grade]:
             min_delay, max_delay, min_fanout, max_fanout = pipclass
@@ -19,61 +19,503 @@
 
 #include "json_frontend.h"
 #include "frontend_base.h"
-#include "json11.hpp"
 #include "log.h"
 #include "nextpnr.h"
 
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <streambuf>
+#include <string_view>
 
 NEXTPNR_NAMESPACE_BEGIN
 
-using namespace json11;
+namespace {
 
-struct JsonFrontendImpl
+// A flat, read-only representation of a JSON document, with one fixed size node per value in document order. Strings
+// point back into the source text where they have no escapes, so the source must outlive the tape. This avoids the
+// per-value allocations of a DOM, which for large netlists cost several times the size of the file itself.
+//
+// Object members are kept in key order (the last of any duplicate keys winning), matching the std::map based
+// json11::Json that the frontend used to iterate over, so that designs import in the same order as before.
+struct JsonTape
 {
-    // See specification in frontend_base.h
-    JsonFrontendImpl(Json &root) : root(root) {};
-    Json &root;
-    typedef const Json &ModuleDataType;
-    typedef const Json &ModulePortDataType;
-    typedef const Json &CellDataType;
-    typedef const Json &NetnameDataType;
-    typedef const Json::array &BitVectorDataType;
+    enum NodeType
+    {
+        JSON_NULL,
+        JSON_FALSE,
+        JSON_TRUE,
+        JSON_NUMBER,
+        JSON_STRING,
+        JSON_ARRAY,
+        JSON_OBJECT,
+    };
+
+    struct Node
+    {
+        // number: the value as double bits; string: offset into the source, or into unescaped if escaped is set;
+        // object: offset into members
+        uint64_t data;
+        // Index of the node after this value and all of its children
+        uint32_t end;
+        // string: length in bytes; array: number of elements; object: number of (distinct) members
+        uint32_t size : 28;
+        uint32_t type : 3;
+        uint32_t escaped : 1;
+    };
+
+    static constexpr uint32_t max_size = (1u << 28) - 1;
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    const char *src = nullptr;
+    size_t src_len = 0;
+    std::vector<Node> nodes;
+    // Decoded strings that contained escapes
+    std::string unescaped;
+    // For each object, the node indices of its keys sorted by key; the value follows each key
+    std::vector<uint32_t> members;
 
-    template <typename TFunc> void foreach_module(TFunc Func) const
+    NodeType type(uint32_t idx) const { return NodeType(nodes.at(idx).type); }
+
+    std::string_view str(uint32_t idx) const
     {
-        for (const auto &mod : root.object_items())
-            Func(mod.first, mod.second);
+        const Node &n = nodes.at(idx);
+        if (n.type != JSON_STRING)
+            return std::string_view();
+        return std::string_view((n.escaped ? unescaped.data() : src) + n.data, n.size);
     }
 
-    template <typename TFunc> void foreach_port(ModuleDataType &mod, TFunc Func) const
+    double number(uint32_t idx) const
     {
-        const auto &ports = mod["ports"];
-        if (ports.is_null())
-            return;
-        for (const auto &port : ports.object_items())
-            Func(port.first, port.second);
+        const Node &n = nodes.at(idx);
+        if (n.type != JSON_NUMBER)
+            return 0;
+        double value;
+        std::memcpy(&value, &n.data, sizeof(value));
+        return value;
+    }
+
+    int int_value(uint32_t idx) const
+    {
+        // Out of range values come back as something that doesn't compare equal to number(), like json11
+        double value = number(idx);
+        return (value >= INT_MIN && value <= INT_MAX) ? int(value) : 0;
+    }
+
+    uint32_t size(uint32_t idx) const { return nodes.at(idx).size; }
+
+    uint32_t element(uint32_t arr, uint32_t i) const
+    {
+        const Node &n = nodes.at(arr);
+        NPNR_ASSERT(n.type == JSON_ARRAY && i < n.size);
+        // Arrays of scalars, like bit vectors, are indexed directly
+        if (n.end == arr + 1 + n.size)
+            return arr + 1 + i;
+        uint32_t elem = arr + 1;
+        for (; i > 0; --i)
+            elem = nodes.at(elem).end;
+        return elem;
     }
 
-    template <typename TFunc> void foreach_cell(ModuleDataType &mod, TFunc Func) const
+    // The value of member key of an object, or npos if it isn't an object or doesn't have that member
+    uint32_t find(uint32_t obj, std::string_view key) const
     {
-        const auto &cells = mod["cells"];
-        if (cells.is_null())
+        const Node &n = nodes.at(obj);
+        if (n.type != JSON_OBJECT)
+            return npos;
+        auto begin = members.begin() + n.data, end = begin + n.size;
+        auto fnd =
+                std::lower_bound(begin, end, key, [&](uint32_t k, std::string_view value) { return str(k) < value; });
+        if (fnd == end || str(*fnd) != key)
+            return npos;
+        return *fnd + 1;
+    }
+
+    // Calls Func(key, value) for each member of an object, in key order
+    template <typename TFunc> void foreach_member(uint32_t obj, TFunc Func) const
+    {
+        if (obj == npos || type(obj) != JSON_OBJECT)
             return;
-        for (const auto &cell : cells.object_items())
-            Func(cell.first, cell.second);
+        const Node &n = nodes.at(obj);
+        for (uint32_t i = 0; i < n.size; i++) {
+            uint32_t key = members.at(n.data + i);
+            Func(std::string(str(key)), key + 1);
+        }
+    }
+};
+
+struct JsonTapeParser
+{
+    JsonTapeParser(JsonTape &tape, const std::string &filename) : tape(tape), filename(filename) {};
+    JsonTape &tape;
+    const std::string &filename;
+    size_t pos = 0;
+    // Limit on nesting, the same as json11's
+    static constexpr int max_depth = 200;
+
+    [[noreturn]] void fail(const char *what)
+    {
+        int line = 1;
+        for (size_t i = 0; i < pos && i < tape.src_len; i++)
+            if (tape.src[i] == '\n')
+                ++line;
+        log_error("Failed to parse JSON file '%s': %s on line %d.\n", filename.c_str(), what, line);
     }
 
-    template <typename TFunc> void foreach_netname(ModuleDataType &mod, TFunc Func) const
+    bool at_end() const { return pos >= tape.src_len; }
+    char peek() const { return at_end() ? '\0' : tape.src[pos]; }
+
+    void skip_whitespace()
     {
-        const auto &netnames = mod["netnames"];
-        if (netnames.is_null())
+        while (!at_end()) {
+            char c = tape.src[pos];
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                ++pos;
+            } else if (c == '/' && pos + 1 < tape.src_len && tape.src[pos + 1] == '/') {
+                while (!at_end() && tape.src[pos] != '\n')
+                    ++pos;
+            } else if (c == '/' && pos + 1 < tape.src_len && tape.src[pos + 1] == '*') {
+                pos += 2;
+                while (pos + 1 < tape.src_len && !(tape.src[pos] == '*' && tape.src[pos + 1] == '/'))
+                    ++pos;
+                if (pos + 1 >= tape.src_len)
+                    fail("unterminated comment");
+                pos += 2;
+            } else {
+                break;
+            }
+        }
+    }
+
+    uint32_t push(JsonTape::NodeType type, uint64_t data = 0, uint32_t size = 0)
+    {
+        if (tape.nodes.size() >= JsonTape::npos)
+            fail("too many values");
+        uint32_t idx = uint32_t(tape.nodes.size());
+        JsonTape::Node n;
+        n.data = data;
+        n.end = idx + 1;
+        n.size = size;
+        n.type = type;
+        n.escaped = 0;
+        tape.nodes.push_back(n);
+        return idx;
+    }
+
+    void encode_utf8(long pt, std::string &out)
+    {
+        if (pt < 0x80) {
+            out += char(pt);
+        } else if (pt < 0x800) {
+            out += char((pt >> 6) | 0xC0);
+            out += char((pt & 0x3F) | 0x80);
+        } else if (pt < 0x10000) {
+            out += char((pt >> 12) | 0xE0);
+            out += char(((pt >> 6) & 0x3F) | 0x80);
+            out += char((pt & 0x3F) | 0x80);
+        } else {
+            out += char((pt >> 18) | 0xF0);
+            out += char(((pt >> 12) & 0x3F) | 0x80);
+            out += char(((pt >> 6) & 0x3F) | 0x80);
+            out += char((pt & 0x3F) | 0x80);
+        }
+    }
+
+    long parse_hex4()
+    {
+        if (pos + 4 > tape.src_len)
+            fail("bad \\u escape");
+        long value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = tape.src[pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                value |= c - 'A' + 10;
+            else
+                fail("bad \\u escape");
+        }
+        return value;
+    }
+
+    void parse_string()
+    {
+        NPNR_ASSERT(peek() == '"');
+        size_t start = ++pos;
+        // Fast path for strings without escapes, which are left in the source
+        while (!at_end() && tape.src[pos] != '"' && tape.src[pos] != '\\') {
+            if (uint8_t(tape.src[pos]) < 0x20)
+                fail("unescaped control character in string");
+            ++pos;
+        }
+        if (at_end())
+            fail("unterminated string");
+        if (tape.src[pos] == '"') {
+            if (pos - start > JsonTape::max_size)
+                fail("string too long");
+            push(JsonTape::JSON_STRING, start, uint32_t(pos - start));
+            ++pos;
             return;
-        for (const auto &netname : netnames.object_items())
-            Func(netname.first, netname.second);
+        }
+        size_t offset = tape.unescaped.size();
+        tape.unescaped.append(tape.src + start, pos - start);
+        long last_escaped = -1;
+        while (true) {
+            if (at_end())
+                fail("unterminated string");
+            char c = tape.src[pos++];
+            if (c == '"')
+                break;
+            if (uint8_t(c) < 0x20)
+                fail("unescaped control character in string");
+            if (c != '\\') {
+                tape.unescaped += c;
+                last_escaped = -1;
+                continue;
+            }
+            if (at_end())
+                fail("unterminated string");
+            c = tape.src[pos++];
+            if (c == 'u') {
+                long pt = parse_hex4();
+                // Join UTF-16 surrogate pairs
+                if (last_escaped >= 0xD800 && last_escaped <= 0xDBFF && pt >= 0xDC00 && pt <= 0xDFFF) {
+                    // Replace the high surrogate, encoded on its own, with the full code point
+                    tape.unescaped.resize(tape.unescaped.size() - 3);
+                    encode_utf8((((last_escaped - 0xD800) << 10) | (pt - 0xDC00)) + 0x10000, tape.unescaped);
+                    last_escaped = -1;
+                } else {
+                    encode_utf8(pt, tape.unescaped);
+                    last_escaped = pt;
+                }
+                continue;
+            }
+            last_escaped = -1;
+            switch (c) {
+            case 'b':
+                tape.unescaped += '\b';
+                break;
+            case 'f':
+                tape.unescaped += '\f';
+                break;
+            case 'n':
+                tape.unescaped += '\n';
+                break;
+            case 'r':
+                tape.unescaped += '\r';
+                break;
+            case 't':
+                tape.unescaped += '\t';
+                break;
+            case '"':
+            case '\\':
+            case '/':
+                tape.unescaped += c;
+                break;
+            default:
+                fail("invalid escape character in string");
+            }
+        }
+        if (tape.unescaped.size() - offset > JsonTape::max_size)
+            fail("string too long");
+        uint32_t idx = push(JsonTape::JSON_STRING, offset, uint32_t(tape.unescaped.size() - offset));
+        tape.nodes.at(idx).escaped = 1;
+    }
+
+    void parse_number()
+    {
+        size_t start = pos;
+        bool is_int = true;
+        if (peek() == '-')
+            ++pos;
+        if (!(peek() >= '0' && peek() <= '9'))
+            fail("invalid number");
+        while (!at_end()) {
+            char c = tape.src[pos];
+            if (c >= '0' && c <= '9') {
+                ++pos;
+            } else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                is_int = false;
+                ++pos;
+            } else {
+                break;
+            }
+        }
+        double value;
+        size_t len = pos - start;
+        if (is_int && len <= 18) {
+            // Most numbers in a netlist are signal indices, so avoid strtod for them
+            int64_t result = 0;
+            for (size_t i = (tape.src[start] == '-') ? 1 : 0; i < len; i++)
+                result = result * 10 + (tape.src[start + i] - '0');
+            value = double((tape.src[start] == '-') ? -result : result);
+        } else {
+            // The source isn't null terminated, so strtod needs a copy
+            char buf[64];
+            if (len >= sizeof(buf))
+                fail("invalid number");
+            std::memcpy(buf, tape.src + start, len);
+            buf[len] = '\0';
+            char *buf_end;
+            value = std::strtod(buf, &buf_end);
+            if (buf_end != buf + len)
+                fail("invalid number");
+        }
+        uint64_t data;
+        std::memcpy(&data, &value, sizeof(data));
+        push(JsonTape::JSON_NUMBER, data);
+    }
+
+    void parse_literal(const char *text, JsonTape::NodeType type)
+    {
+        size_t len = std::strlen(text);
+        if (tape.src_len - pos < len || std::memcmp(tape.src + pos, text, len) != 0)
+            fail("unexpected character");
+        pos += len;
+        push(type);
     }
 
-    PortType lookup_portdir(const std::string &dir) const
+    void parse_array(int depth)
+    {
+        uint32_t idx = push(JsonTape::JSON_ARRAY);
+        ++pos;
+        uint32_t count = 0;
+        skip_whitespace();
+        if (peek() == ']') {
+            ++pos;
+        } else {
+            while (true) {
+                parse_value(depth + 1);
+                ++count;
+                skip_whitespace();
+                char c = peek();
+                ++pos;
+                if (c == ']')
+                    break;
+                if (c != ',')
+                    fail("expected ',' or ']' in array");
+            }
+        }
+        if (count > JsonTape::max_size)
+            fail("array too long");
+        tape.nodes.at(idx).size = count;
+        tape.nodes.at(idx).end = uint32_t(tape.nodes.size());
+    }
+
+    void parse_object(int depth)
+    {
+        uint32_t idx = push(JsonTape::JSON_OBJECT);
+        ++pos;
+        std::vector<uint32_t> keys;
+        skip_whitespace();
+        if (peek() == '}') {
+            ++pos;
+        } else {
+            while (true) {
+                skip_whitespace();
+                if (peek() != '"')
+                    fail("expected '\"' in object");
+                keys.push_back(uint32_t(tape.nodes.size()));
+                parse_string();
+                skip_whitespace();
+                if (peek() != ':')
+                    fail("expected ':' in object");
+                ++pos;
+                parse_value(depth + 1);
+                skip_whitespace();
+                char c = peek();
+                ++pos;
+                if (c == '}')
+                    break;
+                if (c != ',')
+                    fail("expected ',' or '}' in object");
+            }
+        }
+        // Sort members by key, keeping only the last of any duplicates
+        std::stable_sort(keys.begin(), keys.end(),
+                         [&](uint32_t a, uint32_t b) { return tape.str(a) < tape.str(b); });
+        size_t offset = tape.members.size();
+        for (size_t i = 0; i < keys.size(); i++)
+            if (i + 1 == keys.size() || tape.str(keys.at(i)) != tape.str(keys.at(i + 1)))
+                tape.members.push_back(keys.at(i));
+        if (tape.members.size() - offset > JsonTape::max_size)
+            fail("object too large");
+        tape.nodes.at(idx).data = offset;
+        tape.nodes.at(idx).size = uint32_t(tape.members.size() - offset);
+        tape.nodes.at(idx).end = uint32_t(tape.nodes.size());
+    }
+
+    void parse_value(int depth)
+    {
+        if (depth > max_depth)
+            fail("exceeded maximum nesting depth");
+        skip_whitespace();
+        char c = peek();
+        if (c == '{')
+            parse_object(depth);
+        else if (c == '[')
+            parse_array(depth);
+        else if (c == '"')
+            parse_string();
+        else if (c == '-' || (c >= '0' && c <= '9'))
+            parse_number();
+        else if (c == 't')
+            parse_literal("true", JsonTape::JSON_TRUE);
+        else if (c == 'f')
+            parse_literal("false", JsonTape::JSON_FALSE);
+        else if (c == 'n')
+            parse_literal("null", JsonTape::JSON_NULL);
+        else if (at_end())
+            fail("unexpected end of input");
+        else
+            fail("unexpected character");
+    }
+
+    void operator()()
+    {
+        parse_value(0);
+        skip_whitespace();
+        if (!at_end())
+            fail("unexpected trailing characters");
+    }
+};
+
+struct JsonFrontendImpl
+{
+    // See specification in frontend_base.h
+    JsonFrontendImpl(const JsonTape &tape, uint32_t modules) : tape(tape), modules(modules) {};
+    const JsonTape &tape;
+    uint32_t modules;
+    // All of these are node indices into the tape
+    typedef uint32_t ModuleDataType;
+    typedef uint32_t ModulePortDataType;
+    typedef uint32_t CellDataType;
+    typedef uint32_t NetnameDataType;
+    typedef uint32_t BitVectorDataType;
+
+    template <typename TFunc> void foreach_module(TFunc Func) const { tape.foreach_member(modules, Func); }
+
+    template <typename TFunc> void foreach_port(ModuleDataType mod, TFunc Func) const
+    {
+        tape.foreach_member(tape.find(mod, "ports"), Func);
+    }
+
+    template <typename TFunc> void foreach_cell(ModuleDataType mod, TFunc Func) const
+    {
+        tape.foreach_member(tape.find(mod, "cells"), Func);
+    }
+
+    template <typename TFunc> void foreach_netname(ModuleDataType mod, TFunc Func) const
+    {
+        tape.foreach_member(tape.find(mod, "netnames"), Func);
+    }
+
+    PortType lookup_portdir(std::string_view dir) const
     {
         if (dir == "input")
             return PORT_IN;
@@ -85,126 +527,146 @@ struct JsonFrontendImpl
             NPNR_ASSERT_FALSE("invalid json port direction");
     }
 
-    PortType get_port_dir(ModulePortDataType &port) const { return lookup_portdir(port["direction"].string_value()); }
+    // Members that are missing come back as an empty string, zero or an empty array, like json11's null
+    std::string_view get_str(uint32_t obj, std::string_view key) const
+    {
+        uint32_t val = tape.find(obj, key);
+        return (val == JsonTape::npos) ? std::string_view() : tape.str(val);
+    }
 
-    int get_array_offset(const Json &obj) const
+    int get_int(uint32_t obj, std::string_view key) const
     {
-        auto offset = obj["offset"];
-        return offset.is_null() ? 0 : offset.int_value();
+        uint32_t val = tape.find(obj, key);
+        return (val == JsonTape::npos) ? 0 : tape.int_value(val);
     }
 
-    bool is_array_upto(const Json &obj) const
+    uint32_t get_array(uint32_t obj, std::string_view key) const
     {
-        auto upto = obj["upto"];
-        return upto.is_null() ? false : bool(upto.int_value());
+        uint32_t val = tape.find(obj, key);
+        return (val == JsonTape::npos || tape.type(val) != JsonTape::JSON_ARRAY) ? JsonTape::npos : val;
     }
 
-    BitVectorDataType &get_port_bits(ModulePortDataType &port) const { return port["bits"].array_items(); }
+    PortType get_port_dir(ModulePortDataType port) const { return lookup_portdir(get_str(port, "direction")); }
+
+    int get_array_offset(uint32_t obj) const { return get_int(obj, "offset"); }
 
-    const std::string &get_cell_type(CellDataType &cell) const { return cell["type"].string_value(); }
+    bool is_array_upto(uint32_t obj) const { return bool(get_int(obj, "upto")); }
 
-    Property parse_property(const Json &val) const
+    BitVectorDataType get_port_bits(ModulePortDataType port) const { return get_array(port, "bits"); }
+
+    std::string get_cell_type(CellDataType cell) const { return std::string(get_str(cell, "type")); }
+
+    Property parse_property(uint32_t val) const
     {
-        if (val.is_number()) {
-            if (val.int_value() != val.number_value())
+        if (tape.type(val) == JsonTape::JSON_NUMBER) {
+            if (tape.int_value(val) != tape.number(val))
                 log_error("Found an out-of-range integer parameter in the JSON file.\n"
                           "Please regenerate the input file with an up-to-date version of yosys.\n");
-            return Property(val.int_value(), 32);
+            return Property(tape.int_value(val), 32);
         } else {
-            return Property::from_string(val.string_value());
+            return Property::from_string(std::string(tape.str(val)));
         }
     }
 
-    template <typename TFunc> void foreach_attr(const Json &obj, TFunc Func) const
+    template <typename TFunc> void foreach_property(uint32_t obj, std::string_view key, TFunc Func) const
     {
-        const auto &attrs = obj["attributes"];
-        if (attrs.is_null())
-            return;
-        for (const auto &attr : attrs.object_items()) {
-            Func(attr.first, parse_property(attr.second));
-        }
+        tape.foreach_member(tape.find(obj, key),
+                            [&](const std::string &name, uint32_t value) { Func(name, parse_property(value)); });
     }
 
-    template <typename TFunc> void foreach_param(const Json &obj, TFunc Func) const
+    template <typename TFunc> void foreach_attr(uint32_t obj, TFunc Func) const
     {
-        const auto &params = obj["parameters"];
-        if (params.is_null())
-            return;
-        for (const auto &param : params.object_items()) {
-            Func(param.first, parse_property(param.second));
-        }
+        foreach_property(obj, "attributes", Func);
     }
 
-    template <typename TFunc> void foreach_setting(const Json &obj, TFunc Func) const
+    template <typename TFunc> void foreach_param(uint32_t obj, TFunc Func) const
     {
-        const auto &settings = obj["settings"];
-        if (settings.is_null())
-            return;
-        for (const auto &setting : settings.object_items()) {
-            Func(setting.first, parse_property(setting.second));
-        }
+        foreach_property(obj, "parameters", Func);
+    }
+
+    template <typename TFunc> void foreach_setting(uint32_t obj, TFunc Func) const
+    {
+        foreach_property(obj, "settings", Func);
     }
 
-    template <typename TFunc> void foreach_port_dir(CellDataType &cell, TFunc Func) const
+    template <typename TFunc> void foreach_port_dir(CellDataType cell, TFunc Func) const
     {
-        for (const auto &pdir : cell["port_directions"].object_items())
-            Func(pdir.first, lookup_portdir(pdir.second.string_value()));
+        tape.foreach_member(tape.find(cell, "port_directions"), [&](const std::string &name, uint32_t value) {
+            Func(name, lookup_portdir(tape.str(value)));
+        });
     }
 
-    template <typename TFunc> void foreach_port_conn(CellDataType &cell, TFunc Func) const
+    template <typename TFunc> void foreach_port_conn(CellDataType cell, TFunc Func) const
     {
-        for (const auto &pconn : cell["connections"].object_items())
-            Func(pconn.first, pconn.second.array_items());
+        tape.foreach_member(tape.find(cell, "connections"), [&](const std::string &name, uint32_t value) {
+            Func(name, (tape.type(value) == JsonTape::JSON_ARRAY) ? value : JsonTape::npos);
+        });
     }
 
-    BitVectorDataType &get_net_bits(NetnameDataType &net) const { return net["bits"].array_items(); }
+    BitVectorDataType get_net_bits(NetnameDataType net) const { return get_array(net, "bits"); }
 
-    int get_vector_length(BitVectorDataType &bits) const { return int(bits.size()); }
+    int get_vector_length(BitVectorDataType bits) const { return (bits == JsonTape::npos) ? 0 : int(tape.size(bits)); }
 
-    bool is_vector_bit_undef(BitVectorDataType &bits, int i) const
+    bool is_vector_bit_undef(BitVectorDataType bits, int i) const
     {
-        NPNR_ASSERT(i < int(bits.size()));
-        return bits[i] == "x";
+        NPNR_ASSERT(i < get_vector_length(bits));
+        return tape.str(tape.element(bits, i)) == "x";
     }
 
-    bool is_vector_bit_constant(BitVectorDataType &bits, int i) const
+    bool is_vector_bit_constant(BitVectorDataType bits, int i) const
     {
-        NPNR_ASSERT(i < int(bits.size()));
-        return bits[i].is_string();
+        NPNR_ASSERT(i < get_vector_length(bits));
+        return tape.type(tape.element(bits, i)) == JsonTape::JSON_STRING;
     }
 
-    char get_vector_bit_constval(BitVectorDataType &bits, int i) const
+    char get_vector_bit_constval(BitVectorDataType bits, int i) const
     {
-        auto s = bits.at(i).string_value();
+        auto s = tape.str(tape.element(bits, i));
         NPNR_ASSERT(s.size() == 1);
         return s.at(0);
     }
 
-    int get_vector_bit_signal(BitVectorDataType &bits, int i) const
+    int get_vector_bit_signal(BitVectorDataType bits, int i) const
     {
-        NPNR_ASSERT(bits.at(i).is_number());
-        return bits.at(i).int_value();
+        uint32_t bit = tape.element(bits, i);
+        NPNR_ASSERT(tape.type(bit) == JsonTape::JSON_NUMBER);
+        return tape.int_value(bit);
     }
 };
 
-bool parse_json(std::istream &in, const std::string &filename, Context *ctx)
+bool parse_json_buffer(const char *data, size_t len, const std::string &filename, Context *ctx)
 {
-    Json root;
-    {
-        if (!in)
-            log_error("Failed to open JSON file '%s'.\n", filename.c_str());
-        std::string json_str((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-        std::string error;
-        root = Json::parse(json_str, error, JsonParse::COMMENTS);
-        if (root.is_null())
-            log_error("Failed to parse JSON file '%s': %s.\n", filename.c_str(), error.c_str());
-        root = root["modules"];
-        if (root.is_null())
-            log_error("JSON file '%s' doesn't look like a netlist (doesn't contain \"modules\" key)\n",
-                      filename.c_str());
-    }
-    GenericFrontend<JsonFrontendImpl>(ctx, JsonFrontendImpl(root), /*split_io=*/true)();
+    JsonTape tape;
+    tape.src = data;
+    tape.src_len = len;
+    JsonTapeParser(tape, filename)();
+    uint32_t modules = tape.find(0, "modules");
+    if (modules == JsonTape::npos)
+        log_error("JSON file '%s' doesn't look like a netlist (doesn't contain \"modules\" key)\n", filename.c_str());
+    GenericFrontend<JsonFrontendImpl>(ctx, JsonFrontendImpl(tape, modules), /*split_io=*/true)();
     return true;
 }
+} // namespace
+
+bool parse_json(std::istream &in, const std::string &filename, Context *ctx)
+{
+    if (!in)
+        log_error("Failed to open JSON file '%s'.\n", filename.c_str());
+    std::string json_str((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return parse_json_buffer(json_str.data(), json_str.size(), filename, ctx);
+}
+
+bool parse_json_file(const std::string &filename, Context *ctx)
+{
+    boost::iostreams::mapped_file_source file;
+    try {
+        file.open(filename);
+    } catch (std::exception &) {
+        // Not something that can be mapped, like an empty file or a pipe
+        std::ifstream in(filename);
+        return parse_json(in, filename, ctx);
+    }
+    return parse_json_buffer(file.data(), file.size(), filename, ctx);
+}
 
 NEXTPNR_NAMESPACE_END
@@ -282,6 +282,8 @@ struct Arch : BaseArch<ArchRanges>
     void unbindWire(WireId wire) override;
     bool checkWireAvail(WireId wire) const override;
     NetInfo *getBoundWireNet(WireId wire) const override;
+    int getWireIndex(WireId wire) const override { return wire.index; }
+    int getWireCount() const override { return int(wires.size()); }
     WireId getConflictingWireWire(WireId wire) const override { return wire; }
     NetInfo *getConflictingWireNet(WireId wire) const override;
     DelayQuad getWireDelay(WireId wire) const override { return DelayQuad(0); }
@@ -318,6 +320,8 @@ struct Arch : BaseArch<ArchRanges>
 
     delay_t estimateDelay(WireId src, WireId dst) const override;
     delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const override;
+    // A viaduct uarch may have its own predictDelay
+    bool isPredictDelayRelative() const override { return uarch == nullptr; }
     delay_t getDelayEpsilon() const override { return delay_epsilon; }
     delay_t getRipupDelayPenalty() const override { return ripup_penalty; }
     float getDelayNS(delay_t v) const override { return v; }
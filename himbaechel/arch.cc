@@ -126,6 +126,7 @@ void Arch::load_chipdb(const std::string &path)
         std::filesystem::path p(db_path);
         db_path = p.make_preferred().string();
     }
+    chipdb_path = db_path;
     try {
         blob_file.open(db_path);
         if (db_path.empty() || !blob_file.is_open())
@@ -195,6 +196,8 @@ void Arch::init_tiles()
             NPNR_ASSERT(int(tile_name.size()) == tile);
             tile_name.push_back(name);
             tile_name2idx[name] = tile;
+            tile_wire_index.push_back(wire_count);
+            wire_count += chip_tile_info(chip_info, tile).wires.ssize();
         }
     }
 }
@@ -292,6 +295,8 @@ bool Arch::route()
 {
     set_fast_pip_delays(true);
     uarch->preRoute();
+    if (bool_or_default(settings, id("lookahead")) && !lookahead.ready())
+        lookahead.init(getCtx(), chipdb_path + ".lookahead");
     std::string router = str_or_default(settings, id("router"), defaultRouter);
     if (router == "default") {
         router = uarch->getDefaultRouter();
@@ -27,6 +27,7 @@
 #include "base_arch.h"
 #include "chipdb.h"
 #include "himbaechel_api.h"
+#include "lookahead.h"
 #include "nextpnr_namespaces.h"
 #include "nextpnr_types.h"
 
@@ -480,6 +481,7 @@ struct Arch : BaseArch<ArchRanges>
     void parse_vopt();
 
     // Database references
+    std::string chipdb_path;
     boost::iostreams::mapped_file_source blob_file;
     const ChipInfoPOD *chip_info;
     const PackageInfoPOD *package_info = nullptr;
@@ -548,6 +550,8 @@ struct Arch : BaseArch<ArchRanges>
         return IdString(chip_wire_info(chip_info, wire).const_value);
     }
     WireRange getWires() const override { return WireRange(chip_info); }
+    int getWireIndex(WireId wire) const override { return tile_wire_index.at(wire.tile) + wire.index; }
+    int getWireCount() const override { return wire_count; }
     bool checkWireAvail(WireId wire) const override
     {
         if (!uarch->checkWireAvail(wire))
@@ -670,11 +674,20 @@ struct Arch : BaseArch<ArchRanges>
 
     // -------------------------------------------------
 
-    delay_t estimateDelay(WireId src, WireId dst) const override { return uarch->estimateDelay(src, dst); }
+    delay_t estimateDelay(WireId src, WireId dst) const override
+    {
+        if (lookahead.ready()) {
+            delay_t est = lookahead.estimateDelay(src, dst);
+            if (est >= 0)
+                return est;
+        }
+        return uarch->estimateDelay(src, dst);
+    }
     delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const override
     {
         return uarch->predictDelay(src_bel, src_pin, dst_bel, dst_pin);
     }
+    bool isPredictDelayRelative() const override { return uarch->isPredictDelayRelative(); }
     delay_t getDelayEpsilon() const override { return 20; }                 // TODO
     delay_t getRipupDelayPenalty() const override { return ripup_penalty; } // TODO
     float getDelayNS(delay_t v) const override { return v * 0.001; }
@@ -899,6 +912,9 @@ struct Arch : BaseArch<ArchRanges>
     void set_fast_pip_delays(bool fast_mode);
     std::vector<IdString> tile_name;
     dict<IdString, int> tile_name2idx;
+    // offset of the first wire of each tile in the dense wire index
+    std::vector<int> tile_wire_index;
+    int wire_count = 0;
 
     // -------------------------------------------------
     IdString get_tile_type(int tile) const;
@@ -912,6 +928,9 @@ struct Arch : BaseArch<ArchRanges>
     dict<WireId, uint64_t> drive_res;
     dict<WireId, uint64_t> load_cap;
 
+    // Used in place of the uarch delay estimate, once set up by route() if lookahead is enabled
+    Lookahead lookahead;
+
     delay_t ripup_penalty = 120;
 };
 
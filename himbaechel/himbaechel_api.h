@@ -100,6 +100,9 @@ struct HimbaechelAPI
     // --- Route lookahead ---
     virtual delay_t estimateDelay(WireId src, WireId dst) const;
     virtual delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const;
+    // Uarches whose predictDelay only depends on the bel types, the pins and the offset between the bels may override
+    // this to return true, which allows the predictDelay cache to be used
+    virtual bool isPredictDelayRelative() const { return false; }
     virtual BoundingBox getRouteBoundingBox(WireId src, WireId dst) const;
 
     // Cell->bel pin mapping
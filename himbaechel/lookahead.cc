@@ -0,0 +1,311 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "lookahead.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+#include "log.h"
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+// Number of instances of each wire class that are expanded
+constexpr int samples_per_class = 3;
+// Limit on the wires visited by each expansion, so classes with very dense routing nearby don't take forever
+constexpr int max_visits = 100000;
+// Used to extrapolate if no table reaches its edge
+constexpr int32_t default_per_tile = 100;
+
+constexpr uint32_t cache_magic = 0x4b4c4841;
+constexpr int32_t cache_version = 1;
+} // namespace
+
+void Lookahead::init(Context *ctx, const std::string &cache_file)
+{
+    chip_info = ctx->chip_info;
+    setup_classes();
+
+    std::string signature = ctx->getChipName();
+    if (ctx->speed_grade)
+        signature += "/" + IdString(ctx->speed_grade->name).str(ctx);
+    signature += stringf("/%d/%d", class_count, radius);
+    // Uarch options can change pip availability and delays, and so the tables
+    std::vector<std::string> vopts = ctx->args.vopts;
+    std::sort(vopts.begin(), vopts.end());
+    for (const auto &vopt : vopts)
+        signature += "/" + vopt;
+
+    std::error_code ec;
+    auto cache_time = std::filesystem::last_write_time(cache_file, ec);
+    bool cache_valid = !ec && cache_time >= std::filesystem::last_write_time(ctx->chipdb_path, ec) && !ec;
+    if (cache_valid && read_cache(cache_file, signature)) {
+        log_info("Loaded routing lookahead from %s.\n", cache_file.c_str());
+        return;
+    }
+
+    auto build_start = std::chrono::high_resolution_clock::now();
+    log_info("Building routing lookahead for %d wire classes...\n", class_count);
+    build(ctx);
+    auto build_end = std::chrono::high_resolution_clock::now();
+    log_info("    built routing lookahead in %.02fs\n", std::chrono::duration<float>(build_end - build_start).count());
+    write_cache(cache_file, signature);
+}
+
+void Lookahead::setup_classes()
+{
+    wire_class.clear();
+    wire_class.resize(chip_info->tile_types.size());
+    class_count = 0;
+    for (int type = 0; type < chip_info->tile_types.ssize(); type++) {
+        const auto &wires = chip_info->tile_types[type].wires;
+        dict<int32_t, int32_t> class_by_wire_type;
+        wire_class.at(type).resize(wires.size());
+        for (int i = 0; i < wires.ssize(); i++) {
+            int32_t wire_type = wires[i].wire_type;
+            if (wire_type == 0) {
+                // Untyped wire, nothing is known about what it has in common with other wires
+                wire_class.at(type).at(i) = class_count++;
+            } else {
+                auto found = class_by_wire_type.find(wire_type);
+                if (found == class_by_wire_type.end())
+                    found = class_by_wire_type.emplace(wire_type, class_count++).first;
+                wire_class.at(type).at(i) = found->second;
+            }
+        }
+    }
+}
+
+void Lookahead::build(Context *ctx)
+{
+    // Pick samples of each class from the tiles closest to the middle of the device, so that as much of the table as
+    // possible is inside the device
+    std::vector<int> tiles(chip_info->width * chip_info->height);
+    std::iota(tiles.begin(), tiles.end(), 0);
+    auto dist_to_middle = [&](int tile) {
+        int x, y;
+        tile_xy(chip_info, tile, x, y);
+        return std::abs(x - chip_info->width / 2) + std::abs(y - chip_info->height / 2);
+    };
+    std::stable_sort(tiles.begin(), tiles.end(), [&](int a, int b) { return dist_to_middle(a) < dist_to_middle(b); });
+
+    std::vector<std::vector<WireId>> samples(class_count);
+    int full_classes = 0;
+    for (int tile : tiles) {
+        int type = chip_info->tile_insts[tile].type;
+        for (int i = 0; i < chip_info->tile_types[type].wires.ssize(); i++) {
+            if (!is_root_wire(chip_info, tile, i))
+                continue;
+            auto &class_samples = samples.at(wire_class.at(type).at(i));
+            if (int(class_samples.size()) >= samples_per_class)
+                continue;
+            class_samples.emplace_back(tile, i);
+            if (int(class_samples.size()) == samples_per_class)
+                ++full_classes;
+        }
+        if (full_classes == class_count)
+            break;
+    }
+
+    tables.assign(size_t(class_count) * width * width, -1);
+    per_tile.assign(class_count, -1);
+    auto &thread_pool = ctx->get_thread_pool();
+    thread_pool.run(class_count, [&](int cls) { build_class(ctx, samples.at(cls), cls); });
+
+    // Classes that never reach the edge of their table extrapolate with the median delay per tile of the others
+    std::vector<int32_t> known_per_tile;
+    for (int32_t d : per_tile)
+        if (d >= 0)
+            known_per_tile.push_back(d);
+    int32_t median_per_tile = default_per_tile;
+    if (!known_per_tile.empty()) {
+        std::nth_element(known_per_tile.begin(), known_per_tile.begin() + known_per_tile.size() / 2,
+                         known_per_tile.end());
+        median_per_tile = known_per_tile.at(known_per_tile.size() / 2);
+    }
+    for (auto &d : per_tile)
+        if (d < 0)
+            d = median_per_tile;
+
+    // Fill the offsets that weren't reached from a neighbour closer to the source. Going through them in order of
+    // Manhattan distance means that neighbour has always been filled already.
+    std::vector<std::pair<int, int>> offsets;
+    for (int dy = -radius; dy <= radius; dy++)
+        for (int dx = -radius; dx <= radius; dx++)
+            offsets.emplace_back(dx, dy);
+    std::stable_sort(offsets.begin(), offsets.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+        return std::abs(a.first) + std::abs(a.second) < std::abs(b.first) + std::abs(b.second);
+    });
+    thread_pool.run(class_count, [&](int cls) {
+        int32_t *table = &tables.at(size_t(cls) * width * width);
+        if (table[radius * width + radius] == -1)
+            return;
+        for (auto [dx, dy] : offsets) {
+            int32_t &entry = table[(dy + radius) * width + (dx + radius)];
+            if (entry != -1)
+                continue;
+            int32_t best = std::numeric_limits<int32_t>::max();
+            if (dx != 0)
+                best = std::min(best, table[(dy + radius) * width + (dx - (dx > 0 ? 1 : -1) + radius)]);
+            if (dy != 0)
+                best = std::min(best, table[(dy - (dy > 0 ? 1 : -1) + radius) * width + (dx + radius)]);
+            entry = best + per_tile.at(cls);
+        }
+    });
+}
+
+void Lookahead::build_class(Context *ctx, const std::vector<WireId> &samples, int cls)
+{
+    int32_t *table = &tables.at(size_t(cls) * width * width);
+    bool reached_other_tile = false;
+    for (WireId src : samples) {
+        int sx, sy;
+        tile_xy(chip_info, src.tile, sx, sy);
+        dict<WireId, delay_t> best;
+        std::priority_queue<std::pair<delay_t, WireId>, std::vector<std::pair<delay_t, WireId>>,
+                            std::greater<std::pair<delay_t, WireId>>>
+                queue;
+        best[src] = 0;
+        queue.emplace(0, src);
+        int visits = 0;
+        while (!queue.empty() && visits < max_visits) {
+            auto [cost, wire] = queue.top();
+            queue.pop();
+            if (cost > best.at(wire))
+                continue;
+            ++visits;
+            int x, y;
+            tile_xy(chip_info, wire.tile, x, y);
+            int dx = x - sx, dy = y - sy;
+            if (std::abs(dx) > radius || std::abs(dy) > radius)
+                continue;
+            int32_t &entry = table[(dy + radius) * width + (dx + radius)];
+            if (entry == -1 || cost < entry)
+                entry = cost;
+            if (dx != 0 || dy != 0)
+                reached_other_tile = true;
+            for (PipId pip : ctx->getPipsDownhill(wire)) {
+                WireId next = ctx->getPipDstWire(pip);
+                delay_t next_cost = cost + ctx->getPipDelay(pip).maxDelay() + ctx->getWireDelay(next).maxDelay();
+                auto found = best.find(next);
+                if (found != best.end() && found->second <= next_cost)
+                    continue;
+                best[next] = next_cost;
+                queue.emplace(next_cost, next);
+            }
+        }
+    }
+
+    if (!reached_other_tile) {
+        // Wires that don't lead anywhere, like bel inputs, aren't a useful basis for an estimate
+        std::fill(table, table + width * width, -1);
+        return;
+    }
+
+    // The cheapest delay per tile to the edge of the table
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            if (std::abs(dx) != radius && std::abs(dy) != radius)
+                continue;
+            int32_t entry = table[(dy + radius) * width + (dx + radius)];
+            if (entry == -1)
+                continue;
+            int32_t d = entry / (std::abs(dx) + std::abs(dy));
+            if (per_tile.at(cls) == -1 || d < per_tile.at(cls))
+                per_tile.at(cls) = d;
+        }
+    }
+}
+
+delay_t Lookahead::estimateDelay(WireId src, WireId dst) const
+{
+    int cls = wire_class.at(chip_info->tile_insts[src.tile].type).at(src.index);
+    const int32_t *table = &tables.at(size_t(cls) * width * width);
+    if (table[radius * width + radius] == -1)
+        return -1;
+    int sx, sy, dx, dy;
+    tile_xy(chip_info, src.tile, sx, sy);
+    tile_xy(chip_info, dst.tile, dx, dy);
+    int ox = dx - sx, oy = dy - sy;
+    int cx = std::clamp(ox, -radius, radius), cy = std::clamp(oy, -radius, radius);
+    return table[(cy + radius) * width + (cx + radius)] + per_tile.at(cls) * (std::abs(ox - cx) + std::abs(oy - cy));
+}
+
+bool Lookahead::read_cache(const std::string &filename, const std::string &signature)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+        return false;
+    auto read_int = [&]() {
+        int32_t value = 0;
+        in.read(reinterpret_cast<char *>(&value), sizeof(value));
+        return value;
+    };
+    if (uint32_t(read_int()) != cache_magic || read_int() != cache_version)
+        return false;
+    int32_t sig_len = read_int();
+    if (sig_len != int32_t(signature.size()))
+        return false;
+    std::string file_sig(sig_len, '\0');
+    in.read(file_sig.data(), sig_len);
+    if (!in || file_sig != signature)
+        return false;
+    std::vector<int32_t> file_tables(size_t(class_count) * width * width), file_per_tile(class_count);
+    in.read(reinterpret_cast<char *>(file_tables.data()), file_tables.size() * sizeof(int32_t));
+    in.read(reinterpret_cast<char *>(file_per_tile.data()), file_per_tile.size() * sizeof(int32_t));
+    if (!in)
+        return false;
+    tables = std::move(file_tables);
+    per_tile = std::move(file_per_tile);
+    return true;
+}
+
+void Lookahead::write_cache(const std::string &filename, const std::string &signature) const
+{
+    // Write to a temporary file first, so concurrent runs never see half a cache
+    std::string tmp_filename =
+            filename + stringf(".%lld.tmp", (long long)std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream out(tmp_filename, std::ios::binary);
+        auto write_int = [&](int32_t value) { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+        write_int(int32_t(cache_magic));
+        write_int(cache_version);
+        write_int(int32_t(signature.size()));
+        out.write(signature.data(), signature.size());
+        out.write(reinterpret_cast<const char *>(tables.data()), tables.size() * sizeof(int32_t));
+        out.write(reinterpret_cast<const char *>(per_tile.data()), per_tile.size() * sizeof(int32_t));
+        if (!out) {
+            log_warning("Unable to write routing lookahead cache %s.\n", tmp_filename.c_str());
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_filename, filename, ec);
+    if (ec) {
+        log_warning("Unable to write routing lookahead cache %s: %s.\n", filename.c_str(), ec.message().c_str());
+        std::filesystem::remove(tmp_filename, ec);
+    }
+}
+
+NEXTPNR_NAMESPACE_END
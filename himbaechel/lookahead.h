@@ -0,0 +1,72 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef HIMBAECHEL_LOOKAHEAD_H
+#define HIMBAECHEL_LOOKAHEAD_H
+
+#include <string>
+#include <vector>
+
+#include "archdefs.h"
+#include "chipdb.h"
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+struct Context;
+
+// Routing lookahead built from the chipdb routing graph, along the lines of VPR's map lookahead.
+//
+// Wires are grouped into classes by tile type and wire type (untyped wires get a class each). For each class, a few
+// instances near the middle of the device are expanded with Dijkstra, and the lowest delay to reach any wire in each
+// tile at an offset of up to `radius` tiles is recorded. Offsets outside the table are extrapolated from its edge.
+//
+// Building the tables takes a while on large devices, so they are cached in a file, normally next to the chipdb. The
+// cache is rebuilt if it is older than the chipdb or was built for a different device, speed grade or set of uarch
+// options.
+struct Lookahead
+{
+    static constexpr int radius = 8;
+
+    void init(Context *ctx, const std::string &cache_file);
+    bool ready() const { return !tables.empty(); }
+
+    // Returns -1 if there is no table for the source wire (for example, it has no downhill pips)
+    delay_t estimateDelay(WireId src, WireId dst) const;
+
+  private:
+    static constexpr int width = 2 * radius + 1;
+
+    const ChipInfoPOD *chip_info = nullptr;
+    // Class index by [tile type][tile wire index]
+    std::vector<std::vector<int32_t>> wire_class;
+    int class_count = 0;
+    // width * width delays per class, indexed by (dy + radius) * width + (dx + radius); -1 if the class has no table
+    std::vector<int32_t> tables;
+    // Delay per tile used to extrapolate past the edge of each class's table
+    std::vector<int32_t> per_tile;
+
+    void setup_classes();
+    void build(Context *ctx);
+    void build_class(Context *ctx, const std::vector<WireId> &samples, int cls);
+    bool read_cache(const std::string &filename, const std::string &signature);
+    void write_cache(const std::string &filename, const std::string &signature) const;
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif
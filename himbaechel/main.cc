@@ -53,6 +53,9 @@ po::options_description HimbaechelCommandHandler::getArchOptions()
     specific.add_options()("list-uarch", "list included uarches");
     specific.add_options()("vopt,o", po::value<std::vector<std::string>>(),
                            "options to pass to the himbächel uarch (use help as argument to get more info)");
+    specific.add_options()("lookahead",
+                           "estimate routing delays with lookahead tables built from the routing graph (cached next to "
+                           "the chipdb)");
 
     return specific;
 }
@@ -93,6 +96,8 @@ std::unique_ptr<Context> HimbaechelCommandHandler::createContext(dict<std::strin
         ctx->uarch->with_gui = true;
     ctx->uarch->init(ctx.get());
     ctx->late_init();
+    if (vm.count("lookahead"))
+        ctx->settings[ctx->id("lookahead")] = 1;
     return ctx;
 }
 
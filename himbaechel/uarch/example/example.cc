@@ -89,6 +89,9 @@ struct ExampleImpl : HimbaechelAPI
         }
     }
 
+    // The default predictDelay only uses the distance between the bels
+    bool isPredictDelayRelative() const override { return true; }
+
     // Bel bucket functions
     IdString getBelBucketForCellType(IdString cell_type) const override
     {
@@ -0,0 +1,164 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "fast_bels.h"
+#include "example_test.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExampleBelGridTest : public ExampleTest
+{
+  protected:
+    virtual void SetUp()
+    {
+        ExampleTest::SetUp();
+        for (auto bel : ctx->getBels())
+            if (ctx->getBelType(bel) == ctx->id("LUT4"))
+                luts.push_back(bel);
+    }
+
+    int brute_count(int x0, int y0, int x1, int y1, const pool<BelId> *exclude = nullptr)
+    {
+        int result = 0;
+        for (auto bel : luts) {
+            Loc loc = ctx->getBelLocation(bel);
+            if (loc.x >= x0 && loc.x <= x1 && loc.y >= y0 && loc.y <= y1 && !(exclude && exclude->count(bel)))
+                ++result;
+        }
+        return result;
+    }
+
+    std::vector<BelId> luts;
+};
+
+TEST_F(ExampleBelGridTest, counts)
+{
+    FastBels fast_bels(ctx, false, -1);
+    BelGrid &grid = fast_bels.getGridForCellType(ctx->id("LUT4"));
+    ASSERT_EQ(grid.size(), int(luts.size()));
+    ASSERT_EQ(grid.count_free(), int(luts.size()));
+    for (int i = 0; i < 200; i++) {
+        int x0 = ctx->rng(grid.width() + 4) - 2, y0 = ctx->rng(grid.height() + 4) - 2;
+        int x1 = x0 + ctx->rng(8), y1 = y0 + ctx->rng(8);
+        ASSERT_EQ(grid.count(x0, y0, x1, y1), brute_count(x0, y0, x1, y1));
+        ASSERT_EQ(grid.count_free(x0, y0, x1, y1), brute_count(x0, y0, x1, y1));
+    }
+    // Mark some bels as used, and check the free counts follow
+    pool<BelId> used;
+    for (int i = 0; i < int(luts.size()) / 3; i++) {
+        BelId bel = luts.at(ctx->rng(int(luts.size())));
+        used.insert(bel);
+        grid.set_free(bel, false);
+    }
+    ASSERT_EQ(grid.count_free(), int(luts.size() - used.size()));
+    for (int i = 0; i < 200; i++) {
+        int x0 = ctx->rng(grid.width()), y0 = ctx->rng(grid.height());
+        int x1 = x0 + ctx->rng(8), y1 = y0 + ctx->rng(8);
+        ASSERT_EQ(grid.count_free(x0, y0, x1, y1), brute_count(x0, y0, x1, y1, &used));
+    }
+}
+
+TEST_F(ExampleBelGridTest, random_bel_in_box)
+{
+    FastBels fast_bels(ctx, false, -1);
+    BelGrid &grid = fast_bels.getGridForCellType(ctx->id("LUT4"));
+    pool<BelId> seen;
+    for (int i = 0; i < 2000; i++) {
+        BelId bel = grid.random_bel(*ctx, 2, 3, 4, 5);
+        ASSERT_NE(bel, BelId());
+        Loc loc = ctx->getBelLocation(bel);
+        ASSERT_TRUE(loc.x >= 2 && loc.x <= 4 && loc.y >= 3 && loc.y <= 5);
+        seen.insert(bel);
+    }
+    // Every bel in the box gets picked eventually
+    ASSERT_EQ(int(seen.size()), brute_count(2, 3, 4, 5));
+    ASSERT_EQ(grid.random_bel(*ctx, -5, -5, -1, -1), BelId());
+}
+
+TEST_F(ExampleBelGridTest, nearest_free)
+{
+    FastBels fast_bels(ctx, false, -1);
+    BelGrid &grid = fast_bels.getGridForCellType(ctx->id("LUT4"));
+    int x = grid.width() / 2, y = grid.height() / 2;
+    auto distance = [&](BelId bel) {
+        Loc loc = ctx->getBelLocation(bel);
+        return std::max(std::abs(loc.x - x), std::abs(loc.y - y));
+    };
+    auto any = [](BelId) { return true; };
+    BelId first = grid.nearest_free_bel(ctx, x, y, any);
+    ASSERT_NE(first, BelId());
+    int min_dist = distance(first);
+    for (auto bel : luts)
+        ASSERT_GE(distance(bel), min_dist);
+    // Once everything nearby is used, the next one is further away
+    for (auto bel : luts)
+        if (distance(bel) <= min_dist + 1)
+            grid.set_free(bel, false);
+    BelId next = grid.nearest_free_bel(ctx, x, y, any);
+    ASSERT_NE(next, BelId());
+    ASSERT_EQ(distance(next), min_dist + 2);
+    // Bound bels are skipped, even if they are still marked free
+    CellInfo *ci = ctx->createCell(ctx->id("lut"), ctx->id("LUT4"));
+    ctx->bindBel(next, ci, STRENGTH_WEAK);
+    BelId after_bind = grid.nearest_free_bel(ctx, x, y, any);
+    ASSERT_NE(after_bind, next);
+    ASSERT_NE(after_bind, BelId());
+    // The predicate is respected
+    BelId filtered = grid.nearest_free_bel(ctx, x, y, [&](BelId bel) { return ctx->getBelLocation(bel).z != 0; });
+    ASSERT_NE(filtered, BelId());
+    ASSERT_NE(ctx->getBelLocation(filtered).z, 0);
+}
+
+TEST_F(ExampleBelGridTest, unbound_bel_found_again)
+{
+    FastBels fast_bels(ctx, false, -1);
+    BelGrid &grid = fast_bels.getGridForCellType(ctx->id("LUT4"));
+    BelGrid &bucket_grid = fast_bels.getGridForBelBucket(ctx->getBelBucketForCellType(ctx->id("LUT4")));
+    int x = grid.width() / 2, y = grid.height() / 2;
+    auto any = [](BelId) { return true; };
+    BelId bel = grid.nearest_free_bel(ctx, x, y, any);
+    ASSERT_NE(bel, BelId());
+    CellInfo *ci = ctx->createCell(ctx->id("lut"), ctx->id("LUT4"));
+    ctx->bindBel(bel, ci, STRENGTH_WEAK);
+    fast_bels.setBelFree(bel, false);
+    ASSERT_EQ(grid.count_free(), grid.size() - 1);
+    ASSERT_EQ(bucket_grid.count_free(), bucket_grid.size() - 1);
+    ASSERT_NE(grid.nearest_free_bel(ctx, x, y, any), bel);
+    // Unbinding gives the bel back to every grid holding it
+    ctx->unbindBel(bel);
+    fast_bels.setBelFree(bel, true);
+    ASSERT_EQ(grid.count_free(), grid.size());
+    ASSERT_EQ(bucket_grid.count_free(), bucket_grid.size());
+    ASSERT_EQ(grid.nearest_free_bel(ctx, x, y, any), bel);
+}
+
+TEST_F(ExampleBelGridTest, random_free)
+{
+    FastBels fast_bels(ctx, false, -1);
+    BelGrid &grid = fast_bels.getGridForCellType(ctx->id("LUT4"));
+    // Leave a single bel free
+    for (auto bel : luts)
+        grid.set_free(bel, false);
+    grid.set_free(luts.at(luts.size() / 2), true);
+    for (int i = 0; i < 10; i++)
+        ASSERT_EQ(grid.random_free_bel(ctx, *ctx), luts.at(luts.size() / 2));
+    grid.set_free(luts.at(luts.size() / 2), false);
+    ASSERT_EQ(grid.random_free_bel(ctx, *ctx), BelId());
+}
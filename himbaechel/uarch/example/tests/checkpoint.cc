@@ -0,0 +1,233 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <fstream>
+#include <vector>
+#include "example_test.h"
+#include "log.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExampleCheckpointTest : public ExampleTest
+{
+  protected:
+    virtual void SetUp()
+    {
+        ExampleTest::SetUp();
+        filename = ::testing::TempDir() + "checkpoint_test.npnrckpt";
+    }
+
+    virtual void TearDown()
+    {
+        std::remove(filename.c_str());
+        ExampleTest::TearDown();
+    }
+
+    // LUTs each driving a FF, with parameters, attributes and a clock constraint to carry over
+    void create_design(int lut_count)
+    {
+        set_flow_defaults();
+        ctx->settings[ctx->id("router")] = std::string("router1");
+        auto luts = create_lut_ff_design(lut_count);
+        for (int i = 0; i < lut_count; i++) {
+            luts.at(i)->params[ctx->id("INIT")] = Property(0x8000 + i, 16);
+            luts.at(i)->attrs[ctx->id("src")] = std::string("test.v:") + std::to_string(i);
+        }
+        NetInfo *first = ctx->nets.at(ctx->id("lut0_f")).get();
+        first->clkconstr = std::make_unique<ClockConstraint>();
+        first->clkconstr->period = DelayPair(10000);
+        first->clkconstr->high = DelayPair(5000);
+        first->clkconstr->low = DelayPair(5000);
+        ctx->net_aliases[ctx->id("first_alias")] = first->name;
+        first->aliases.push_back(ctx->id("first_alias"));
+        ctx->design_loaded = true;
+    }
+
+    void write(CheckpointStage stage)
+    {
+        std::ofstream out(filename, std::ios::binary);
+        ctx->writeCheckpoint(out, stage);
+    }
+
+    // Ids are per context, so everything is compared by name
+    std::string name(const Context *c, IdString id) { return id.str(c); }
+
+    template <typename T> std::vector<std::pair<std::string, T>> named(const Context *c, const dict<IdString, T> &d)
+    {
+        std::vector<std::pair<std::string, T>> result;
+        for (auto &entry : d)
+            result.emplace_back(entry.first.str(c), entry.second);
+        return result;
+    }
+
+    std::string bel_name(const Context *c, BelId bel) { return bel == BelId() ? "" : c->nameOfBel(bel); }
+    std::string pip_name(const Context *c, PipId pip) { return pip == PipId() ? "" : c->nameOfPip(pip); }
+
+    // Checks that the design in other is the same as that in ctx, down to the iteration order of everything
+    void check_same(Context *other)
+    {
+        ASSERT_EQ(named(ctx, ctx->settings), named(other, other->settings));
+        ASSERT_EQ(ctx->cells.size(), other->cells.size());
+        auto other_cell = other->cells.begin();
+        for (auto &cell : ctx->cells) {
+            const CellInfo *a = cell.second.get(), *b = other_cell->second.get();
+            ++other_cell;
+            ASSERT_EQ(name(ctx, a->name), name(other, b->name));
+            ASSERT_EQ(name(ctx, a->type), name(other, b->type));
+            ASSERT_EQ(named(ctx, a->params), named(other, b->params));
+            ASSERT_EQ(named(ctx, a->attrs), named(other, b->attrs));
+            ASSERT_EQ(bel_name(ctx, a->bel), bel_name(other, b->bel));
+            ASSERT_EQ(a->belStrength, b->belStrength);
+            ASSERT_EQ(a->ports.size(), b->ports.size());
+            auto other_port = b->ports.begin();
+            for (auto &port : a->ports) {
+                ASSERT_EQ(name(ctx, port.first), name(other, other_port->first));
+                ASSERT_EQ(port.second.type, other_port->second.type);
+                ASSERT_EQ(name(ctx, port.second.net ? port.second.net->name : IdString()),
+                          name(other, other_port->second.net ? other_port->second.net->name : IdString()));
+                ++other_port;
+            }
+        }
+        ASSERT_EQ(ctx->nets.size(), other->nets.size());
+        auto other_net = other->nets.begin();
+        for (auto &net : ctx->nets) {
+            const NetInfo *a = net.second.get(), *b = other_net->second.get();
+            ++other_net;
+            ASSERT_EQ(name(ctx, a->name), name(other, b->name));
+            ASSERT_EQ(name(ctx, a->driver.cell ? a->driver.cell->name : IdString()),
+                      name(other, b->driver.cell ? b->driver.cell->name : IdString()));
+            ASSERT_EQ(name(ctx, a->driver.port), name(other, b->driver.port));
+            std::vector<std::string> a_users, b_users;
+            for (auto &usr : a->users)
+                a_users.push_back(name(ctx, usr.cell->name) + "." + name(ctx, usr.port));
+            for (auto &usr : b->users)
+                b_users.push_back(name(other, usr.cell->name) + "." + name(other, usr.port));
+            ASSERT_EQ(a_users, b_users);
+            ASSERT_EQ(a->wires.size(), b->wires.size());
+            auto other_wire = b->wires.begin();
+            for (auto &wire : a->wires) {
+                ASSERT_EQ(std::string(ctx->nameOfWire(wire.first)), std::string(other->nameOfWire(other_wire->first)));
+                ASSERT_EQ(pip_name(ctx, wire.second.pip), pip_name(other, other_wire->second.pip));
+                ASSERT_EQ(wire.second.strength, other_wire->second.strength);
+                ++other_wire;
+            }
+            ASSERT_EQ(bool(a->clkconstr), bool(b->clkconstr));
+            if (a->clkconstr) {
+                ASSERT_EQ(a->clkconstr->period.max_delay, b->clkconstr->period.max_delay);
+            }
+        }
+        std::vector<std::pair<std::string, std::string>> a_aliases, b_aliases;
+        for (auto &alias : ctx->net_aliases)
+            a_aliases.emplace_back(name(ctx, alias.first), name(ctx, alias.second));
+        for (auto &alias : other->net_aliases)
+            b_aliases.emplace_back(name(other, alias.first), name(other, alias.second));
+        ASSERT_EQ(a_aliases, b_aliases);
+    }
+
+    std::string filename;
+};
+
+TEST_F(ExampleCheckpointTest, netlist_roundtrip)
+{
+    ctx->rngseed(1);
+    create_design(20);
+    write(CheckpointStage::NETLIST);
+    Context *loaded = new_context();
+    ASSERT_EQ(loaded->readCheckpoint(filename), CheckpointStage::NETLIST);
+    ASSERT_TRUE(loaded->design_loaded);
+    check_same(loaded);
+    ASSERT_EQ(loaded->nets.at(loaded->id("lut0_f"))->aliases, std::vector<IdString>({loaded->id("first_alias")}));
+    delete loaded;
+}
+
+TEST_F(ExampleCheckpointTest, routed_roundtrip)
+{
+    ctx->rngseed(1);
+    create_design(40);
+    ASSERT_TRUE(ctx->place());
+    ASSERT_TRUE(ctx->route());
+    write(CheckpointStage::ROUTED);
+    Context *loaded = new_context();
+    ASSERT_EQ(loaded->readCheckpoint(filename), CheckpointStage::ROUTED);
+    check_same(loaded);
+    // The bindings went through the arch, not just into the netlist
+    for (auto &cell : loaded->cells)
+        ASSERT_EQ(loaded->getBoundBelCell(cell.second->bel), cell.second.get());
+    for (auto &net : loaded->nets)
+        for (auto &wire : net.second->wires)
+            ASSERT_EQ(loaded->getBoundWireNet(wire.first), net.second.get());
+    delete loaded;
+}
+
+TEST_F(ExampleCheckpointTest, route_from_placed)
+{
+    ctx->rngseed(1);
+    create_design(40);
+    ASSERT_TRUE(ctx->place());
+    write(CheckpointStage::PLACED);
+    Context *loaded = new_context();
+    ASSERT_EQ(loaded->readCheckpoint(filename), CheckpointStage::PLACED);
+    ASSERT_TRUE(loaded->route());
+    for (auto &net : loaded->nets) {
+        if (net.second->driver.cell && net.second->users.entries() > 0) {
+            ASSERT_FALSE(net.second->wires.empty());
+        }
+    }
+    delete loaded;
+}
+
+TEST_F(ExampleCheckpointTest, errors)
+{
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << "not a checkpoint";
+    }
+    Context *loaded = new_context();
+    EXPECT_THROW(loaded->readCheckpoint(filename), log_execution_error_exception);
+    delete loaded;
+    create_design(5);
+    write(CheckpointStage::NETLIST);
+    std::string contents;
+    {
+        std::ifstream in(filename, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto expect_fails = [&](const std::string &bad) {
+        {
+            std::ofstream out(filename, std::ios::binary);
+            out.write(bad.data(), bad.size());
+        }
+        loaded = new_context();
+        EXPECT_THROW(loaded->readCheckpoint(filename), log_execution_error_exception);
+        delete loaded;
+    };
+    // A truncated file
+    expect_fails(contents.substr(0, contents.size() / 2));
+    auto patch_u32 = [&](size_t offset, uint32_t value) {
+        std::string bad = contents;
+        for (int i = 0; i < 4; i++)
+            bad.at(offset + i) = char(value >> (8 * i));
+        return bad;
+    };
+    // A stage that doesn't exist, just after the magic and version
+    expect_fails(patch_u32(12, uint32_t(CheckpointStage::ROUTED) + 1));
+    // An empty IdString table, whose count is at the offset in the trailer
+    size_t ids_offset = 0;
+    for (int i = 0; i < 8; i++)
+        ids_offset |= size_t(uint8_t(contents.at(contents.size() - 16 + i))) << (8 * i);
+    expect_fails(patch_u32(ids_offset, 0));
+}
@@ -0,0 +1,119 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <set>
+#include <tuple>
+#include <vector>
+#include "example_test.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExampleDelayCacheTest : public ExampleTest
+{
+  protected:
+    virtual void SetUp()
+    {
+        ExampleTest::SetUp();
+        ASSERT_TRUE(ctx->isPredictDelayRelative());
+        ctx->delay_cache.enabled = true;
+        for (BelId bel : ctx->getBels())
+            bels.push_back(bel);
+        for (int i = 0; i < 8; i++)
+            pins.push_back(ctx->idf("P%d", i));
+    }
+
+    // Every arc from the first bel to a later one, with every sink pin
+    struct Arc
+    {
+        BelId src, dst;
+        IdString src_pin, dst_pin;
+    };
+    std::vector<Arc> arcs(int count)
+    {
+        std::vector<Arc> result;
+        for (int i = 1; i < int(bels.size()) && int(result.size()) < count; i++)
+            for (IdString pin : pins)
+                result.push_back(Arc{bels.front(), bels.at(i), pins.front(), pin});
+        return result;
+    }
+
+    // The number of distinct cache keys among some arcs
+    size_t distinct_keys(const std::vector<Arc> &arcs)
+    {
+        std::set<std::tuple<IdString, IdString, IdString, IdString, int, int>> keys;
+        for (const auto &arc : arcs) {
+            Loc src_loc = ctx->getBelLocation(arc.src), dst_loc = ctx->getBelLocation(arc.dst);
+            keys.emplace(ctx->getBelType(arc.src), arc.src_pin, ctx->getBelType(arc.dst), arc.dst_pin,
+                         dst_loc.x - src_loc.x, dst_loc.y - src_loc.y);
+        }
+        return keys.size();
+    }
+
+    std::vector<BelId> bels;
+    std::vector<IdString> pins;
+};
+
+TEST_F(ExampleDelayCacheTest, hit_matches_predict)
+{
+    BelId src = bels.front(), dst = bels.back();
+    delay_t expected = ctx->predictDelay(src, pins.at(0), dst, pins.at(1));
+    ASSERT_EQ(ctx->predictDelayCached(src, pins.at(0), dst, pins.at(1)), expected);
+    ASSERT_EQ(ctx->predictDelayCached(src, pins.at(0), dst, pins.at(1)), expected);
+    ASSERT_EQ(ctx->delay_cache.misses(), 1);
+    ASSERT_EQ(ctx->delay_cache.hits(), 1);
+    ASSERT_EQ(ctx->delay_cache.entries(), 1);
+}
+
+TEST_F(ExampleDelayCacheTest, keeps_entries_when_growing)
+{
+    // Well past the initial table size, so that it is replaced several times
+    auto all = arcs(20000);
+    size_t keys = distinct_keys(all);
+    ASSERT_GT(keys, 2048U);
+    for (const auto &arc : all)
+        ASSERT_EQ(ctx->predictDelayCached(arc.src, arc.src_pin, arc.dst, arc.dst_pin),
+                  ctx->predictDelay(arc.src, arc.src_pin, arc.dst, arc.dst_pin));
+    ASSERT_EQ(ctx->delay_cache.entries(), int64_t(keys));
+    ASSERT_EQ(ctx->delay_cache.misses(), int64_t(keys));
+    // Everything is found again in the grown table
+    int64_t misses = ctx->delay_cache.misses();
+    for (const auto &arc : all)
+        ASSERT_EQ(ctx->predictDelayCached(arc.src, arc.src_pin, arc.dst, arc.dst_pin),
+                  ctx->predictDelay(arc.src, arc.src_pin, arc.dst, arc.dst_pin));
+    ASSERT_EQ(ctx->delay_cache.misses(), misses);
+}
+
+TEST_F(ExampleDelayCacheTest, concurrent_misses)
+{
+    auto all = arcs(20000);
+    size_t keys = distinct_keys(all);
+    // Every task looks up the same arcs starting at a different point, so that tasks miss on the same keys at once
+    const int tasks = 16;
+    std::vector<int> errors(tasks, 0);
+    ctx->get_thread_pool().run(tasks, [&](int t) {
+        for (size_t i = 0; i < all.size(); i++) {
+            const auto &arc = all.at((i + t * 97) % all.size());
+            if (ctx->predictDelayCached(arc.src, arc.src_pin, arc.dst, arc.dst_pin) !=
+                ctx->predictDelay(arc.src, arc.src_pin, arc.dst, arc.dst_pin))
+                ++errors.at(t);
+        }
+    });
+    for (int e : errors)
+        ASSERT_EQ(e, 0);
+    ASSERT_EQ(ctx->delay_cache.entries(), int64_t(keys));
+    ASSERT_EQ(ctx->delay_cache.hits() + ctx->delay_cache.misses(), int64_t(tasks * all.size()));
+}
@@ -0,0 +1,124 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef EXAMPLE_TEST_H
+#define EXAMPLE_TEST_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "command.h"
+#include "gtest/gtest.h"
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// Base fixture for the tests running on the example device, with helpers for building small designs
+class ExampleTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        init_share_dirname();
+        chipArgs.device = "EXAMPLE";
+        ctx = new_context();
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    // The thread pool is sized when first used and never changes, so a test comparing thread counts needs a context
+    // for each; threads is the size of its pool, or 0 for the default
+    Context *new_context(int threads = 0)
+    {
+        Context *result = new Context(chipArgs);
+        if (threads > 0)
+            result->settings[result->id("threads")] = threads;
+        result->uarch->init(result);
+        result->late_init();
+        return result;
+    }
+
+    // The defaults that CommandHandler would otherwise fill in, needed to run the placer and router
+    void set_flow_defaults()
+    {
+        ctx->settings[ctx->id("target_freq")] = std::to_string(100e6);
+        ctx->settings[ctx->id("timing_driven")] = false;
+        ctx->settings[ctx->id("router/tmg_ripup")] = false;
+        ctx->settings[ctx->id("placer")] = std::string("heap");
+        ctx->settings[ctx->id("placerHeap/alpha")] = std::to_string(0.1);
+        ctx->settings[ctx->id("placerHeap/beta")] = std::to_string(0.9);
+        ctx->settings[ctx->id("placerHeap/criticalityExponent")] = std::to_string(2);
+        ctx->settings[ctx->id("placerHeap/timingWeight")] = std::to_string(10);
+    }
+
+    void add_port(CellInfo *cell, const std::string &name, PortType dir)
+    {
+        IdString id = ctx->id(name);
+        cell->ports[id].name = id;
+        cell->ports[id].type = dir;
+    };
+
+    // One of the last few signals created, so that a design built from them has some locality
+    NetInfo *recent_signal(const std::vector<NetInfo *> &signals)
+    {
+        return signals.at(signals.size() - 1 - ctx->rng(std::min(int(signals.size()), 16)));
+    }
+
+    // A network of LUTs with a FF on every LUT output, and no IO, so it can be placed and routed without constraints.
+    // Inputs come from recently created signals, so that it routes without much congestion. Cell and net names start
+    // with prefix; if clk is given, the FFs also have a CLK input connected to it. Returns the LUTs.
+    std::vector<CellInfo *> create_lut_ff_design(int lut_count, const std::string &prefix = "",
+                                                 NetInfo *clk = nullptr)
+    {
+        std::vector<CellInfo *> luts;
+        std::vector<NetInfo *> signals;
+        for (int i = 0; i < lut_count; i++) {
+            CellInfo *lut = ctx->createCell(ctx->id(prefix + stringf("lut%d", i)), ctx->id("LUT4"));
+            for (int j = 0; j < 4; j++)
+                add_port(lut, stringf("I[%d]", j), PORT_IN);
+            add_port(lut, "F", PORT_OUT);
+            CellInfo *ff = ctx->createCell(ctx->id(prefix + stringf("ff%d", i)), ctx->id("DFF"));
+            add_port(ff, "D", PORT_IN);
+            if (clk) {
+                add_port(ff, "CLK", PORT_IN);
+                ff->connectPort(ctx->id("CLK"), clk);
+            }
+            add_port(ff, "Q", PORT_OUT);
+
+            NetInfo *lut_out = ctx->createNet(ctx->id(prefix + stringf("lut%d_f", i)));
+            lut->connectPort(ctx->id("F"), lut_out);
+            ff->connectPort(ctx->id("D"), lut_out);
+            NetInfo *ff_out = ctx->createNet(ctx->id(prefix + stringf("ff%d_q", i)));
+            ff->connectPort(ctx->id("Q"), ff_out);
+
+            for (int j = 0; j < 4 && !signals.empty(); j++)
+                lut->connectPort(ctx->idf("I[%d]", j), recent_signal(signals));
+            signals.push_back(lut_out);
+            signals.push_back(ff_out);
+            luts.push_back(lut);
+        }
+        ctx->assignArchInfo();
+        return luts;
+    }
+
+    ArchArgs chipArgs;
+    Context *ctx;
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif
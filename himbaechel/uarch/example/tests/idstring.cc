@@ -0,0 +1,128 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "idstring_db.h"
+
+USING_NEXTPNR_NAMESPACE
+
+namespace {
+std::vector<std::string> make_names(int count)
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < count; i++)
+        names.push_back("top/inst_" + std::to_string(i / 16) + "/cell_" + std::to_string(i));
+    return names;
+}
+} // namespace
+
+TEST(IdStringDBTest, dense_and_stable)
+{
+    IdStringDB db;
+    ASSERT_EQ(db.get(""), 0);
+    auto names = make_names(100000);
+    std::vector<const std::string *> ptrs;
+    for (int i = 0; i < int(names.size()); i++) {
+        ASSERT_EQ(db.get(names.at(i)), i + 1);
+        ptrs.push_back(&db.str(i + 1));
+    }
+    ASSERT_EQ(db.size(), int(names.size()) + 1);
+    // Growing the tables moves neither the strings nor their indices
+    for (int i = 0; i < int(names.size()); i++) {
+        ASSERT_EQ(db.find(names.at(i)), i + 1);
+        ASSERT_EQ(&db.str(i + 1), ptrs.at(i));
+        ASSERT_EQ(*ptrs.at(i), names.at(i));
+    }
+    ASSERT_EQ(db.find("not_there"), -1);
+}
+
+TEST(IdStringDBTest, concurrent_get)
+{
+    IdStringDB db;
+    const int thread_count = 8;
+    auto names = make_names(20000);
+    // Each thread interns all the names, starting at a different point so that they race on adding the same strings
+    std::vector<std::vector<int>> results(thread_count, std::vector<int>(names.size()));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; t++)
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < names.size(); i++) {
+                size_t n = (i + t * names.size() / thread_count) % names.size();
+                results.at(t).at(n) = db.get(names.at(n));
+            }
+        });
+    // Meanwhile, every string counted by size() must already be readable
+    std::atomic<bool> done{false};
+    std::atomic<int> bad_reads{0};
+    std::thread reader([&]() {
+        while (!done.load()) {
+            int size = db.size();
+            for (int idx = std::max(0, size - 64); idx < size; idx++)
+                if (db.str(idx).empty())
+                    ++bad_reads;
+            std::this_thread::yield();
+        }
+    });
+    for (auto &th : threads)
+        th.join();
+    done.store(true);
+    reader.join();
+
+    ASSERT_EQ(bad_reads.load(), 0);
+    ASSERT_EQ(db.size(), int(names.size()));
+    std::vector<bool> seen(names.size());
+    for (size_t n = 0; n < names.size(); n++) {
+        int idx = results.at(0).at(n);
+        for (int t = 1; t < thread_count; t++)
+            ASSERT_EQ(results.at(t).at(n), idx);
+        ASSERT_EQ(db.str(idx), names.at(n));
+        ASSERT_FALSE(seen.at(idx));
+        seen.at(idx) = true;
+    }
+}
+
+// Interning throughput with a mix of new and existing strings, for 1 to 8 threads sharing one database. This only
+// records numbers, as timings on shared CI machines are too noisy to assert on, so it is disabled by default; run with
+// --gtest_also_run_disabled_tests to see them.
+TEST(IdStringDBTest, DISABLED_throughput)
+{
+    const int lookups = 2000000;
+    auto names = make_names(200000);
+    for (int thread_count : {1, 2, 4, 8}) {
+        IdStringDB db;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; t++)
+            threads.emplace_back([&, t]() {
+                int result = 0;
+                for (int i = t; i < lookups; i += thread_count)
+                    result ^= db.get(names.at((size_t(i) * 7919) % names.size()));
+                ASSERT_GE(result, 0);
+            });
+        for (auto &th : threads)
+            th.join();
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ASSERT_EQ(db.size(), int(names.size()));
+        RecordProperty("lookups_per_sec_" + std::to_string(thread_count) + "_threads", int(lookups / secs));
+    }
+}
@@ -0,0 +1,213 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "json11.hpp"
+#include "json_frontend.h"
+#include "example_test.h"
+#include "log.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+USING_NEXTPNR_NAMESPACE
+
+namespace {
+// A Yosys style netlist of a chain of LUTs, each also fed by a top level input
+std::string make_netlist(int lut_count)
+{
+    std::ostringstream out;
+    out << "{\n  \"creator\": \"test\",\n  \"modules\": {\n    \"top\": {\n";
+    out << "      \"attributes\": { \"top\": \"00000000000000000000000000000001\" },\n";
+    out << "      \"ports\": {\n";
+    out << "        \"a\": { \"direction\": \"input\", \"bits\": [ 2 ] },\n";
+    out << "        \"q\": { \"direction\": \"output\", \"bits\": [ " << (lut_count + 2) << " ] }\n";
+    out << "      },\n      \"cells\": {\n";
+    for (int i = 0; i < lut_count; i++) {
+        out << "        \"lut" << i << "\": {\n";
+        out << "          \"hide_name\": 0,\n          \"type\": \"LUT4\",\n";
+        out << "          \"parameters\": { \"INIT\": \"1010101010101010\" },\n";
+        out << "          \"attributes\": { \"src\": \"top.v:" << i << ".1-" << i << ".20\" },\n";
+        out << "          \"port_directions\": { \"F\": \"output\", \"I[0]\": \"input\", \"I[1]\": \"input\", "
+               "\"I[2]\": \"input\", \"I[3]\": \"input\" },\n";
+        out << "          \"connections\": { \"F\": [ " << (i + 3) << " ], \"I[0]\": [ " << (i + 2)
+            << " ], \"I[1]\": [ 2 ], \"I[2]\": [ \"0\" ], \"I[3]\": [ \"1\" ] }\n";
+        out << "        }" << (i + 1 < lut_count ? "," : "") << "\n";
+    }
+    out << "      },\n      \"netnames\": {\n";
+    for (int i = 0; i < lut_count; i++)
+        out << "        \"n" << i << "\": { \"hide_name\": 0, \"bits\": [ " << (i + 3) << " ], \"attributes\": {} },\n";
+    out << "        \"a\": { \"hide_name\": 0, \"bits\": [ 2 ], \"attributes\": {} }\n";
+    out << "      }\n    }\n  }\n}\n";
+    return out.str();
+}
+} // namespace
+
+class ExampleJsonFrontendTest : public ExampleTest
+{
+  protected:
+    void parse(const std::string &json)
+    {
+        std::istringstream in(json);
+        parse_json(in, "test.json", ctx);
+    }
+};
+
+TEST_F(ExampleJsonFrontendTest, imports_netlist)
+{
+    parse(make_netlist(10));
+    ASSERT_EQ(ctx->top_module, ctx->id("top"));
+    int lut_count = 0;
+    for (auto &cell : ctx->cells)
+        if (cell.second->type == ctx->id("LUT4"))
+            ++lut_count;
+    ASSERT_EQ(lut_count, 10);
+    CellInfo *lut = ctx->cells.at(ctx->id("lut3")).get();
+    ASSERT_EQ(lut->type, ctx->id("LUT4"));
+    ASSERT_EQ(lut->params.at(ctx->id("INIT")).as_int64(), 0xAAAA);
+    ASSERT_EQ(lut->attrs.at(ctx->id("src")).as_string(), "top.v:3.1-3.20");
+    ASSERT_EQ(lut->getPort(ctx->id("I[0]")), ctx->cells.at(ctx->id("lut2"))->getPort(ctx->id("F")));
+    ASSERT_EQ(lut->getPort(ctx->id("I[0]"))->name, ctx->id("n2"));
+    ASSERT_EQ(lut->getPort(ctx->id("I[1]"))->name, ctx->id("a"));
+    ASSERT_EQ(lut->getPort(ctx->id("I[2]"))->driver.cell->type, ctx->id("GND"));
+    ASSERT_EQ(lut->getPort(ctx->id("I[3]"))->driver.cell->type, ctx->id("VCC"));
+}
+
+TEST_F(ExampleJsonFrontendTest, matches_file)
+{
+    std::string json = make_netlist(50);
+    std::string filename = ::testing::TempDir() + "json_frontend_matches_file.json";
+    {
+        std::ofstream out(filename);
+        out << json;
+    }
+    parse_json_file(filename, ctx);
+    Context *ctx2 = new_context();
+    std::istringstream in(json);
+    parse_json(in, "test.json", ctx2);
+    std::remove(filename.c_str());
+    ASSERT_EQ(ctx->cells.size(), ctx2->cells.size());
+    ASSERT_EQ(ctx->nets.size(), ctx2->nets.size());
+    for (auto &net : ctx->nets) {
+        NetInfo *net2 = ctx2->nets.at(net.first).get();
+        ASSERT_EQ(net.second->users.entries(), net2->users.entries());
+    }
+    delete ctx2;
+}
+
+TEST_F(ExampleJsonFrontendTest, strings_and_ordering)
+{
+    // Members come back in key order with the last duplicate winning, as they did with json11's std::map, whatever
+    // the order in the file; escapes and comments are handled
+    parse(R"({
+        "modules": {
+            // a comment
+            "top": {
+                "attributes": { "top": 1 },
+                "cells": {
+                    "c": { "type": "LUT4", "parameters": { "INIT": 1, "INIT": 2 } },
+                    /* another comment */
+                    "a": { "type": "LUT4", "attributes": { "name": "q\"\\\u0041\ud83d\ude00" } },
+                    "b": { "type": "LUT4" }
+                }
+            }
+        }
+    })");
+    std::vector<std::string> names;
+    for (auto &cell : ctx->cells)
+        names.push_back(cell.first.str(ctx));
+    // dict iterates newest first
+    std::reverse(names.begin(), names.end());
+    ASSERT_EQ(names, std::vector<std::string>({"a", "b", "c"}));
+    ASSERT_EQ(ctx->cells.at(ctx->id("c"))->params.at(ctx->id("INIT")).as_int64(), 2);
+    ASSERT_EQ(ctx->cells.at(ctx->id("a"))->attrs.at(ctx->id("name")).as_string(), "q\"\\A\xF0\x9F\x98\x80");
+}
+
+TEST_F(ExampleJsonFrontendTest, errors)
+{
+    EXPECT_THROW(parse("{ \"modules\": { \"top\": { } }"), log_execution_error_exception);
+    EXPECT_THROW(parse("{ \"modules\": { \"top\": [ 1, ] } }"), log_execution_error_exception);
+    EXPECT_THROW(parse("{ \"modules\": { \"top\": \"unterminated } }"), log_execution_error_exception);
+    EXPECT_THROW(parse("{ \"modules\": { } } trailing"), log_execution_error_exception);
+    EXPECT_THROW(parse("{ \"cells\": { } }"), log_execution_error_exception);
+}
+
+#ifndef _WIN32
+// Wall time and peak RSS of loading a large netlist, against the json11 DOM that the frontend used to build. "json11"
+// is just reading the file and building the DOM; "json11_import" then also imports the design while holding the DOM,
+// as the old frontend did, which gives its peak RSS (its time includes a second parse, so isn't meaningful). Each
+// runs in its own process so that peak RSS is separate. This only records numbers, so is disabled by default; run
+// with --gtest_also_run_disabled_tests to see them.
+TEST_F(ExampleJsonFrontendTest, DISABLED_throughput)
+{
+    std::string filename = ::testing::TempDir() + "json_frontend_throughput.json";
+    {
+        std::ofstream out(filename);
+        out << make_netlist(200000);
+    }
+    auto measure = [&](const std::string &label, std::function<void()> load) {
+        int fds[2];
+        ASSERT_EQ(pipe(fds), 0);
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            close(fds[0]);
+            auto start = std::chrono::steady_clock::now();
+            load();
+            double result[2] = {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 0};
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            result[1] = double(usage.ru_maxrss);
+            if (write(fds[1], result, sizeof(result)) != sizeof(result))
+                _exit(1);
+            _exit(0);
+        }
+        close(fds[1]);
+        double result[2];
+        ASSERT_EQ(read(fds[0], result, sizeof(result)), ssize_t(sizeof(result)));
+        close(fds[0]);
+        int status;
+        waitpid(pid, &status, 0);
+        ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        RecordProperty(label + "_ms", int(result[0] * 1000));
+        RecordProperty(label + "_peak_rss_kb", int(result[1]));
+    };
+    auto parse_json11 = [&]() {
+        std::ifstream in(filename);
+        std::string json_str((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::string error;
+        json11::Json root = json11::Json::parse(json_str, error, json11::JsonParse::COMMENTS);
+        if (root.is_null())
+            _exit(1);
+        return root;
+    };
+    measure("json11", [&]() { parse_json11(); });
+    measure("json11_import", [&]() {
+        json11::Json root = parse_json11();
+        parse_json_file(filename, ctx);
+    });
+    measure("tape", [&]() { parse_json_file(filename, ctx); });
+    std::remove(filename.c_str());
+}
+#endif
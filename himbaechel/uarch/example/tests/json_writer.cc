@@ -0,0 +1,395 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "example_test.h"
+#include "json_frontend.h"
+#include "jsonwrite.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExampleJsonWriterTest : public ExampleTest
+{
+  protected:
+    // LUTs with partly connected inputs, so that the writer has to number the missing bits, and a few oddly named
+    // cells and top level ports
+    void create_design(int lut_count)
+    {
+        std::vector<NetInfo *> signals;
+        for (int i = 0; i < lut_count; i++) {
+            CellInfo *lut = ctx->createCell(ctx->idf((i % 7 == 0) ? "$lut\\%d" : "lut%d", i), ctx->id("LUT4"));
+            for (int j = 0; j < 4; j++)
+                add_port(lut, stringf("I[%d]", j), PORT_IN);
+            add_port(lut, "F", PORT_OUT);
+            if (i % 5 == 0)
+                add_port(lut, "UNUSED", PORT_IN);
+            lut->params[ctx->id("INIT")] = Property(0x8000 + i, 16);
+            lut->params[ctx->id("MODE")] = std::string((i % 3 == 0) ? "0101" : "logic\\mode");
+            lut->attrs[ctx->id("src")] = std::string("test.v:") + std::to_string(i);
+            NetInfo *out = ctx->createNet(ctx->idf((i % 11 == 0) ? "$n%d" : "n%d", i));
+            out->attrs[ctx->id("keep")] = Property(1, 1);
+            lut->connectPort(ctx->id("F"), out);
+            for (int j = 0; j < 4 && !signals.empty(); j++)
+                if (ctx->rng(4) != 0)
+                    lut->connectPort(ctx->idf("I[%d]", j), recent_signal(signals));
+            signals.push_back(out);
+        }
+        for (int i = 0; i < 3; i++) {
+            IdString name = ctx->idf("data[%d]", i + 1);
+            ctx->ports[name].name = name;
+            ctx->ports[name].type = PORT_IN;
+            ctx->ports[name].net = (i == 1) ? nullptr : signals.at(i);
+        }
+        IdString clk = ctx->id("clk");
+        ctx->ports[clk].name = clk;
+        ctx->ports[clk].type = PORT_INOUT;
+        ctx->settings[ctx->id("seed")] = std::string("1");
+        ctx->attrs[ctx->id("step")] = std::string("route");
+    }
+
+    // The output with the version in the creator line blanked, and the numbers in bit lists replaced by the names of
+    // the nets they stand for, or by "x<n>" for the n-th dummy bit, so that it doesn't depend on IdString indices
+    std::string normalised(const std::string &json)
+    {
+        int ids = ctx->idstring_db->size(), dummy_base = ids + 1000;
+        std::istringstream in(json);
+        std::ostringstream out;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.find("\"creator\":") != std::string::npos)
+                line = "  \"creator\": \"\",";
+            size_t begin = line.find("[ "), end = line.rfind(" ]");
+            if (begin != std::string::npos && end != std::string::npos && end > begin) {
+                std::istringstream bits(line.substr(begin + 2, end - (begin + 2)));
+                std::string bit, names;
+                while (std::getline(bits, bit, ',')) {
+                    int value = std::stoi(bit);
+                    names += names.empty() ? "" : ", ";
+                    names += (value < ids) ? IdString(value).str(ctx) : stringf("x%d", value - dummy_base);
+                }
+                line = line.substr(0, begin + 2) + names + line.substr(end);
+            }
+            out << line << "\n";
+        }
+        return out.str();
+    }
+
+    std::string write()
+    {
+        std::ostringstream out;
+        std::string filename = "test.json";
+        EXPECT_TRUE(write_json_file(out, filename, ctx));
+        return out.str();
+    }
+};
+
+TEST_F(ExampleJsonWriterTest, format)
+{
+    ctx->rngseed(1);
+    create_design(30);
+    std::string json = write();
+    auto contains = [&](const std::string &text) { return json.find(text) != std::string::npos; };
+    ASSERT_TRUE(contains("        \"$lut\\\\0\": {\n          \"hide_name\": 1,\n          \"type\": \"LUT4\",\n"));
+    ASSERT_TRUE(contains("            \"MODE\": \"0101 \",\n"));
+    ASSERT_TRUE(contains("            \"MODE\": \"logic\\\\mode\",\n"));
+    ASSERT_TRUE(contains("            \"INIT\": \"1000000000000010\"\n"));
+    ASSERT_TRUE(contains("            \"UNUSED\": [  ],\n"));
+    ASSERT_TRUE(contains("          \"offset\": 1,\n"));
+    ASSERT_TRUE(contains(stringf("          \"bits\": [ %d ] ,\n", ctx->id("n1").index)));
+    // Disconnected bits are numbered in the order they are written, from just after an offset past every id
+    int dummy = ctx->idstring_db->size() + 1000;
+    int dummy_count = 0;
+    for (size_t pos = json.find("[ "); pos != std::string::npos; pos = json.find("[ ", pos + 1)) {
+        std::istringstream bits(json.substr(pos + 2, json.find(" ]", pos) - (pos + 2)));
+        std::string bit;
+        while (std::getline(bits, bit, ',')) {
+            if (std::stoi(bit) > dummy) {
+                ASSERT_EQ(std::stoi(bit), dummy + 1);
+                ++dummy;
+                ++dummy_count;
+            }
+        }
+    }
+    ASSERT_GT(dummy_count, 0);
+}
+
+TEST_F(ExampleJsonWriterTest, thread_count_independent)
+{
+    auto write_with = [&](int threads) {
+        delete ctx;
+        ctx = new_context(threads);
+        // Enough cells and nets that they are written in parallel blocks
+        ctx->rngseed(1);
+        create_design(3000);
+        std::string json = write();
+        // Other than the setting itself, the output should be the same
+        std::string setting = "\"threads\": \"";
+        size_t pos = json.find(setting);
+        EXPECT_NE(pos, std::string::npos);
+        return json.replace(pos, json.find('"', pos + setting.size()) - pos, "\"threads\": \"N");
+    };
+    std::string serial = write_with(1);
+    ASSERT_EQ(write_with(3), serial);
+    ASSERT_EQ(write_with(8), serial);
+}
+
+TEST_F(ExampleJsonWriterTest, round_trip)
+{
+    ctx->rngseed(1);
+    create_design(2000);
+    // The top level inputs would conflict with the LUTs driving the same nets
+    ctx->ports.clear();
+    std::istringstream in(write());
+    Context *loaded = new_context();
+    ASSERT_TRUE(parse_json(in, "test.json", loaded));
+    ASSERT_EQ(loaded->cells.size(), ctx->cells.size());
+    for (auto &cell : ctx->cells) {
+        const CellInfo *other = loaded->cells.at(loaded->id(cell.first.str(ctx))).get();
+        ASSERT_EQ(other->params.at(loaded->id("INIT")), cell.second->params.at(ctx->id("INIT")));
+        for (auto &port : cell.second->ports) {
+            const NetInfo *net = other->getPort(loaded->id(port.first.str(ctx)));
+            // Each missing bit of a bus gets its own dummy number, so comes back as an undriven net of its own
+            if (port.second.net) {
+                ASSERT_EQ(net->name.str(loaded), port.second.net->name.str(ctx));
+            } else if (net) {
+                ASSERT_TRUE(net->driver.cell == nullptr && net->users.entries() == 1);
+            }
+        }
+    }
+    delete loaded;
+}
+
+// Wall time of writing a large design, serially and on the default thread pool. This only records numbers, so is
+// disabled by default; run with --gtest_also_run_disabled_tests to see them.
+TEST_F(ExampleJsonWriterTest, DISABLED_throughput)
+{
+    for (int threads : {1, 8}) {
+        delete ctx;
+        ctx = new_context(threads);
+        ctx->rngseed(1);
+        create_design(200000);
+        std::string filename = ::testing::TempDir() + "json_writer_throughput.json";
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::ofstream out(filename);
+            ASSERT_TRUE(write_json_file(out, filename, ctx));
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::remove(filename.c_str());
+        RecordProperty(stringf("threads_%d_ms", threads), int(elapsed * 1000));
+    }
+}
+
+// The output for a fixed design must match what the writer produced before it was parallelised
+TEST_F(ExampleJsonWriterTest, golden)
+{
+    ctx->rngseed(1);
+    create_design(6);
+    const std::string expected = R"({
+  "creator": "",
+  "modules": {
+    "top": {
+      "settings": {
+        "seed": "1 "
+      },
+      "attributes": {
+        "step": "route"
+      },
+      "ports": {
+        "clk": {
+          "direction": "inout",
+          "bits": [ clk ]
+        },
+        "data": {
+          "direction": "input",
+          "offset": 1,
+          "bits": [ $n0, data[2], n2 ]
+        }
+      },
+      "cells": {
+        "lut5": {
+          "hide_name": 0,
+          "type": "LUT4",
+          "parameters": {
+            "MODE": "logic\\mode",
+            "INIT": "1000000000000101"
+          },
+          "attributes": {
+            "src": "test.v:5"
+          },
+          "port_directions": {
+            "UNUSED": "input",
+            "F": "output",
+            "I": "input"
+          },
+          "connections": {
+            "UNUSED": [  ],
+            "F": [ n5 ],
+            "I": [ n2, n3, x1, n1 ]
+          }
+        },
+        "lut4": {
+          "hide_name": 0,
+          "type": "LUT4",
+          "parameters": {
+            "MODE": "logic\\mode",
+            "INIT": "1000000000000100"
+          },
+          "attributes": {
+            "src": "test.v:4"
+          },
+          "port_directions": {
+            "F": "output",
+            "I": "input"
+          },
+          "connections": {
+            "F": [ n4 ],
+            "I": [ $n0, n1, x2, $n0 ]
+          }
+        },
+        "lut3": {
+          "hide_name": 0,
+          "type": "LUT4",
+          "parameters": {
+            "MODE": "0101 ",
+            "INIT": "1000000000000011"
+          },
+          "attributes": {
+            "src": "test.v:3"
+          },
+          "port_directions": {
+            "F": "output",
+            "I": "input"
+          },
+          "connections": {
+            "F": [ n3 ],
+            "I": [ n2, n1, n2, n2 ]
+          }
+        },
+        "lut2": {
+          "hide_name": 0,
+          "type": "LUT4",
+          "parameters": {
+            "MODE": "logic\\mode",
+            "INIT": "1000000000000010"
+          },
+          "attributes": {
+            "src": "test.v:2"
+          },
+          "port_directions": {
+            "F": "output",
+            "I": "input"
+          },
+          "connections": {
+            "F": [ n2 ],
+            "I": [ x3, x4, $n0, n1 ]
+          }
+        },
+        "lut1": {
+          "hide_name": 0,
+          "type": "LUT4",
+          "parameters": {
+            "MODE": "logic\\mode",
+            "INIT": "1000000000000001"
+          },
+          "attributes": {
+            "src": "test.v:1"
+          },
+          "port_directions": {
+            "F": "output",
+            "I": "input"
+          },
+          "connections": {
+            "F": [ n1 ],
+            "I": [ x5, $n0, $n0, $n0 ]
+          }
+        },
+        "$lut\\0": {
+          "hide_name": 1,
+          "type": "LUT4",
+          "parameters": {
+            "MODE": "0101 ",
+            "INIT": "1000000000000000"
+          },
+          "attributes": {
+            "src": "test.v:0"
+          },
+          "port_directions": {
+            "UNUSED": "input",
+            "F": "output",
+            "I": "input"
+          },
+          "connections": {
+            "UNUSED": [  ],
+            "F": [ $n0 ],
+            "I": [ x6, x7, x8, x9 ]
+          }
+        }
+      },
+      "netnames": {
+        "n5": {
+          "hide_name": 0,
+          "bits": [ n5 ] ,
+          "attributes": {
+            "keep": "1"
+          }
+        },
+        "n4": {
+          "hide_name": 0,
+          "bits": [ n4 ] ,
+          "attributes": {
+            "keep": "1"
+          }
+        },
+        "n3": {
+          "hide_name": 0,
+          "bits": [ n3 ] ,
+          "attributes": {
+            "keep": "1"
+          }
+        },
+        "n2": {
+          "hide_name": 0,
+          "bits": [ n2 ] ,
+          "attributes": {
+            "keep": "1"
+          }
+        },
+        "n1": {
+          "hide_name": 0,
+          "bits": [ n1 ] ,
+          "attributes": {
+            "keep": "1"
+          }
+        },
+        "$n0": {
+          "hide_name": 1,
+          "bits": [ $n0 ] ,
+          "attributes": {
+            "keep": "1"
+          }
+        }
+      }
+    }
+  }
+}
+)";
+    ASSERT_EQ(normalised(write()), expected);
+}
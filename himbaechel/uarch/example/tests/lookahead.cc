@@ -0,0 +1,127 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include "example_test.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExampleLookaheadTest : public ExampleTest
+{
+  protected:
+    virtual void SetUp()
+    {
+        ExampleTest::SetUp();
+        // Not the real cache next to the chipdb, which must be left alone, and unique so test runs can overlap
+        cache_file = (std::filesystem::temp_directory_path() /
+                      stringf("nextpnr-lookahead-test-%lld.lookahead",
+                              (long long)std::chrono::steady_clock::now().time_since_epoch().count()))
+                             .string();
+        std::filesystem::remove(cache_file);
+    }
+
+    virtual void TearDown()
+    {
+        std::filesystem::remove(cache_file);
+        ExampleTest::TearDown();
+    }
+
+    // The wire with a given name in the first LOGIC tile at or right of (x, y)
+    WireId logic_wire(int x, int y, const std::string &name)
+    {
+        for (; x < ctx->getGridDimX(); x++) {
+            int tile = tile_by_xy(ctx->chip_info, x, y);
+            if (ctx->get_tile_type(tile) != ctx->id("LOGIC"))
+                continue;
+            const auto &wires = chip_tile_info(ctx->chip_info, tile).wires;
+            for (int i = 0; i < wires.ssize(); i++)
+                if (IdString(wires[i].name) == ctx->id(name))
+                    return WireId(tile, i);
+        }
+        return WireId();
+    }
+
+    std::string cache_file;
+};
+
+TEST_F(ExampleLookaheadTest, grows_with_distance)
+{
+    Lookahead lookahead;
+    lookahead.init(ctx, cache_file);
+    ASSERT_TRUE(lookahead.ready());
+
+    WireId src = logic_wire(50, 50, "SWITCH0");
+    ASSERT_NE(src, WireId());
+    int sx = src.tile % ctx->getGridDimX();
+    delay_t near = lookahead.estimateDelay(src, logic_wire(sx + 2, 50, "L0_I0"));
+    delay_t far = lookahead.estimateDelay(src, logic_wire(sx + 6, 56, "L0_I0"));
+    // Outside the table, so extrapolated
+    delay_t very_far = lookahead.estimateDelay(src, logic_wire(sx + 30, 80, "L0_I0"));
+    ASSERT_GT(near, 0);
+    ASSERT_GT(far, near);
+    ASSERT_GT(very_far, far);
+
+    // Bel inputs have no downhill pips, so there is no table for them
+    ASSERT_EQ(lookahead.estimateDelay(logic_wire(50, 50, "L0_I0"), src), -1);
+}
+
+TEST_F(ExampleLookaheadTest, cache_matches_built)
+{
+    Lookahead built;
+    built.init(ctx, cache_file);
+    ASSERT_TRUE(std::filesystem::exists(cache_file));
+    // A rebuild would write the cache again, so give it a time that a new file won't have, and check it is kept
+    auto marker = std::filesystem::last_write_time(ctx->chipdb_path);
+    std::filesystem::last_write_time(cache_file, marker);
+    Lookahead cached;
+    cached.init(ctx, cache_file);
+    ASSERT_TRUE(cached.ready());
+    ASSERT_EQ(std::filesystem::last_write_time(cache_file), marker);
+
+    WireId src = logic_wire(40, 40, "SWITCH3");
+    ASSERT_NE(src, WireId());
+    for (int y = 30; y < 60; y += 3) {
+        WireId dst = logic_wire(45, y, "L1_I2");
+        ASSERT_EQ(built.estimateDelay(src, dst), cached.estimateDelay(src, dst));
+    }
+}
+
+TEST_F(ExampleLookaheadTest, corrupt_cache_rebuilt)
+{
+    Lookahead built;
+    built.init(ctx, cache_file);
+    {
+        std::ofstream out(cache_file, std::ios::binary | std::ios::trunc);
+        out << "not a lookahead";
+    }
+    // Recent enough to be used, if it could be read
+    auto marker = std::filesystem::last_write_time(ctx->chipdb_path);
+    std::filesystem::last_write_time(cache_file, marker);
+    Lookahead rebuilt;
+    rebuilt.init(ctx, cache_file);
+    ASSERT_TRUE(rebuilt.ready());
+    ASSERT_NE(std::filesystem::last_write_time(cache_file), marker);
+
+    WireId src = logic_wire(40, 40, "SWITCH3");
+    ASSERT_NE(src, WireId());
+    for (int y = 30; y < 60; y += 3) {
+        WireId dst = logic_wire(45, y, "L1_I2");
+        ASSERT_EQ(built.estimateDelay(src, dst), rebuilt.estimateDelay(src, dst));
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+#include "example_test.h"
+#include "placer_multilevel.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExamplePlacerMultilevelTest : public ExampleTest
+{
+  protected:
+    virtual void SetUp()
+    {
+        ExampleTest::SetUp();
+        for (auto bel : ctx->getBels()) {
+            Loc loc = ctx->getBelLocation(bel);
+            max_x = std::max(max_x, loc.x);
+            max_y = std::max(max_y, loc.y);
+        }
+    }
+
+    // A chain of LUTs, each also fed by a few of the ones before it
+    std::vector<CellInfo *> create_design(int lut_count)
+    {
+        std::vector<CellInfo *> luts;
+        for (int i = 0; i < lut_count; i++) {
+            CellInfo *lut = ctx->createCell(ctx->idf("lut%d", i), ctx->id("LUT4"));
+            for (int j = 0; j < 4; j++)
+                add_port(lut, stringf("I[%d]", j), PORT_IN);
+            add_port(lut, "F", PORT_OUT);
+            lut->connectPort(ctx->id("F"), ctx->createNet(ctx->idf("lut%d_f", i)));
+            for (int j = 0; j < 4 && j < i; j++) {
+                CellInfo *src = luts.at(i - 1 - ctx->rng(std::min(i, 8)));
+                lut->connectPort(ctx->idf("I[%d]", j), src->getPort(ctx->id("F")));
+            }
+            luts.push_back(lut);
+        }
+        return luts;
+    }
+
+    int max_x = 0, max_y = 0;
+};
+
+TEST_F(ExamplePlacerMultilevelTest, places_within_grid)
+{
+    ctx->rngseed(1);
+    auto cells = create_design(400);
+    PlacerMultilevelCfg cfg(ctx);
+    // Small enough that several levels are used
+    cfg.min_clusters = 20;
+    auto result = placer_multilevel(ctx, cfg, cells, [](const CellInfo *, Loc &) { return false; });
+    ASSERT_EQ(result.size(), cells.size());
+    for (const auto &loc : result) {
+        ASSERT_GE(loc.x, 0);
+        ASSERT_LT(loc.x, max_x + 1);
+        ASSERT_GE(loc.y, 0);
+        ASSERT_LT(loc.y, max_y + 1);
+    }
+    // Spreading has to have moved cells apart, rather than leaving them all at the centre
+    auto minmax_x = std::minmax_element(result.begin(), result.end(),
+                                        [](const MultilevelLoc &a, const MultilevelLoc &b) { return a.x < b.x; });
+    ASSERT_GT(minmax_x.second->x - minmax_x.first->x, 2.0);
+}
+
+TEST_F(ExamplePlacerMultilevelTest, fixed_cells_pull)
+{
+    ctx->rngseed(1);
+    auto cells = create_design(100);
+    // Anchor the start of the chain in a corner, which should pull its neighbours towards it
+    CellInfo *fixed = cells.front();
+    cells.erase(cells.begin());
+    PlacerMultilevelCfg cfg(ctx);
+    cfg.min_clusters = 10;
+    auto result = placer_multilevel(ctx, cfg, cells, [&](const CellInfo *ci, Loc &loc) {
+        if (ci != fixed)
+            return false;
+        loc = Loc(0, 0, 0);
+        return true;
+    });
+    ASSERT_EQ(result.size(), cells.size());
+    double first = result.front().x + result.front().y, last = result.back().x + result.back().y;
+    ASSERT_LT(first, last);
+}
+
+TEST_F(ExamplePlacerMultilevelTest, heap_from_multilevel)
+{
+    set_flow_defaults();
+    ctx->settings[ctx->id("placerHeap/multilevel")] = true;
+    ctx->rngseed(1);
+    create_design(200);
+    ctx->assignArchInfo();
+    ASSERT_TRUE(ctx->place());
+    for (auto &cell : ctx->cells)
+        ASSERT_NE(cell.second->bel, BelId());
+}
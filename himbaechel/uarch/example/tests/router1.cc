@@ -0,0 +1,79 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <vector>
+#include "example_test.h"
+#include "router1.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExampleRouter1Test : public ExampleTest
+{
+  protected:
+    virtual void SetUp()
+    {
+        ExampleTest::SetUp();
+        set_flow_defaults();
+    }
+
+    // The bound wires of every net, by name, in iteration order
+    std::vector<std::pair<IdString, std::vector<WireId>>> all_wires()
+    {
+        std::vector<std::pair<IdString, std::vector<WireId>>> result;
+        for (auto &net : ctx->nets) {
+            std::vector<WireId> wires;
+            for (auto &wire : net.second->wires)
+                wires.push_back(wire.first);
+            result.emplace_back(net.first, wires);
+        }
+        return result;
+    }
+};
+
+TEST_F(ExampleRouter1Test, only_nets)
+{
+    ctx->rngseed(1);
+    create_lut_ff_design(40);
+    ASSERT_TRUE(ctx->place());
+    ASSERT_TRUE(router1(ctx, Router1Cfg(ctx)));
+    // Cut the routing of one net in the middle, so that some of its arcs no longer reach the source
+    NetInfo *broken = nullptr;
+    for (auto &net : ctx->nets)
+        if (net.second->wires.size() >= 4 && (broken == nullptr || net.first < broken->name))
+            broken = net.second.get();
+    ASSERT_NE(broken, nullptr);
+    WireId cut;
+    for (auto &wire : broken->wires)
+        if (wire.second.pip != PipId() && ctx->getPipSrcWire(wire.second.pip) != ctx->getNetinfoSourceWire(broken))
+            cut = wire.first;
+    ASSERT_NE(cut, WireId());
+    ctx->unbindWire(cut);
+    auto before = all_wires();
+
+    Router1Cfg cfg(ctx);
+    cfg.onlyNets.insert(broken->name);
+    ASSERT_TRUE(router1(ctx, cfg));
+    ASSERT_TRUE(ctx->checkRoutedDesign());
+    // There is plenty of room, so the other nets are left alone
+    auto after = all_wires();
+    ASSERT_EQ(before.size(), after.size());
+    for (size_t i = 0; i < before.size(); i++) {
+        if (before.at(i).first != broken->name) {
+            ASSERT_EQ(before.at(i), after.at(i));
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "example_test.h"
+#include "json11.hpp"
+#include "router2.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExampleRouter2Test : public ExampleTest
+{
+  protected:
+    virtual void SetUp()
+    {
+        ExampleTest::SetUp();
+        set_flow_defaults();
+        perf_file = std::filesystem::temp_directory_path() /
+                    stringf("nextpnr-router2-test-%lld.json",
+                            (long long)std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    virtual void TearDown()
+    {
+        std::filesystem::remove(perf_file);
+        ExampleTest::TearDown();
+    }
+
+    std::filesystem::path perf_file;
+};
+
+// Search throughput of router2 on a placed design, for comparing changes to its per-wire data. Disabled by default as
+// it takes a while and only records numbers; run with --gtest_also_run_disabled_tests and look for the wires_per_sec
+// property in the output (or the XML report with --gtest_output=xml).
+TEST_F(ExampleRouter2Test, DISABLED_throughput)
+{
+    ctx->rngseed(1);
+    create_lut_ff_design(250);
+    ASSERT_TRUE(ctx->place());
+
+    Router2Cfg cfg(ctx);
+    cfg.perf_json = perf_file.string();
+    router2(ctx, cfg);
+
+    std::ifstream in(perf_file);
+    std::stringstream buf;
+    buf << in.rdbuf();
+    std::string err;
+    auto perf = json11::Json::parse(buf.str(), err);
+    ASSERT_TRUE(err.empty()) << err;
+    const auto &total = perf["total"];
+    double search_time = total["search_time"].number_value(), popped = total["wires_popped"].number_value();
+    ASSERT_GT(popped, 0);
+    RecordProperty("threads", total["threads"].int_value());
+    RecordProperty("wires_popped", int(popped));
+    RecordProperty("search_ms", int(search_time * 1000));
+    RecordProperty("wires_per_sec", int(search_time > 0 ? popped / search_time : 0));
+}
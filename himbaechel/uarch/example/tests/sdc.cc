@@ -0,0 +1,164 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <vector>
+#include "example_test.h"
+#include "log.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExampleSdcTest : public ExampleTest
+{
+  protected:
+    // A few levels of hierarchy, flattened into names separated by '/'
+    void create_design()
+    {
+        for (int i = 0; i < 8; i++)
+            ctx->createNet(ctx->idf("cpu/alu/sum[%d]", i));
+        ctx->createNet(ctx->id("cpu/clk"));
+        ctx->createNet(ctx->id("clk_main"));
+        ctx->net_aliases[ctx->id("sys_clk")] = ctx->id("clk_main");
+        for (int i = 0; i < 4; i++) {
+            CellInfo *ff = ctx->createCell(ctx->idf("cpu/regs/r%d", i), ctx->id("DFF"));
+            ff->addOutput(ctx->id("Q"));
+            ff->addInput(ctx->id("D"));
+            ff->connectPort(ctx->id("Q"), ctx->createNet(ctx->idf("cpu/regs/q%d", i)));
+        }
+        for (int i = 0; i < 4; i++) {
+            IdString name = ctx->idf("data[%d]", i);
+            ctx->ports[name].name = name;
+            ctx->ports[name].type = PORT_IN;
+            ctx->ports[name].net = ctx->createNet(ctx->idf("data_in[%d]", i));
+        }
+    }
+
+    // The names of the nets that create_clock constrained, sorted
+    std::vector<std::string> clocks(const std::string &sdc)
+    {
+        for (auto &net : ctx->nets)
+            net.second->clkconstr.reset();
+        std::istringstream in(sdc);
+        ctx->read_sdc(in);
+        std::vector<std::string> result;
+        for (auto &net : ctx->nets)
+            if (net.second->clkconstr)
+                result.push_back(net.first.str(ctx));
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::vector<std::string> sums(std::vector<int> bits)
+    {
+        std::vector<std::string> result;
+        for (int bit : bits)
+            result.push_back(stringf("cpu/alu/sum[%d]", bit));
+        return result;
+    }
+};
+
+TEST_F(ExampleSdcTest, exact)
+{
+    create_design();
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets clk_main]"), std::vector<std::string>{"clk_main"});
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets sys_clk]"), std::vector<std::string>{"clk_main"});
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets {cpu/alu/sum[3]}]"), sums({3}));
+    ASSERT_EQ(clocks("create_clock -period 10 [get_ports {data[1]}]"), std::vector<std::string>{"data_in[1]"});
+    ASSERT_EQ(clocks("create_clock -period 10 [get_pins cpu/regs/r2/Q]"), std::vector<std::string>{"cpu/regs/q2"});
+    ASSERT_TRUE(clocks("create_clock -period 10 [get_nets nothing]").empty());
+}
+
+TEST_F(ExampleSdcTest, glob)
+{
+    create_design();
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets {cpu/alu/sum[*]}]"), sums({0, 1, 2, 3, 4, 5, 6, 7}));
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets {cpu/alu/s?m[?]}]"), sums({0, 1, 2, 3, 4, 5, 6, 7}));
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets {*/alu/sum[5]}]"), sums({5}));
+    // Aliases match too, but give the net they alias only once
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets *clk*]"), std::vector<std::string>{"clk_main"});
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets *_clk clk*]"), std::vector<std::string>{"clk_main"});
+    ASSERT_EQ(clocks("create_clock -period 10 [get_ports {data[*]}]"),
+              std::vector<std::string>({"data_in[0]", "data_in[1]", "data_in[2]", "data_in[3]"}));
+    ASSERT_TRUE(clocks("create_clock -period 10 [get_nets cpu/alu/sum*x]").empty());
+}
+
+TEST_F(ExampleSdcTest, hierarchical)
+{
+    create_design();
+    // Without -hierarchical, wildcards stay within one level of the hierarchy
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets cpu/*]"), std::vector<std::string>{"cpu/clk"});
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets cpu?clk]"), std::vector<std::string>{});
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets {cpu/*/sum[7]}]"), sums({7}));
+    auto all = clocks("create_clock -period 10 [get_nets -hierarchical cpu/*]");
+    ASSERT_EQ(all.size(), 13U);
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets -hier {*sum[2]}]"), sums({2}));
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets -hier cpu?clk]"), std::vector<std::string>{"cpu/clk"});
+}
+
+TEST_F(ExampleSdcTest, regexp)
+{
+    create_design();
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets -regexp {cpu/alu/sum.[0-3].}]"), sums({0, 1, 2, 3}));
+    // Matched against the whole name
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets -regexp {sum.1.}]"), std::vector<std::string>{});
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets -regexp {.*sum.(1|6).}]"), sums({1, 6}));
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets -regexp {cpu/alu/sum.[5-9]?.}]"), sums({5, 6, 7}));
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets -regexp -nocase {CLK_.*}]"),
+              std::vector<std::string>{"clk_main"});
+    ASSERT_EQ(clocks("create_clock -period 10 [get_nets -nocase {CPU/ALU/SUM[4]}]"), sums({4}));
+    EXPECT_THROW(clocks("create_clock -period 10 [get_nets -regexp {cpu/(}]"), log_execution_error_exception);
+}
+
+TEST_F(ExampleSdcTest, cells_and_pins)
+{
+    create_design();
+    ASSERT_EQ(clocks("create_clock -period 10 [get_pins {cpu/regs/r*/Q}]"),
+              std::vector<std::string>({"cpu/regs/q0", "cpu/regs/q1", "cpu/regs/q2", "cpu/regs/q3"}));
+    // D is not connected
+    ASSERT_EQ(clocks("create_clock -period 10 [get_pins {cpu/regs/r1/*}]"), std::vector<std::string>{"cpu/regs/q1"});
+    ASSERT_TRUE(clocks("create_clock -period 10 [get_pins {cpu/regs/r1/D}]").empty());
+    // create_clock does not take cells, so this only fails if some were found
+    EXPECT_THROW(clocks("create_clock -period 10 [get_cells cpu/regs/*]"), log_execution_error_exception);
+    ASSERT_TRUE(clocks("create_clock -period 10 [get_cells -quiet cpu/alu/*]").empty());
+    EXPECT_THROW(clocks("create_clock -period 10 [get_cells -bogus cpu/regs/*]"), log_execution_error_exception);
+}
+
+// Time to load a constraint file with many wildcard queries against a large design. This only records numbers, so is
+// disabled by default; run with --gtest_also_run_disabled_tests to see them.
+TEST_F(ExampleSdcTest, DISABLED_throughput)
+{
+    const int net_count = 500000, query_count = 2000;
+    for (int i = 0; i < net_count; i++)
+        ctx->createNet(ctx->idf("top/u%d/n%d", i % 1000, i));
+    std::ostringstream sdc;
+    for (int i = 0; i < query_count; i++)
+        sdc << "create_clock -period 10 [get_nets -quiet " << stringf("top/u%d/n%d", (i * 7919) % 1000, i * 97)
+            << "?]\n";
+    std::ostringstream regexp_sdc;
+    for (int i = 0; i < 10; i++)
+        regexp_sdc << "create_clock -period 10 [get_nets -quiet -regexp " << stringf("{.*/n%d}", i * 12347) << "]\n";
+    auto time = [&](const std::string &label, const std::string &text) {
+        auto start = std::chrono::steady_clock::now();
+        clocks(text);
+        RecordProperty(label + "_ms",
+                       int(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000));
+    };
+    time("glob", sdc.str());
+    time("regexp", regexp_sdc.str());
+}
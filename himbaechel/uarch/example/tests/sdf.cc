@@ -0,0 +1,99 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <sstream>
+#include <vector>
+#include "example_test.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExampleSdfTest : public ExampleTest
+{
+  protected:
+    // LUTs each driving a FF on a shared clock, with names that need escaping; placed, so that net delays are
+    // predicted from the bel locations. Each cell goes on the first free bel that takes it, rather than through the
+    // placer, so that the placement is the same whatever the thread count.
+    void create_design(int lut_count)
+    {
+        ctx->attrs[ctx->id("module")] = std::string("top\"x");
+        create_lut_ff_design(lut_count, "$u[0].", ctx->createNet(ctx->id("clk")));
+        dict<IdString, std::vector<CellInfo *>> unplaced;
+        for (auto &cell : ctx->cells)
+            unplaced[cell.second->type].push_back(cell.second.get());
+        for (BelId bel : ctx->getBels()) {
+            for (auto &type : unplaced) {
+                if (type.second.empty() || !ctx->isValidBelForCellType(type.first, bel))
+                    continue;
+                ctx->bindBel(bel, type.second.back(), STRENGTH_USER);
+                type.second.pop_back();
+                break;
+            }
+        }
+        for (auto &cell : ctx->cells)
+            ASSERT_NE(cell.second->bel, BelId());
+    }
+
+    std::string write(bool cvc_mode)
+    {
+        std::ostringstream out;
+        ctx->writeSDF(out, cvc_mode);
+        return out.str();
+    }
+};
+
+TEST_F(ExampleSdfTest, format)
+{
+    ctx->rngseed(1);
+    create_design(10);
+    std::string sdf = write(false);
+    auto contains = [&](const std::string &text) { return sdf.find(text) != std::string::npos; };
+    std::string header = "(DELAYFILE\n  (SDFVERSION \"3.0\")\n  (DESIGN \"top\"\"x\")\n";
+    ASSERT_EQ(sdf.substr(0, header.size()), header);
+    ASSERT_TRUE(contains("  (DIVIDER /)\n"));
+    ASSERT_TRUE(contains("    (CELLTYPE \"top\"\"x\")\n    (INSTANCE )\n"));
+    ASSERT_TRUE(contains("    (CELLTYPE \"LUT4\")\n    (INSTANCE \\$u\\[0\\].lut5)\n"));
+    ASSERT_TRUE(contains("        (IOPATH I\\[3\\] F (195:195:195) (195:195:195))\n"));
+    ASSERT_TRUE(contains("        (IOPATH CLK Q (200:200:200) (200:200:200))\n"));
+    ASSERT_TRUE(contains("      (SETUPHOLD (negedge D) (posedge CLK) (150:150:150) (25:25:25))\n"));
+    ASSERT_TRUE(contains("        (INTERCONNECT \\$u\\[0\\].lut8/F \\$u\\[0\\].lut9/I\\[1\\] "));
+    // The clock has no driver, so no interconnect delays
+    ASSERT_FALSE(contains("/CLK ("));
+    // The first LUT has no inputs connected, so no delays
+    std::string footer = "    (INSTANCE \\$u\\[0\\].lut0)\n    )\n)\n";
+    ASSERT_EQ(sdf.substr(sdf.size() - footer.size()), footer);
+
+    std::string cvc = write(true);
+    ASSERT_NE(cvc.find("  (DIVIDER .)\n"), std::string::npos);
+    ASSERT_NE(cvc.find("    (INSTANCE \\$u\\[0\\]\\.ff9)\n"), std::string::npos);
+    ASSERT_NE(cvc.find("        (INTERCONNECT \\$u\\[0\\]\\.lut8.F \\$u\\[0\\]\\.lut9.I\\[1\\] "),
+              std::string::npos);
+}
+
+TEST_F(ExampleSdfTest, thread_count_independent)
+{
+    std::vector<std::string> results;
+    for (int threads : {1, 3, 8}) {
+        delete ctx;
+        ctx = new_context(threads);
+        // Enough cells and nets for several rounds of chunks to be written in parallel
+        ctx->rngseed(1);
+        create_design(600);
+        results.push_back(write(false) + write(true));
+    }
+    ASSERT_EQ(results.at(1), results.at(0));
+    ASSERT_EQ(results.at(2), results.at(0));
+}
@@ -0,0 +1,58 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "gtest/gtest.h"
+#include "thread_pool.h"
+
+USING_NEXTPNR_NAMESPACE
+
+TEST(ThreadPoolTest, runs_every_index_once)
+{
+    ThreadPool pool(4);
+    for (int count : {0, 1, 3, 1000}) {
+        std::vector<std::atomic<int>> calls(count);
+        pool.run(count, [&](int i) { calls.at(i)++; });
+        for (auto &c : calls)
+            ASSERT_EQ(c.load(), 1);
+    }
+}
+
+TEST(ThreadPoolTest, nested_run)
+{
+    ThreadPool pool(4);
+    std::atomic<int> total{0};
+    pool.run(8, [&](int) { pool.run(8, [&](int) { total++; }); });
+    ASSERT_EQ(total.load(), 64);
+}
+
+TEST(ThreadPoolTest, exception_reaches_caller)
+{
+    ThreadPool pool(4);
+    ASSERT_THROW(pool.run(100,
+                          [&](int i) {
+                              if (i == 77)
+                                  throw std::runtime_error("failed");
+                          }),
+                 std::runtime_error);
+    // The pool is still usable afterwards
+    std::atomic<int> total{0};
+    pool.run(100, [&](int) { total++; });
+    ASSERT_EQ(total.load(), 100);
+}
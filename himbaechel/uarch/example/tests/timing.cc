@@ -0,0 +1,146 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <vector>
+#include "example_test.h"
+#include "timing.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class ExampleTimingTest : public ExampleTest
+{
+  protected:
+    // Create a random network of LUTs, with a FF on every LUT output
+    void create_design(int lut_count)
+    {
+        ctx->settings[ctx->id("target_freq")] = std::to_string(100e6);
+        CellInfo *clk_buf = ctx->createCell(ctx->id("clk_buf"), ctx->id("INBUF"));
+        add_port(clk_buf, "O", PORT_OUT);
+        NetInfo *clk = ctx->createNet(ctx->id("clk"));
+        clk_buf->connectPort(ctx->id("O"), clk);
+
+        std::vector<NetInfo *> signals;
+        for (int i = 0; i < lut_count; i++) {
+            CellInfo *lut = ctx->createCell(ctx->idf("lut%d", i), ctx->id("LUT4"));
+            for (int j = 0; j < 4; j++)
+                add_port(lut, stringf("I[%d]", j), PORT_IN);
+            add_port(lut, "F", PORT_OUT);
+            CellInfo *ff = ctx->createCell(ctx->idf("ff%d", i), ctx->id("DFF"));
+            add_port(ff, "D", PORT_IN);
+            add_port(ff, "CLK", PORT_IN);
+            add_port(ff, "Q", PORT_OUT);
+
+            NetInfo *lut_out = ctx->createNet(ctx->idf("lut%d_f", i));
+            lut->connectPort(ctx->id("F"), lut_out);
+            ff->connectPort(ctx->id("D"), lut_out);
+            ff->connectPort(ctx->id("CLK"), clk);
+            NetInfo *ff_out = ctx->createNet(ctx->idf("ff%d_q", i));
+            ff->connectPort(ctx->id("Q"), ff_out);
+
+            // Only connect to earlier signals, so there are no combinational loops
+            for (int j = 0; j < 4 && !signals.empty(); j++)
+                lut->connectPort(ctx->idf("I[%d]", j), signals.at(ctx->rng(int(signals.size()))));
+            signals.push_back(lut_out);
+            signals.push_back(ff_out);
+        }
+        ctx->assignArchInfo();
+    }
+
+    // The same port in a context holding the same design as ctx
+    CellPortKey same_port(const Context *other, CellPortKey port)
+    {
+        return CellPortKey(other->id(port.cell.str(ctx)), other->id(port.port.str(ctx)));
+    }
+
+    // Analysers a on ctx and b on b_ctx, which holds the same design, get the same random route delays
+    void randomise_route_delays(TimingAnalyser &a, TimingAnalyser &b, int count, const Context *b_ctx)
+    {
+        std::vector<CellPortKey> sinks;
+        for (auto &net : ctx->nets)
+            for (auto &usr : net.second->users)
+                sinks.emplace_back(usr);
+        for (int i = 0; i < count; i++) {
+            CellPortKey port = sinks.at(ctx->rng(int(sinks.size())));
+            delay_t delay = ctx->rng(2000);
+            a.set_route_delay(port, DelayPair(delay));
+            b.set_route_delay(same_port(b_ctx, port), DelayPair(delay));
+        }
+    }
+
+    void check_identical(TimingAnalyser &a, TimingAnalyser &b, const Context *b_ctx)
+    {
+        for (auto &cell : ctx->cells) {
+            for (auto &port : cell.second->ports) {
+                if (port.second.net == nullptr)
+                    continue;
+                CellPortKey key(cell.first, port.first), b_key = same_port(b_ctx, key);
+                ASSERT_EQ(a.get_criticality(key), b.get_criticality(b_key));
+                ASSERT_EQ(a.get_setup_slack(key), b.get_setup_slack(b_key));
+                ASSERT_EQ(a.get_domain_setup_slack(key), b.get_domain_setup_slack(b_key));
+            }
+        }
+    }
+};
+
+TEST_F(ExampleTimingTest, incremental_matches_full)
+{
+    ctx->rngseed(1);
+    create_design(500);
+    for (bool with_clock_skew : {false, true}) {
+        TimingAnalyser full(ctx), incr(ctx);
+        full.with_clock_skew = with_clock_skew;
+        incr.with_clock_skew = with_clock_skew;
+        incr.incremental = true;
+        full.setup();
+        incr.setup();
+        // A mix of small changes, which take the incremental path, and large ones, which fall back to a full run
+        for (int count : {1, 5, 20, 100, 2000, 3}) {
+            randomise_route_delays(full, incr, count, ctx);
+            full.run(false);
+            incr.run(false);
+            check_identical(full, incr, ctx);
+        }
+    }
+}
+
+TEST_F(ExampleTimingTest, multithreaded_matches_single)
+{
+    // The thread count is fixed for each context, so the multithreaded analyser runs on a second copy of the design
+    delete ctx;
+    ctx = new_context(4);
+    ctx->rngseed(1);
+    create_design(5000);
+    Context *multi_ctx = ctx;
+    ctx = new_context(1);
+    ctx->rngseed(1);
+    create_design(5000);
+    for (bool with_clock_skew : {false, true}) {
+        TimingAnalyser single(ctx), multi(multi_ctx);
+        single.with_clock_skew = with_clock_skew;
+        multi.with_clock_skew = with_clock_skew;
+        single.setup();
+        multi.setup();
+        check_identical(single, multi, multi_ctx);
+        for (int i = 0; i < 3; i++) {
+            randomise_route_delays(single, multi, 5000, multi_ctx);
+            single.run(false);
+            multi.run(false);
+            check_identical(single, multi, multi_ctx);
+        }
+    }
+    delete multi_ctx;
+}
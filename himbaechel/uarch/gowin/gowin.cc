@@ -40,6 +40,7 @@ struct GowinImpl : HimbaechelAPI
     void notifyBelChange(BelId bel, CellInfo *cell) override;
 
     delay_t estimateDelay(WireId src, WireId dst) const override;
+    bool isPredictDelayRelative() const override { return true; } // the default predictDelay only uses the distance
 
     // Bel bucket functions
     IdString getBelBucketForCellType(IdString cell_type) const override;
@@ -584,6 +584,9 @@ struct Arch : BaseArch<ArchRanges>
         return wire_to_net[wire.index];
     }
 
+    int getWireIndex(WireId wire) const override { return wire.index; }
+    int getWireCount() const override { return int(chip_info->wire_data.size()); }
+
     DelayQuad getWireDelay(WireId wire) const override
     {
         NPNR_ASSERT(wire != WireId());
@@ -797,6 +800,7 @@ struct Arch : BaseArch<ArchRanges>
 
     delay_t estimateDelay(WireId src, WireId dst) const override;
     delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const override;
+    bool isPredictDelayRelative() const override { return true; }
     delay_t getDelayEpsilon() const override { return 20; }
     delay_t getRipupDelayPenalty() const override { return 200; }
     float getDelayNS(delay_t v) const override { return v * 0.001; }
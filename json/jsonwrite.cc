@@ -19,12 +19,14 @@
 
 #include "jsonwrite.h"
 #include <assert.h>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <log.h>
 #include <map>
 #include <string>
+#include <string_view>
 #include "nextpnr.h"
 #include "version.h"
 
@@ -32,63 +34,87 @@ NEXTPNR_NAMESPACE_BEGIN
 
 namespace JsonWriter {
 
-std::string get_string(std::string str)
+// Everything is formatted by appending to string buffers, rather than through many small stream writes, so that cells
+// and nets can be formatted in parallel and then written out in order
+
+void append_string(std::string &out, std::string_view str)
 {
-    std::string newstr = "\"";
+    out += '"';
     for (char c : str) {
         if (c == '\\')
-            newstr += c;
-        newstr += c;
+            out += c;
+        out += c;
     }
-    return newstr + "\"";
+    out += '"';
 }
 
-std::string get_name(IdString name, Context *ctx) { return get_string(name.c_str(ctx)); }
+void append_name(std::string &out, IdString name, const Context *ctx) { append_string(out, name.str(ctx)); }
+
+void append_property(std::string &out, const Property &value)
+{
+    if (value.is_string) {
+        append_string(out, value.to_string());
+    } else {
+        // As to_string, bits MSB first; these never need escaping
+        out += '"';
+        out.append(value.str.rbegin(), value.str.rend());
+        out += '"';
+    }
+}
 
-void write_parameters(std::ostream &f, Context *ctx, const dict<IdString, Property> &parameters,
+void write_parameters(std::string &out, const Context *ctx, const dict<IdString, Property> &parameters,
                       bool for_module = false)
 {
     bool first = true;
     for (auto &param : parameters) {
-        f << stringf("%s\n", first ? "" : ",");
-        f << stringf("        %s%s: ", for_module ? "" : "    ", get_name(param.first, ctx).c_str());
-        f << get_string(param.second.to_string());
+        out += first ? "\n" : ",\n";
+        out += for_module ? "        " : "            ";
+        append_name(out, param.first, ctx);
+        out += ": ";
+        append_property(out, param.second);
         first = false;
     }
 }
 
 struct PortGroup
 {
-    std::string name;
+    // Points into the IdString database, which never moves its strings
+    std::string_view name;
     std::vector<std::pair<int, int>> grouped_bits; // (index, bit)
     std::vector<int> bits;
     PortType dir;
     int offset = 0;
 };
 
-std::vector<PortGroup> group_ports(Context *ctx, const dict<IdString, PortInfo> &ports, bool is_cell = false)
+std::vector<PortGroup> group_ports(const Context *ctx, const dict<IdString, PortInfo> &ports, bool is_cell = false)
 {
     std::vector<PortGroup> groups;
     dict<std::string, size_t> base_to_group;
+    // The bits of a bus are usually next to each other, so try the last bus seen before the lookup
+    int last_bus = -1;
     for (auto &pair : ports) {
-        std::string name = pair.second.name.str(ctx);
-        if ((name.back() != ']') || (name.find('[') == std::string::npos)) {
+        std::string_view name = pair.second.name.str(ctx);
+        if ((name.empty() || name.back() != ']') || (name.find('[') == std::string_view::npos)) {
             groups.push_back(
                     {name,
                      {{0, (is_cell ? (pair.second.net ? pair.second.net->name.index : -1) : pair.first.index)}},
                      {},
                      pair.second.type});
         } else {
-            int off1 = int(name.find_last_of('['));
-            std::string basename = name.substr(0, off1);
-            int index = std::stoi(name.substr(off1 + 1, name.size() - (off1 + 2)));
+            size_t off1 = name.find_last_of('[');
+            std::string_view basename = name.substr(0, off1);
+            int index = std::stoi(std::string(name.substr(off1 + 1, name.size() - (off1 + 2))));
 
-            if (!base_to_group.count(basename)) {
-                base_to_group[basename] = groups.size();
-                groups.push_back({basename, {}, {}, pair.second.type});
+            if (last_bus == -1 || groups.at(last_bus).name != basename) {
+                std::string key(basename);
+                if (!base_to_group.count(key)) {
+                    base_to_group[key] = groups.size();
+                    groups.push_back({basename, {}, {}, pair.second.type});
+                }
+                last_bus = int(base_to_group.at(key));
             }
 
-            auto &grp = groups.at(base_to_group[basename]);
+            auto &grp = groups.at(last_bus);
             grp.grouped_bits.emplace_back(index, pair.second.net ? pair.second.net->name.index
                                                                  : (is_cell ? -1 : pair.first.index));
         }
@@ -104,129 +130,213 @@ std::vector<PortGroup> group_ports(Context *ctx, const dict<IdString, PortInfo>
             NPNR_ASSERT(group.bits.at(vec_idx) == -1);
             group.bits.at(vec_idx) = bit.second;
         }
+        group.grouped_bits = {};
     }
     return groups;
 }
 
-std::string format_port_bits(const PortGroup &port, int &dummy_idx)
+// Single disconnected ports are written as an empty list; missing bits of anything else get a unique dummy number
+bool skip_port_bits(const PortGroup &port) { return port.bits.size() == 1 && port.bits.at(0) == -1; }
+
+int count_dummy_bits(const PortGroup &port)
+{
+    return skip_port_bits(port) ? 0 : int(std::count(port.bits.begin(), port.bits.end(), -1));
+}
+
+void format_port_bits(std::string &out, const PortGroup &port, int &dummy_idx)
 {
-    std::stringstream s;
-    s << "[ ";
+    out += "[ ";
     bool first = true;
-    if (port.bits.size() != 1 || port.bits.at(0) != -1) // skip single disconnected ports
+    if (!skip_port_bits(port))
         for (auto bit : port.bits) {
             if (!first)
-                s << ", ";
-            if (bit == -1)
-                s << (++dummy_idx);
-            else
-                s << bit;
+                out += ", ";
+            out += std::to_string((bit == -1) ? ++dummy_idx : bit);
             first = false;
         }
-    s << " ]";
-    return s.str();
+    out += " ]";
+}
+
+// Below this many cells or nets, handing work to the thread pool costs more than it saves
+static constexpr int min_parallel_items = 1024;
+
+// Split [0, count) into at most max_blocks contiguous blocks, run in parallel, calling func(block, begin, end)
+template <typename Tf> void run_blocks(Context *ctx, int count, int max_blocks, Tf func)
+{
+    if (max_blocks == 1 || count < min_parallel_items) {
+        func(0, 0, count);
+        return;
+    }
+    int block_size = (count + max_blocks - 1) / max_blocks;
+    ctx->get_thread_pool().run(max_blocks, [&](int block) {
+        int begin = std::min(count, block * block_size);
+        int end = std::min(count, begin + block_size);
+        func(block, begin, end);
+    });
+}
+
+void write_cell(std::string &out, const Context *ctx, const CellInfo *c, const std::vector<PortGroup> &cell_ports,
+                int &dummy_idx)
+{
+    out += "        ";
+    append_name(out, c->name, ctx);
+    out += ": {\n";
+    out += "          \"hide_name\": ";
+    out += (c->name.c_str(ctx)[0] == '$') ? "1" : "0";
+    out += ",\n";
+    out += "          \"type\": ";
+    append_name(out, c->type, ctx);
+    out += ",\n";
+    out += "          \"parameters\": {";
+    write_parameters(out, ctx, c->params);
+    out += "\n          },\n";
+    out += "          \"attributes\": {";
+    write_parameters(out, ctx, c->attrs);
+    out += "\n          },\n";
+    out += "          \"port_directions\": {";
+    bool first = true;
+    for (auto &pg : cell_ports) {
+        out += first ? "\n" : ",\n";
+        out += "            ";
+        append_string(out, pg.name);
+        out += (pg.dir == PORT_IN) ? ": \"input\"" : (pg.dir == PORT_OUT) ? ": \"output\"" : ": \"inout\"";
+        first = false;
+    }
+    out += "\n          },\n";
+    out += "          \"connections\": {";
+    first = true;
+    for (auto &pg : cell_ports) {
+        out += first ? "\n" : ",\n";
+        out += "            ";
+        append_string(out, pg.name);
+        out += ": ";
+        format_port_bits(out, pg, dummy_idx);
+        first = false;
+    }
+    out += "\n          }\n";
+    out += "        }";
+}
+
+void write_net(std::string &out, const Context *ctx, const NetInfo *w)
+{
+    out += "        ";
+    append_name(out, w->name, ctx);
+    out += ": {\n";
+    out += "          \"hide_name\": ";
+    out += (w->name.c_str(ctx)[0] == '$') ? "1" : "0";
+    out += ",\n";
+    out += "          \"bits\": [ ";
+    out += std::to_string(w->name.index);
+    out += " ] ,\n";
+    out += "          \"attributes\": {";
+    write_parameters(out, ctx, w->attrs);
+    out += "\n          }\n";
+    out += "        }";
 }
 
 void write_module(std::ostream &f, Context *ctx)
 {
+    std::string out;
     auto val = ctx->attrs.find(ctx->id("module"));
-    int dummy_idx = int(ctx->idstring_idx_to_str->size()) + 1000;
-    if (val != ctx->attrs.end())
-        f << stringf("    %s: {\n", get_string(val->second.as_string()).c_str());
-    else
-        f << stringf("    %s: {\n", get_string("top").c_str());
-    f << stringf("      \"settings\": {");
-    write_parameters(f, ctx, ctx->settings, true);
-    f << stringf("\n      },\n");
-    f << stringf("      \"attributes\": {");
-    write_parameters(f, ctx, ctx->attrs, true);
-    f << stringf("\n      },\n");
-    f << stringf("      \"ports\": {");
+    int dummy_idx = ctx->idstring_db->size() + 1000;
+    out += "    ";
+    append_string(out, (val != ctx->attrs.end()) ? val->second.as_string() : std::string("top"));
+    out += ": {\n";
+    out += "      \"settings\": {";
+    write_parameters(out, ctx, ctx->settings, true);
+    out += "\n      },\n";
+    out += "      \"attributes\": {";
+    write_parameters(out, ctx, ctx->attrs, true);
+    out += "\n      },\n";
+    out += "      \"ports\": {";
 
     auto ports = group_ports(ctx, ctx->ports);
     bool first = true;
     for (auto &port : ports) {
-        f << stringf("%s\n", first ? "" : ",");
-        f << stringf("        %s: {\n", get_string(port.name).c_str());
-        f << stringf("          \"direction\": \"%s\",\n", port.dir == PORT_IN      ? "input"
-                                                           : port.dir == PORT_INOUT ? "inout"
-                                                                                    : "output");
+        out += first ? "\n" : ",\n";
+        out += "        ";
+        append_string(out, port.name);
+        out += ": {\n";
+        out += "          \"direction\": ";
+        out += port.dir == PORT_IN ? "\"input\",\n" : port.dir == PORT_INOUT ? "\"inout\",\n" : "\"output\",\n";
         if (port.offset != 0) {
-            f << stringf("          \"offset\": %d,\n", port.offset);
+            out += "          \"offset\": ";
+            out += std::to_string(port.offset);
+            out += ",\n";
         }
-        f << stringf("          \"bits\": %s\n", format_port_bits(port, dummy_idx).c_str());
-        f << stringf("        }");
+        out += "          \"bits\": ";
+        format_port_bits(out, port, dummy_idx);
+        out += "\n        }";
         first = false;
     }
-    f << stringf("\n      },\n");
+    out += "\n      },\n";
+    out += "      \"cells\": {";
+    f.write(out.data(), out.size());
 
-    f << stringf("      \"cells\": {");
-    first = true;
-    for (auto &pair : ctx->cells) {
-        auto &c = pair.second;
-        auto cell_ports = group_ports(ctx, c->ports, true);
-        f << stringf("%s\n", first ? "" : ",");
-        f << stringf("        %s: {\n", get_name(c->name, ctx).c_str());
-        f << stringf("          \"hide_name\": %s,\n", c->name.c_str(ctx)[0] == '$' ? "1" : "0");
-        f << stringf("          \"type\": %s,\n", get_name(c->type, ctx).c_str());
-        f << stringf("          \"parameters\": {");
-        write_parameters(f, ctx, c->params);
-        f << stringf("\n          },\n");
-        f << stringf("          \"attributes\": {");
-        write_parameters(f, ctx, c->attrs);
-        f << stringf("\n          },\n");
-        f << stringf("          \"port_directions\": {");
-        bool first2 = true;
-        for (auto &pg : cell_ports) {
-            std::string direction = (pg.dir == PORT_IN) ? "input" : (pg.dir == PORT_OUT) ? "output" : "inout";
-            f << stringf("%s\n", first2 ? "" : ",");
-            f << stringf("            %s: \"%s\"", get_string(pg.name).c_str(), direction.c_str());
-            first2 = false;
+    // Dummy bit numbers follow the order cells are written in, so count them for each block of cells first, to know
+    // where each block starts
+    int max_blocks = ctx->get_thread_pool().size();
+    std::vector<const CellInfo *> cells;
+    cells.reserve(ctx->cells.size());
+    for (auto &pair : ctx->cells)
+        cells.push_back(pair.second.get());
+    std::vector<std::vector<PortGroup>> cell_ports(cells.size());
+    std::vector<int> block_dummies(max_blocks, 0);
+    run_blocks(ctx, int(cells.size()), max_blocks, [&](int block, int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            cell_ports.at(i) = group_ports(ctx, cells.at(i)->ports, true);
+            for (auto &pg : cell_ports.at(i))
+                block_dummies.at(block) += count_dummy_bits(pg);
         }
-        f << stringf("\n          },\n");
-        f << stringf("          \"connections\": {");
-        first2 = true;
-        for (auto &pg : cell_ports) {
-            f << stringf("%s\n", first2 ? "" : ",");
-            f << stringf("            %s: %s", get_string(pg.name).c_str(), format_port_bits(pg, dummy_idx).c_str());
-            first2 = false;
+    });
+    std::vector<std::string> blocks(max_blocks);
+    run_blocks(ctx, int(cells.size()), max_blocks, [&](int block, int begin, int end) {
+        int block_dummy_idx = dummy_idx;
+        for (int i = 0; i < block; i++)
+            block_dummy_idx += block_dummies.at(i);
+        for (int i = begin; i < end; i++) {
+            blocks.at(block) += (i == 0) ? "\n" : ",\n";
+            write_cell(blocks.at(block), ctx, cells.at(i), cell_ports.at(i), block_dummy_idx);
+            cell_ports.at(i) = {};
         }
-        f << stringf("\n          }\n");
-
-        f << stringf("        }");
-        first = false;
+    });
+    for (auto &block : blocks) {
+        f.write(block.data(), block.size());
+        block = {};
     }
 
-    f << stringf("\n      },\n");
+    f << "\n      },\n";
+    f << "      \"netnames\": {";
 
-    f << stringf("      \"netnames\": {");
-    first = true;
-    for (auto &pair : ctx->nets) {
-        auto &w = pair.second;
-        f << stringf("%s\n", first ? "" : ",");
-        f << stringf("        %s: {\n", get_name(w->name, ctx).c_str());
-        f << stringf("          \"hide_name\": %s,\n", w->name.c_str(ctx)[0] == '$' ? "1" : "0");
-        f << stringf("          \"bits\": [ %d ] ,\n", pair.first.index);
-        f << stringf("          \"attributes\": {");
-        write_parameters(f, ctx, w->attrs);
-        f << stringf("\n          }\n");
-        f << stringf("        }");
-        first = false;
-    }
+    std::vector<const NetInfo *> nets;
+    nets.reserve(ctx->nets.size());
+    for (auto &pair : ctx->nets)
+        nets.push_back(pair.second.get());
+    run_blocks(ctx, int(nets.size()), max_blocks, [&](int block, int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            blocks.at(block) += (i == 0) ? "\n" : ",\n";
+            write_net(blocks.at(block), ctx, nets.at(i));
+        }
+    });
+    for (auto &block : blocks)
+        f.write(block.data(), block.size());
 
-    f << stringf("\n      }\n");
-    f << stringf("    }");
+    f << "\n      }\n";
+    f << "    }";
 }
 
 void write_context(std::ostream &f, Context *ctx)
 {
-    f << stringf("{\n");
-    f << stringf("  \"creator\": %s,\n",
-                 get_string("Next Generation Place and Route (Version " GIT_DESCRIBE_STR ")").c_str());
-    f << stringf("  \"modules\": {\n");
+    std::string out;
+    out += "{\n";
+    out += "  \"creator\": ";
+    append_string(out, "Next Generation Place and Route (Version " GIT_DESCRIBE_STR ")");
+    out += ",\n";
+    out += "  \"modules\": {\n";
+    f << out;
     write_module(f, ctx);
-    f << stringf("\n  }");
-    f << stringf("\n}\n");
+    f << "\n  }";
+    f << "\n}\n";
 }
 
 }; // End Namespace JsonWriter
@@ -736,6 +736,9 @@ struct Arch : BaseArch<ArchRanges>
     virtual bool checkWireAvail(WireId wire) const override { return getBoundWireNet(wire) == nullptr; }
     NetInfo *getBoundWireNet(WireId wire) const override { return wire2net.at(get_wire_vecidx(wire)); }
 
+    int getWireIndex(WireId wire) const override { return get_wire_vecidx(wire); }
+    int getWireCount() const override { return int(wire2net.size()); }
+
     DelayQuad getWireDelay(WireId wire) const override { return DelayQuad(0); }
 
     WireRange getWires() const override
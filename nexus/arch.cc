@@ -127,6 +127,8 @@ Arch::Arch(ArchArgs args) : args(args)
         auto &ts = tileStatus.at(i);
         ts.boundwires.resize(loc.wires.size());
         ts.boundpips.resize(loc.pips.size());
+        tile_wire_index.push_back(wire_count);
+        wire_count += int(loc.wires.size());
     }
 
     for (int i = 0; i < chip_info->width; i++) {
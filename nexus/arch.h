@@ -927,6 +927,10 @@ struct Arch : BaseArch<ArchRanges>
 
     std::vector<TileStatus> tileStatus;
 
+    // offset of the first wire of each tile in the dense wire index
+    std::vector<int> tile_wire_index;
+    int wire_count = 0;
+
     // fast access to  X and Y IdStrings for building object names
     std::vector<IdString> x_ids, y_ids;
     // inverse of the above for name->object mapping
@@ -1179,6 +1183,9 @@ struct Arch : BaseArch<ArchRanges>
     virtual bool checkWireAvail(WireId wire) const override { return getBoundWireNet(wire) == nullptr; }
     NetInfo *getBoundWireNet(WireId wire) const override { return tileStatus.at(wire.tile).boundwires.at(wire.index); }
 
+    int getWireIndex(WireId wire) const override { return tile_wire_index.at(wire.tile) + wire.index; }
+    int getWireCount() const override { return wire_count; }
+
     IdString getWireConstantValue(WireId wire) const override
     {
         if (chip_wire_data(db, chip_info, wire).name == ID_LOCAL_VCC)
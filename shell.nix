@@ -24,7 +24,6 @@ in pkgs.mkShell {
   buildInputs = with pkgs; [
     cmake
     ninja
-    eigen
     boostPython
     pythonPkgs.python
     apycula